@@ -0,0 +1,410 @@
+#include "bench_util.h"
+
+#include "alloc.h"
+#include "editor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Headless editor-core benchmark. Every workload runs against a freshly
+// loaded document and prints one JSON object per line:
+//
+//   andex_bench [--sizes 1K,64K,1M,16M,128M,500M] [--workloads a,b]
+//               [--max-ops N] [--seed N] [--check-allocs]
+//
+// Op counts are derived from the document size (not wall time) so two runs
+// with the same arguments execute exactly the same edits.
+//
+// --check-allocs instead asserts that steady-state keystrokes (typing,
+// cursor movement, backspace) do no allocations in the editor core, and
+// exits non-zero if any of them does. Its sizes default to 1K,64K,1M.
+
+#define BENCH_DEFAULT_SIZES "1K,64K,1M,16M,128M,500M"
+#define BENCH_DEFAULT_MAX_OPS 20000
+#define BENCH_MIN_OPS 3
+#define BENCH_WORK_BYTES (256ull * 1024 * 1024)
+#define BENCH_PASTE_BYTES 4096
+#define BENCH_LINE_WIDTH 80
+#define BENCH_CHECK_SIZES "1K,64K,1M"
+#define BENCH_CHECK_KEYSTROKES 500
+
+typedef struct {
+  TextEditor editor;
+  BenchRng rng;
+  const char *paste;
+  size_t paste_len;
+  size_t typed;
+  size_t chain_len;
+} BenchCtx;
+
+typedef struct {
+  const char *name;
+  void (*prepare)(BenchCtx *ctx, size_t ops);
+  void (*setup)(BenchCtx *ctx);
+  void (*run)(BenchCtx *ctx);
+  size_t op_cap;
+  bool chain;
+} Workload;
+
+static const char TYPED_TEXT[] =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five "
+    "dozen liquor jugs.\n";
+
+static size_t doc_len(BenchCtx *ctx) {
+  return char_buffer_len(&ctx->editor.chars);
+}
+
+static void move_to_middle(BenchCtx *ctx, size_t ops) {
+  (void)ops;
+  text_editor_move_to_pos(&ctx->editor, doc_len(ctx) / 2);
+}
+
+static void run_type_char(BenchCtx *ctx) {
+  const char *c = &TYPED_TEXT[ctx->typed++ % (sizeof(TYPED_TEXT) - 1)];
+  text_editor_insert(&ctx->editor, c, 1);
+}
+
+static void run_paste(BenchCtx *ctx) {
+  text_editor_insert(&ctx->editor, ctx->paste, ctx->paste_len);
+}
+
+static void run_random_move(BenchCtx *ctx) {
+  size_t pos = bench_rng_range(&ctx->rng, doc_len(ctx) + 1);
+  text_editor_move_to_pos(&ctx->editor, pos);
+}
+
+static void setup_word_delete(BenchCtx *ctx) {
+  if (ctx->editor.cursor.byte_pos == 0)
+    text_editor_move_to_pos(&ctx->editor, doc_len(ctx));
+}
+
+static void run_word_delete(BenchCtx *ctx) {
+  text_editor_delete_word_backward(&ctx->editor);
+}
+
+static void setup_select_all(BenchCtx *ctx) {
+  if (doc_len(ctx) == 0)
+    text_editor_undo(&ctx->editor);
+  text_editor_set_selection(&ctx->editor, 0, doc_len(ctx));
+}
+
+static void run_select_all_delete(BenchCtx *ctx) {
+  text_editor_delete_selection(&ctx->editor);
+}
+
+// records `ops` keystrokes, then each timed run undoes the whole chain and
+// redoes it again
+static void prepare_undo_chain(BenchCtx *ctx, size_t ops) {
+  move_to_middle(ctx, ops);
+  for (size_t i = 0; i < ops; i++)
+    run_type_char(ctx);
+}
+
+static void run_undo_redo(BenchCtx *ctx) {
+  for (size_t i = 0; i < ctx->chain_len; i++)
+    text_editor_undo(&ctx->editor);
+  for (size_t i = 0; i < ctx->chain_len; i++)
+    text_editor_redo(&ctx->editor);
+}
+
+// the document as one line of words, the shape of corpus_gen's long_line,
+// typed into at the middle; each keystroke cuts the render lines again
+static void prepare_long_line(BenchCtx *ctx, size_t ops) {
+  const size_t len = doc_len(ctx);
+  char *text = malloc(len + 1);
+  if (text) {
+    char_buffer_to_buffer(&ctx->editor.chars, text, len + 1);
+    for (size_t i = 0; i < len; i++) {
+      if (text[i] == '\n')
+        text[i] = ' ';
+    }
+    text_editor_clear(&ctx->editor);
+    text_editor_insert(&ctx->editor, text, len);
+    free(text);
+  }
+  move_to_middle(ctx, ops);
+  text_editor_prepare_render_lines(&ctx->editor);
+}
+
+static void run_long_line_type(BenchCtx *ctx) {
+  run_type_char(ctx);
+  text_editor_prepare_render_lines(&ctx->editor);
+}
+
+static const Workload WORKLOADS[] = {
+    {"typing", move_to_middle, NULL, run_type_char, 0, false},
+    // every paste grows the document, so keep the storm bounded
+    {"paste_storm", move_to_middle, NULL, run_paste, 512, false},
+    {"cursor_random", NULL, NULL, run_random_move, 0, false},
+    {"word_delete", move_to_middle, setup_word_delete, run_word_delete, 0,
+     false},
+    {"select_all_delete", NULL, setup_select_all, run_select_all_delete, 0,
+     false},
+    {"undo_redo", prepare_undo_chain, NULL, run_undo_redo, 0, true},
+    {"long_line_typing", prepare_long_line, NULL, run_long_line_type, 0,
+     false},
+};
+
+static size_t ops_for_size(size_t doc_bytes, size_t max_ops) {
+  size_t ops = (size_t)(BENCH_WORK_BYTES / (doc_bytes ? doc_bytes : 1));
+  if (ops > max_ops)
+    ops = max_ops;
+  if (ops < BENCH_MIN_OPS)
+    ops = BENCH_MIN_OPS;
+  return ops;
+}
+
+static void run_workload(const Workload *w, const char *doc, size_t doc_bytes,
+                         size_t max_ops, uint64_t seed) {
+  BenchCtx ctx = {0};
+  bench_rng_seed(&ctx.rng, seed ^ (uint64_t)doc_bytes);
+
+  BenchRng paste_rng;
+  bench_rng_seed(&paste_rng, seed + 1);
+  char *paste = bench_generate_document(&paste_rng, BENCH_PASTE_BYTES);
+  ctx.paste = paste;
+  ctx.paste_len = BENCH_PASTE_BYTES;
+
+  // same load path as load_entry() in main.c
+  text_editor_init(&ctx.editor, 4096);
+  text_editor_clear(&ctx.editor);
+  text_editor_insert(&ctx.editor, doc, doc_bytes);
+  text_editor_move_to_pos(&ctx.editor, 0);
+
+  size_t ops = ops_for_size(doc_bytes, max_ops);
+  if (w->op_cap && ops > w->op_cap)
+    ops = w->op_cap;
+  size_t runs = ops;
+  if (w->chain) {
+    ctx.chain_len = ops;
+    runs = 1;
+    ops *= 2;
+  }
+
+  if (w->prepare)
+    w->prepare(&ctx, ops);
+
+  uint64_t elapsed_ns = 0;
+  AllocStats before = core_alloc_stats();
+  AllocStats setup_allocs = {0};
+
+  for (size_t i = 0; i < runs; i++) {
+    if (w->setup) {
+      AllocStats s0 = core_alloc_stats();
+      w->setup(&ctx);
+      AllocStats s1 = core_alloc_stats();
+      setup_allocs.mallocs += s1.mallocs - s0.mallocs;
+      setup_allocs.reallocs += s1.reallocs - s0.reallocs;
+      setup_allocs.bytes += s1.bytes - s0.bytes;
+    }
+    uint64_t start = bench_now_ns();
+    w->run(&ctx);
+    elapsed_ns += bench_now_ns() - start;
+  }
+
+  AllocStats after = core_alloc_stats();
+  uint64_t allocs = (after.mallocs - before.mallocs) +
+                    (after.reallocs - before.reallocs) -
+                    (setup_allocs.mallocs + setup_allocs.reallocs);
+  uint64_t alloc_bytes = after.bytes - before.bytes - setup_allocs.bytes;
+
+  printf("{\"bench\":\"editor\",\"workload\":\"%s\",\"doc_bytes\":%zu,"
+         "\"ops\":%zu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.3f,"
+         "\"alloc_bytes_per_op\":%.1f}\n",
+         w->name, doc_bytes, ops, (double)elapsed_ns / (double)ops,
+         (double)allocs / (double)ops, (double)alloc_bytes / (double)ops);
+  fflush(stdout);
+
+  text_editor_destroy(&ctx.editor);
+  free(paste);
+}
+
+static void key_type(BenchCtx *ctx) {
+  if (ctx->typed % BENCH_LINE_WIDTH == BENCH_LINE_WIDTH - 1) {
+    ctx->typed++;
+    text_editor_insert(&ctx->editor, "\n", 1);
+  } else {
+    run_type_char(ctx);
+  }
+}
+
+static void key_cursor(BenchCtx *ctx) {
+  switch (bench_rng_range(&ctx->rng, 8)) {
+  case 0:
+    text_editor_move_left(&ctx->editor);
+    break;
+  case 1:
+    text_editor_move_right(&ctx->editor);
+    break;
+  case 2:
+    text_editor_move_up(&ctx->editor);
+    break;
+  case 3:
+    text_editor_move_down(&ctx->editor);
+    break;
+  case 4:
+    text_editor_move_word_left(&ctx->editor);
+    break;
+  case 5:
+    text_editor_move_word_right(&ctx->editor);
+    break;
+  case 6:
+    text_editor_move_home(&ctx->editor);
+    break;
+  default:
+    text_editor_move_end(&ctx->editor);
+    break;
+  }
+}
+
+static void key_backspace(BenchCtx *ctx) {
+  text_editor_delete_backward(&ctx->editor);
+}
+
+typedef struct {
+  const char *name;
+  void (*key)(BenchCtx *ctx);
+} KeystrokeCheck;
+
+static const KeystrokeCheck KEYSTROKE_CHECKS[] = {
+    {"typing", key_type},
+    {"cursor", key_cursor},
+    {"backspace", key_backspace},
+};
+
+// every keystroke is followed by the per-frame render line rebuild, like in
+// the app. A warmup round of the same keys (typed, then erased) grows the
+// buffers to their steady-state size first.
+static bool check_keystroke_allocs(const KeystrokeCheck *check,
+                                   const char *doc, size_t doc_bytes,
+                                   uint64_t seed) {
+  BenchCtx ctx = {0};
+  text_editor_init(&ctx.editor, 4096);
+  text_editor_clear(&ctx.editor);
+  text_editor_insert(&ctx.editor, doc, doc_bytes);
+  text_editor_move_to_pos(&ctx.editor, doc_len(&ctx) / 2);
+
+  for (int round = 0; round < 2; round++) {
+    bench_rng_seed(&ctx.rng, seed);
+    ctx.typed = 0;
+    for (size_t i = 0; i < BENCH_CHECK_KEYSTROKES; i++) {
+      key_type(&ctx);
+      text_editor_prepare_render_lines(&ctx.editor);
+    }
+    for (size_t i = 0; i < BENCH_CHECK_KEYSTROKES; i++) {
+      key_backspace(&ctx);
+      text_editor_prepare_render_lines(&ctx.editor);
+    }
+  }
+
+  // backspace needs text in front of the caret
+  if (check->key == key_backspace) {
+    for (size_t i = 0; i < BENCH_CHECK_KEYSTROKES; i++)
+      key_type(&ctx);
+    text_editor_prepare_render_lines(&ctx.editor);
+  }
+
+  bench_rng_seed(&ctx.rng, seed);
+  ctx.typed = 0;
+  AllocStats before = core_alloc_stats();
+  for (size_t i = 0; i < BENCH_CHECK_KEYSTROKES; i++) {
+    check->key(&ctx);
+    text_editor_prepare_render_lines(&ctx.editor);
+  }
+  AllocStats after = core_alloc_stats();
+
+  uint64_t allocs = (after.mallocs - before.mallocs) +
+                    (after.reallocs - before.reallocs);
+  printf("{\"bench\":\"alloc_check\",\"keystroke\":\"%s\","
+         "\"doc_bytes\":%zu,\"keystrokes\":%d,\"allocs\":%llu,"
+         "\"ok\":%s}\n",
+         check->name, doc_bytes, BENCH_CHECK_KEYSTROKES,
+         (unsigned long long)allocs, allocs == 0 ? "true" : "false");
+  fflush(stdout);
+
+  text_editor_destroy(&ctx.editor);
+  return allocs == 0;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--sizes LIST] [--workloads LIST] [--max-ops N] "
+          "[--seed N] [--check-allocs]\n  workloads:",
+          argv0);
+  for (size_t i = 0; i < sizeof(WORKLOADS) / sizeof(WORKLOADS[0]); i++)
+    fprintf(stderr, " %s", WORKLOADS[i].name);
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+  const char *sizes = NULL;
+  const char *filter = NULL;
+  size_t max_ops = BENCH_DEFAULT_MAX_OPS;
+  uint64_t seed = 1;
+  bool check_allocs = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+      sizes = argv[++i];
+    } else if (strcmp(argv[i], "--workloads") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--max-ops") == 0 && i + 1 < argc) {
+      max_ops = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--check-allocs") == 0) {
+      check_allocs = true;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (max_ops == 0)
+    max_ops = 1;
+  if (!sizes)
+    sizes = check_allocs ? BENCH_CHECK_SIZES : BENCH_DEFAULT_SIZES;
+
+  bool ok = true;
+  const char *p = sizes;
+  while (*p) {
+    size_t doc_bytes = bench_parse_size(p);
+    const char *comma = strchr(p, ',');
+
+    if (doc_bytes > 0) {
+      BenchRng doc_rng;
+      bench_rng_seed(&doc_rng, seed);
+      char *doc = bench_generate_document(&doc_rng, doc_bytes);
+      if (!doc) {
+        fprintf(stderr, "Failed to allocate %zu byte document\n", doc_bytes);
+        return 1;
+      }
+
+      if (check_allocs) {
+        for (size_t i = 0;
+             i < sizeof(KEYSTROKE_CHECKS) / sizeof(KEYSTROKE_CHECKS[0]); i++) {
+          if (bench_filter_match(filter, KEYSTROKE_CHECKS[i].name))
+            ok = check_keystroke_allocs(&KEYSTROKE_CHECKS[i], doc, doc_bytes,
+                                        seed) &&
+                 ok;
+        }
+      } else {
+        for (size_t i = 0; i < sizeof(WORKLOADS) / sizeof(WORKLOADS[0]);
+             i++) {
+          if (bench_filter_match(filter, WORKLOADS[i].name))
+            run_workload(&WORKLOADS[i], doc, doc_bytes, max_ops, seed);
+        }
+      }
+      free(doc);
+    }
+
+    if (!comma)
+      break;
+    p = comma + 1;
+  }
+
+  // peak RSS only grows over a run, so it covers every workload above
+  // rather than any one of them
+  printf("{\"bench\":\"editor\",\"process_peak_rss_kb\":%llu}\n",
+         (unsigned long long)bench_peak_rss_kb());
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,354 @@
+#if !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+#include "bench_util.h"
+#include "headless_app.h"
+
+#include "sokol_gfx.h"
+#include "sokol_app.h"
+#include "util/sokol_gl.h"
+#include "clay.h"
+#include "fontstash.h"
+#include "util/sokol_fontstash.h"
+#include "shaders.h"
+#include "sokol_clay.h"
+
+#include "app.h"
+#include "replay.h"
+#include "res.h"
+#include "svg.h"
+#include "text_batch.h"
+#include "text_measure.h"
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// Headless end-to-end benchmark: runs the real init/frame/event callbacks
+// from main.c against an offscreen EGL context, so layout, sclay_render,
+// the selection and cursor pipelines and the SVG icons are all measured.
+// Mesa's llvmpipe makes this usable on machines without a GPU or X11:
+//
+//   andex_frame_bench [--document PATH | --size 256K] [--width 1280]
+//                     [--height 720] [--dpi 1] [--msaa N] [--warmup N]
+//                     [--scroll-frames N] [--type-frames N] [--seed N]
+//                     [--svg triangles|atlas]
+//
+// HOME points at a scratch directory holding only the benchmark document,
+// so the user's journal is never read or written. Every phase prints one
+// JSON object with the frame rate and per-phase profiler timings.
+// ANDEX_REPLAY_FILE also works here; the run ends when the replay does.
+
+#define BENCH_DEFAULT_SIZE "256K"
+#define BENCH_DEFAULT_WARMUP 30
+#define BENCH_DEFAULT_SCROLL_FRAMES 300
+#define BENCH_DEFAULT_TYPE_FRAMES 300
+#define BENCH_TYPE_LINE 60
+
+extern sapp_desc sokol_main(int argc, char *argv[]);
+
+static const char TYPED_TEXT[] =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five "
+    "dozen liquor jugs. ";
+
+typedef enum {
+  BENCH_PHASE_IDLE,
+  BENCH_PHASE_SCROLL,
+  BENCH_PHASE_TYPE,
+} BenchPhase;
+
+static const char *BENCH_PHASE_NAMES[] = {"idle", "scroll", "type"};
+
+static struct {
+  sapp_desc desc;
+  float mouse_x;
+  float mouse_y;
+  size_t typed;
+  double *frame_ms;
+  double *phase_ms;
+} g_bench;
+
+// writes the document as today's entry in a scratch $HOME/Documents/andex
+static bool write_scratch_entry(const char *home, const char *doc,
+                                size_t doc_bytes, char *filename,
+                                size_t filename_size) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/Documents", home);
+  mkdir(path, 0755);
+  snprintf(path, sizeof(path), "%s/Documents/andex", home);
+  mkdir(path, 0755);
+
+  char date_str[64];
+  time_t now = time(NULL);
+  strftime(date_str, sizeof(date_str), "%Y-%m-%d-%H-%M-%S", localtime(&now));
+  snprintf(filename, filename_size,
+           "[00000000-0000-0000-0000-00000000benc]-[%s].md", date_str);
+
+  snprintf(path, sizeof(path), "%s/Documents/andex/%s", home, filename);
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+  bool ok = fwrite(doc, 1, doc_bytes, file) == doc_bytes;
+  ok = fclose(file) == 0 && ok;
+  return ok;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int flag,
+                        struct FTW *ftw) {
+  (void)sb;
+  (void)flag;
+  (void)ftw;
+  return remove(path);
+}
+
+// startup opens a fresh entry when today's has text, select ours instead
+static void select_bench_entry(const char *filename) {
+  for (size_t i = 0; i < g_app->history.count; i++) {
+    if (strcmp(g_app->history.entries[i].filename, filename) == 0) {
+      HandleEntrySelect((Clay_ElementId){0},
+                        (Clay_PointerData){
+                            .state = CLAY_POINTER_DATA_PRESSED_THIS_FRAME},
+                        (intptr_t)i);
+      return;
+    }
+  }
+  fprintf(stderr, "Benchmark entry %s was not loaded\n", filename);
+}
+
+static void send_event(sapp_event ev) {
+  ev.frame_count = headless_app_frame_count();
+  ev.mouse_x = g_bench.mouse_x;
+  ev.mouse_y = g_bench.mouse_y;
+  ev.window_width = sapp_width();
+  ev.window_height = sapp_height();
+  ev.framebuffer_width = sapp_width();
+  ev.framebuffer_height = sapp_height();
+  g_bench.desc.event_cb(&ev);
+}
+
+// one event per frame keeps frame() from idling between frames
+static void send_phase_input(BenchPhase phase) {
+  switch (phase) {
+  case BENCH_PHASE_IDLE:
+    send_event((sapp_event){.type = SAPP_EVENTTYPE_MOUSE_MOVE});
+    break;
+  case BENCH_PHASE_SCROLL:
+    send_event((sapp_event){.type = SAPP_EVENTTYPE_MOUSE_SCROLL,
+                            .scroll_y = -1.0f});
+    break;
+  case BENCH_PHASE_TYPE:
+    if (++g_bench.typed % BENCH_TYPE_LINE == 0) {
+      send_event((sapp_event){.type = SAPP_EVENTTYPE_KEY_DOWN,
+                              .key_code = SAPP_KEYCODE_ENTER});
+    } else {
+      size_t i = g_bench.typed % (sizeof(TYPED_TEXT) - 1);
+      send_event((sapp_event){.type = SAPP_EVENTTYPE_CHAR,
+                              .char_code = (uint32_t)TYPED_TEXT[i]});
+    }
+    break;
+  }
+}
+
+static int compare_double(const void *a, const void *b) {
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+static void print_stats(double *samples, int count) {
+  double total = 0.0;
+  for (int i = 0; i < count; i++)
+    total += samples[i];
+  qsort(samples, (size_t)count, sizeof(double), compare_double);
+  int p99 = (count * 99) / 100;
+  if (p99 >= count)
+    p99 = count - 1;
+  printf("{\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}",
+         total / count, samples[count / 2], samples[p99], samples[count - 1]);
+}
+
+// returns false once the app asked to quit
+static bool run_phase(BenchPhase phase, int frames, bool report,
+                      size_t doc_bytes) {
+  int done = 0;
+  uint64_t start = bench_now_ns();
+  for (; done < frames && !headless_app_quit_requested(); done++) {
+    uint64_t frame_start = bench_now_ns();
+    send_phase_input(phase);
+    g_bench.desc.frame_cb();
+    headless_app_present();
+    g_bench.frame_ms[done] = (double)(bench_now_ns() - frame_start) / 1e6;
+    for (int p = 0; p < PROF_PHASE_COUNT; p++)
+      g_bench.phase_ms[p * frames + done] = prof_last_frame_ms((ProfPhase)p);
+  }
+  double elapsed = (double)(bench_now_ns() - start) / 1e9;
+
+  if (report && done > 0) {
+    const char *svg_backend = getenv("ANDEX_SVG_BACKEND");
+    if (!svg_backend)
+      svg_backend = "triangles";
+    printf("{\"bench\":\"frame\",\"phase\":\"%s\",\"doc_bytes\":%zu,"
+           "\"width\":%d,\"height\":%d,\"dpi_scale\":%.2f,\"msaa\":%d,"
+           "\"renderer\":\"%s\",\"svg\":\"%s\",\"frames\":%d,\"fps\":%.2f,"
+           "\"frame\":",
+           BENCH_PHASE_NAMES[phase], doc_bytes, sapp_width(), sapp_height(),
+           sapp_dpi_scale(), sapp_sample_count(), headless_app_renderer(),
+           svg_backend, done, elapsed > 0.0 ? done / elapsed : 0.0);
+    print_stats(g_bench.frame_ms, done);
+    printf(",\"phases\":{");
+    for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+      if (p == PROF_FRAME)
+        continue;
+      printf("%s\"%s\":", p == 0 ? "" : ",", prof_phase_name((ProfPhase)p));
+      print_stats(&g_bench.phase_ms[p * frames], done);
+    }
+    svg_scratch_stats_t svg_stats = svg_scratch_stats();
+    printf("},\"svg_scratch\":{\"arena_peak_bytes\":%zu,"
+           "\"arena_reserved_bytes\":%zu,\"max_flat_points\":%d,"
+           "\"max_edges\":%d,\"max_stroke_tris\":%d}",
+           svg_stats.arena_peak_bytes, svg_stats.arena_reserved_bytes,
+           svg_stats.max_flat_points, svg_stats.max_edges,
+           svg_stats.max_stroke_tris);
+    TextBatchStats text = text_batch_stats();
+    printf(",\"text\":{\"draws\":%u,\"flushes\":%u,\"glyphs\":%u,"
+           "\"cache_hits\":%u,\"cache_misses\":%u}",
+           text.draws, text.flushes, text.glyphs, text.cache_hits,
+           text.cache_misses);
+    TextMeasureStats measure = text_measure_stats();
+    printf(",\"measure\":{\"fast\":%u,\"fallback\":%u}", measure.fast,
+           measure.fallback);
+    ResStats res = res_stats();
+    printf(",\"res\":{\"fonts\":%u,\"icons\":%u,\"images\":%u,"
+           "\"textures\":%u}",
+           res.fonts, res.icons, res.images, res.textures);
+    printf(",\"peak_rss_kb\":%llu}\n",
+           (unsigned long long)bench_peak_rss_kb());
+    fflush(stdout);
+  }
+  return !headless_app_quit_requested();
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--document PATH | --size N] [--width N] [--height N] "
+          "[--dpi F] [--msaa N] [--warmup N] [--scroll-frames N] "
+          "[--type-frames N] [--seed N] [--svg triangles|atlas]\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *document = NULL;
+  const char *size = BENCH_DEFAULT_SIZE;
+  HeadlessAppConfig config = {.width = 0, .height = 0, .dpi_scale = 1.0f};
+  int warmup = BENCH_DEFAULT_WARMUP;
+  int scroll_frames = BENCH_DEFAULT_SCROLL_FRAMES;
+  int type_frames = BENCH_DEFAULT_TYPE_FRAMES;
+  uint64_t seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--document") == 0 && i + 1 < argc) {
+      document = argv[++i];
+    } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+      size = argv[++i];
+    } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+      config.width = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+      config.height = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--dpi") == 0 && i + 1 < argc) {
+      config.dpi_scale = (float)atof(argv[++i]);
+    } else if (strcmp(argv[i], "--msaa") == 0 && i + 1 < argc) {
+      config.sample_count = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+      warmup = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--scroll-frames") == 0 && i + 1 < argc) {
+      scroll_frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--type-frames") == 0 && i + 1 < argc) {
+      type_frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--svg") == 0 && i + 1 < argc) {
+      // read by init_cb when it picks the icon backend
+      setenv("ANDEX_SVG_BACKEND", argv[++i], 1);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  size_t doc_bytes = 0;
+  char *doc = NULL;
+  if (document) {
+    doc = bench_read_document(document, &doc_bytes);
+    if (!doc) {
+      fprintf(stderr, "Failed to read %s\n", document);
+      return 1;
+    }
+  } else {
+    BenchRng rng;
+    bench_rng_seed(&rng, seed);
+    doc_bytes = bench_parse_size(size);
+    doc = bench_generate_document(&rng, doc_bytes);
+    if (!doc) {
+      fprintf(stderr, "Failed to allocate %zu byte document\n", doc_bytes);
+      return 1;
+    }
+  }
+
+  char home[] = "/tmp/andex_frame_bench_XXXXXX";
+  char filename[256];
+  if (!mkdtemp(home) || setenv("HOME", home, 1) != 0 ||
+      !write_scratch_entry(home, doc, doc_bytes, filename, sizeof(filename))) {
+    fprintf(stderr, "Failed to set up a scratch home directory\n");
+    free(doc);
+    return 1;
+  }
+  free(doc);
+
+  g_bench.desc = sokol_main(argc, argv);
+  if (config.width <= 0)
+    config.width = g_bench.desc.width;
+  if (config.height <= 0)
+    config.height = g_bench.desc.height;
+
+  int status = 1;
+  if (headless_app_init(&g_bench.desc, &config)) {
+    g_bench.desc.init_cb();
+    select_bench_entry(filename);
+
+    // park the pointer over the editor column so scrolling hits it
+    g_bench.mouse_x = sapp_widthf() * 0.5f;
+    g_bench.mouse_y = sapp_heightf() * 0.5f;
+
+    int max_frames = warmup;
+    if (scroll_frames > max_frames)
+      max_frames = scroll_frames;
+    if (type_frames > max_frames)
+      max_frames = type_frames;
+    if (max_frames < 1)
+      max_frames = 1;
+    g_bench.frame_ms = malloc(sizeof(double) * (size_t)max_frames);
+    g_bench.phase_ms =
+        malloc(sizeof(double) * (size_t)max_frames * PROF_PHASE_COUNT);
+
+    if (replay_is_replaying()) {
+      // the recording supplies the input, frames run until it is done
+      while (run_phase(BENCH_PHASE_IDLE, max_frames, false, doc_bytes))
+        ;
+    } else if (run_phase(BENCH_PHASE_IDLE, warmup, false, doc_bytes) &&
+               run_phase(BENCH_PHASE_SCROLL, scroll_frames, true,
+                         doc_bytes)) {
+      run_phase(BENCH_PHASE_TYPE, type_frames, true, doc_bytes);
+    }
+
+    g_bench.desc.cleanup_cb();
+    free(g_bench.frame_ms);
+    free(g_bench.phase_ms);
+    status = 0;
+  }
+  headless_app_shutdown();
+
+  nftw(home, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+  return status;
+}
@@ -0,0 +1,421 @@
+#include "bench_util.h"
+
+#include "sokol_gfx.h"
+#include "util/sokol_gl.h"
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+#include "fontstash.h"
+#include "util/sokol_fontstash.h"
+#include "shaders.h"
+#include "sokol_clay.h"
+
+#include "app.h"
+#include "layout_cache.h"
+#include "res.h"
+#include "ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Headless layout benchmark: times Clay_BeginLayout / render_editor_ui /
+// Clay_EndLayout without a window or GPU. Text is measured with fixed
+// per-glyph advances proportional to the font size so results don't depend
+// on font rasterization. --wrap-cols gives the columns a line holds at the
+// smallest font size:
+//
+//   andex_layout_bench [--sizes 1K,16K,64K,256K,1M] [--wrap-cols 40,70,120]
+//                      [--font-sizes 22,28,34] [--frames N] [--seed N]
+//                      [--doc FILE]... [--check]
+//
+// Every configuration prints one JSON object per line. --doc runs on a file
+// instead, such as one andex_corpus wrote, or as well with --sizes.
+//
+// --check times nothing: it lays every line out through Clay on its own and
+// compares the rows and height with what the line cache wraps it into, and
+// exits 1 if any line differs.
+
+#define BENCH_DEFAULT_SIZES "1K,16K,64K,256K,1M"
+#define BENCH_DEFAULT_WRAP_COLS "40,70,120"
+#define BENCH_DEFAULT_FONT_SIZES "22,28,34"
+#define BENCH_DEFAULT_FRAMES 20
+#define BENCH_MAX_DOCS 16
+// mismatches printed in full per configuration
+#define BENCH_CHECK_REPORT 5
+#define BENCH_SCREEN_WIDTH 1280.0f
+#define BENCH_SCREEN_HEIGHT 720.0f
+
+AppState *g_app = NULL;
+
+// the layout only registers these; nothing clicks in the benchmark
+void HandleFontSelect(Clay_ElementId elementId, Clay_PointerData pointerData,
+                      intptr_t userData) {}
+void HandleFontSizeChange(Clay_ElementId elementId,
+                          Clay_PointerData pointerData, intptr_t userData) {}
+void HandleFullscreenToggle(Clay_ElementId elementId,
+                            Clay_PointerData pointerData, intptr_t userData) {}
+void HandleLulCow(Clay_ElementId elementId, Clay_PointerData pointerData,
+                  intptr_t userData) {}
+void HandleTimerToggle(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData) {}
+void HandleNewEntry(Clay_ElementId elementId, Clay_PointerData pointerData,
+                    intptr_t userData) {}
+void HandleEntrySelect(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData) {}
+void HandleEntryExport(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData) {}
+void HandleEntryDelete(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData) {}
+void HandleOpenDirectory(Clay_ElementId elementId, Clay_PointerData pointerData,
+                         intptr_t userData) {}
+
+// nothing is drawn, so the resources are never loaded; text is measured by
+// fixed advances whatever the font
+sclay_font_t res_font(ResourceFontId id) { return g_app->gfx.fonts[id]; }
+svg_element_t *res_icon(ResourceIconId id) { return &g_app->gfx.icons[id]; }
+sclay_image *res_image(ResourceImageId id) {
+  (void)id;
+  return NULL;
+}
+
+// advance per pixel of font size, so bigger text wraps sooner like it does
+// with a real font
+static float g_advance_per_px = 0.4f;
+
+static Clay_Dimensions measure_fixed_advance(Clay_StringSlice text,
+                                             Clay_TextElementConfig *config,
+                                             void *user_data) {
+  (void)user_data;
+  int glyphs = 0;
+  for (int i = 0; i < text.length; i++) {
+    if (((unsigned char)text.chars[i] & 0xC0) != 0x80)
+      glyphs++;
+  }
+
+  float height = config->lineHeight > 0 ? (float)config->lineHeight
+                                        : (float)config->fontSize;
+  return (Clay_Dimensions){
+      .width = glyphs * (g_advance_per_px * config->fontSize +
+                         config->letterSpacing),
+      .height = height,
+  };
+}
+
+static void handle_clay_errors(Clay_ErrorData error) {
+  fprintf(stderr, "Clay error: %.*s\n", error.errorText.length,
+          error.errorText.chars);
+  exit(1);
+}
+
+static int font_size_index_for(int px) {
+  int best = 0;
+  for (int i = 0; i < num_font_sizes; i++) {
+    if (abs(font_sizes[i] - px) < abs(font_sizes[best] - px))
+      best = i;
+  }
+  return best;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a;
+  uint64_t ub = *(const uint64_t *)b;
+  return (ua > ub) - (ua < ub);
+}
+
+// Sets the font size and glyph advance for a configuration and returns the
+// columns a line holds at that size.
+static int set_config(int wrap_cols, int font_px) {
+  g_app->font_size_index = font_size_index_for(font_px);
+  // wrap_cols counts columns at the smallest font size; larger sizes fit
+  // proportionally fewer
+  const float text_width = EDITOR_COLUMN_WIDTH - 2.0f * EDITOR_COLUMN_PADDING;
+  g_advance_per_px = text_width / ((float)wrap_cols * (float)font_sizes[0]);
+  // the advance changes every line's wrap, so the line cache starts over
+  ui_set_measure_text(measure_fixed_advance, NULL);
+  return (int)(text_width /
+               (g_advance_per_px * font_sizes[g_app->font_size_index]));
+}
+
+static void run_config(size_t doc_bytes, int wrap_cols, int font_px,
+                       int frames) {
+  const int cols = set_config(wrap_cols, font_px);
+
+  uint64_t *samples = malloc(sizeof(uint64_t) * (size_t)frames);
+  int commands = 0;
+
+  // one untimed frame to fill Clay's measure cache, like a steady-state app
+  for (int f = -1; f < frames; f++) {
+    uint64_t start = bench_now_ns();
+    Clay_SetPointerState((Clay_Vector2){-1.0f, -1.0f}, false);
+    Clay_BeginLayout();
+    render_editor_ui();
+    Clay_RenderCommandArray cmds = Clay_EndLayout();
+    uint64_t elapsed = bench_now_ns() - start;
+
+    commands = cmds.length;
+    if (f >= 0)
+      samples[f] = elapsed;
+  }
+
+  uint64_t total = 0;
+  for (int f = 0; f < frames; f++)
+    total += samples[f];
+  qsort(samples, (size_t)frames, sizeof(uint64_t), compare_u64);
+
+  printf("{\"bench\":\"layout\",\"doc_bytes\":%zu,\"lines\":%zu,"
+         "\"laid_out_lines\":%zu,\"wrap_cols\":%d,\"font_size\":%d,"
+         "\"cols\":%d,"
+         "\"frames\":%d,\"render_commands\":%d,\"mean_ms\":%.4f,"
+         "\"p50_ms\":%.4f,\"max_ms\":%.4f,\"peak_rss_kb\":%llu}\n",
+         doc_bytes, g_app->editor.render_line_count,
+         g_app->editor.layout_end - g_app->editor.layout_first, wrap_cols,
+         font_sizes[g_app->font_size_index], cols, frames, commands,
+         (double)total / frames / 1e6, (double)samples[frames / 2] / 1e6,
+         (double)samples[frames - 1] / 1e6,
+         (unsigned long long)bench_peak_rss_kb());
+  fflush(stdout);
+  free(samples);
+}
+
+static float measure_check_text(const char *str, size_t len,
+                                void *user_data) {
+  Clay_StringSlice slice = {
+      .length = (int32_t)len, .chars = str, .baseChars = str};
+  return measure_fixed_advance(slice, user_data, NULL).width;
+}
+
+// Lays every render line out through Clay on its own, in a column as wide
+// as the editor's text, and compares the rows it draws and the height it
+// gives the line with the line cache's wrap. Returns the lines that differ.
+static size_t check_config(const char *doc_name, size_t doc_bytes,
+                           int wrap_cols, int font_px) {
+  const int cols = set_config(wrap_cols, font_px);
+  TextEditor *editor = &g_app->editor;
+  // one frame of the UI cuts the long lines along this size's rows
+  Clay_SetPointerState((Clay_Vector2){-1.0f, -1.0f}, false);
+  Clay_BeginLayout();
+  render_editor_ui();
+  Clay_EndLayout();
+
+  const int size = font_sizes[g_app->font_size_index];
+  Clay_TextElementConfig config = {
+      .fontSize = (uint16_t)size,
+      .lineHeight = (uint16_t)(size - 2),
+      .wrapMode = CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD};
+  const LayoutStyle style = {
+      .font_size = size,
+      .line_height = (float)(size - 2),
+      .wrap_width = EDITOR_COLUMN_WIDTH - 2.0f * EDITOR_COLUMN_PADDING};
+  LayoutCache cache;
+  layout_cache_init(&cache, measure_check_text, &config);
+  // Clay still has the words measured with the last advance, and would skip
+  // the rows of a tall line below the screen
+  Clay_ResetMeasureTextCache();
+  Clay_SetCullingEnabled(false);
+
+  size_t rows = 0, mismatches = 0;
+  for (size_t i = 0; i < editor->render_line_count; i++) {
+    const char *text = editor->render_lines[i];
+    const size_t len = editor->render_lengths[i];
+    // the UI draws an empty line as " ", one row either way
+    if (len == 0)
+      continue;
+    Clay_BeginLayout();
+    CLAY({.id = CLAY_ID("CheckColumn"),
+          .layout = {.sizing = {CLAY_SIZING_FIXED(style.wrap_width),
+                                CLAY_SIZING_FIT(0, 0)}}}) {
+      Clay_String str = {.chars = text,
+                         .isStaticallyAllocated = true,
+                         .length = (int32_t)len};
+      CLAY_TEXT(str, CLAY_TEXT_CONFIG(config));
+    }
+    Clay_RenderCommandArray cmds = Clay_EndLayout();
+    Clay_ElementData column = Clay_GetElementData(CLAY_ID("CheckColumn"));
+
+    const LayoutLine *line =
+        layout_cache_get(&cache, &style, editor->render_hashes[i], text, len);
+    if (!line) {
+      fprintf(stderr, "Failed to wrap line %zu\n", i);
+      exit(1);
+    }
+    bool same = column.found && column.boundingBox.height == line->height;
+    uint32_t clay_rows = 0;
+    for (int c = 0; c < cmds.length; c++) {
+      const Clay_RenderCommand *cmd = &cmds.internalArray[c];
+      if (cmd->commandType != CLAY_RENDER_COMMAND_TYPE_TEXT)
+        continue;
+      const size_t start =
+          (size_t)(cmd->renderData.text.stringContents.chars - text);
+      if (clay_rows >= line->rows || line->row_starts[clay_rows] != start)
+        same = false;
+      clay_rows++;
+    }
+    rows += line->rows;
+    if (same && clay_rows == line->rows)
+      continue;
+    if (mismatches < BENCH_CHECK_REPORT)
+      fprintf(stderr,
+              "%s, %d cols, %dpx: line %zu (%zu bytes) has %u rows %.1fpx "
+              "high in Clay, %u rows %.1fpx high in the line cache\n",
+              doc_name, wrap_cols, size, i, len, clay_rows,
+              column.boundingBox.height, line->rows, line->height);
+    mismatches++;
+  }
+  Clay_SetCullingEnabled(true);
+  layout_cache_destroy(&cache);
+
+  printf("{\"bench\":\"layout_check\",\"doc\":\"%s\",\"doc_bytes\":%zu,"
+         "\"lines\":%zu,\"wrap_cols\":%d,\"font_size\":%d,\"cols\":%d,"
+         "\"rows\":%zu,\"mismatches\":%zu}\n",
+         doc_name, doc_bytes, editor->render_line_count, wrap_cols, size, cols,
+         rows, mismatches);
+  fflush(stdout);
+  return mismatches;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--sizes LIST] [--wrap-cols LIST] [--font-sizes LIST] "
+          "[--frames N] [--seed N] [--doc FILE]... [--check]\n",
+          argv0);
+}
+
+// Runs every configuration on one document, or checks them with check set.
+// Returns the lines that failed the check.
+static size_t run_document(const char *name, const char *doc,
+                           size_t doc_bytes, const char *wrap_list,
+                           const char *font_list, int frames, bool check,
+                           void **prev_arena) {
+  text_editor_clear(&g_app->editor);
+  text_editor_insert(&g_app->editor, doc, doc_bytes);
+  text_editor_move_to_pos(&g_app->editor, 0);
+  text_editor_prepare_render_lines(&g_app->editor);
+
+  // every line is a container plus a text element, and long lines wrap
+  // into many words
+  size_t lines = g_app->editor.render_line_count;
+  Clay_SetMaxElementCount((int32_t)(lines * 4 + 1024));
+  Clay_SetMaxMeasureTextCacheWordCount((int32_t)(doc_bytes / 2 + 65536));
+  uint64_t arena_size = Clay_MinMemorySize();
+  void *arena_memory = malloc(arena_size);
+  Clay_Initialize(
+      Clay_CreateArenaWithCapacityAndMemory(arena_size, arena_memory),
+      (Clay_Dimensions){BENCH_SCREEN_WIDTH, BENCH_SCREEN_HEIGHT},
+      (Clay_ErrorHandler){.errorHandlerFunction = handle_clay_errors});
+
+  // the previous context is read by Clay_Initialize, free it afterwards
+  free(*prev_arena);
+  *prev_arena = arena_memory;
+
+  size_t mismatches = 0;
+  const char *w = wrap_list;
+  while (*w) {
+    int wrap_cols = atoi(w);
+    const char *f = font_list;
+    while (wrap_cols > 0 && *f) {
+      int font_px = atoi(f);
+      if (font_px > 0 && check)
+        mismatches += check_config(name, doc_bytes, wrap_cols, font_px);
+      else if (font_px > 0)
+        run_config(doc_bytes, wrap_cols, font_px, frames);
+      const char *next = strchr(f, ',');
+      if (!next)
+        break;
+      f = next + 1;
+    }
+    const char *next = strchr(w, ',');
+    if (!next)
+      break;
+    w = next + 1;
+  }
+  return mismatches;
+}
+
+int main(int argc, char **argv) {
+  const char *sizes = NULL;
+  const char *wrap_list = BENCH_DEFAULT_WRAP_COLS;
+  const char *font_list = BENCH_DEFAULT_FONT_SIZES;
+  int frames = BENCH_DEFAULT_FRAMES;
+  uint64_t seed = 1;
+  const char *docs[BENCH_MAX_DOCS];
+  int doc_count = 0;
+  bool check = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+      sizes = argv[++i];
+    } else if (strcmp(argv[i], "--wrap-cols") == 0 && i + 1 < argc) {
+      wrap_list = argv[++i];
+    } else if (strcmp(argv[i], "--font-sizes") == 0 && i + 1 < argc) {
+      font_list = argv[++i];
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--doc") == 0 && i + 1 < argc &&
+               doc_count < BENCH_MAX_DOCS) {
+      docs[doc_count++] = argv[++i];
+    } else if (strcmp(argv[i], "--check") == 0) {
+      check = true;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (frames < 1)
+    frames = 1;
+  // documents from files replace the generated ones unless --sizes is given
+  if (!sizes)
+    sizes = doc_count > 0 ? "" : BENCH_DEFAULT_SIZES;
+
+  srand((unsigned)seed);
+  g_app = calloc(1, sizeof(AppState));
+  g_app->bottom_nav_opacity = 1.0f;
+  g_app->hovered_entry_index = -1;
+  snprintf(g_app->timer_string, sizeof(g_app->timer_string), "15:00");
+  text_editor_init(&g_app->editor, 4096);
+
+  void *prev_arena = NULL;
+  size_t mismatches = 0;
+  const char *p = sizes;
+  while (*p) {
+    size_t doc_bytes = bench_parse_size(p);
+    const char *comma = strchr(p, ',');
+
+    if (doc_bytes > 0) {
+      BenchRng rng;
+      bench_rng_seed(&rng, seed);
+      char *doc = bench_generate_document(&rng, doc_bytes);
+      if (!doc) {
+        fprintf(stderr, "Failed to allocate %zu byte document\n", doc_bytes);
+        return 1;
+      }
+      char name[32];
+      snprintf(name, sizeof(name), "generated %zu", doc_bytes);
+      mismatches += run_document(name, doc, doc_bytes, wrap_list, font_list,
+                                 frames, check, &prev_arena);
+      free(doc);
+    }
+
+    if (!comma)
+      break;
+    p = comma + 1;
+  }
+
+  for (int i = 0; i < doc_count; i++) {
+    size_t doc_bytes = 0;
+    char *doc = bench_read_document(docs[i], &doc_bytes);
+    if (!doc) {
+      fprintf(stderr, "Failed to read %s\n", docs[i]);
+      return 1;
+    }
+    mismatches += run_document(docs[i], doc, doc_bytes, wrap_list, font_list,
+                               frames, check, &prev_arena);
+    free(doc);
+  }
+
+  ui_shutdown();
+  free(prev_arena);
+  text_editor_destroy(&g_app->editor);
+  free(g_app);
+  return mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,347 @@
+#include "bench_util.h"
+
+#define NANOSVG_IMPLEMENTATION
+#define NANOSVGRAST_IMPLEMENTATION
+#include "nanosvg.h"
+#include "nanosvgrast.h"
+#include "resources.h"
+#include "svg_tess.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Headless SVG tessellation benchmark and fidelity check: tessellates every
+// icon the app ships, as gen.ts compiled it into resources.h, at several
+// pixel sizes with svg_geom_build, then rasterizes the triangles and compares
+// the coverage with nanosvg's rasterizer on the icon's source file in --icons:
+//
+//   andex_svg_bench [--icons DIR] [--sizes 16,24,32,64,128] [--iterations N]
+//                   [--max-error F] [--max-l1 F] [--max-px-error F]
+//
+// Every icon and size prints one JSON object per line, then a summary. The
+// exit status is non-zero when the area, l1 or worst pixel error exceeds its
+// limit, so a tessellator or gen.ts change can be judged on fidelity as well
+// as speed.
+
+#ifndef BENCH_ICONS_DIR
+#define BENCH_ICONS_DIR "resources/icons"
+#endif
+#define BENCH_DEFAULT_SIZES "16,24,32,64,128"
+#define BENCH_DEFAULT_ITERATIONS 200
+#define BENCH_DEFAULT_MAX_ERROR 0.05
+// edges only differ by antialiasing, so l1 stays near the area error unless
+// coverage moves; a missing thin feature shows up in the worst pixel even
+// when the total area nets out
+#define BENCH_DEFAULT_MAX_L1 0.15
+#define BENCH_DEFAULT_MAX_PX_ERROR 0.5
+// subsamples per pixel axis when rasterizing our triangles
+#define BENCH_SUBSAMPLES 4
+
+typedef struct {
+  double area_error;   // |ours - nanosvg| / nanosvg covered area
+  double l1_error;     // per-pixel coverage differences / nanosvg area
+  double max_px_error; // largest single pixel coverage difference
+} CoverageResult;
+
+typedef struct {
+  double area, l1, px;
+} ErrorLimits;
+
+// Marks every subsample whose center lies inside the triangle. The union of
+// overlapping triangles is what gets compared, so seams and overlaps between
+// trapezoids don't count twice.
+static void cover_triangle(uint8_t *samples, int sw, int sh,
+                           const sgp_triangle *t, float sx, float sy) {
+  const float s = (float)BENCH_SUBSAMPLES;
+  float ax = t->a.x * sx * s, ay = t->a.y * sy * s;
+  float bx = t->b.x * sx * s, by = t->b.y * sy * s;
+  float cx = t->c.x * sx * s, cy = t->c.y * sy * s;
+
+  float area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+  if (area == 0.0f)
+    return;
+  if (area < 0.0f) {
+    float tx = bx, ty = by;
+    bx = cx, by = cy;
+    cx = tx, cy = ty;
+  }
+
+  float minx = ax < bx ? (ax < cx ? ax : cx) : (bx < cx ? bx : cx);
+  float maxx = ax > bx ? (ax > cx ? ax : cx) : (bx > cx ? bx : cx);
+  float miny = ay < by ? (ay < cy ? ay : cy) : (by < cy ? by : cy);
+  float maxy = ay > by ? (ay > cy ? ay : cy) : (by > cy ? by : cy);
+  int x0 = (int)minx < 0 ? 0 : (int)minx;
+  int y0 = (int)miny < 0 ? 0 : (int)miny;
+  int x1 = (int)maxx + 1 > sw ? sw : (int)maxx + 1;
+  int y1 = (int)maxy + 1 > sh ? sh : (int)maxy + 1;
+
+  for (int y = y0; y < y1; y++) {
+    float py = (float)y + 0.5f;
+    for (int x = x0; x < x1; x++) {
+      float px = (float)x + 0.5f;
+      if ((bx - ax) * (py - ay) - (by - ay) * (px - ax) >= 0.0f &&
+          (cx - bx) * (py - by) - (cy - by) * (px - bx) >= 0.0f &&
+          (ax - cx) * (py - cy) - (ay - cy) * (px - cx) >= 0.0f)
+        samples[y * sw + x] = 1;
+    }
+  }
+}
+
+static CoverageResult compare_coverage(NSVGrasterizer *rast,
+                                       NSVGimage *source,
+                                       const NSVGimage *image,
+                                       const svg_geom_t *geom, int width,
+                                       int height) {
+  CoverageResult result = {0};
+  const float sx = (float)width / image->width;
+  const float sy = (float)height / image->height;
+
+  uint8_t *reference = calloc((size_t)width * height, 4);
+  nsvgRasterizeXY(rast, source, 0.0f, 0.0f, (float)width / source->width,
+                  (float)height / source->height, reference, width, height,
+                  width * 4);
+
+  // only what the SVG paints itself; the build also covers shapes that only
+  // an override color would show
+  const int sw = width * BENCH_SUBSAMPLES;
+  const int sh = height * BENCH_SUBSAMPLES;
+  uint8_t *samples = calloc((size_t)sw * sh, 1);
+  int index = 0;
+  for (const NSVGshape *shape = image->shapes; shape;
+       shape = shape->next, index++) {
+    const svg_shape_geom_t *sg = &geom->shapes[index];
+    if (shape->fill.type != NSVG_PAINT_NONE) {
+      for (uint32_t i = 0; i < sg->fill_count; i++)
+        cover_triangle(samples, sw, sh, &geom->tris[sg->fill_start + i], sx,
+                       sy);
+    }
+    if (shape->stroke.type != NSVG_PAINT_NONE) {
+      for (uint32_t i = 0; i < sg->stroke_count; i++)
+        cover_triangle(samples, sw, sh, &geom->tris[sg->stroke_start + i], sx,
+                       sy);
+    }
+  }
+
+  double ours_area = 0.0, ref_area = 0.0, l1 = 0.0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int covered = 0;
+      for (int j = 0; j < BENCH_SUBSAMPLES; j++) {
+        const uint8_t *row =
+            samples + (size_t)(y * BENCH_SUBSAMPLES + j) * sw +
+            x * BENCH_SUBSAMPLES;
+        for (int i = 0; i < BENCH_SUBSAMPLES; i++)
+          covered += row[i];
+      }
+      double ours = (double)covered / (BENCH_SUBSAMPLES * BENCH_SUBSAMPLES);
+      double ref = reference[(y * width + x) * 4 + 3] / 255.0;
+      double diff = ours > ref ? ours - ref : ref - ours;
+      ours_area += ours;
+      ref_area += ref;
+      l1 += diff;
+      if (diff > result.max_px_error)
+        result.max_px_error = diff;
+    }
+  }
+  double denom = ref_area > 1.0 ? ref_area : 1.0;
+  result.area_error =
+      (ours_area > ref_area ? ours_area - ref_area : ref_area - ours_area) /
+      denom;
+  result.l1_error = l1 / denom;
+
+  free(samples);
+  free(reference);
+  return result;
+}
+
+static void paint_white(NSVGpaint *paint) {
+  if (paint->type == NSVG_PAINT_NONE)
+    return;
+  if (paint->type == NSVG_PAINT_LINEAR_GRADIENT ||
+      paint->type == NSVG_PAINT_RADIAL_GRADIENT)
+    free(paint->gradient);
+  paint->type = NSVG_PAINT_COLOR;
+  paint->color = 0xFFFFFFFF;
+}
+
+// Opaque white paint for everything the source SVG draws, so nanosvg's alpha
+// channel is plain coverage. Gradients become solid too.
+static void paint_image_white(NSVGimage *image) {
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next) {
+    shape->opacity = 1.0f;
+    paint_white(&shape->fill);
+    paint_white(&shape->stroke);
+  }
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t ua = *(const uint64_t *)a;
+  uint64_t ub = *(const uint64_t *)b;
+  return (ua > ub) - (ua < ub);
+}
+
+static bool run_icon(NSVGrasterizer *rast, const char *name,
+                     NSVGimage *source, const NSVGimage *image, int size,
+                     int iterations, ErrorLimits limits) {
+  const float sx = (float)size / image->width;
+  const float sy = (float)size / image->height;
+
+  uint64_t *samples = malloc(sizeof(uint64_t) * (size_t)iterations);
+  svg_geom_t geom = {0};
+  bool built = true;
+  // one untimed build so the scratch arena has its blocks, like the cache
+  for (int i = -1; i < iterations && built; i++) {
+    svg_geom_release(&geom);
+    uint64_t start = bench_now_ns();
+    built = svg_geom_build(&geom, image, sx, sy, NULL);
+    if (i >= 0)
+      samples[i] = bench_now_ns() - start;
+  }
+  if (!built) {
+    fprintf(stderr, "%s: tessellation failed at %dpx\n", name, size);
+    svg_geom_release(&geom);
+    free(samples);
+    return false;
+  }
+
+  // separate pass: reading the clock around every path skews the total
+  svg_tess_timing_t timing = {0};
+  for (int i = 0; i < iterations; i++) {
+    svg_geom_release(&geom);
+    svg_geom_build(&geom, image, sx, sy, &timing);
+  }
+
+  uint64_t total = 0;
+  for (int i = 0; i < iterations; i++)
+    total += samples[i];
+  qsort(samples, (size_t)iterations, sizeof(uint64_t), compare_u64);
+
+  uint32_t fill_tris = 0, stroke_tris = 0;
+  for (int i = 0; i < geom.nshapes; i++) {
+    fill_tris += geom.shapes[i].fill_count;
+    stroke_tris += geom.shapes[i].stroke_count;
+  }
+
+  CoverageResult cov =
+      compare_coverage(rast, source, image, &geom, size, size);
+  bool pass = cov.area_error <= limits.area && cov.l1_error <= limits.l1 &&
+              cov.max_px_error <= limits.px;
+
+  printf("{\"bench\":\"svg\",\"icon\":\"%s\",\"size\":%d,\"iterations\":%d,"
+         "\"tris\":%u,\"fill_tris\":%u,\"stroke_tris\":%u,"
+         "\"mean_us\":%.3f,\"p50_us\":%.3f,\"max_us\":%.3f,"
+         "\"flatten_us\":%.3f,\"fill_us\":%.3f,\"stroke_us\":%.3f,"
+         "\"area_error\":%.5f,\"l1_error\":%.5f,\"max_px_error\":%.3f,"
+         "\"pass\":%s}\n",
+         name, size, iterations, geom.ntris, fill_tris, stroke_tris,
+         (double)total / iterations / 1e3,
+         (double)samples[iterations / 2] / 1e3,
+         (double)samples[iterations - 1] / 1e3,
+         (double)timing.flatten_ns / iterations / 1e3,
+         (double)timing.fill_ns / iterations / 1e3,
+         (double)timing.stroke_ns / iterations / 1e3, cov.area_error,
+         cov.l1_error, cov.max_px_error, pass ? "true" : "false");
+  fflush(stdout);
+
+  svg_geom_release(&geom);
+  free(samples);
+  return pass;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s [--icons DIR] [--sizes LIST] [--iterations N] "
+          "[--max-error F] [--max-l1 F] [--max-px-error F]\n",
+          argv0);
+}
+
+int main(int argc, char **argv) {
+  const char *icons_dir = BENCH_ICONS_DIR;
+  const char *sizes = BENCH_DEFAULT_SIZES;
+  int iterations = BENCH_DEFAULT_ITERATIONS;
+  ErrorLimits limits = {BENCH_DEFAULT_MAX_ERROR, BENCH_DEFAULT_MAX_L1,
+                        BENCH_DEFAULT_MAX_PX_ERROR};
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--icons") == 0 && i + 1 < argc) {
+      icons_dir = argv[++i];
+    } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+      sizes = argv[++i];
+    } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--max-error") == 0 && i + 1 < argc) {
+      limits.area = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--max-l1") == 0 && i + 1 < argc) {
+      limits.l1 = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--max-px-error") == 0 && i + 1 < argc) {
+      limits.px = atof(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (iterations < 1)
+    iterations = 1;
+
+  NSVGrasterizer *rast = nsvgCreateRasterizer();
+  if (!rast) {
+    fprintf(stderr, "Failed to create the nanosvg rasterizer\n");
+    return 1;
+  }
+
+  int runs = 0, failures = 0;
+  RES_FOR_EACH_ICON(id) {
+    const char *name = RES_GET_ICON(id)->name;
+    NSVGimage *image = svg_load_compiled(RES_GET_ICON_SVG(id));
+    if (!image || image->width <= 0.0f || image->height <= 0.0f) {
+      fprintf(stderr, "%s: failed to load the compiled icon\n", name);
+      failures++;
+      svg_image_delete(image);
+      continue;
+    }
+
+    // the source gen.ts compiled, as the reference
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", icons_dir, name);
+    NSVGimage *source = nsvgParseFromFile(path, "px", 96.0f);
+    if (!source || source->width <= 0.0f || source->height <= 0.0f) {
+      fprintf(stderr, "%s: failed to parse\n", path);
+      failures++;
+      nsvgDelete(source);
+      svg_image_delete(image);
+      continue;
+    }
+    paint_image_white(source);
+
+    const char *p = sizes;
+    while (*p) {
+      int size = atoi(p);
+      if (size > 0) {
+        runs++;
+        if (!run_icon(rast, name, source, image, size, iterations, limits))
+          failures++;
+      }
+      const char *next = strchr(p, ',');
+      if (!next)
+        break;
+      p = next + 1;
+    }
+    nsvgDelete(source);
+    svg_image_delete(image);
+  }
+
+  svg_scratch_stats_t stats = svg_scratch_stats();
+  printf("{\"bench\":\"svg_summary\",\"icons\":%d,\"runs\":%d,"
+         "\"failures\":%d,\"max_error\":%.4f,\"max_l1\":%.4f,"
+         "\"max_px_error\":%.3f,\"arena_peak_bytes\":%zu,"
+         "\"max_edges\":%d,\"max_stroke_tris\":%d,\"peak_rss_kb\":%llu}\n",
+         RES_ICON_COUNT, runs, failures, limits.area, limits.l1, limits.px,
+         stats.arena_peak_bytes,
+         stats.max_edges, stats.max_stroke_tris,
+         (unsigned long long)bench_peak_rss_kb());
+
+  nsvgDeleteRasterizer(rast);
+  svg_tess_cleanup();
+  return failures > 0 ? 1 : 0;
+}
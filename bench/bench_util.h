@@ -0,0 +1,165 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Shared helpers for the headless benchmark tools: a monotonic clock, peak
+// resident set size, and a small seeded PRNG plus a document generator so
+// workloads are reproducible.
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+static inline uint64_t bench_now_ns(void) {
+#if defined(_WIN32)
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER counter;
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t bench_peak_rss_kb(void) {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return 0;
+  return (uint64_t)pmc.PeakWorkingSetSize / 1024;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return (uint64_t)usage.ru_maxrss / 1024;
+#else
+  return (uint64_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+typedef struct {
+  uint64_t state;
+} BenchRng;
+
+static inline void bench_rng_seed(BenchRng *rng, uint64_t seed) {
+  rng->state = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+// splitmix64
+static inline uint64_t bench_rng_next(BenchRng *rng) {
+  uint64_t z = (rng->state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+static inline uint64_t bench_rng_range(BenchRng *rng, uint64_t n) {
+  return n ? bench_rng_next(rng) % n : 0;
+}
+
+// parses "512", "64K", "16M", "1G"
+static inline size_t bench_parse_size(const char *str) {
+  char *end = NULL;
+  double value = strtod(str, &end);
+  if (end && (*end == 'k' || *end == 'K'))
+    value *= 1024.0;
+  else if (end && (*end == 'm' || *end == 'M'))
+    value *= 1024.0 * 1024.0;
+  else if (end && (*end == 'g' || *end == 'G'))
+    value *= 1024.0 * 1024.0 * 1024.0;
+  return value > 0.0 ? (size_t)value : 0;
+}
+
+// the whole file, e.g. one andex_corpus wrote; NULL if it can't be read
+static inline char *bench_read_document(const char *path, size_t *out_size) {
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return NULL;
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  char *doc = size >= 0 ? malloc((size_t)size + 1) : NULL;
+  if (doc && fread(doc, 1, (size_t)size, file) != (size_t)size) {
+    free(doc);
+    doc = NULL;
+  }
+  fclose(file);
+  if (doc)
+    *out_size = (size_t)size;
+  return doc;
+}
+
+#define BENCH_DOC_LINE_WIDTH 80
+
+// Journal-like prose from a fixed word list, with lines broken a little
+// short of BENCH_DOC_LINE_WIDTH; the same seed gives the same document
+static inline char *bench_generate_document(BenchRng *rng, size_t size) {
+  static const char *words[] = {
+      "the",     "editor", "gap",      "buffer",  "line",  "cursor",  "undo",
+      "journal", "entry",  "markdown", "history", "a",     "of",      "and",
+      "to",      "render", "layout",   "quick",   "brown", "fox",     "#",
+      "-",       "notes",  "today",    "wrote",   "about", "nothing", "much"};
+  char *doc = malloc(size);
+  if (!doc)
+    return NULL;
+
+  const size_t word_count = sizeof(words) / sizeof(words[0]);
+  size_t pos = 0;
+  size_t col = 0;
+  while (pos < size) {
+    const char *word = words[bench_rng_range(rng, word_count)];
+    size_t len = strlen(word);
+    for (size_t i = 0; i < len && pos < size; i++, col++)
+      doc[pos++] = word[i];
+    if (pos >= size)
+      break;
+    if (col >= BENCH_DOC_LINE_WIDTH - 10 && bench_rng_range(rng, 4) == 0) {
+      doc[pos++] = '\n';
+      col = 0;
+    } else {
+      doc[pos++] = ' ';
+      col++;
+    }
+  }
+  return doc;
+}
+
+// true when name appears in a comma-separated filter (NULL matches all)
+static inline bool bench_filter_match(const char *filter, const char *name) {
+  if (!filter)
+    return true;
+  size_t name_len = strlen(name);
+  const char *p = filter;
+  while (*p) {
+    const char *comma = strchr(p, ',');
+    size_t len = comma ? (size_t)(comma - p) : strlen(p);
+    if (len == name_len && strncmp(p, name, len) == 0)
+      return true;
+    if (!comma)
+      break;
+    p = comma + 1;
+  }
+  return false;
+}
+
+#endif
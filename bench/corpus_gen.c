@@ -0,0 +1,392 @@
+#include "bench_util.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#define corpus_mkdir(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define corpus_mkdir(path) mkdir(path, 0755)
+#endif
+
+// Reproducible inputs for the benchmarks. Output depends only on the
+// arguments and the seed, never on the clock or the machine:
+//
+//   andex_corpus history DIR [--entries 1000] [--entry-size 2K] [--seed N]
+//   andex_corpus doc KIND FILE [--size N] [--seed N]
+//
+// `history` writes entries in the app's [uuid]-[YYYY-MM-DD-HH-MM-SS].md
+// scheme, one every few hours going back from 2026-01-01 00:00:00 UTC.
+// Point HOME at a directory whose Documents/andex is DIR to load them.
+//
+// `doc` kinds and their default sizes:
+//   long_line    50M  one line of words, no newline at all
+//   empty_lines   4M  nothing but '\n', one empty line per byte
+//   utf8         16M  2, 3 and 4 byte sequences mixed with ASCII
+//   crlf         16M  prose with "\r\n" line endings
+//   markdown     16M  deeply nested lists, quotes, headings and fences
+
+#define CORPUS_DEFAULT_ENTRIES 1000
+#define CORPUS_DEFAULT_ENTRY_SIZE "2K"
+#define CORPUS_BASE_TIME 1767225600 // 2026-01-01 00:00:00 UTC
+#define CORPUS_LINE_WIDTH 80
+#define CORPUS_MAX_DEPTH 32
+
+typedef struct {
+  FILE *file;
+  size_t written;
+  size_t limit;
+  size_t col;
+} CorpusOut;
+
+// writes whole tokens only, so multibyte sequences are never cut in half
+static bool out_put(CorpusOut *out, const char *s, size_t len) {
+  if (out->written + len > out->limit)
+    return false;
+  fwrite(s, 1, len, out->file);
+  out->written += len;
+  for (size_t i = 0; i < len; i++)
+    out->col = s[i] == '\n' ? 0 : out->col + 1;
+  return true;
+}
+
+static bool out_puts(CorpusOut *out, const char *s) {
+  return out_put(out, s, strlen(s));
+}
+
+static const char *ASCII_WORDS[] = {
+    "the",    "journal", "entry", "today",   "morning", "wrote",  "about",
+    "a",      "quiet",   "walk",  "and",     "coffee",  "of",     "notes",
+    "thought", "nothing", "much", "editor",  "window",  "rain",   "later",
+    "to",     "remember", "why",  "because", "again",   "small",  "steps"};
+
+// precomposed and combining accents, RTL scripts, CJK, astral-plane
+// symbols and a ZWJ emoji sequence
+static const char *UTF8_WORDS[] = {
+    "café",  "naïve",  "Ärger",  "smørrebrød", "привет",    "мир",
+    "γράφω", "λέξη",   "שלום",   "مرحبا",      "日記",      "今日は",
+    "書く",  "한국어", "글쓰기", "ไทย",        "€",         "→",
+    "😀",    "📓",     "🦊",     "👩‍💻",         "e\xcc\x81", "ﬁ",
+    "𝔘𝔫𝔦",   "Ωμέγα",  "文字化け"};
+
+#define COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *pick_word(BenchRng *rng, const char **words, size_t n) {
+  return words[bench_rng_range(rng, n)];
+}
+
+// prose with soft line breaks around CORPUS_LINE_WIDTH and an occasional
+// blank line between paragraphs
+static void write_prose(CorpusOut *out, BenchRng *rng, const char **words,
+                        size_t word_count, const char *newline) {
+  for (;;) {
+    if (!out_puts(out, pick_word(rng, words, word_count)))
+      return;
+    bool ok;
+    if (out->col >= CORPUS_LINE_WIDTH - 12 && bench_rng_range(rng, 3) == 0) {
+      ok = out_puts(out, newline) &&
+           (bench_rng_range(rng, 6) != 0 || out_puts(out, newline));
+    } else {
+      ok = out_put(out, " ", 1);
+    }
+    if (!ok)
+      return;
+  }
+}
+
+static void write_long_line(CorpusOut *out, BenchRng *rng) {
+  while (out_puts(out, pick_word(rng, ASCII_WORDS, COUNT(ASCII_WORDS))) &&
+         out_put(out, " ", 1))
+    ;
+}
+
+static void write_empty_lines(CorpusOut *out, BenchRng *rng) {
+  (void)rng;
+  char block[4096];
+  memset(block, '\n', sizeof(block));
+  while (out->written < out->limit) {
+    size_t n = out->limit - out->written;
+    if (n > sizeof(block))
+      n = sizeof(block);
+    out_put(out, block, n);
+  }
+}
+
+static void write_utf8(CorpusOut *out, BenchRng *rng) {
+  // one ASCII word in four keeps wrapping and word boundaries realistic
+  for (;;) {
+    const char *word = bench_rng_range(rng, 4) == 0
+                           ? pick_word(rng, ASCII_WORDS, COUNT(ASCII_WORDS))
+                           : pick_word(rng, UTF8_WORDS, COUNT(UTF8_WORDS));
+    if (!out_puts(out, word))
+      return;
+    const char *sep =
+        out->col >= CORPUS_LINE_WIDTH && bench_rng_range(rng, 3) == 0 ? "\n"
+                                                                       : " ";
+    if (!out_puts(out, sep))
+      return;
+  }
+}
+
+static void write_crlf(CorpusOut *out, BenchRng *rng) {
+  write_prose(out, rng, ASCII_WORDS, COUNT(ASCII_WORDS), "\r\n");
+}
+
+static bool write_md_text(CorpusOut *out, BenchRng *rng, size_t words) {
+  for (size_t i = 0; i < words; i++) {
+    const char *word = pick_word(rng, ASCII_WORDS, COUNT(ASCII_WORDS));
+    char token[64];
+    switch (bench_rng_range(rng, 10)) {
+    case 0:
+      snprintf(token, sizeof(token), "**%s**", word);
+      break;
+    case 1:
+      snprintf(token, sizeof(token), "_%s_", word);
+      break;
+    case 2:
+      snprintf(token, sizeof(token), "`%s`", word);
+      break;
+    case 3:
+      snprintf(token, sizeof(token), "[%s](https://example.com/%s)", word,
+               word);
+      break;
+    default:
+      snprintf(token, sizeof(token), "%s", word);
+      break;
+    }
+    if ((i > 0 && !out_put(out, " ", 1)) || !out_puts(out, token))
+      return false;
+  }
+  return out_put(out, "\n", 1);
+}
+
+static void write_markdown(CorpusOut *out, BenchRng *rng) {
+  for (;;) {
+    bool ok = true;
+    switch (bench_rng_range(rng, 5)) {
+    case 0: {
+      size_t level = 1 + bench_rng_range(rng, 6);
+      for (size_t i = 0; i < level && ok; i++)
+        ok = out_put(out, "#", 1);
+      ok = ok && out_put(out, " ", 1) &&
+           write_md_text(out, rng, 2 + bench_rng_range(rng, 6));
+      break;
+    }
+    case 1: {
+      // a list that nests one level deeper per item, then unwinds
+      size_t depth = 1 + bench_rng_range(rng, CORPUS_MAX_DEPTH);
+      for (size_t d = 0; d < depth * 2 && ok; d++) {
+        size_t level = d < depth ? d : depth * 2 - d - 1;
+        for (size_t i = 0; i < level && ok; i++)
+          ok = out_put(out, "  ", 2);
+        ok = ok && out_puts(out, bench_rng_range(rng, 2) ? "- " : "1. ") &&
+             write_md_text(out, rng, 3 + bench_rng_range(rng, 8));
+      }
+      break;
+    }
+    case 2: {
+      size_t depth = 1 + bench_rng_range(rng, CORPUS_MAX_DEPTH);
+      for (size_t i = 0; i < depth && ok; i++)
+        ok = out_put(out, "> ", 2);
+      ok = ok && write_md_text(out, rng, 5 + bench_rng_range(rng, 20));
+      break;
+    }
+    case 3: {
+      ok = out_puts(out, "```c\n");
+      size_t lines = 1 + bench_rng_range(rng, 12);
+      for (size_t i = 0; i < lines && ok; i++) {
+        char line[128];
+        snprintf(line, sizeof(line), "%*sint %s_%zu = %llu;\n",
+                 (int)(bench_rng_range(rng, 4) * 4), "",
+                 pick_word(rng, ASCII_WORDS, COUNT(ASCII_WORDS)), i,
+                 (unsigned long long)bench_rng_range(rng, 100000));
+        ok = out_puts(out, line);
+      }
+      ok = ok && out_puts(out, "```\n");
+      break;
+    }
+    default:
+      ok = write_md_text(out, rng, 10 + bench_rng_range(rng, 60));
+      break;
+    }
+    if (!ok || !out_put(out, "\n", 1))
+      return;
+  }
+}
+
+typedef struct {
+  const char *name;
+  const char *default_size;
+  void (*write)(CorpusOut *out, BenchRng *rng);
+} DocKind;
+
+static const DocKind DOC_KINDS[] = {
+    {"long_line", "50M", write_long_line},
+    {"empty_lines", "4M", write_empty_lines},
+    {"utf8", "16M", write_utf8},
+    {"crlf", "16M", write_crlf},
+    {"markdown", "16M", write_markdown},
+};
+
+static bool make_dirs(const char *path) {
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "%s", path);
+  for (char *p = buf + 1; *p; p++) {
+    if (*p != '/' && *p != '\\')
+      continue;
+    char c = *p;
+    *p = '\0';
+    if (corpus_mkdir(buf) != 0 && errno != EEXIST)
+      return false;
+    *p = c;
+  }
+  return corpus_mkdir(buf) == 0 || errno == EEXIST;
+}
+
+static int generate_doc(const DocKind *kind, const char *path, size_t size,
+                        uint64_t seed) {
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return 1;
+  }
+
+  BenchRng rng;
+  bench_rng_seed(&rng, seed);
+  CorpusOut out = {.file = file, .limit = size};
+  kind->write(&out, &rng);
+
+  bool ok = ferror(file) == 0;
+  ok = fclose(file) == 0 && ok;
+  if (!ok) {
+    fprintf(stderr, "Failed to write %s\n", path);
+    return 1;
+  }
+  printf("{\"corpus\":\"doc\",\"kind\":\"%s\",\"path\":\"%s\",\"bytes\":%zu,"
+         "\"seed\":%llu}\n",
+         kind->name, path, out.written, (unsigned long long)seed);
+  return 0;
+}
+
+static int generate_history(const char *dir, size_t entries, size_t entry_size,
+                            uint64_t seed) {
+  if (!make_dirs(dir)) {
+    fprintf(stderr, "Failed to create %s\n", dir);
+    return 1;
+  }
+
+  BenchRng rng;
+  bench_rng_seed(&rng, seed);
+  time_t when = (time_t)CORPUS_BASE_TIME;
+  size_t total = 0;
+
+  for (size_t i = 0; i < entries; i++) {
+    // same shape as create_new_entry() in main.c
+    char id[64];
+    snprintf(id, sizeof(id), "%08llx-%04llx-%04llx-%04llx-%012llx",
+             (unsigned long long)(bench_rng_next(&rng) & 0xffffffffull),
+             (unsigned long long)(bench_rng_next(&rng) & 0xffff),
+             (unsigned long long)(bench_rng_next(&rng) & 0xffff),
+             (unsigned long long)(bench_rng_next(&rng) & 0xffff),
+             (unsigned long long)(bench_rng_next(&rng) & 0xffffffffffffull));
+
+    when -= (time_t)(3600 + bench_rng_range(&rng, 36 * 3600));
+    char date_str[64];
+    strftime(date_str, sizeof(date_str), "%Y-%m-%d-%H-%M-%S", gmtime(&when));
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/[%s]-[%s].md", dir, id, date_str);
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+      fprintf(stderr, "Failed to open %s\n", path);
+      return 1;
+    }
+
+    // sizes spread from a quarter to twice the requested average
+    size_t size = entry_size / 4 + bench_rng_range(&rng, entry_size * 7 / 4 + 1);
+    CorpusOut out = {.file = file, .limit = size};
+    if (bench_rng_range(&rng, 8) == 0)
+      write_markdown(&out, &rng);
+    else
+      write_prose(&out, &rng, ASCII_WORDS, COUNT(ASCII_WORDS), "\n");
+    total += out.written;
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+      fprintf(stderr, "Failed to write %s\n", path);
+      return 1;
+    }
+  }
+
+  printf("{\"corpus\":\"history\",\"path\":\"%s\",\"entries\":%zu,"
+         "\"bytes\":%zu,\"seed\":%llu}\n",
+         dir, entries, total, (unsigned long long)seed);
+  return 0;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+          "usage: %s history DIR [--entries N] [--entry-size N] [--seed N]\n"
+          "       %s doc KIND FILE [--size N] [--seed N]\n  kinds:",
+          argv0, argv0);
+  for (size_t i = 0; i < COUNT(DOC_KINDS); i++)
+    fprintf(stderr, " %s", DOC_KINDS[i].name);
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bool history = strcmp(argv[1], "history") == 0;
+  const DocKind *kind = NULL;
+  int first_opt = 3;
+  if (!history) {
+    if (strcmp(argv[1], "doc") != 0 || argc < 4) {
+      usage(argv[0]);
+      return 1;
+    }
+    for (size_t i = 0; i < COUNT(DOC_KINDS); i++) {
+      if (strcmp(argv[2], DOC_KINDS[i].name) == 0)
+        kind = &DOC_KINDS[i];
+    }
+    if (!kind) {
+      usage(argv[0]);
+      return 1;
+    }
+    first_opt = 4;
+  }
+
+  size_t entries = CORPUS_DEFAULT_ENTRIES;
+  size_t entry_size = bench_parse_size(CORPUS_DEFAULT_ENTRY_SIZE);
+  size_t size = kind ? bench_parse_size(kind->default_size) : 0;
+  uint64_t seed = 1;
+
+  for (int i = first_opt; i < argc; i++) {
+    if (strcmp(argv[i], "--entries") == 0 && i + 1 < argc && history) {
+      entries = strtoull(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--entry-size") == 0 && i + 1 < argc &&
+               history) {
+      entry_size = bench_parse_size(argv[++i]);
+    } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && !history) {
+      size = bench_parse_size(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (history)
+    return generate_history(argv[2], entries, entry_size, seed);
+  return generate_doc(kind, argv[3], size, seed);
+}
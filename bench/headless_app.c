@@ -0,0 +1,210 @@
+#include "headless_app.h"
+
+#include "sokol_gfx.h"
+#include "sokol_app.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#define HEADLESS_CLIPBOARD_SIZE 65536
+
+static struct {
+  EGLDisplay display;
+  EGLSurface surface;
+  EGLContext context;
+  int width;
+  int height;
+  float dpi_scale;
+  int sample_count;
+  bool fullscreen;
+  bool quit_requested;
+  uint64_t frame_count;
+  char clipboard[HEADLESS_CLIPBOARD_SIZE];
+} g_headless;
+
+static EGLDisplay headless_open_display(void) {
+  // surfaceless needs neither X11 nor a render node, so it also works on
+  // containers and CI runners without a GPU
+  PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress(
+          "eglGetPlatformDisplayEXT");
+  if (get_platform_display) {
+    EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                              EGL_DEFAULT_DISPLAY, NULL);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+      return display;
+  }
+
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+    return display;
+  return EGL_NO_DISPLAY;
+}
+
+static bool headless_choose_config(int sample_count, EGLConfig *out) {
+  const EGLint attribs[] = {EGL_SURFACE_TYPE,
+                            EGL_PBUFFER_BIT,
+                            EGL_RENDERABLE_TYPE,
+                            EGL_OPENGL_BIT,
+                            EGL_RED_SIZE,
+                            8,
+                            EGL_GREEN_SIZE,
+                            8,
+                            EGL_BLUE_SIZE,
+                            8,
+                            EGL_ALPHA_SIZE,
+                            8,
+                            EGL_DEPTH_SIZE,
+                            24,
+                            EGL_STENCIL_SIZE,
+                            8,
+                            EGL_SAMPLE_BUFFERS,
+                            sample_count > 1 ? 1 : 0,
+                            EGL_SAMPLES,
+                            sample_count > 1 ? sample_count : 0,
+                            EGL_NONE};
+  EGLint count = 0;
+  return eglChooseConfig(g_headless.display, attribs, out, 1, &count) &&
+         count > 0;
+}
+
+bool headless_app_init(const sapp_desc *desc, const HeadlessAppConfig *config) {
+  memset(&g_headless, 0, sizeof(g_headless));
+  g_headless.dpi_scale = config->dpi_scale > 0.0f ? config->dpi_scale : 1.0f;
+  g_headless.width = (int)((float)config->width * g_headless.dpi_scale);
+  g_headless.height = (int)((float)config->height * g_headless.dpi_scale);
+  g_headless.sample_count =
+      config->sample_count > 0 ? config->sample_count : desc->sample_count;
+  if (g_headless.sample_count < 1)
+    g_headless.sample_count = 1;
+
+  g_headless.display = headless_open_display();
+  if (g_headless.display == EGL_NO_DISPLAY) {
+    fprintf(stderr, "headless: no EGL display\n");
+    return false;
+  }
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    fprintf(stderr, "headless: EGL has no desktop GL\n");
+    return false;
+  }
+
+  EGLConfig egl_config;
+  if (!headless_choose_config(g_headless.sample_count, &egl_config)) {
+    if (g_headless.sample_count == 1 ||
+        !headless_choose_config(1, &egl_config)) {
+      fprintf(stderr, "headless: no matching EGL config\n");
+      return false;
+    }
+    fprintf(stderr, "headless: %dx MSAA unavailable, using 1\n",
+            g_headless.sample_count);
+    g_headless.sample_count = 1;
+  }
+
+  const EGLint surface_attribs[] = {EGL_WIDTH, g_headless.width, EGL_HEIGHT,
+                                    g_headless.height, EGL_NONE};
+  g_headless.surface =
+      eglCreatePbufferSurface(g_headless.display, egl_config, surface_attribs);
+  if (g_headless.surface == EGL_NO_SURFACE) {
+    fprintf(stderr, "headless: failed to create %dx%d pbuffer\n",
+            g_headless.width, g_headless.height);
+    return false;
+  }
+
+  // same version sokol_app asks for with SOKOL_GLCORE
+  const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                    4,
+                                    EGL_CONTEXT_MINOR_VERSION,
+                                    1,
+                                    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                    EGL_NONE};
+  g_headless.context = eglCreateContext(g_headless.display, egl_config,
+                                        EGL_NO_CONTEXT, context_attribs);
+  if (g_headless.context == EGL_NO_CONTEXT) {
+    fprintf(stderr, "headless: failed to create a GL 4.1 core context\n");
+    return false;
+  }
+  if (!eglMakeCurrent(g_headless.display, g_headless.surface,
+                      g_headless.surface, g_headless.context)) {
+    fprintf(stderr, "headless: eglMakeCurrent failed\n");
+    return false;
+  }
+  return true;
+}
+
+void headless_app_shutdown(void) {
+  if (g_headless.display == EGL_NO_DISPLAY)
+    return;
+  eglMakeCurrent(g_headless.display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                 EGL_NO_CONTEXT);
+  if (g_headless.context != EGL_NO_CONTEXT)
+    eglDestroyContext(g_headless.display, g_headless.context);
+  if (g_headless.surface != EGL_NO_SURFACE)
+    eglDestroySurface(g_headless.display, g_headless.surface);
+  eglTerminate(g_headless.display);
+  memset(&g_headless, 0, sizeof(g_headless));
+}
+
+void headless_app_present(void) {
+  glFinish();
+  g_headless.frame_count++;
+}
+
+bool headless_app_quit_requested(void) { return g_headless.quit_requested; }
+
+uint64_t headless_app_frame_count(void) { return g_headless.frame_count; }
+
+const char *headless_app_renderer(void) {
+  const char *renderer = (const char *)glGetString(GL_RENDERER);
+  return renderer ? renderer : "unknown";
+}
+
+// sokol_app API used by main.c, sokol_glue.h and sokol_clay.h
+
+bool sapp_isvalid(void) { return g_headless.context != EGL_NO_CONTEXT; }
+int sapp_width(void) { return g_headless.width; }
+float sapp_widthf(void) { return (float)g_headless.width; }
+int sapp_height(void) { return g_headless.height; }
+float sapp_heightf(void) { return (float)g_headless.height; }
+int sapp_color_format(void) { return SG_PIXELFORMAT_RGBA8; }
+int sapp_depth_format(void) { return SG_PIXELFORMAT_DEPTH_STENCIL; }
+int sapp_sample_count(void) { return g_headless.sample_count; }
+bool sapp_high_dpi(void) { return g_headless.dpi_scale > 1.0f; }
+float sapp_dpi_scale(void) { return g_headless.dpi_scale; }
+uint64_t sapp_frame_count(void) { return g_headless.frame_count; }
+double sapp_frame_duration(void) { return 1.0 / 60.0; }
+bool sapp_is_fullscreen(void) { return g_headless.fullscreen; }
+void sapp_toggle_fullscreen(void) {
+  g_headless.fullscreen = !g_headless.fullscreen;
+}
+void sapp_request_quit(void) { g_headless.quit_requested = true; }
+void sapp_quit(void) { g_headless.quit_requested = true; }
+void sapp_cancel_quit(void) { g_headless.quit_requested = false; }
+
+void sapp_set_clipboard_string(const char *str) {
+  snprintf(g_headless.clipboard, sizeof(g_headless.clipboard), "%s",
+           str ? str : "");
+}
+const char *sapp_get_clipboard_string(void) { return g_headless.clipboard; }
+
+// the framebuffer of the current pbuffer surface
+uint32_t sapp_gl_get_framebuffer(void) { return 0; }
+
+const void *sapp_x11_get_window(void) { return NULL; }
+const void *sapp_x11_get_display(void) { return NULL; }
+const void *sapp_egl_get_display(void) { return g_headless.display; }
+const void *sapp_egl_get_context(void) { return g_headless.context; }
+
+// mac_window.c equivalents, there is no window to shape
+void app_make_compact_window(bool show_controls) { (void)show_controls; }
+void app_set_minimum_window_size(float width, float height) {
+  (void)width;
+  (void)height;
+}
@@ -0,0 +1,31 @@
+#ifndef HEADLESS_APP_H
+#define HEADLESS_APP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Stand-in for sokol_app in andex_frame_bench: owns an offscreen EGL context
+// (Mesa surfaceless or default display, pbuffer backbuffer) and implements
+// the sapp_* functions the app calls. main.c is built with ANDEX_HEADLESS so
+// it doesn't pull in the real sokol_app implementation.
+
+typedef struct sapp_desc sapp_desc;
+
+typedef struct {
+  int width;
+  int height;
+  float dpi_scale;
+  int sample_count; // 0 uses the sapp_desc value
+} HeadlessAppConfig;
+
+bool headless_app_init(const sapp_desc *desc, const HeadlessAppConfig *config);
+void headless_app_shutdown(void);
+
+// waits for the GPU to finish the frame; pbuffers have nothing to swap
+void headless_app_present(void);
+
+bool headless_app_quit_requested(void);
+uint64_t headless_app_frame_count(void);
+const char *headless_app_renderer(void);
+
+#endif
@@ -1,13 +1,31 @@
+import { existsSync, mkdirSync, readFileSync, writeFileSync } from "fs";
 import path from "path";
+import { inflateSync } from "zlib";
 
+type ImageFormat = "png" | "rgba8" | "qoi";
 type ImageEntry = {
 	id: string;
 	path: string;
 	uv?: [number, number, number, number];
+	format?: ImageFormat; // "png" if not given
+	premultiply?: boolean;
+	mips?: boolean; // "rgba8" only
+	texture?: string; // images naming the same texture are packed together
 };
 type FontEntry = { id: string; path: string };
 type IconEntry = { id: string; path: string; fill?: number; stroke?: number };
-type Spec = { images?: ImageEntry[]; fonts?: FontEntry[]; icons?: IconEntry[] };
+type GlyphFaces = { fonts: string[]; sizes: number[] };
+type GlyphSpec = {
+	scales?: number[];
+	ranges?: [number, number][];
+	faces?: GlyphFaces[];
+};
+type Spec = {
+	images?: ImageEntry[];
+	fonts?: FontEntry[];
+	icons?: IconEntry[];
+	glyphs?: GlyphSpec;
+};
 
 const [, , inPath, outPath] = process.argv;
 if (!inPath || !outPath) {
@@ -22,6 +40,7 @@ const outDir = path.dirname(path.resolve(outPath));
 const images = Array.isArray(spec.images) ? spec.images : [];
 const fonts = Array.isArray(spec.fonts) ? spec.fonts : [];
 const icons = Array.isArray(spec.icons) ? spec.icons : [];
+const glyphs: GlyphSpec = spec.glyphs ?? {};
 
 function posixRel(fromDir: string, absFile: string): string {
 	const rel = path.relative(fromDir, absFile);
@@ -49,8 +68,1191 @@ function formatHexColor(color: number | undefined): string {
 	return `0x${color.toString(16).toUpperCase().padStart(8, "0")}`;
 }
 
+/* ===== SVG compilation =====
+ * Icons are parsed here instead of at startup. The output matches what
+ * nanosvg's parser builds at 96 dpi: transforms are applied, every path is
+ * a start point followed by cubic segments, and colors are packed the way
+ * NSVGpaint stores them (0xAABBGGRR). */
+
+type Xform = [number, number, number, number, number, number];
+type SvgAttr = {
+	xform: Xform;
+	fill: number | null; // 0xBBGGRR, null for none
+	stroke: number | null;
+	opacity: number;
+	fillOpacity: number;
+	strokeOpacity: number;
+	strokeWidth: number;
+	fillRule: number;
+	lineJoin: number;
+	lineCap: number;
+	miterLimit: number;
+	visible: boolean;
+};
+type SvgPath = { pts: number[]; closed: boolean };
+type SvgShape = {
+	fill: number | null; // 0xAABBGGRR, null for none
+	stroke: number | null;
+	opacity: number;
+	strokeWidth: number;
+	fillRule: number;
+	lineJoin: number;
+	lineCap: number;
+	miterLimit: number;
+	visible: boolean;
+	paths: SvgPath[];
+};
+type CompiledSvg = { width: number; height: number; shapes: SvgShape[] };
+type XmlNode = {
+	tag: string;
+	attrs: Record<string, string>;
+	children: XmlNode[];
+};
+
+const SVG_DPI = 96;
+const SVG_KAPPA = 0.5522847493;
+
+const SVG_NAMED_COLORS: Record<string, number> = {
+	black: 0x000000,
+	white: 0xffffff,
+	red: 0xff0000,
+	green: 0x008000,
+	blue: 0x0000ff,
+	yellow: 0xffff00,
+	cyan: 0x00ffff,
+	magenta: 0xff00ff,
+	gray: 0x808080,
+	grey: 0x808080,
+	silver: 0xc0c0c0,
+	orange: 0xffa500,
+	currentcolor: 0x000000,
+};
+
+function parseXml(text: string, file: string): XmlNode {
+	const root: XmlNode = { tag: "#root", attrs: {}, children: [] };
+	const stack: XmlNode[] = [root];
+	const tagRe =
+		/<!--[\s\S]*?-->|<\?[\s\S]*?\?>|<!\[CDATA\[[\s\S]*?\]\]>|<!DOCTYPE[^>]*>|<\/\s*([\w:-]+)\s*>|<([\w:-]+)((?:\s+[\w:-]+\s*=\s*(?:"[^"]*"|'[^']*'))*)\s*(\/?)>/g;
+	const attrRe = /([\w:-]+)\s*=\s*(?:"([^"]*)"|'([^']*)')/g;
+	for (const m of text.matchAll(tagRe)) {
+		if (m[1]) {
+			if (stack.length < 2 || stack[stack.length - 1].tag !== m[1])
+				throw new Error(`${file}: unbalanced </${m[1]}>`);
+			stack.pop();
+		} else if (m[2]) {
+			const node: XmlNode = { tag: m[2], attrs: {}, children: [] };
+			for (const a of (m[3] ?? "").matchAll(attrRe))
+				node.attrs[a[1]] = a[2] ?? a[3];
+			stack[stack.length - 1].children.push(node);
+			if (!m[4]) stack.push(node);
+		}
+	}
+	const svg = root.children.find((n) => n.tag === "svg");
+	if (!svg) throw new Error(`${file}: no <svg> element`);
+	return svg;
+}
+
+function xformMultiply(a: Xform, b: Xform): Xform {
+	// a applied after b
+	return [
+		a[0] * b[0] + a[2] * b[1],
+		a[1] * b[0] + a[3] * b[1],
+		a[0] * b[2] + a[2] * b[3],
+		a[1] * b[2] + a[3] * b[3],
+		a[0] * b[4] + a[2] * b[5] + a[4],
+		a[1] * b[4] + a[3] * b[5] + a[5],
+	];
+}
+
+function xformPoint(t: Xform, x: number, y: number): [number, number] {
+	return [x * t[0] + y * t[2] + t[4], x * t[1] + y * t[3] + t[5]];
+}
+
+function xformAverageScale(t: Xform): number {
+	const sx = Math.hypot(t[0], t[2]);
+	const sy = Math.hypot(t[1], t[3]);
+	return (sx + sy) * 0.5;
+}
+
+function parseNumbers(s: string): number[] {
+	return (s.match(/[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?/g) ?? []).map(
+		Number,
+	);
+}
+
+function parseTransform(s: string, file: string): Xform {
+	let t: Xform = [1, 0, 0, 1, 0, 0];
+	for (const m of s.matchAll(/(\w+)\s*\(([^)]*)\)/g)) {
+		const v = parseNumbers(m[2]);
+		let x: Xform;
+		switch (m[1]) {
+			case "matrix":
+				x = [v[0], v[1], v[2], v[3], v[4], v[5]];
+				break;
+			case "translate":
+				x = [1, 0, 0, 1, v[0], v[1] ?? 0];
+				break;
+			case "scale":
+				x = [v[0], 0, 0, v[1] ?? v[0], 0, 0];
+				break;
+			case "rotate": {
+				const a = (v[0] * Math.PI) / 180;
+				const cs = Math.cos(a);
+				const sn = Math.sin(a);
+				x = [cs, sn, -sn, cs, 0, 0];
+				if (v.length >= 3) {
+					x = xformMultiply(
+						[1, 0, 0, 1, v[1], v[2]],
+						xformMultiply(x, [1, 0, 0, 1, -v[1], -v[2]]),
+					);
+				}
+				break;
+			}
+			case "skewX":
+				x = [1, 0, Math.tan((v[0] * Math.PI) / 180), 1, 0, 0];
+				break;
+			case "skewY":
+				x = [1, Math.tan((v[0] * Math.PI) / 180), 0, 1, 0, 0];
+				break;
+			default:
+				throw new Error(`${file}: unsupported transform ${m[1]}`);
+		}
+		t = xformMultiply(t, x);
+	}
+	return t;
+}
+
+function parseLength(s: string | undefined, fallback: number): number {
+	if (s === undefined) return fallback;
+	const m = s
+		.trim()
+		.match(/^([-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?)(\w*|%)$/);
+	if (!m) return fallback;
+	const v = Number(m[1]);
+	switch (m[2]) {
+		case "pt":
+			return (v * SVG_DPI) / 72;
+		case "pc":
+			return (v * SVG_DPI) / 6;
+		case "in":
+			return v * SVG_DPI;
+		case "mm":
+			return (v * SVG_DPI) / 25.4;
+		case "cm":
+			return (v * SVG_DPI) / 2.54;
+		case "%":
+			return fallback;
+		default:
+			return v;
+	}
+}
+
+function parseColor(s: string, file: string): number | null {
+	const c = s.trim().toLowerCase();
+	if (c === "none" || c === "transparent") return null;
+	let rgb: number;
+	if (/^#[0-9a-f]{6}$/.test(c)) {
+		rgb = parseInt(c.slice(1), 16);
+	} else if (/^#[0-9a-f]{3}$/.test(c)) {
+		rgb = parseInt(c[1] + c[1] + c[2] + c[2] + c[3] + c[3], 16);
+	} else if (c.startsWith("rgb(")) {
+		const parts = c.slice(4, -1).split(",");
+		const [r, g, b] = parts.map((p) =>
+			Math.round(
+				p.includes("%") ? (parseFloat(p) * 255) / 100 : parseFloat(p),
+			),
+		);
+		rgb = (r << 16) | (g << 8) | b;
+	} else if (c in SVG_NAMED_COLORS) {
+		rgb = SVG_NAMED_COLORS[c];
+	} else {
+		throw new Error(`${file}: unsupported color ${s}`);
+	}
+	const r = (rgb >> 16) & 0xff;
+	const g = (rgb >> 8) & 0xff;
+	const b = rgb & 0xff;
+	return (b << 16) | (g << 8) | r;
+}
+
+function applyAttrs(
+	parent: SvgAttr,
+	node: XmlNode,
+	file: string,
+): SvgAttr {
+	const attr: SvgAttr = { ...parent };
+	const props: Record<string, string> = { ...node.attrs };
+	for (const decl of (node.attrs.style ?? "").split(";")) {
+		const i = decl.indexOf(":");
+		if (i > 0) props[decl.slice(0, i).trim()] = decl.slice(i + 1).trim();
+	}
+	if (props.transform)
+		attr.xform = xformMultiply(
+			parent.xform,
+			parseTransform(props.transform, file),
+		);
+	if (props.fill !== undefined) attr.fill = parseColor(props.fill, file);
+	if (props.stroke !== undefined) attr.stroke = parseColor(props.stroke, file);
+	if (props.opacity !== undefined) attr.opacity = parseFloat(props.opacity);
+	if (props["fill-opacity"] !== undefined)
+		attr.fillOpacity = parseFloat(props["fill-opacity"]);
+	if (props["stroke-opacity"] !== undefined)
+		attr.strokeOpacity = parseFloat(props["stroke-opacity"]);
+	if (props["stroke-width"] !== undefined)
+		attr.strokeWidth = parseLength(props["stroke-width"], 1);
+	if (props["stroke-miterlimit"] !== undefined)
+		attr.miterLimit = parseFloat(props["stroke-miterlimit"]);
+	if (props["fill-rule"] !== undefined)
+		attr.fillRule = props["fill-rule"] === "evenodd" ? 1 : 0;
+	if (props["stroke-linejoin"] !== undefined)
+		attr.lineJoin =
+			{ miter: 0, round: 1, bevel: 2 }[props["stroke-linejoin"]] ?? 0;
+	if (props["stroke-linecap"] !== undefined)
+		attr.lineCap =
+			{ butt: 0, round: 1, square: 2 }[props["stroke-linecap"]] ?? 0;
+	if (props.display === "none" || props.visibility === "hidden")
+		attr.visible = false;
+	return attr;
+}
+
+class PathBuilder {
+	paths: SvgPath[] = [];
+	pts: number[] = [];
+	x = 0;
+	y = 0;
+
+	moveTo(x: number, y: number) {
+		this.flush(false);
+		this.pts = [x, y];
+		this.x = x;
+		this.y = y;
+	}
+	lineTo(x: number, y: number) {
+		const dx = x - this.x;
+		const dy = y - this.y;
+		this.cubicTo(
+			this.x + dx / 3,
+			this.y + dy / 3,
+			x - dx / 3,
+			y - dy / 3,
+			x,
+			y,
+		);
+	}
+	cubicTo(
+		x1: number,
+		y1: number,
+		x2: number,
+		y2: number,
+		x: number,
+		y: number,
+	) {
+		if (this.pts.length === 0) this.pts = [this.x, this.y];
+		this.pts.push(x1, y1, x2, y2, x, y);
+		this.x = x;
+		this.y = y;
+	}
+	quadTo(cx: number, cy: number, x: number, y: number) {
+		this.cubicTo(
+			this.x + ((cx - this.x) * 2) / 3,
+			this.y + ((cy - this.y) * 2) / 3,
+			x + ((cx - x) * 2) / 3,
+			y + ((cy - y) * 2) / 3,
+			x,
+			y,
+		);
+	}
+	// endpoint arc to cubics, SVG 1.1 appendix F.6
+	arcTo(
+		rx: number,
+		ry: number,
+		rotation: number,
+		largeArc: boolean,
+		sweep: boolean,
+		x: number,
+		y: number,
+	) {
+		const x1 = this.x;
+		const y1 = this.y;
+		rx = Math.abs(rx);
+		ry = Math.abs(ry);
+		if (rx < 1e-6 || ry < 1e-6 || (x1 === x && y1 === y)) {
+			this.lineTo(x, y);
+			return;
+		}
+		const phi = (rotation * Math.PI) / 180;
+		const cs = Math.cos(phi);
+		const sn = Math.sin(phi);
+		const dx = (x1 - x) / 2;
+		const dy = (y1 - y) / 2;
+		const x1p = cs * dx + sn * dy;
+		const y1p = -sn * dx + cs * dy;
+		const lambda = (x1p * x1p) / (rx * rx) + (y1p * y1p) / (ry * ry);
+		if (lambda > 1) {
+			rx *= Math.sqrt(lambda);
+			ry *= Math.sqrt(lambda);
+		}
+		const num = rx * rx * ry * ry - rx * rx * y1p * y1p - ry * ry * x1p * x1p;
+		const den = rx * rx * y1p * y1p + ry * ry * x1p * x1p;
+		let f = Math.sqrt(Math.max(0, num / den));
+		if (largeArc === sweep) f = -f;
+		const cxp = (f * rx * y1p) / ry;
+		const cyp = (-f * ry * x1p) / rx;
+		const cx = cs * cxp - sn * cyp + (x1 + x) / 2;
+		const cy = sn * cxp + cs * cyp + (y1 + y) / 2;
+		const angle = (ux: number, uy: number, vx: number, vy: number) =>
+			Math.atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+		const a1 = angle(1, 0, (x1p - cxp) / rx, (y1p - cyp) / ry);
+		let da = angle(
+			(x1p - cxp) / rx,
+			(y1p - cyp) / ry,
+			(-x1p - cxp) / rx,
+			(-y1p - cyp) / ry,
+		);
+		if (!sweep && da > 0) da -= 2 * Math.PI;
+		else if (sweep && da < 0) da += 2 * Math.PI;
+
+		const segments = Math.max(1, Math.ceil(Math.abs(da) / (Math.PI / 2)));
+		const step = da / segments;
+		const k = (4 / 3) * Math.tan(step / 4);
+		const point = (a: number, r: number) => {
+			const ex = rx * Math.cos(a);
+			const ey = ry * Math.sin(a);
+			const tx = -rx * Math.sin(a) * r;
+			const ty = ry * Math.cos(a) * r;
+			return [ex, ey, tx, ty];
+		};
+		for (let i = 0; i < segments; i++) {
+			const s = point(a1 + i * step, k);
+			const e = point(a1 + (i + 1) * step, k);
+			const c1x = s[0] + s[2];
+			const c1y = s[1] + s[3];
+			const c2x = e[0] - e[2];
+			const c2y = e[1] - e[3];
+			this.cubicTo(
+				cx + cs * c1x - sn * c1y,
+				cy + sn * c1x + cs * c1y,
+				cx + cs * c2x - sn * c2y,
+				cy + sn * c2x + cs * c2y,
+				i === segments - 1 ? x : cx + cs * e[0] - sn * e[1],
+				i === segments - 1 ? y : cy + sn * e[0] + cs * e[1],
+			);
+		}
+	}
+	close() {
+		if (this.pts.length === 0) return;
+		const sx = this.pts[0];
+		const sy = this.pts[1];
+		// nanosvg always closes with an explicit segment back to the start
+		this.lineTo(sx, sy);
+		this.flush(true);
+		this.x = sx;
+		this.y = sy;
+	}
+	flush(closed: boolean) {
+		// a start point and at least one cubic
+		if (this.pts.length >= 8) this.paths.push({ pts: this.pts, closed });
+		this.pts = [];
+	}
+}
+
+function buildPathData(d: string, b: PathBuilder, file: string) {
+	const tokenRe =
+		/[MmLlHhVvCcSsQqTtAaZz]|[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?/g;
+	const tokens = d.match(tokenRe) ?? [];
+	let i = 0;
+	let cmd = "";
+	let lastCtrlX = 0;
+	let lastCtrlY = 0;
+	let lastCmd = "";
+	const num = () => {
+		if (i >= tokens.length || /[a-z]/i.test(tokens[i]))
+			throw new Error(`${file}: truncated path data`);
+		return Number(tokens[i++]);
+	};
+	while (i < tokens.length) {
+		if (/[a-z]/i.test(tokens[i])) cmd = tokens[i++];
+		else if (!cmd) throw new Error(`${file}: path data without a command`);
+		const rel = cmd === cmd.toLowerCase();
+		const ox = rel ? b.x : 0;
+		const oy = rel ? b.y : 0;
+		switch (cmd.toUpperCase()) {
+			case "M":
+				b.moveTo(ox + num(), oy + num());
+				// further coordinate pairs are implicit lineTos
+				cmd = rel ? "l" : "L";
+				break;
+			case "L":
+				b.lineTo(ox + num(), oy + num());
+				break;
+			case "H":
+				b.lineTo(ox + num(), b.y);
+				break;
+			case "V":
+				b.lineTo(b.x, oy + num());
+				break;
+			case "C": {
+				const x1 = ox + num();
+				const y1 = oy + num();
+				lastCtrlX = ox + num();
+				lastCtrlY = oy + num();
+				b.cubicTo(x1, y1, lastCtrlX, lastCtrlY, ox + num(), oy + num());
+				break;
+			}
+			case "S": {
+				const smooth = "CS".includes(lastCmd);
+				const x1 = smooth ? 2 * b.x - lastCtrlX : b.x;
+				const y1 = smooth ? 2 * b.y - lastCtrlY : b.y;
+				lastCtrlX = ox + num();
+				lastCtrlY = oy + num();
+				b.cubicTo(x1, y1, lastCtrlX, lastCtrlY, ox + num(), oy + num());
+				break;
+			}
+			case "Q":
+				lastCtrlX = ox + num();
+				lastCtrlY = oy + num();
+				b.quadTo(lastCtrlX, lastCtrlY, ox + num(), oy + num());
+				break;
+			case "T": {
+				const smooth = "QT".includes(lastCmd);
+				lastCtrlX = smooth ? 2 * b.x - lastCtrlX : b.x;
+				lastCtrlY = smooth ? 2 * b.y - lastCtrlY : b.y;
+				b.quadTo(lastCtrlX, lastCtrlY, ox + num(), oy + num());
+				break;
+			}
+			case "A": {
+				const rx = num();
+				const ry = num();
+				const rotation = num();
+				const largeArc = num() !== 0;
+				const sweep = num() !== 0;
+				b.arcTo(rx, ry, rotation, largeArc, sweep, ox + num(), oy + num());
+				break;
+			}
+			case "Z":
+				b.close();
+				break;
+			default:
+				throw new Error(`${file}: unsupported path command ${cmd}`);
+		}
+		lastCmd = cmd.toUpperCase();
+		if (lastCmd === "Z" && i < tokens.length && !/[a-z]/i.test(tokens[i]))
+			throw new Error(`${file}: coordinates after Z`);
+	}
+	b.flush(false);
+}
+
+function buildShapeGeometry(node: XmlNode, file: string): SvgPath[] {
+	const b = new PathBuilder();
+	const a = node.attrs;
+	const len = (name: string) => parseLength(a[name], 0);
+	switch (node.tag) {
+		case "path":
+			buildPathData(a.d ?? "", b, file);
+			break;
+		case "rect": {
+			const x = len("x");
+			const y = len("y");
+			const w = len("width");
+			const h = len("height");
+			let rx = a.rx !== undefined ? len("rx") : len("ry");
+			let ry = a.ry !== undefined ? len("ry") : rx;
+			rx = Math.min(rx, w / 2);
+			ry = Math.min(ry, h / 2);
+			if (w <= 0 || h <= 0) break;
+			if (rx <= 0 || ry <= 0) {
+				b.moveTo(x, y);
+				b.lineTo(x + w, y);
+				b.lineTo(x + w, y + h);
+				b.lineTo(x, y + h);
+			} else {
+				const kx = rx * (1 - SVG_KAPPA);
+				const ky = ry * (1 - SVG_KAPPA);
+				b.moveTo(x + rx, y);
+				b.lineTo(x + w - rx, y);
+				b.cubicTo(x + w - kx, y, x + w, y + ky, x + w, y + ry);
+				b.lineTo(x + w, y + h - ry);
+				b.cubicTo(x + w, y + h - ky, x + w - kx, y + h, x + w - rx, y + h);
+				b.lineTo(x + rx, y + h);
+				b.cubicTo(x + kx, y + h, x, y + h - ky, x, y + h - ry);
+				b.lineTo(x, y + ry);
+				b.cubicTo(x, y + ky, x + kx, y, x + rx, y);
+			}
+			b.close();
+			break;
+		}
+		case "circle":
+		case "ellipse": {
+			const cx = len("cx");
+			const cy = len("cy");
+			const rx = node.tag === "circle" ? len("r") : len("rx");
+			const ry = node.tag === "circle" ? rx : len("ry");
+			if (rx <= 0 || ry <= 0) break;
+			const kx = rx * SVG_KAPPA;
+			const ky = ry * SVG_KAPPA;
+			b.moveTo(cx + rx, cy);
+			b.cubicTo(cx + rx, cy + ky, cx + kx, cy + ry, cx, cy + ry);
+			b.cubicTo(cx - kx, cy + ry, cx - rx, cy + ky, cx - rx, cy);
+			b.cubicTo(cx - rx, cy - ky, cx - kx, cy - ry, cx, cy - ry);
+			b.cubicTo(cx + kx, cy - ry, cx + rx, cy - ky, cx + rx, cy);
+			b.close();
+			break;
+		}
+		case "line":
+			b.moveTo(len("x1"), len("y1"));
+			b.lineTo(len("x2"), len("y2"));
+			b.flush(false);
+			break;
+		case "polyline":
+		case "polygon": {
+			const v = parseNumbers(a.points ?? "");
+			for (let j = 0; j + 1 < v.length; j += 2) {
+				if (j === 0) b.moveTo(v[0], v[1]);
+				else b.lineTo(v[j], v[j + 1]);
+			}
+			if (node.tag === "polygon") b.close();
+			else b.flush(false);
+			break;
+		}
+	}
+	return b.paths;
+}
+
+function packPaint(rgb: number | null, opacity: number): number | null {
+	if (rgb === null) return null;
+	const alpha = Math.round(Math.min(1, Math.max(0, opacity)) * 255);
+	return (rgb | (alpha << 24)) >>> 0;
+}
+
+const SVG_SHAPE_TAGS = new Set([
+	"path",
+	"rect",
+	"circle",
+	"ellipse",
+	"line",
+	"polyline",
+	"polygon",
+]);
+const SVG_SKIPPED_TAGS = new Set(["title", "desc", "metadata", "defs"]);
+
+function compileSvg(absPath: string): CompiledSvg {
+	const file = path.basename(absPath);
+	const svg = parseXml(readFileSync(absPath, "utf8"), file);
+	const shapes: SvgShape[] = [];
+
+	const visit = (node: XmlNode, parent: SvgAttr) => {
+		if (SVG_SKIPPED_TAGS.has(node.tag)) return;
+		const attr = applyAttrs(parent, node, file);
+		if (SVG_SHAPE_TAGS.has(node.tag)) {
+			const paths = buildShapeGeometry(node, file);
+			if (paths.length === 0) return;
+			for (const p of paths) {
+				for (let j = 0; j < p.pts.length; j += 2) {
+					[p.pts[j], p.pts[j + 1]] = xformPoint(
+						attr.xform,
+						p.pts[j],
+						p.pts[j + 1],
+					);
+				}
+			}
+			shapes.push({
+				fill: packPaint(attr.fill, attr.fillOpacity),
+				stroke: packPaint(attr.stroke, attr.strokeOpacity),
+				opacity: attr.opacity,
+				strokeWidth: attr.strokeWidth * xformAverageScale(attr.xform),
+				fillRule: attr.fillRule,
+				lineJoin: attr.lineJoin,
+				lineCap: attr.lineCap,
+				miterLimit: attr.miterLimit,
+				visible: attr.visible,
+				paths,
+			});
+			return;
+		}
+		if (node.tag !== "g" && node.tag !== "svg") {
+			console.warn(`${file}: ignoring <${node.tag}>`);
+			return;
+		}
+		for (const child of node.children) visit(child, attr);
+	};
+
+	const root: SvgAttr = {
+		xform: [1, 0, 0, 1, 0, 0],
+		fill: 0x000000,
+		stroke: null,
+		opacity: 1,
+		fillOpacity: 1,
+		strokeOpacity: 1,
+		strokeWidth: 1,
+		fillRule: 0,
+		lineJoin: 0,
+		lineCap: 0,
+		miterLimit: 4,
+		visible: true,
+	};
+	visit(svg, root);
+
+	let width = parseLength(svg.attrs.width, 0);
+	let height = parseLength(svg.attrs.height, 0);
+	const viewBox = parseNumbers(svg.attrs.viewBox ?? "");
+	if (viewBox.length === 4 && viewBox[2] > 0 && viewBox[3] > 0) {
+		// scale to the viewport like preserveAspectRatio="xMidYMid meet"
+		const [vx, vy, vw, vh] = viewBox;
+		if (width <= 0) width = vw;
+		if (height <= 0) height = vh;
+		let sx = width / vw;
+		let sy = height / vh;
+		let tx = -vx * sx;
+		let ty = -vy * sy;
+		if ((svg.attrs.preserveAspectRatio ?? "").trim() !== "none") {
+			const s = Math.min(sx, sy);
+			tx = -vx * s + (width - vw * s) / 2;
+			ty = -vy * s + (height - vh * s) / 2;
+			sx = sy = s;
+		}
+		for (const shape of shapes) {
+			shape.strokeWidth *= (sx + sy) / 2;
+			for (const p of shape.paths) {
+				for (let j = 0; j < p.pts.length; j += 2) {
+					p.pts[j] = p.pts[j] * sx + tx;
+					p.pts[j + 1] = p.pts[j + 1] * sy + ty;
+				}
+			}
+		}
+	}
+	if (width <= 0 || height <= 0)
+		throw new Error(`${file}: needs a width and height or a viewBox`);
+	return { width, height, shapes };
+}
+
+function formatFloat(v: number): string {
+	let s = String(Number(v.toPrecision(7)));
+	if (s === "-0") s = "0";
+	if (!/[.e]/.test(s)) s += ".0";
+	return `${s}f`;
+}
+function formatPaint(color: number | null): string {
+	return color === null ? "0" : formatHexColor(color);
+}
+
+function genCompiledSvg(sym: string, svg: CompiledSvg): string[] {
+	const out: string[] = [];
+	const pts: number[] = [];
+	const paths: string[] = [];
+	const shapes: string[] = [];
+	for (const shape of svg.shapes) {
+		const firstPath = paths.length;
+		for (const p of shape.paths) {
+			paths.push(`{ ${pts.length / 2}, ${p.pts.length / 2}, ${p.closed} }`);
+			pts.push(...p.pts);
+		}
+		const fields = [
+			`.fill = ${formatPaint(shape.fill)}`,
+			`.stroke = ${formatPaint(shape.stroke)}`,
+			`.has_fill = ${shape.fill !== null}`,
+			`.has_stroke = ${shape.stroke !== null}`,
+			`.opacity = ${formatFloat(shape.opacity)}`,
+			`.stroke_width = ${formatFloat(shape.strokeWidth)}`,
+			`.miter_limit = ${formatFloat(shape.miterLimit)}`,
+			`.fill_rule = ${shape.fillRule}`,
+			`.line_join = ${shape.lineJoin}`,
+			`.line_cap = ${shape.lineCap}`,
+			`.visible = ${shape.visible}`,
+			`.first_path = ${firstPath}`,
+			`.npaths = ${shape.paths.length}`,
+		];
+		shapes.push(`{ ${fields.join(", ")} }`);
+	}
+
+	out.push(`static const float ${sym}_pts[] = {`);
+	for (let i = 0; i < pts.length; i += 8)
+		out.push(`    ${pts.slice(i, i + 8).map(formatFloat).join(", ")},`);
+	out.push("};");
+	out.push(`static const svg_compiled_path_t ${sym}_paths[] = {`);
+	for (const p of paths) out.push(`    ${p},`);
+	out.push("};");
+	out.push(`static const svg_compiled_shape_t ${sym}_shapes[] = {`);
+	for (const s of shapes) out.push(`    ${s},`);
+	out.push("};");
+	const size = `${formatFloat(svg.width)}, ${formatFloat(svg.height)}`;
+	out.push(
+		`static const svg_compiled_t ${sym} = { ${size}, ${sym}_shapes, ` +
+			`${shapes.length}, ${sym}_paths, ${sym}_pts };`,
+	);
+	return out;
+}
+
+/* ===== Image textures =====
+ * Images are decoded here rather than at startup. Each one lands on a
+ * texture: images naming the same texture are shelf-packed into it with a
+ * one-pixel extruded gutter and reached through their ResourceUV, the rest
+ * get a texture of their own. "rgba8" textures are embedded as raw pixels,
+ * optionally premultiplied and followed by their mip levels, and upload as
+ * they are; "qoi" ones decode in one linear pass; "png" embeds the file for
+ * stb_image like before. */
+
+type Texture = {
+	name: string;
+	format: ImageFormat;
+	premultiply: boolean;
+	mips: boolean;
+	images: ImageEntry[];
+	width: number;
+	height: number;
+	levels: number;
+	rects: Map<string, [number, number, number, number]>;
+	data: Uint8Array; // what gets embedded; the file itself for "png"
+	embedRelToOut: string;
+};
+
+type Pixels = { width: number; height: number; rgba: Uint8Array };
+
+function decodePng(file: string): Pixels {
+	const buf = readFileSync(file);
+	const sig = [0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a];
+	if (!sig.every((b, i) => buf[i] === b)) throw new Error(`${file}: not a PNG`);
+	let width = 0;
+	let height = 0;
+	let colorType = 0;
+	let palette: Uint8Array = new Uint8Array(0);
+	let trns: Uint8Array = new Uint8Array(0);
+	const idat: Buffer[] = [];
+	for (let pos = 8; pos + 8 <= buf.length; ) {
+		const len = buf.readUInt32BE(pos);
+		const type = buf.toString("latin1", pos + 4, pos + 8);
+		const body = buf.subarray(pos + 8, pos + 8 + len);
+		pos += 12 + len;
+		if (type === "IHDR") {
+			width = body.readUInt32BE(0);
+			height = body.readUInt32BE(4);
+			colorType = body[9];
+			if (body[8] !== 8 || body[12] !== 0) {
+				throw new Error(
+					`${file}: only 8-bit non-interlaced PNGs convert; use "format": "png"`,
+				);
+			}
+		} else if (type === "PLTE") palette = body;
+		else if (type === "tRNS") trns = body;
+		else if (type === "IDAT") idat.push(body);
+		else if (type === "IEND") break;
+	}
+	const channels = [1, 0, 3, 1, 2, 0, 4][colorType] ?? 0;
+	if (!channels) throw new Error(`${file}: bad PNG color type ${colorType}`);
+
+	const raw = inflateSync(Buffer.concat(idat));
+	const stride = width * channels;
+	const rows = new Uint8Array(stride * height);
+	for (let y = 0; y < height; y++) {
+		const filter = raw[y * (stride + 1)];
+		const src = y * (stride + 1) + 1;
+		const dst = y * stride;
+		for (let x = 0; x < stride; x++) {
+			const a = x >= channels ? rows[dst + x - channels] : 0;
+			const b = y > 0 ? rows[dst - stride + x] : 0;
+			const c = x >= channels && y > 0 ? rows[dst - stride + x - channels] : 0;
+			let pred = 0;
+			if (filter === 1) pred = a;
+			else if (filter === 2) pred = b;
+			else if (filter === 3) pred = (a + b) >> 1;
+			else if (filter === 4) {
+				const p = a + b - c;
+				const pa = Math.abs(p - a);
+				const pb = Math.abs(p - b);
+				const pc = Math.abs(p - c);
+				pred = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+			} else if (filter !== 0) {
+				throw new Error(`${file}: bad PNG filter ${filter}`);
+			}
+			rows[dst + x] = (raw[src + x] + pred) & 0xff;
+		}
+	}
+
+	const rgba = new Uint8Array(width * height * 4);
+	for (let i = 0; i < width * height; i++) {
+		const s = i * channels;
+		let r = 0;
+		let g = 0;
+		let b = 0;
+		let a = 255;
+		if (colorType === 0 || colorType === 4) {
+			r = g = b = rows[s];
+			if (colorType === 4) a = rows[s + 1];
+			else if (trns.length >= 2 && rows[s] === trns[1]) a = 0;
+		} else if (colorType === 3) {
+			const p = rows[s];
+			r = palette[p * 3];
+			g = palette[p * 3 + 1];
+			b = palette[p * 3 + 2];
+			if (p < trns.length) a = trns[p];
+		} else {
+			r = rows[s];
+			g = rows[s + 1];
+			b = rows[s + 2];
+			if (colorType === 6) a = rows[s + 3];
+			else if (
+				trns.length >= 6 &&
+				r === trns[1] &&
+				g === trns[3] &&
+				b === trns[5]
+			) {
+				a = 0;
+			}
+		}
+		rgba.set([r, g, b, a], i * 4);
+	}
+	return { width, height, rgba };
+}
+
+function premultiply(rgba: Uint8Array) {
+	for (let i = 0; i < rgba.length; i += 4) {
+		const a = rgba[i + 3];
+		for (let c = 0; c < 3; c++) {
+			rgba[i + c] = Math.round((rgba[i + c] * a) / 255);
+		}
+	}
+}
+
+// 2x2 box filter. Straight alpha weighs color by coverage, so transparent
+// texels don't bleed their (meaningless) color into the edges.
+function halve(src: Pixels, premultiplied: boolean): Pixels {
+	const width = Math.max(1, src.width >> 1);
+	const height = Math.max(1, src.height >> 1);
+	const rgba = new Uint8Array(width * height * 4);
+	for (let y = 0; y < height; y++) {
+		for (let x = 0; x < width; x++) {
+			const sum = [0, 0, 0, 0];
+			const plain = [0, 0, 0];
+			for (const [dx, dy] of [
+				[0, 0],
+				[1, 0],
+				[0, 1],
+				[1, 1],
+			]) {
+				const sx = Math.min(x * 2 + dx, src.width - 1);
+				const sy = Math.min(y * 2 + dy, src.height - 1);
+				const s = (sy * src.width + sx) * 4;
+				const a = premultiplied ? 255 : src.rgba[s + 3];
+				for (let c = 0; c < 3; c++) {
+					sum[c] += src.rgba[s + c] * a;
+					plain[c] += src.rgba[s + c];
+				}
+				sum[3] += src.rgba[s + 3];
+			}
+			const weight = premultiplied ? 4 * 255 : sum[3];
+			const d = (y * width + x) * 4;
+			for (let c = 0; c < 3; c++) {
+				rgba[d + c] = Math.round(
+					weight > 0 ? sum[c] / weight : plain[c] / 4,
+				);
+			}
+			rgba[d + 3] = Math.round(sum[3] / 4);
+		}
+	}
+	return { width, height, rgba };
+}
+
+// https://qoiformat.org/qoi-specification.pdf
+function encodeQoi(img: Pixels): Uint8Array {
+	const out: number[] = [0x71, 0x6f, 0x69, 0x66];
+	const u32 = (v: number) =>
+		out.push((v >>> 24) & 0xff, (v >>> 16) & 0xff, (v >>> 8) & 0xff, v & 0xff);
+	u32(img.width);
+	u32(img.height);
+	out.push(4, 0);
+
+	const index = new Uint32Array(64);
+	let prev = 0x000000ff; // rgba packed big-endian
+	let run = 0;
+	const px = img.rgba;
+	for (let i = 0; i < px.length; i += 4) {
+		const r = px[i];
+		const g = px[i + 1];
+		const b = px[i + 2];
+		const a = px[i + 3];
+		const cur = ((r << 24) | (g << 16) | (b << 8) | a) >>> 0;
+		if (cur === prev) {
+			run++;
+			if (run === 62 || i + 4 === px.length) {
+				out.push(0xc0 | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0) {
+			out.push(0xc0 | (run - 1));
+			run = 0;
+		}
+		const slot = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+		if (index[slot] === cur) {
+			out.push(slot);
+		} else {
+			index[slot] = cur;
+			const pa = prev & 0xff;
+			if (a !== pa) {
+				out.push(0xff, r, g, b, a);
+			} else {
+				const vr = ((r - (prev >>> 24) + 384) & 0xff) - 128;
+				const vg = ((g - ((prev >>> 16) & 0xff) + 384) & 0xff) - 128;
+				const vb = ((b - ((prev >>> 8) & 0xff) + 384) & 0xff) - 128;
+				const vgr = vr - vg;
+				const vgb = vb - vg;
+				if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+					out.push(0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+				} else if (
+					vgr > -9 &&
+					vgr < 8 &&
+					vg > -33 &&
+					vg < 32 &&
+					vgb > -9 &&
+					vgb < 8
+				) {
+					out.push(0x80 | (vg + 32), ((vgr + 8) << 4) | (vgb + 8));
+				} else {
+					out.push(0xfe, r, g, b);
+				}
+			}
+		}
+		prev = cur;
+	}
+	out.push(0, 0, 0, 0, 0, 0, 0, 1);
+	return Uint8Array.from(out);
+}
+
+// Tallest first onto shelves no wider than the widest image or a square's
+// worth of the total area, whichever is wider.
+function packTexture(parts: { id: string; img: Pixels }[]) {
+	const pad = parts.length > 1 ? 1 : 0;
+	let area = 0;
+	let widest = 0;
+	for (const { img } of parts) {
+		area += (img.width + 2 * pad) * (img.height + 2 * pad);
+		widest = Math.max(widest, img.width + 2 * pad);
+	}
+	const width =
+		parts.length > 1 ? Math.max(widest, Math.ceil(Math.sqrt(area))) : widest;
+	const order = [...parts].sort((a, b) => b.img.height - a.img.height);
+	const rects = new Map<string, [number, number, number, number]>();
+	let x = 0;
+	let y = 0;
+	let shelf = 0;
+	for (const { id, img } of order) {
+		if (x + img.width + 2 * pad > width) {
+			x = 0;
+			y += shelf;
+			shelf = 0;
+		}
+		rects.set(id, [x + pad, y + pad, img.width, img.height]);
+		x += img.width + 2 * pad;
+		shelf = Math.max(shelf, img.height + 2 * pad);
+	}
+	const height = y + shelf;
+
+	const rgba = new Uint8Array(width * height * 4);
+	for (const { id, img } of parts) {
+		const [rx, ry, w, h] = rects.get(id)!;
+		for (let dy = -pad; dy < h + pad; dy++) {
+			const sy = Math.min(Math.max(dy, 0), h - 1);
+			for (let dx = -pad; dx < w + pad; dx++) {
+				const sx = Math.min(Math.max(dx, 0), w - 1);
+				const s = (sy * w + sx) * 4;
+				rgba.set(
+					img.rgba.subarray(s, s + 4),
+					((ry + dy) * width + rx + dx) * 4,
+				);
+			}
+		}
+	}
+	return { img: { width, height, rgba }, rects };
+}
+
+function textureSymFromName(name: string): string {
+	return name.replace(/[^a-z0-9]+/gi, "_").replace(/^_+|_+$/g, "");
+}
+
+function writeBlob(name: string, data: Uint8Array): string {
+	const dir = path.join(outDir, "resource_blobs");
+	const file = path.join(dir, name);
+	mkdirSync(dir, { recursive: true });
+	// unchanged blobs keep their mtime, so the build doesn't redo the embed
+	if (!existsSync(file) || !readFileSync(file).equals(Buffer.from(data))) {
+		writeFileSync(file, data);
+	}
+	return posixRel(outDir, file);
+}
+
+function buildTextures(): Texture[] {
+	const byName = new Map<string, Texture>();
+	for (const i of images) {
+		const { abs } = resolveForEmbed(i.path);
+		const name = textureSymFromName(
+			i.texture ?? i.id.replace(/^RES_IMG_/, ""),
+		).toLowerCase();
+		const format = i.format ?? "png";
+		let tex = byName.get(name);
+		if (!tex) {
+			tex = {
+				name,
+				format,
+				premultiply: i.premultiply ?? false,
+				mips: i.mips ?? false,
+				images: [],
+				width: 0,
+				height: 0,
+				levels: 1,
+				rects: new Map(),
+				data: new Uint8Array(0),
+				embedRelToOut: "",
+			};
+			byName.set(name, tex);
+		} else if (
+			tex.format !== format ||
+			tex.premultiply !== (i.premultiply ?? false) ||
+			tex.mips !== (i.mips ?? false)
+		) {
+			throw new Error(`${i.id}: differs in format from texture ${name}`);
+		}
+		if (format === "png" && tex.images.length > 0) {
+			throw new Error(`${i.id}: "png" images can't share a texture`);
+		}
+		if (format !== "rgba8" && tex.mips) {
+			throw new Error(`${i.id}: mip levels are only embedded for "rgba8"`);
+		}
+		if (format === "png" && tex.premultiply) {
+			throw new Error(`${i.id}: "png" images are embedded as they are`);
+		}
+		tex.images.push(i);
+		if (format === "png") {
+			const png = readFileSync(abs);
+			tex.data = png;
+			tex.width = png.readUInt32BE(16);
+			tex.height = png.readUInt32BE(20);
+			tex.embedRelToOut = resolveForEmbed(i.path).embedRelToOut;
+		}
+	}
+
+	for (const tex of byName.values()) {
+		if (tex.format === "png") continue;
+		const { img, rects } = packTexture(
+			tex.images.map((i) => ({
+				id: i.id,
+				img: decodePng(resolveForEmbed(i.path).abs),
+			})),
+		);
+		if (tex.premultiply) premultiply(img.rgba);
+		tex.width = img.width;
+		tex.height = img.height;
+		tex.rects = rects;
+		if (tex.format === "qoi") {
+			tex.embedRelToOut = writeBlob(`${tex.name}.qoi`, encodeQoi(img));
+			continue;
+		}
+		const levels = [img.rgba];
+		for (let level = img; tex.mips && (level.width > 1 || level.height > 1); ) {
+			level = halve(level, tex.premultiply);
+			levels.push(level.rgba);
+		}
+		tex.levels = levels.length;
+		const data = new Uint8Array(levels.reduce((n, l) => n + l.length, 0));
+		let at = 0;
+		for (const l of levels) {
+			data.set(l, at);
+			at += l.length;
+		}
+		tex.embedRelToOut = writeBlob(`${tex.name}.rgba`, data);
+	}
+	return [...byName.values()];
+}
+
+function textureIdFromName(name: string): string {
+	return `RES_TEXTURE_${name.toUpperCase()}`;
+}
+
+// The image's place on its texture, with its own uv (if any) taken as
+// relative to that place.
+function imageUV(tex: Texture, i: ImageEntry): number[] | null {
+	const own = Array.isArray(i.uv) && i.uv.length === 4 ? i.uv : null;
+	if (tex.images.length === 1) return own;
+	const [x, y, w, h] = tex.rects.get(i.id)!;
+	const [u0, v0, u1, v1] = own ?? [0, 0, 1, 1];
+	const round = (v: number) => Number(v.toPrecision(7));
+	return [
+		round((x + u0 * w) / tex.width),
+		round((y + v0 * h) / tex.height),
+		round((x + u1 * w) / tex.width),
+		round((y + v1 * h) / tex.height),
+	];
+}
+
+/* ===== Glyph bake spec =====
+ * Which font, size and codepoint combinations andex_glyph_bake rasterizes
+ * at build time. Emitted as X-macros, so only the tool that expands them
+ * pays for the tables. */
+
+function genGlyphBakeSpec(): string[] {
+	const fontIds = new Set(fonts.map((f) => f.id));
+	const scales = glyphs.scales ?? [1];
+	const ranges = glyphs.ranges ?? [];
+	const faces: [string, number][] = [];
+	for (const set of glyphs.faces ?? []) {
+		for (const font of set.fonts) {
+			if (!fontIds.has(font)) {
+				throw new Error(`glyphs: unknown font ${font}`);
+			}
+			for (const size of set.sizes) {
+				if (!(size > 0)) {
+					throw new Error(`glyphs: bad size ${size} for ${font}`);
+				}
+				faces.push([font, size]);
+			}
+		}
+	}
+	for (const scale of scales) {
+		if (!(scale > 0)) throw new Error(`glyphs: bad scale ${scale}`);
+	}
+	for (const [first, last] of ranges) {
+		if (!(first >= 0 && first <= last && last <= 0x10ffff)) {
+			throw new Error(`glyphs: bad range ${first}-${last}`);
+		}
+	}
+
+	const out: string[] = [
+		"/* ===== Glyph bake spec (expanded by tools/glyph_bake.c) ===== */",
+	];
+	if (faces.length === 0 || ranges.length === 0) {
+		out.push(
+			"#define RES_GLYPH_BAKE_SCALES(X) /* no baked glyphs */",
+			"#define RES_GLYPH_BAKE_RANGES(X) /* no baked glyphs */",
+			"#define RES_GLYPH_BAKE_FACES(X)  /* no baked glyphs */",
+			"",
+		);
+		return out;
+	}
+	const list = (name: string, items: string[]) => {
+		out.push(`#define ${name}(X) \\`);
+		items.forEach((item, i) =>
+			out.push(`    X(${item})${i + 1 < items.length ? " \\" : ""}`),
+		);
+	};
+	list(
+		"RES_GLYPH_BAKE_SCALES",
+		scales.map((s) => `${s}`),
+	);
+	list(
+		"RES_GLYPH_BAKE_RANGES",
+		ranges.map(([first, last]) => `${first}, ${last}`),
+	);
+	list(
+		"RES_GLYPH_BAKE_FACES",
+		faces.map(([font, size]) => `${font}, ${size}`),
+	);
+	out.push("");
+	return out;
+}
+
 function genHeader(): string {
 	const out: string[] = [];
+	const textures = buildTextures();
+	const textureOf = new Map<string, Texture>();
+	for (const t of textures) for (const i of t.images) textureOf.set(i.id, t);
 
 	out.push(
 		"/* Auto-generated by generate-resources.ts — do not edit by hand. */",
@@ -60,6 +1262,8 @@ function genHeader(): string {
 		"#include <stddef.h> /* size_t */",
 		"#include <stdint.h> /* uint32_t */",
 		"",
+		'#include "svg.h" /* svg_compiled_t */',
+		"",
 		"/* ===== Resource kinds (tag) ===== */",
 		"typedef enum {",
 		"    RES_KIND_IMAGE = 1,",
@@ -72,6 +1276,24 @@ function genHeader(): string {
 		"    float u0, v0, u1, v1;",
 		"} ResourceUV;",
 		"",
+		"/* How a texture's pixels are embedded */",
+		"typedef enum {",
+		"    RES_IMAGE_PNG   = 0, /* the file itself, decoded by stb_image */",
+		"    RES_IMAGE_RGBA8 = 1, /* raw pixels, mip levels back to back */",
+		"    RES_IMAGE_QOI   = 2, /* QOI stream of RGBA8 pixels */",
+		"} ResourceImageFormat;",
+		"",
+		"/* One GPU texture; images on it are told apart by their ResourceUV */",
+		"typedef struct ResourceTexture {",
+		"    const unsigned char *data;",
+		"    size_t size;",
+		"    const char *name;",
+		"    ResourceImageFormat format;",
+		"    int width, height;",
+		"    int mips;          /* levels in data, 1 without mipmaps */",
+		"    int premultiplied; /* color already multiplied by alpha */",
+		"} ResourceTexture;",
+		"",
 		"/* Tagged union for all embedded resources */",
 		"typedef struct EmbeddedBlob {",
 		"    const unsigned char *data;",
@@ -81,6 +1303,7 @@ function genHeader(): string {
 		"    union {",
 		"        struct {",
 		"            const ResourceUV *uv; /* NULL if not provided */",
+		"            int texture;          /* ResourceTextureId */",
 		"        } image;",
 		"        struct {",
 		"            int _unused; /* room for future font-specific metadata */",
@@ -88,6 +1311,7 @@ function genHeader(): string {
 		"        struct {",
 		"            uint32_t fill;   /* RGBA color in 0xRRGGBBAA format */",
 		"            uint32_t stroke; /* RGBA color in 0xRRGGBBAA format */",
+		"            const svg_compiled_t *svg; /* compiled by gen.ts */",
 		"        } icon;",
 		"    } as;",
 		"} EmbeddedBlob;",
@@ -102,6 +1326,13 @@ function genHeader(): string {
 		for (const i of images) out.push(`    ${i.id},`);
 		out.push("    RES_IMG_COUNT", "} ResourceImageId;", "");
 	}
+	if (textures.length === 0) {
+		out.push("typedef enum { RES_TEXTURE_COUNT = 0 } ResourceTextureId;", "");
+	} else {
+		out.push("typedef enum {");
+		for (const t of textures) out.push(`    ${textureIdFromName(t.name)},`);
+		out.push("    RES_TEXTURE_COUNT", "} ResourceTextureId;", "");
+	}
 	if (fonts.length === 0) {
 		out.push("typedef enum { RES_FONT_COUNT = 0 } ResourceFontId;", "");
 	} else {
@@ -137,6 +1368,13 @@ function genHeader(): string {
 	} else {
 		out.push(`#define RES_FOR_EACH_IMAGE(idvar) /* no images */`);
 	}
+	if (textures.length > 0) {
+		out.push(
+			`#define RES_FOR_EACH_TEXTURE(idvar) \\\n    for (int idvar = 0; idvar < RES_TEXTURE_COUNT; ++idvar)`,
+		);
+	} else {
+		out.push(`#define RES_FOR_EACH_TEXTURE(idvar) /* no textures */`);
+	}
 	if (fonts.length > 0) {
 		out.push(
 			`#define RES_FOR_EACH_FONT(idvar)  \\\n    for (int idvar = 0; idvar < RES_FONT_COUNT; ++idvar)`,
@@ -153,24 +1391,24 @@ function genHeader(): string {
 	}
 	out.push("");
 
-	if (images.some((i) => Array.isArray(i.uv) && i.uv.length === 4)) {
-		for (const i of images) {
-			if (Array.isArray(i.uv) && i.uv.length === 4) {
-				const [u0, v0, u1, v1] = i.uv;
+	const uvs = images.map((i) => imageUV(textureOf.get(i.id)!, i));
+	if (uvs.some((uv) => uv)) {
+		images.forEach((i, n) => {
+			if (uvs[n]) {
+				const [u0, v0, u1, v1] = uvs[n]!;
 				out.push(
 					`static const ResourceUV ${uvSymFromId(i.id)} = { ${u0}, ${v0}, ${u1}, ${v1} };`,
 				);
 			}
-		}
+		});
 		out.push("");
 	}
 
-	for (const i of images) {
-		const { embedRelToOut } = resolveForEmbed(i.path);
-		const sym = blobSymFromPath(embedRelToOut);
+	for (const t of textures) {
+		const sym = blobSymFromPath(t.embedRelToOut);
 		out.push(
 			`static const unsigned char ${sym}[] = {`,
-			`    #embed "${embedRelToOut}"`,
+			`    #embed "${t.embedRelToOut}"`,
 			"};",
 		);
 	}
@@ -184,30 +1422,39 @@ function genHeader(): string {
 		);
 	}
 	for (const i of icons) {
-		const { embedRelToOut } = resolveForEmbed(i.path);
+		const { abs, embedRelToOut } = resolveForEmbed(i.path);
 		const sym = blobSymFromPath(embedRelToOut);
+		out.push(...genCompiledSvg(sym, compileSvg(abs)));
+	}
+	out.push("");
+
+	const formats = { png: "PNG", rgba8: "RGBA8", qoi: "QOI" };
+	if (textures.length > 0) {
 		out.push(
-			`static const unsigned char ${sym}[] = {`,
-			`    #embed "${embedRelToOut}"`,
-			`    , 0 /* null terminator for SVG strings */`,
-			"};",
+			"static const ResourceTexture g_resource_textures[RES_TEXTURE_COUNT] = {",
 		);
+		for (const t of textures) {
+			const sym = blobSymFromPath(t.embedRelToOut);
+			out.push(
+				`    [${textureIdFromName(t.name)}] = { ${sym}, sizeof(${sym}), "${t.name}", RES_IMAGE_${formats[t.format]}, ${t.width}, ${t.height}, ${t.levels}, ${t.premultiply ? 1 : 0} },`,
+			);
+		}
+		out.push("};", "");
 	}
-	out.push("");
 
 	out.push("static const EmbeddedBlob g_embedded_resources[RES_COUNT] = {");
 
-	for (const i of images) {
-		const { embedRelToOut, baseName } = resolveForEmbed(i.path);
-		const sym = blobSymFromPath(embedRelToOut);
-		const uvPtr =
-			Array.isArray(i.uv) && i.uv.length === 4
-				? `&${uvSymFromId(i.id)}`
-				: "NULL";
+	images.forEach((i, n) => {
+		// named after the data embedded for it, which is only the source file
+		// for "png" textures
+		const t = textureOf.get(i.id)!;
+		const baseName = path.basename(t.embedRelToOut);
+		const sym = blobSymFromPath(t.embedRelToOut);
+		const uvPtr = uvs[n] ? `&${uvSymFromId(i.id)}` : "NULL";
 		out.push(
-			`    [RES_INDEX_IMAGE(${i.id})] = { ${sym}, sizeof(${sym}), "${baseName}", RES_KIND_IMAGE, { .image = { ${uvPtr} } } },`,
+			`    [RES_INDEX_IMAGE(${i.id})] = { ${sym}, sizeof(${sym}), "${baseName}", RES_KIND_IMAGE, { .image = { ${uvPtr}, ${textureIdFromName(t.name)} } } },`,
 		);
-	}
+	});
 
 	for (const f of fonts) {
 		const { embedRelToOut, baseName } = resolveForEmbed(f.path);
@@ -223,7 +1470,7 @@ function genHeader(): string {
 		const fill = formatHexColor(i.fill);
 		const stroke = formatHexColor(i.stroke);
 		out.push(
-			`    [RES_INDEX_ICON(${i.id})] = { ${sym}, sizeof(${sym}), "${baseName}", RES_KIND_ICON,  { .icon  = { ${fill}, ${stroke} } } },`,
+			`    [RES_INDEX_ICON(${i.id})] = { NULL, 0, "${baseName}", RES_KIND_ICON,  { .icon  = { ${fill}, ${stroke}, &${sym} } } },`,
 		);
 	}
 	out.push("};", "");
@@ -249,16 +1496,17 @@ function genHeader(): string {
 		"#define RES_GET_IMAGE_UV(id)     (g_embedded_resources[RES_INDEX_IMAGE(id)].as.image.uv)",
 	);
 	out.push(
-		"#define RES_GET_FONT_DATA(id)    (g_embedded_resources[RES_INDEX_FONT(id)].data)",
+		"#define RES_GET_IMAGE_TEXTURE(id) (g_embedded_resources[RES_INDEX_IMAGE(id)].as.image.texture)",
 	);
+	out.push("#define RES_GET_TEXTURE(id)      (&g_resource_textures[id])");
 	out.push(
-		"#define RES_GET_FONT_SIZE(id)    (g_embedded_resources[RES_INDEX_FONT(id)].size)",
+		"#define RES_GET_FONT_DATA(id)    (g_embedded_resources[RES_INDEX_FONT(id)].data)",
 	);
 	out.push(
-		"#define RES_GET_ICON_DATA(id)    (g_embedded_resources[RES_INDEX_ICON(id)].data)",
+		"#define RES_GET_FONT_SIZE(id)    (g_embedded_resources[RES_INDEX_FONT(id)].size)",
 	);
 	out.push(
-		"#define RES_GET_ICON_SIZE(id)    (g_embedded_resources[RES_INDEX_ICON(id)].size)",
+		"#define RES_GET_ICON_SVG(id)     (g_embedded_resources[RES_INDEX_ICON(id)].as.icon.svg)",
 	);
 	out.push(
 		"#define RES_GET_ICON_FILL(id)    (g_embedded_resources[RES_INDEX_ICON(id)].as.icon.fill)",
@@ -268,6 +1516,8 @@ function genHeader(): string {
 	);
 	out.push("");
 
+	out.push(...genGlyphBakeSpec());
+
 	out.push("#endif /* RESOURCES_H */", "");
 	return out.join("\n");
 }
@@ -192,4 +192,49 @@ void main() {
 }
 @end
 
-@program selection selection_vs selection_fs
\ No newline at end of file
+@program selection selection_vs selection_fs
+
+// Distance-field glyphs from text_sdf, drawn through sokol_gl: the vertex
+// stage is sokol_gl's own, so the pipeline takes its vertex layout and
+// uniforms.
+@vs text_sdf_vs
+layout(binding=0) uniform vs_params {
+    mat4 mvp;
+    mat4 tm;
+};
+
+in vec4 position;
+in vec2 texcoord0;
+in vec4 color0;
+in float psize;
+out vec4 uv;
+out vec4 color;
+
+void main() {
+    gl_Position = mvp * position;
+#ifndef SOKOL_WGSL
+    gl_PointSize = psize;
+#endif
+    uv = tm * vec4(texcoord0, 0.0, 1.0);
+    color = color0;
+}
+@end
+
+@fs text_sdf_fs
+layout(binding=0) uniform texture2D tex;
+layout(binding=0) uniform sampler smp;
+
+in vec4 uv;
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    // the field is 0.5 on the outline; a one-pixel ramp across it at any scale
+    float dist = texture(sampler2D(tex, smp), uv.xy).r;
+    float width = max(fwidth(dist) * 0.5, 1e-4);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+    frag_color = vec4(color.rgb, color.a * alpha);
+}
+@end
+
+@program text_sdf text_sdf_vs text_sdf_fs
@@ -0,0 +1,25 @@
+#include "alloc.h"
+#include <stdlib.h>
+
+static AllocStats g_alloc_stats;
+
+void *core_malloc(size_t size) {
+  g_alloc_stats.mallocs++;
+  g_alloc_stats.bytes += size;
+  return malloc(size);
+}
+
+void *core_realloc(void *ptr, size_t size) {
+  g_alloc_stats.reallocs++;
+  g_alloc_stats.bytes += size;
+  return realloc(ptr, size);
+}
+
+void core_free(void *ptr) {
+  if (!ptr)
+    return;
+  g_alloc_stats.frees++;
+  free(ptr);
+}
+
+AllocStats core_alloc_stats(void) { return g_alloc_stats; }
@@ -0,0 +1,24 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocation entry points for the editor core (buffer.c, editor.c). They
+// forward to the C allocator, so blocks handed out to callers can still be
+// released with free(), and keep running counts for the benchmarks.
+
+typedef struct {
+  uint64_t mallocs;
+  uint64_t reallocs;
+  uint64_t frees;
+  uint64_t bytes;
+} AllocStats;
+
+void *core_malloc(size_t size);
+void *core_realloc(void *ptr, size_t size);
+void core_free(void *ptr);
+
+AllocStats core_alloc_stats(void);
+
+#endif
@@ -0,0 +1,187 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "anim.h"
+#include "sokol_time.h"
+#include <limits.h>
+#include <math.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#define ANIM_MAX_DT 0.25f
+#define ANIM_SETTLE_EPSILON 0.005f
+
+static struct {
+  void (*on_signal)(void);
+#if defined(_WIN32)
+  DWORD thread; // the waiting thread, which gets a WM_NULL
+#elif !defined(__EMSCRIPTEN__)
+  int pipe[2]; // a byte in the pipe ends the wait; -1 before init
+#endif
+} g_wake = {
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+    .pipe = {-1, -1},
+#endif
+};
+
+void anim_clock_init(AnimClock *clock) {
+  clock->last_tick = stm_now();
+  clock->wake_tick = 0;
+  clock->dt = 0.0f;
+}
+
+float anim_clock_advance(AnimClock *clock) {
+  uint64_t now = stm_now();
+  float dt = (float)stm_sec(stm_diff(now, clock->last_tick));
+  if (dt > ANIM_MAX_DT)
+    dt = ANIM_MAX_DT;
+
+  clock->last_tick = now;
+  clock->wake_tick = ANIM_WAKE_NEVER;
+  clock->dt = dt;
+  return dt;
+}
+
+// converts a "move this fraction of the remaining distance every frame"
+// factor tuned at reference_hz into a per-second exponential rate
+float anim_rate_from_frame_factor(float factor, float reference_hz) {
+  return -logf(1.0f - factor) * reference_hz;
+}
+
+void anim_request_frame(AnimClock *clock) { clock->wake_tick = 0; }
+
+void anim_wake_at(AnimClock *clock, uint64_t tick) {
+  if (tick < clock->wake_tick)
+    clock->wake_tick = tick;
+}
+
+void anim_wake_after(AnimClock *clock, uint64_t from_tick, double seconds) {
+  if (seconds <= 0.0) {
+    anim_request_frame(clock);
+    return;
+  }
+  anim_wake_at(clock, from_tick + (uint64_t)(seconds * 1e9));
+}
+
+uint64_t anim_next_wake(const AnimClock *clock) { return clock->wake_tick; }
+
+double anim_wait_seconds(const AnimClock *clock) {
+  if (clock->wake_tick == ANIM_WAKE_NEVER)
+    return INFINITY;
+  uint64_t now = stm_now();
+  if (clock->wake_tick <= now)
+    return 0.0;
+  return stm_sec(clock->wake_tick - now);
+}
+
+void anim_wait(const AnimClock *clock, int input_fd) {
+#if defined(__EMSCRIPTEN__)
+  (void)clock;
+  (void)input_fd;
+#else
+  double wait = anim_wait_seconds(clock);
+  if (wait <= 0.0)
+    return;
+
+#if defined(_WIN32)
+  (void)input_fd;
+  DWORD timeout = INFINITE;
+  if (wait < (double)(INFINITE - 1) / 1000.0)
+    timeout = (DWORD)ceil(wait * 1000.0);
+  // returns early for any message, including ones already queued
+  MsgWaitForMultipleObjectsEx(0, NULL, timeout, QS_ALLINPUT,
+                              MWMO_INPUTAVAILABLE);
+#else
+  int timeout = -1;
+  if (wait < (double)INT_MAX / 1000.0)
+    timeout = (int)ceil(wait * 1000.0);
+  struct pollfd fds[2];
+  nfds_t count = 0;
+  if (g_wake.pipe[0] >= 0)
+    fds[count++] = (struct pollfd){.fd = g_wake.pipe[0], .events = POLLIN};
+  if (input_fd >= 0)
+    fds[count++] = (struct pollfd){.fd = input_fd, .events = POLLIN};
+  if (poll(fds, count, timeout) > 0 && g_wake.pipe[0] >= 0 &&
+      (fds[0].revents & POLLIN)) {
+    char drain[64];
+    while (read(g_wake.pipe[0], drain, sizeof(drain)) > 0) {
+    }
+  }
+#endif
+#endif
+}
+
+void anim_wake_init(void (*on_signal)(void)) {
+  g_wake.on_signal = on_signal;
+#if defined(_WIN32)
+  g_wake.thread = GetCurrentThreadId();
+#elif !defined(__EMSCRIPTEN__)
+  if (g_wake.pipe[0] >= 0 || pipe(g_wake.pipe) != 0)
+    return;
+  // a full pipe already holds a wake, and the drain must not block
+  for (int i = 0; i < 2; i++) {
+    fcntl(g_wake.pipe[i], F_SETFL, fcntl(g_wake.pipe[i], F_GETFL) | O_NONBLOCK);
+    fcntl(g_wake.pipe[i], F_SETFD, FD_CLOEXEC);
+  }
+#endif
+}
+
+void anim_wake_signal(void) {
+  if (g_wake.on_signal)
+    g_wake.on_signal();
+#if defined(_WIN32)
+  if (g_wake.thread)
+    PostThreadMessageW(g_wake.thread, WM_NULL, 0, 0);
+#elif !defined(__EMSCRIPTEN__)
+  if (g_wake.pipe[1] >= 0) {
+    const char byte = 0;
+    ssize_t written = write(g_wake.pipe[1], &byte, 1);
+    (void)written;
+  }
+#endif
+}
+
+void anim_wake_shutdown(void) {
+  g_wake.on_signal = NULL;
+#if defined(_WIN32)
+  g_wake.thread = 0;
+#elif !defined(__EMSCRIPTEN__)
+  for (int i = 0; i < 2; i++) {
+    if (g_wake.pipe[i] >= 0)
+      close(g_wake.pipe[i]);
+    g_wake.pipe[i] = -1;
+  }
+#endif
+}
+
+bool anim_ease(AnimClock *clock, float *value, float target, float rate) {
+  float diff = target - *value;
+  if (fabsf(diff) <= ANIM_SETTLE_EPSILON) {
+    *value = target;
+    return false;
+  }
+
+  *value += diff * (1.0f - expf(-rate * clock->dt));
+  anim_request_frame(clock);
+  return true;
+}
+
+bool anim_linear(AnimClock *clock, float *value, float target, float speed) {
+  float diff = target - *value;
+  float step = speed * clock->dt;
+  if (fabsf(diff) <= step) {
+    *value = target;
+    return false;
+  }
+
+  *value += diff > 0.0f ? step : -step;
+  anim_request_frame(clock);
+  return true;
+}
@@ -0,0 +1,40 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ANIM_WAKE_NEVER UINT64_MAX
+
+typedef struct {
+  uint64_t last_tick;
+  uint64_t wake_tick;
+  float dt;
+} AnimClock;
+
+void anim_clock_init(AnimClock *clock);
+float anim_clock_advance(AnimClock *clock);
+float anim_rate_from_frame_factor(float factor, float reference_hz);
+
+void anim_request_frame(AnimClock *clock);
+void anim_wake_at(AnimClock *clock, uint64_t tick);
+void anim_wake_after(AnimClock *clock, uint64_t from_tick, double seconds);
+uint64_t anim_next_wake(const AnimClock *clock);
+// seconds until the next wake; 0 if one is due, INFINITY if none is
+double anim_wait_seconds(const AnimClock *clock);
+// Sleeps until the next wake, for good if there is none. Input and
+// anim_wake_signal end the wait early: on Windows any message for the
+// thread, elsewhere input_fd turning readable (-1 for none).
+void anim_wait(const AnimClock *clock, int input_fd);
+
+// Lets other threads end the calling thread's anim_wait. on_signal, if set,
+// also runs on the signalling thread, for loops that sleep some other way.
+void anim_wake_init(void (*on_signal)(void));
+// Ends the current or next anim_wait right away; any thread.
+void anim_wake_signal(void);
+void anim_wake_shutdown(void);
+
+bool anim_ease(AnimClock *clock, float *value, float target, float rate);
+bool anim_linear(AnimClock *clock, float *value, float target, float speed);
+
+#endif
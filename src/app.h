@@ -0,0 +1,150 @@
+#ifndef APP_H
+#define APP_H
+
+// Application state shared between main.c and the UI layout code in ui.c.
+// Include after clay.h, sokol_gfx.h, sokol_clay.h and the generated
+// shaders.h, like sokol_clay.h itself.
+
+#include "anim.h"
+#include "editor.h"
+#include "profiler.h"
+#include "resources.h"
+#include "svg.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+  char id[64];
+  char date[32];
+  char filename[256];
+  char preview[64];
+  time_t timestamp;
+  bool is_selected;
+} FileEntry;
+
+typedef struct {
+  FileEntry *entries;
+  size_t count;
+  size_t capacity;
+  int selected_index;
+} FileHistory;
+
+typedef struct {
+  Clay_Color background;
+  Clay_Color sidebar_bg;
+  Clay_Color text_primary;
+  Clay_Color text_secondary;
+  Clay_Color border;
+  Clay_Color selection;
+  Clay_Color hover;
+} Theme;
+
+typedef struct {
+  sg_pipeline pip;
+  sg_bindings bind;
+  globals_t uniforms;
+  float cursor_x;
+  float cursor_y;
+  float cursor_height;
+} CursorState;
+
+typedef struct {
+  float x, y;
+  float r, g, b, a;
+} SelectionVertex;
+
+typedef struct {
+  sg_pipeline pip;
+  sg_buffer vbuf;
+  sg_buffer ibuf;
+  SelectionVertex *vertices;
+  uint16_t *indices;
+  int capacity_quads;
+} SelectionState;
+
+typedef enum {
+  APP_WINDOW_NORMAL,
+  APP_WINDOW_FULLSCREEN,
+  APP_WINDOW_MINIMIZED
+} AppWindowState;
+
+typedef struct {
+  bool initialized;
+  Theme theme;
+  bool dark_mode;
+  bool lol;
+
+  int font_size_index;
+  int current_font_index;
+
+  float screen_width;
+  float screen_height;
+
+  TextEditor editor;
+  char current_filename[256];
+  char documents_path[512];
+
+  bool show_sidebar;
+  FileHistory history;
+  int hovered_entry_index;
+
+  int timer_seconds;
+  bool timer_running;
+  uint64_t last_timer_update;
+  char timer_string[6];
+  float bottom_nav_opacity;
+  bool bottom_nav_hovering;
+  uint64_t bottom_nav_fade_time;
+
+  uint64_t last_save_time;
+  bool needs_save;
+
+  CursorState cursor;
+  SelectionState selection;
+  void *current_line_tag;
+
+  uint64_t start_time;
+  AnimClock anim;
+
+  struct {
+    bool visible;
+    int frames_until_refresh;
+    char lines[PROF_PHASE_COUNT + 1][96];
+  } profiler;
+
+  AppWindowState window_state;
+
+  struct {
+    sclay_image images[RES_IMG_COUNT];
+    sclay_font_t fonts[RES_FONT_COUNT];
+    svg_element_t icons[RES_ICON_COUNT];
+    bool sdf_text; // text_sdf is up, for the fonts it has taken
+  } gfx;
+} AppState;
+
+extern AppState *g_app;
+
+// Clay pointer callbacks, implemented in main.c
+void HandleFontSelect(Clay_ElementId elementId, Clay_PointerData pointerData,
+                      intptr_t userData);
+void HandleFontSizeChange(Clay_ElementId elementId,
+                          Clay_PointerData pointerData, intptr_t userData);
+void HandleFullscreenToggle(Clay_ElementId elementId,
+                            Clay_PointerData pointerData, intptr_t userData);
+void HandleLulCow(Clay_ElementId elementId, Clay_PointerData pointerData,
+                  intptr_t userData);
+void HandleTimerToggle(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData);
+void HandleNewEntry(Clay_ElementId elementId, Clay_PointerData pointerData,
+                    intptr_t userData);
+void HandleEntrySelect(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData);
+void HandleEntryExport(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData);
+void HandleEntryDelete(Clay_ElementId elementId, Clay_PointerData pointerData,
+                       intptr_t userData);
+void HandleOpenDirectory(Clay_ElementId elementId, Clay_PointerData pointerData,
+                         intptr_t userData);
+
+#endif
@@ -1,4 +1,5 @@
 #include "buffer.h"
+#include "alloc.h"
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,14 +19,14 @@ int utf8_char_len(unsigned char c) {
 bool is_word_boundary(char c) { return !isalnum(c) && c != '_'; }
 
 void char_buffer_init(CharBuffer *cb, size_t capacity) {
-  cb->buf = malloc(capacity);
+  cb->buf = core_malloc(capacity);
   cb->gap_start = cb->buf;
   cb->gap_end = cb->buf + capacity;
   cb->capacity = capacity;
 }
 
 void char_buffer_destroy(CharBuffer *cb) {
-  free(cb->buf);
+  core_free(cb->buf);
   cb->buf = NULL;
 }
 
@@ -44,7 +45,7 @@ void char_buffer_ensure_gap(CharBuffer *cb, size_t needed) {
 
   size_t old_capacity = cb->capacity;
   size_t new_capacity = old_capacity * 2 + needed;
-  char *new_buf = malloc(new_capacity);
+  char *new_buf = core_malloc(new_capacity);
 
   size_t before_len = cb->gap_start - cb->buf;
   memcpy(new_buf, cb->buf, before_len);
@@ -56,7 +57,7 @@ void char_buffer_ensure_gap(CharBuffer *cb, size_t needed) {
   cb->gap_end = new_buf + new_capacity - after_len;
   cb->capacity = new_capacity;
 
-  free(cb->buf);
+  core_free(cb->buf);
   cb->buf = new_buf;
 }
 
@@ -111,6 +112,19 @@ char char_buffer_get_at(CharBuffer *cb, size_t pos) {
   }
 }
 
+void char_buffer_copy_range(CharBuffer *cb, size_t pos, size_t len,
+                            char *dest) {
+  size_t gap_pos = cb->gap_start - cb->buf;
+  size_t before_len = 0;
+  if (pos < gap_pos)
+    before_len = (gap_pos - pos < len) ? gap_pos - pos : len;
+
+  memcpy(dest, cb->buf + pos, before_len);
+  memcpy(dest + before_len,
+         cb->buf + pos + before_len + char_buffer_gap_size(cb),
+         len - before_len);
+}
+
 size_t char_buffer_to_buffer(CharBuffer *cb, char *dest, size_t dest_size) {
   size_t len = char_buffer_len(cb);
   size_t to_copy = (len < dest_size - 1) ? len : dest_size - 1;
@@ -133,7 +147,7 @@ size_t char_buffer_to_buffer(CharBuffer *cb, char *dest, size_t dest_size) {
 }
 
 void line_buffer_init(LineBuffer *lb, size_t capacity) {
-  lb->lines = malloc(capacity * sizeof(size_t));
+  lb->lines = core_malloc(capacity * sizeof(size_t));
   lb->gap_start = lb->lines;
   lb->gap_end = lb->lines + capacity;
   lb->capacity = capacity;
@@ -143,7 +157,7 @@ void line_buffer_init(LineBuffer *lb, size_t capacity) {
 }
 
 void line_buffer_destroy(LineBuffer *lb) {
-  free(lb->lines);
+  core_free(lb->lines);
   lb->lines = NULL;
 }
 
@@ -158,7 +172,7 @@ void line_buffer_ensure_gap(LineBuffer *lb, size_t needed) {
 
   size_t old_capacity = lb->capacity;
   size_t new_capacity = old_capacity * 2 + needed;
-  size_t *new_lines = malloc(new_capacity * sizeof(size_t));
+  size_t *new_lines = core_malloc(new_capacity * sizeof(size_t));
 
   size_t before_count = lb->gap_start - lb->lines;
   memcpy(new_lines, lb->lines, before_count * sizeof(size_t));
@@ -171,10 +185,26 @@ void line_buffer_ensure_gap(LineBuffer *lb, size_t needed) {
   lb->gap_end = new_lines + new_capacity - after_count;
   lb->capacity = new_capacity;
 
-  free(lb->lines);
+  core_free(lb->lines);
   lb->lines = new_lines;
 }
 
+void line_buffer_move_gap(LineBuffer *lb, size_t target_line) {
+  size_t current_line = lb->gap_start - lb->lines;
+
+  if (target_line < current_line) {
+    size_t move_len = current_line - target_line;
+    lb->gap_end -= move_len;
+    memmove(lb->gap_end, lb->gap_start - move_len, move_len * sizeof(size_t));
+    lb->gap_start -= move_len;
+  } else if (target_line > current_line) {
+    size_t move_len = target_line - current_line;
+    memmove(lb->gap_start, lb->gap_end, move_len * sizeof(size_t));
+    lb->gap_start += move_len;
+    lb->gap_end += move_len;
+  }
+}
+
 size_t line_buffer_get(LineBuffer *lb, size_t line) {
   if (line >= line_buffer_count(lb))
     return 0;
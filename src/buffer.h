@@ -28,12 +28,14 @@ void char_buffer_insert(CharBuffer *cb, const char *text, size_t len);
 void char_buffer_delete_forward(CharBuffer *cb, size_t len);
 void char_buffer_delete_backward(CharBuffer *cb, size_t len);
 char char_buffer_get_at(CharBuffer *cb, size_t pos);
+void char_buffer_copy_range(CharBuffer *cb, size_t pos, size_t len, char *dest);
 size_t char_buffer_to_buffer(CharBuffer *cb, char *dest, size_t dest_size);
 
 void line_buffer_init(LineBuffer *lb, size_t capacity);
 void line_buffer_destroy(LineBuffer *lb);
 size_t line_buffer_count(LineBuffer *lb);
 void line_buffer_ensure_gap(LineBuffer *lb, size_t needed);
+void line_buffer_move_gap(LineBuffer *lb, size_t target_line);
 size_t line_buffer_get(LineBuffer *lb, size_t line);
 
 int utf8_char_len(unsigned char c);
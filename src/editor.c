@@ -1,10 +1,181 @@
 #include "editor.h"
+#include "alloc.h"
+#include "layout_cache.h"
+#include "trace.h"
 #include <ctype.h>
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// larger edits get their own block instead of doubling the ring for them
+#define UNDO_RING_MAX_LEN (UNDO_INITIAL_TEXT / 4)
+// how far past its content cut a chunk may run to end where a row starts;
+// a cut depends on no text further on, and rows are far shorter
+#define CHUNK_ROW_REACH 1024
+
+static UndoAction *undo_at(UndoHistory *undo, size_t i) {
+  return &undo->actions[(undo->first + i) % undo->action_capacity];
+}
+
+static void undo_release(UndoHistory *undo, UndoAction *action) {
+  if (action->heap_text) {
+    core_free(action->heap_text);
+    action->heap_text = NULL;
+  } else {
+    // ring text is stored in action order, so this is always the tail
+    undo->text_tail = action->text_offset + action->len;
+  }
+}
+
+static void undo_reset(UndoHistory *undo) {
+  for (size_t i = 0; i < undo->count; i++) {
+    core_free(undo_at(undo, i)->heap_text);
+  }
+  undo->first = 0;
+  undo->count = 0;
+  undo->current = 0;
+  undo->text_head = 0;
+  undo->text_tail = 0;
+}
+
+static void undo_drop_redo(UndoHistory *undo) {
+  for (size_t i = undo->current; i < undo->count; i++) {
+    UndoAction *action = undo_at(undo, i);
+    core_free(action->heap_text);
+    action->heap_text = NULL;
+  }
+  undo->count = undo->current;
+
+  undo->text_head = undo->text_tail;
+  for (size_t i = undo->count; i > 0; i--) {
+    UndoAction *action = undo_at(undo, i - 1);
+    if (!action->heap_text) {
+      undo->text_head = action->text_offset + action->len;
+      break;
+    }
+  }
+}
+
+static bool undo_grow_actions(UndoHistory *undo) {
+  const size_t capacity =
+      undo->action_capacity ? undo->action_capacity * 2 : UNDO_INITIAL_ACTIONS;
+  UndoAction *actions = core_malloc(capacity * sizeof(UndoAction));
+  if (!actions)
+    return false;
+  for (size_t i = 0; i < undo->count; i++)
+    actions[i] = *undo_at(undo, i);
+  core_free(undo->actions);
+  undo->actions = actions;
+  undo->action_capacity = capacity;
+  undo->first = 0;
+  return true;
+}
+
+// Text offsets stay as they are; the live bytes move to where they fall in
+// the larger ring.
+static bool undo_grow_text(UndoHistory *undo, size_t needed) {
+  size_t capacity =
+      undo->text_capacity ? undo->text_capacity * 2 : UNDO_INITIAL_TEXT;
+  while (capacity < needed)
+    capacity *= 2;
+  char *text = core_malloc(capacity);
+  if (!text)
+    return false;
+  for (size_t offset = undo->text_tail; offset < undo->text_head;) {
+    const size_t from = offset % undo->text_capacity;
+    const size_t to = offset % capacity;
+    size_t len = undo->text_head - offset;
+    if (len > undo->text_capacity - from)
+      len = undo->text_capacity - from;
+    if (len > capacity - to)
+      len = capacity - to;
+    memcpy(text + to, undo->text + from, len);
+    offset += len;
+  }
+  core_free(undo->text);
+  undo->text = text;
+  undo->text_capacity = capacity;
+  return true;
+}
+
+static UndoAction *undo_push(UndoHistory *undo, ActionType type, size_t pos,
+                             size_t len) {
+  undo_drop_redo(undo);
+
+  bool in_ring = len <= UNDO_RING_MAX_LEN;
+  if (undo->count == undo->action_capacity)
+    undo_grow_actions(undo);
+  const size_t text_needed =
+      undo->text_head + (in_ring ? len : 0) - undo->text_tail;
+  if (text_needed > undo->text_capacity || !undo->text)
+    undo_grow_text(undo, text_needed);
+  // only when a ring could not grow
+  while (undo->count == undo->action_capacity ||
+         (in_ring &&
+          undo->text_head + len - undo->text_tail > undo->text_capacity)) {
+    if (undo->count == 0)
+      return NULL;
+    undo_release(undo, undo_at(undo, 0));
+    undo->first = (undo->first + 1) % undo->action_capacity;
+    undo->count--;
+    undo->current--;
+  }
+
+  UndoAction *action = undo_at(undo, undo->count);
+  action->type = type;
+  action->pos = pos;
+  action->len = len;
+  action->text_offset = undo->text_head;
+  action->heap_text = NULL;
+  if (in_ring) {
+    undo->text_head += len;
+  } else {
+    action->heap_text = core_malloc(len);
+  }
+
+  undo->count++;
+  undo->current = undo->count;
+  return action;
+}
+
+// start and length of the first piece of an action's text in the byte ring;
+// the rest wraps around to the start of the ring
+static size_t undo_ring_split(const UndoHistory *undo,
+                              const UndoAction *action, size_t *start) {
+  *start = action->text_offset % undo->text_capacity;
+  size_t first = undo->text_capacity - *start;
+  return first < action->len ? first : action->len;
+}
+
+static void undo_insert_text(TextEditor *editor, const UndoAction *action) {
+  if (action->heap_text) {
+    char_buffer_insert(&editor->chars, action->heap_text, action->len);
+    return;
+  }
+  size_t start;
+  size_t first = undo_ring_split(&editor->undo, action, &start);
+  char_buffer_insert(&editor->chars, editor->undo.text + start, first);
+  char_buffer_insert(&editor->chars, editor->undo.text, action->len - first);
+}
+
+// copies the text about to be removed straight out of the gap buffer
+static void text_editor_add_undo_range(TextEditor *editor, ActionType type,
+                                       size_t pos, size_t len) {
+  UndoAction *action = undo_push(&editor->undo, type, pos, len);
+  if (!action)
+    return;
+  if (action->heap_text) {
+    char_buffer_copy_range(&editor->chars, pos, len, action->heap_text);
+    return;
+  }
+  size_t start;
+  size_t first = undo_ring_split(&editor->undo, action, &start);
+  char_buffer_copy_range(&editor->chars, pos, first, editor->undo.text + start);
+  char_buffer_copy_range(&editor->chars, pos + first, len - first,
+                         editor->undo.text);
+}
+
 void text_editor_init(TextEditor *editor, size_t initial_capacity) {
   char_buffer_init(&editor->chars, initial_capacity);
   line_buffer_init(&editor->lines, 256);
@@ -17,19 +188,30 @@ void text_editor_init(TextEditor *editor, size_t initial_capacity) {
   editor->sel_start = 0;
   editor->sel_end = 0;
 
-  editor->undo_head = NULL;
-  editor->undo_current = NULL;
+  memset(&editor->undo, 0, sizeof(editor->undo));
 
   editor->render_line_capacity = 256;
-  editor->render_lines = malloc(editor->render_line_capacity * sizeof(char *));
+  editor->render_lines = core_malloc(editor->render_line_capacity * sizeof(char *));
+  editor->render_hashes =
+      core_malloc(editor->render_line_capacity * sizeof(uint64_t));
+  editor->render_starts =
+      core_malloc(editor->render_line_capacity * sizeof(size_t));
+  editor->render_lengths =
+      core_malloc(editor->render_line_capacity * sizeof(size_t));
   editor->render_line_count = 0;
 
   editor->render_buffer_capacity = 65536;
-  editor->render_line_buffer = malloc(editor->render_buffer_capacity);
+  editor->render_line_buffer = core_malloc(editor->render_buffer_capacity);
   editor->render_buffer_used = 0;
+  editor->revision = 1;
+  editor->render_revision = 0;
+  editor->render_full = true;
+  editor->row_cache = NULL;
+  memset(&editor->row_style, 0, sizeof(editor->row_style));
 
   editor->scroll_y = 0;
   editor->target_scroll_y = 0;
+  editor->follow_cursor = false;
 
   editor->mouse.dragging = false;
   editor->mouse.mouse_down = false;
@@ -42,133 +224,450 @@ void text_editor_destroy(TextEditor *editor) {
   char_buffer_destroy(&editor->chars);
   line_buffer_destroy(&editor->lines);
 
-  free(editor->render_lines);
-  free(editor->render_line_buffer);
+  core_free(editor->render_lines);
+  core_free(editor->render_hashes);
+  core_free(editor->render_starts);
+  core_free(editor->render_lengths);
+  core_free(editor->render_line_buffer);
 
-  UndoAction *action = editor->undo_head;
-  while (action) {
-    UndoAction *next = action->next;
-    free(action->text);
-    free(action);
-    action = next;
+  undo_reset(&editor->undo);
+  core_free(editor->undo.actions);
+  core_free(editor->undo.text);
+}
+
+// Ends the lines in [text, text + len) at each newline; *current carries the
+// length of the line still open across the gap.
+static void scan_line_lengths(LineBuffer *lines, const char *text, size_t len,
+                              size_t *current) {
+  const char *end = text + len;
+  while (text < end) {
+    const char *newline = memchr(text, '\n', (size_t)(end - text));
+    if (!newline) {
+      *current += (size_t)(end - text);
+      return;
+    }
+    line_buffer_ensure_gap(lines, 1);
+    *lines->gap_start++ = *current + (size_t)(newline - text);
+    *current = 0;
+    text = newline + 1;
   }
 }
 
 void text_editor_rebuild_lines(TextEditor *editor) {
+  TRACE_BEGIN("text_editor_rebuild_lines");
+  editor->revision++;
 
   editor->lines.gap_start = editor->lines.lines;
   editor->lines.gap_end = editor->lines.lines + editor->lines.capacity;
 
+  CharBuffer *chars = &editor->chars;
   size_t current_line_len = 0;
-  size_t text_len = char_buffer_len(&editor->chars);
-
-  for (size_t i = 0; i < text_len; i++) {
-    char c = char_buffer_get_at(&editor->chars, i);
-    if (c == '\n') {
-      line_buffer_ensure_gap(&editor->lines, 1);
-      *editor->lines.gap_start++ = current_line_len;
-      current_line_len = 0;
-    } else {
-      current_line_len++;
-    }
-  }
+  scan_line_lengths(&editor->lines, chars->buf,
+                    (size_t)(chars->gap_start - chars->buf), &current_line_len);
+  scan_line_lengths(&editor->lines, chars->gap_end,
+                    (size_t)(chars->buf + chars->capacity - chars->gap_end),
+                    &current_line_len);
 
   line_buffer_ensure_gap(&editor->lines, 1);
   *editor->lines.gap_start++ = current_line_len;
+  editor->render_full = true;
+
+  TRACE_END("text_editor_rebuild_lines");
+}
+
+// Widens the written range by an edit at pos that replaced removed bytes
+// with inserted ones. Bytes of the range that the edit removed map to its
+// end.
+static void record_edit(TextEditor *editor, size_t pos, size_t removed,
+                        size_t inserted) {
+  const ptrdiff_t delta = (ptrdiff_t)inserted - (ptrdiff_t)removed;
+  if (editor->render_revision != editor->revision) {
+    size_t end = editor->edit_end;
+    if (end >= pos + removed)
+      end = (size_t)((ptrdiff_t)end + delta);
+    else if (end > pos)
+      end = pos + inserted;
+    editor->edit_start = pos < editor->edit_start ? pos : editor->edit_start;
+    editor->edit_end = end > pos + inserted ? end : pos + inserted;
+    editor->edit_delta += delta;
+  } else {
+    editor->edit_start = pos;
+    editor->edit_end = pos + inserted;
+    editor->edit_delta = delta;
+  }
+  editor->revision++;
+}
+
+// Updates the line lengths after the text at pos had removed bytes replaced
+// with inserted ones, already done in the char buffer. Only the inserted
+// text is scanned; the lines the edit touched are spliced out of the line
+// buffer and the new ones put in their place.
+static void text_editor_edited(TextEditor *editor, size_t pos, size_t removed,
+                               size_t inserted) {
+  TRACE_BEGIN("text_editor_edited");
+  LineBuffer *lines = &editor->lines;
+  const size_t line_count = line_buffer_count(lines);
+
+  // first and last line the removed bytes were in, old offsets
+  size_t first = 0;
+  size_t start = 0;
+  while (first + 1 < line_count &&
+         start + line_buffer_get(lines, first) < pos) {
+    start += line_buffer_get(lines, first) + 1;
+    first++;
+  }
+  size_t last = first;
+  size_t end = start + line_buffer_get(lines, first);
+  while (last + 1 < line_count && end < pos + removed) {
+    last++;
+    end += line_buffer_get(lines, last) + 1;
+  }
+
+  line_buffer_move_gap(lines, first);
+  lines->gap_end += last - first + 1;
+
+  CharBuffer *chars = &editor->chars;
+  const size_t gap = (size_t)(chars->gap_start - chars->buf);
+  size_t current_line_len = pos - start;
+  if (pos < gap) {
+    const size_t len = (pos + inserted < gap ? pos + inserted : gap) - pos;
+    scan_line_lengths(lines, chars->buf + pos, len, &current_line_len);
+  }
+  if (pos + inserted > gap) {
+    const size_t from = pos > gap ? pos : gap;
+    scan_line_lengths(lines, chars->gap_end + (from - gap),
+                      pos + inserted - from, &current_line_len);
+  }
+  line_buffer_ensure_gap(lines, 1);
+  *lines->gap_start++ = current_line_len + (end - pos - removed);
+
+  record_edit(editor, pos, removed, inserted);
+  TRACE_END("text_editor_edited");
 }
 
 void text_editor_update_cursor_pos(TextEditor *editor) {
   size_t byte_pos = editor->chars.gap_start - editor->chars.buf;
   editor->cursor.byte_pos = byte_pos;
 
+  // walks the line lengths rather than the text
+  const size_t line_count = line_buffer_count(&editor->lines);
   size_t line = 0;
-  size_t col = 0;
-
-  for (size_t i = 0; i < byte_pos; i++) {
-    char c = char_buffer_get_at(&editor->chars, i);
-    if (c == '\n') {
-      line++;
-      col = 0;
-    } else {
-      col++;
-    }
+  size_t line_start = 0;
+  while (line + 1 < line_count) {
+    const size_t line_len = line_buffer_get(&editor->lines, line);
+    if (line_start + line_len >= byte_pos)
+      break;
+    line_start += line_len + 1;
+    line++;
   }
 
   editor->cursor.line = line;
-  editor->cursor.col = col;
+  editor->cursor.col = byte_pos - line_start;
 }
 
 void text_editor_ensure_cursor_visible(TextEditor *editor) {
-  float line_height = 20.0f;
-  float cursor_y = editor->cursor.line * line_height;
-  float viewport_height = 600.0f;
+  editor->follow_cursor = true;
+}
 
-  if (cursor_y > editor->scroll_y + viewport_height - line_height * 2) {
-    editor->target_scroll_y = cursor_y - viewport_height + line_height * 4;
-  }
+static bool is_utf8_continuation(char c) {
+  return ((unsigned char)c & 0xC0) == 0x80;
+}
 
-  else if (cursor_y < editor->scroll_y) {
-    editor->target_scroll_y = cursor_y - line_height;
+// Length of the first layout chunk of a line, which starts a row. Chunks
+// end where the eight bytes before the cut hash to a marker, so an edit only
+// moves the cuts around it and the chunks past it keep their text and
+// cached wraps. Cuts after a space are 64 times likelier, which keeps words
+// whole. The cut then moves on to where the next row starts, so the next
+// chunk begins one, looking no further than CHUNK_ROW_REACH bytes ahead.
+static size_t chunk_length(const TextEditor *editor, const char *text,
+                           size_t len) {
+  if (len <= EDITOR_CHUNK_MAX)
+    return len;
+  const size_t last = EDITOR_CHUNK_MAX - CHUNK_ROW_REACH;
+  size_t cut = 0;
+  for (size_t i = EDITOR_CHUNK_MIN; i < last && cut == 0; i++) {
+    if (is_utf8_continuation(text[i]))
+      continue;
+    uint64_t window;
+    memcpy(&window, text + i - 8, sizeof(window));
+    const uint64_t marker = (window * 0x9E3779B97F4A7C15ull) >> 52;
+    if (text[i - 1] == ' ' ? (marker & 63) == 0 : marker == 0)
+      cut = i;
   }
-
-  if (editor->target_scroll_y < 0) {
-    editor->target_scroll_y = 0;
+  if (cut == 0) {
+    cut = last;
+    while (cut > EDITOR_CHUNK_MIN && is_utf8_continuation(text[cut]))
+      cut--;
   }
+  if (!editor->row_cache)
+    return cut;
+  // the rows that start in the reach are known from it alone
+  const size_t row = layout_next_row_start(
+      editor->row_cache, &editor->row_style, text, cut + CHUNK_ROW_REACH, cut);
+  return row != 0 ? row : cut;
 }
 
-void text_editor_prepare_render_lines(TextEditor *editor) {
-  size_t line_count = line_buffer_count(&editor->lines);
+static bool reserve_render_lines(TextEditor *editor, size_t count) {
+  if (count <= editor->render_line_capacity)
+    return true;
+  const size_t capacity = count * 2;
+  char **lines = core_realloc(editor->render_lines, capacity * sizeof(char *));
+  if (!lines)
+    return false;
+  editor->render_lines = lines;
+  uint64_t *hashes =
+      core_realloc(editor->render_hashes, capacity * sizeof(uint64_t));
+  if (!hashes)
+    return false;
+  editor->render_hashes = hashes;
+  size_t *starts =
+      core_realloc(editor->render_starts, capacity * sizeof(size_t));
+  if (!starts)
+    return false;
+  editor->render_starts = starts;
+  size_t *lengths =
+      core_realloc(editor->render_lengths, capacity * sizeof(size_t));
+  if (!lengths)
+    return false;
+  editor->render_lengths = lengths;
+  editor->render_line_capacity = capacity;
+  return true;
+}
 
-  if (line_count > editor->render_line_capacity) {
-    editor->render_line_capacity = line_count * 2;
-    editor->render_lines = realloc(
-        editor->render_lines, editor->render_line_capacity * sizeof(char *));
-  }
+static void set_render_line(TextEditor *editor, size_t i, char *text,
+                            size_t start, size_t len) {
+  text[len] = '\0';
+  editor->render_lines[i] = text;
+  editor->render_hashes[i] = layout_hash(text, len);
+  editor->render_starts[i] = start;
+  editor->render_lengths[i] = len;
+}
+
+static void add_render_line(TextEditor *editor, char *text, size_t start,
+                            size_t len) {
+  set_render_line(editor, editor->render_line_count++, text, start, len);
+}
+
+static void move_render_lines(TextEditor *editor, size_t to, size_t from,
+                              size_t count) {
+  memmove(editor->render_lines + to, editor->render_lines + from,
+          count * sizeof(char *));
+  memmove(editor->render_hashes + to, editor->render_hashes + from,
+          count * sizeof(uint64_t));
+  memmove(editor->render_starts + to, editor->render_starts + from,
+          count * sizeof(size_t));
+  memmove(editor->render_lengths + to, editor->render_lengths + from,
+          count * sizeof(size_t));
+}
+
+static bool starts_line(const TextEditor *editor, size_t i) {
+  return i == 0 || editor->render_starts[i] != editor->render_starts[i - 1] +
+                                                   editor->render_lengths[i - 1];
+}
 
+static bool cut_all_render_lines(TextEditor *editor) {
+  size_t line_count = line_buffer_count(&editor->lines);
+
+  // every chunk but a line's last is at least EDITOR_CHUNK_MIN long
+  size_t max_render_lines = 0;
   size_t total_needed = 0;
   for (size_t i = 0; i < line_count; i++) {
     size_t line_len = line_buffer_get(&editor->lines, i);
-    total_needed += line_len + 1;
+    const size_t chunks =
+        line_len > EDITOR_CHUNK_MAX ? line_len / EDITOR_CHUNK_MIN + 1 : 1;
+    max_render_lines += chunks;
+    total_needed += line_len + chunks;
   }
 
+  if (!reserve_render_lines(editor, max_render_lines))
+    return false;
   if (total_needed > editor->render_buffer_capacity) {
+    char *buffer = core_realloc(editor->render_line_buffer, total_needed * 2);
+    if (!buffer)
+      return false;
+    editor->render_line_buffer = buffer;
     editor->render_buffer_capacity = total_needed * 2;
-    editor->render_line_buffer =
-        realloc(editor->render_line_buffer, editor->render_buffer_capacity);
   }
 
-  editor->render_line_count = line_count;
+  editor->render_line_count = 0;
   editor->render_buffer_used = 0;
 
   size_t byte_pos = 0;
-  size_t gap_pos = editor->chars.gap_start - editor->chars.buf;
-  size_t gap_size = editor->chars.gap_end - editor->chars.gap_start;
-
   for (size_t i = 0; i < line_count; i++) {
     size_t line_len = line_buffer_get(&editor->lines, i);
-
     char *line_text = editor->render_line_buffer + editor->render_buffer_used;
-    editor->render_lines[i] = line_text;
 
-    if (byte_pos + line_len <= gap_pos) {
-
-      memcpy(line_text, editor->chars.buf + byte_pos, line_len);
-    } else if (byte_pos >= gap_pos) {
-
-      memcpy(line_text, editor->chars.buf + byte_pos + gap_size, line_len);
+    if (line_len <= EDITOR_CHUNK_MAX) {
+      char_buffer_copy_range(&editor->chars, byte_pos, line_len, line_text);
+      add_render_line(editor, line_text, byte_pos, line_len);
+      editor->render_buffer_used += line_len + 1;
     } else {
+      // copied past where the chunks go, then each one is moved down into
+      // place behind its terminator
+      const size_t slack = line_len / EDITOR_CHUNK_MIN;
+      char *src = line_text + slack;
+      char_buffer_copy_range(&editor->chars, byte_pos, line_len, src);
+      size_t offset = 0;
+      while (offset < line_len) {
+        const size_t len =
+            chunk_length(editor, src + offset, line_len - offset);
+        char *chunk = editor->render_line_buffer + editor->render_buffer_used;
+        memmove(chunk, src + offset, len);
+        add_render_line(editor, chunk, byte_pos + offset, len);
+        editor->render_buffer_used += len + 1;
+        offset += len;
+      }
+    }
+    byte_pos += line_len + 1;
+  }
+  editor->render_full = false;
+  return true;
+}
+
+// Cuts the render lines again from the chunk holding the first written byte
+// until a cut past the written range lands where an old one did; from there
+// on the text and so the chunks are the old ones, only moved by edit_delta.
+// New chunks are appended to the render line buffer, and the text of the
+// ones they replace stays behind in it until it fills up and
+// cut_all_render_lines packs it again. False when that is due.
+static bool recut_edited_chunks(TextEditor *editor) {
+  const size_t edit_start = editor->edit_start;
+  const size_t edit_end = editor->edit_end;
+  const ptrdiff_t delta = editor->edit_delta;
+  const size_t old_count = editor->render_line_count;
+  LineBuffer *lines = &editor->lines;
+  const size_t line_count = line_buffer_count(lines);
 
-      size_t before_gap = gap_pos - byte_pos;
-      memcpy(line_text, editor->chars.buf + byte_pos, before_gap);
-      memcpy(line_text + before_gap, editor->chars.gap_end,
-             line_len - before_gap);
+  size_t line = 0;
+  size_t line_start = 0;
+  while (line + 1 < line_count &&
+         line_start + line_buffer_get(lines, line) < edit_start) {
+    line_start += line_buffer_get(lines, line) + 1;
+    line++;
+  }
+  size_t line_len = line_buffer_get(lines, line);
+
+  // Text before edit_start is unchanged, so are the cuts there, except
+  // those within CHUNK_ROW_REACH of it, which looked at the edited text for
+  // their row start or may now split a codepoint, and those close enough to
+  // the end of the line for their chunk to take the rest of it.
+  size_t col;
+  size_t first = text_editor_render_line_at(editor, edit_start, &col);
+  if (editor->render_starts[first] < line_start)
+    return false;
+  while (first > 0 && editor->render_starts[first - 1] >= line_start &&
+         (edit_start - editor->render_starts[first] < CHUNK_ROW_REACH ||
+          line_start + line_len - editor->render_starts[first - 1] <=
+              EDITOR_CHUNK_MAX))
+    first--;
+
+  size_t pos = editor->render_starts[first];
+  size_t resume = first; // first old line that may follow the new ones
+  size_t added = 0;
+  for (;;) {
+    const size_t remaining = line_start + line_len - pos;
+    const size_t copy =
+        remaining > EDITOR_CHUNK_MAX ? EDITOR_CHUNK_MAX + 1 : remaining;
+    if (editor->render_buffer_used + copy + 1 >
+            editor->render_buffer_capacity ||
+        !reserve_render_lines(editor, old_count + added + 1))
+      return false;
+    char *chunk = editor->render_line_buffer + editor->render_buffer_used;
+    char_buffer_copy_range(&editor->chars, pos, copy, chunk);
+    const size_t len = chunk_length(editor, chunk, remaining);
+    set_render_line(editor, old_count + added++, chunk, pos, len);
+    editor->render_buffer_used += len + 1;
+
+    pos += len;
+    bool at_line_start = false;
+    if (pos == line_start + line_len) {
+      if (line + 1 >= line_count) {
+        resume = old_count;
+        break;
+      }
+      line++;
+      line_start = pos + 1;
+      line_len = line_buffer_get(lines, line);
+      pos = line_start;
+      at_line_start = true;
     }
+    if (pos < edit_end)
+      continue;
+    while (resume < old_count &&
+           (ptrdiff_t)editor->render_starts[resume] + delta < (ptrdiff_t)pos)
+      resume++;
+    if (resume < old_count &&
+        (ptrdiff_t)editor->render_starts[resume] + delta == (ptrdiff_t)pos &&
+        starts_line(editor, resume) == at_line_start)
+      break;
+  }
 
-    line_text[line_len] = '\0';
+  // new lines into [first, first + added), the old tail after them
+  const size_t tail = old_count - resume;
+  if (added <= resume - first) {
+    move_render_lines(editor, first, old_count, added);
+    move_render_lines(editor, first + added, resume, tail);
+  } else {
+    const size_t grow = added - (resume - first);
+    if (!reserve_render_lines(editor, old_count + grow + added))
+      return false;
+    move_render_lines(editor, old_count + grow, old_count, added);
+    move_render_lines(editor, resume + grow, resume, tail);
+    move_render_lines(editor, first, old_count + grow, added);
+  }
+  editor->render_line_count = first + added + tail;
+  editor->render_changed_first = first;
+  editor->render_changed_removed = resume - first;
+  editor->render_changed_inserted = added;
+  if (delta != 0) {
+    for (size_t i = first + added; i < editor->render_line_count; i++)
+      editor->render_starts[i] = (size_t)((ptrdiff_t)editor->render_starts[i] + delta);
+  }
+  return true;
+}
 
-    editor->render_buffer_used += line_len + 1;
-    byte_pos += line_len + 1;
+void text_editor_prepare_render_lines(TextEditor *editor) {
+  if (editor->render_revision == editor->revision)
+    return;
+  TRACE_BEGIN("text_editor_prepare_render_lines");
+  const bool recut = !editor->render_full && editor->render_line_count > 0 &&
+                     recut_edited_chunks(editor);
+  if (recut || cut_all_render_lines(editor)) {
+    editor->render_changed_since = recut ? editor->render_revision : 0;
+    editor->render_revision = editor->revision;
   }
+  TRACE_END("text_editor_prepare_render_lines");
+}
+
+void text_editor_set_row_layout(TextEditor *editor, const LayoutCache *cache,
+                                const LayoutStyle *style) {
+  if (editor->row_cache == cache &&
+      memcmp(&editor->row_style, style, sizeof(*style)) == 0)
+    return;
+  editor->row_cache = cache;
+  editor->row_style = *style;
+  editor->render_full = true;
+  editor->revision++;
+}
+
+size_t text_editor_render_line_at(const TextEditor *editor, size_t byte_pos,
+                                  size_t *col) {
+  *col = 0;
+  if (editor->render_line_count == 0)
+    return 0;
+  size_t lo = 0, hi = editor->render_line_count;
+  while (hi - lo > 1) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (editor->render_starts[mid] <= byte_pos)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  const size_t start = editor->render_starts[lo];
+  *col = byte_pos > start ? byte_pos - start : 0;
+  if (*col > editor->render_lengths[lo])
+    *col = editor->render_lengths[lo];
+  return lo;
 }
 
 void text_editor_move_to_pos(TextEditor *editor, size_t byte_pos) {
@@ -291,6 +790,7 @@ void text_editor_move_word_right(TextEditor *editor) {
 }
 
 void text_editor_insert(TextEditor *editor, const char *text, size_t len) {
+  TRACE_BEGIN("text_editor_insert");
 
   if (editor->has_selection) {
     text_editor_delete_selection(editor);
@@ -300,9 +800,11 @@ void text_editor_insert(TextEditor *editor, const char *text, size_t len) {
   text_editor_add_undo(editor, ACTION_INSERT, pos, text, len);
 
   char_buffer_insert(&editor->chars, text, len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, pos, 0, len);
   text_editor_update_cursor_pos(editor);
   text_editor_ensure_cursor_visible(editor);
+
+  TRACE_END("text_editor_insert");
 }
 
 void text_editor_delete_backward(TextEditor *editor) {
@@ -322,18 +824,14 @@ void text_editor_delete_backward(TextEditor *editor) {
     del_len++;
   }
 
-  char *deleted = malloc(del_len);
-  for (size_t i = 0; i < del_len; i++) {
-    deleted[i] = char_buffer_get_at(&editor->chars,
-                                    editor->cursor.byte_pos - del_len + i);
-  }
-  text_editor_add_undo(editor, ACTION_DELETE, editor->cursor.byte_pos - del_len,
-                       deleted, del_len);
-  free(deleted);
+  TRACE_BEGIN("text_editor_delete_backward");
+  text_editor_add_undo_range(editor, ACTION_DELETE,
+                             editor->cursor.byte_pos - del_len, del_len);
 
   char_buffer_delete_backward(&editor->chars, del_len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, editor->cursor.byte_pos - del_len, del_len, 0);
   text_editor_update_cursor_pos(editor);
+  TRACE_END("text_editor_delete_backward");
 }
 
 void text_editor_delete_forward(TextEditor *editor) {
@@ -349,39 +847,32 @@ void text_editor_delete_forward(TextEditor *editor) {
   char c = char_buffer_get_at(&editor->chars, editor->cursor.byte_pos);
   size_t del_len = utf8_char_len(c);
 
-  char *deleted = malloc(del_len);
-  for (size_t i = 0; i < del_len; i++) {
-    deleted[i] =
-        char_buffer_get_at(&editor->chars, editor->cursor.byte_pos + i);
-  }
-  text_editor_add_undo(editor, ACTION_DELETE, editor->cursor.byte_pos, deleted,
-                       del_len);
-  free(deleted);
+  TRACE_BEGIN("text_editor_delete_forward");
+  text_editor_add_undo_range(editor, ACTION_DELETE, editor->cursor.byte_pos,
+                             del_len);
 
   char_buffer_delete_forward(&editor->chars, del_len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, editor->cursor.byte_pos, del_len, 0);
   text_editor_update_cursor_pos(editor);
+  TRACE_END("text_editor_delete_forward");
 }
 
 void text_editor_delete_word_backward(TextEditor *editor) {
   if (editor->cursor.byte_pos == 0)
     return;
 
+  TRACE_BEGIN("text_editor_delete_word_backward");
   size_t start_pos = editor->cursor.byte_pos;
   text_editor_move_word_left(editor);
   size_t end_pos = editor->cursor.byte_pos;
 
   size_t del_len = start_pos - end_pos;
 
-  char *deleted = malloc(del_len);
-  for (size_t i = 0; i < del_len; i++) {
-    deleted[i] = char_buffer_get_at(&editor->chars, end_pos + i);
-  }
-  text_editor_add_undo(editor, ACTION_DELETE, end_pos, deleted, del_len);
-  free(deleted);
+  text_editor_add_undo_range(editor, ACTION_DELETE, end_pos, del_len);
 
   char_buffer_delete_forward(&editor->chars, del_len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, end_pos, del_len, 0);
+  TRACE_END("text_editor_delete_word_backward");
 }
 
 void text_editor_delete_word_forward(TextEditor *editor) {
@@ -389,6 +880,7 @@ void text_editor_delete_word_forward(TextEditor *editor) {
   if (editor->cursor.byte_pos >= text_len)
     return;
 
+  TRACE_BEGIN("text_editor_delete_word_forward");
   size_t start_pos = editor->cursor.byte_pos;
 
   size_t end_pos = start_pos;
@@ -403,15 +895,11 @@ void text_editor_delete_word_forward(TextEditor *editor) {
 
   size_t del_len = end_pos - start_pos;
 
-  char *deleted = malloc(del_len);
-  for (size_t i = 0; i < del_len; i++) {
-    deleted[i] = char_buffer_get_at(&editor->chars, start_pos + i);
-  }
-  text_editor_add_undo(editor, ACTION_DELETE, start_pos, deleted, del_len);
-  free(deleted);
+  text_editor_add_undo_range(editor, ACTION_DELETE, start_pos, del_len);
 
   char_buffer_delete_forward(&editor->chars, del_len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, start_pos, del_len, 0);
+  TRACE_END("text_editor_delete_word_forward");
 }
 
 void text_editor_clear_selection(TextEditor *editor) {
@@ -438,18 +926,15 @@ void text_editor_delete_selection(TextEditor *editor) {
     end = tmp;
   }
 
+  TRACE_BEGIN("text_editor_delete_selection");
   size_t len = end - start;
-  char *deleted = malloc(len);
-  for (size_t i = 0; i < len; i++) {
-    deleted[i] = char_buffer_get_at(&editor->chars, start + i);
-  }
-  text_editor_add_undo(editor, ACTION_DELETE, start, deleted, len);
-  free(deleted);
+  text_editor_add_undo_range(editor, ACTION_DELETE, start, len);
 
   text_editor_move_to_pos(editor, start);
   char_buffer_delete_forward(&editor->chars, len);
-  text_editor_rebuild_lines(editor);
+  text_editor_edited(editor, start, len, 0);
   text_editor_clear_selection(editor);
+  TRACE_END("text_editor_delete_selection");
 }
 
 char *text_editor_get_selection(TextEditor *editor) {
@@ -465,7 +950,7 @@ char *text_editor_get_selection(TextEditor *editor) {
   }
 
   size_t len = end - start;
-  char *text = malloc(len + 1);
+  char *text = core_malloc(len + 1);
   for (size_t i = 0; i < len; i++) {
     text[i] = char_buffer_get_at(&editor->chars, start + i);
   }
@@ -475,77 +960,61 @@ char *text_editor_get_selection(TextEditor *editor) {
 
 void text_editor_add_undo(TextEditor *editor, ActionType type, size_t pos,
                           const char *text, size_t len) {
-  UndoAction *action = malloc(sizeof(UndoAction));
-  action->type = type;
-  action->pos = pos;
-  action->text = malloc(len);
-  memcpy(action->text, text, len);
-  action->len = len;
-
-  if (editor->undo_current) {
-    UndoAction *next = editor->undo_current->next;
-    while (next) {
-      UndoAction *to_free = next;
-      next = next->next;
-      free(to_free->text);
-      free(to_free);
-    }
-    editor->undo_current->next = NULL;
-  }
-
-  action->prev = editor->undo_current;
-  action->next = NULL;
-
-  if (editor->undo_current) {
-    editor->undo_current->next = action;
-  } else {
-    editor->undo_head = action;
+  UndoAction *action = undo_push(&editor->undo, type, pos, len);
+  if (!action)
+    return;
+  if (action->heap_text) {
+    memcpy(action->heap_text, text, len);
+    return;
   }
-
-  editor->undo_current = action;
+  size_t start;
+  size_t first = undo_ring_split(&editor->undo, action, &start);
+  memcpy(editor->undo.text + start, text, first);
+  memcpy(editor->undo.text, text + first, len - first);
 }
 
 void text_editor_undo(TextEditor *editor) {
-  if (!editor->undo_current)
+  if (editor->undo.current == 0)
     return;
 
-  UndoAction *action = editor->undo_current;
+  TRACE_BEGIN("text_editor_undo");
+  UndoAction *action = undo_at(&editor->undo, editor->undo.current - 1);
 
+  text_editor_move_to_pos(editor, action->pos);
   if (action->type == ACTION_INSERT) {
-
-    text_editor_move_to_pos(editor, action->pos);
     char_buffer_delete_forward(&editor->chars, action->len);
+    text_editor_edited(editor, action->pos, action->len, 0);
   } else {
-
-    text_editor_move_to_pos(editor, action->pos);
-    char_buffer_insert(&editor->chars, action->text, action->len);
+    undo_insert_text(editor, action);
+    text_editor_edited(editor, action->pos, 0, action->len);
   }
 
-  text_editor_rebuild_lines(editor);
-  editor->undo_current = action->prev;
+  editor->undo.current--;
+  TRACE_END("text_editor_undo");
 }
 
 void text_editor_redo(TextEditor *editor) {
-  UndoAction *next =
-      editor->undo_current ? editor->undo_current->next : editor->undo_head;
-  if (!next)
+  if (editor->undo.current == editor->undo.count)
     return;
 
-  if (next->type == ACTION_INSERT) {
+  TRACE_BEGIN("text_editor_redo");
+  UndoAction *action = undo_at(&editor->undo, editor->undo.current);
 
-    text_editor_move_to_pos(editor, next->pos);
-    char_buffer_insert(&editor->chars, next->text, next->len);
+  text_editor_move_to_pos(editor, action->pos);
+  if (action->type == ACTION_INSERT) {
+    undo_insert_text(editor, action);
+    text_editor_edited(editor, action->pos, 0, action->len);
   } else {
-
-    text_editor_move_to_pos(editor, next->pos);
-    char_buffer_delete_forward(&editor->chars, next->len);
+    char_buffer_delete_forward(&editor->chars, action->len);
+    text_editor_edited(editor, action->pos, action->len, 0);
   }
 
-  text_editor_rebuild_lines(editor);
-  editor->undo_current = next;
+  editor->undo.current++;
+  TRACE_END("text_editor_redo");
 }
 
 void text_editor_clear(TextEditor *editor) {
+  TRACE_BEGIN("text_editor_clear");
 
   editor->chars.gap_start = editor->chars.buf;
   editor->chars.gap_end = editor->chars.buf + editor->chars.capacity;
@@ -560,19 +1029,14 @@ void text_editor_clear(TextEditor *editor) {
 
   editor->scroll_y = 0;
   editor->target_scroll_y = 0;
+  editor->follow_cursor = false;
 
   editor->render_buffer_used = 0;
   editor->render_line_count = 0;
 
   text_editor_prepare_render_lines(editor);
 
-  UndoAction *action = editor->undo_head;
-  while (action) {
-    UndoAction *next = action->next;
-    free(action->text);
-    free(action);
-    action = next;
-  }
-  editor->undo_head = NULL;
-  editor->undo_current = NULL;
+  undo_reset(&editor->undo);
+
+  TRACE_END("text_editor_clear");
 }
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define EDITOR_H
 
 #include "buffer.h"
+#include "layout_cache.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
   size_t byte_pos;
@@ -13,15 +15,39 @@ typedef struct {
 
 typedef enum { ACTION_INSERT, ACTION_DELETE } ActionType;
 
-typedef struct UndoAction {
+// bounds of a layout chunk of a long line
+#define EDITOR_CHUNK_MIN 2048
+#define EDITOR_CHUNK_MAX 8192
+
+// initial sizes of the undo rings, which double whenever they fill up
+#define UNDO_INITIAL_ACTIONS 32768
+#define UNDO_INITIAL_TEXT (1024 * 1024)
+
+typedef struct {
   ActionType type;
   size_t pos;
-  char *text;
   size_t len;
-  struct UndoAction *next;
-  struct UndoAction *prev;
+  size_t text_offset;
+  char *heap_text;
 } UndoAction;
 
+// Ring of actions plus a byte ring for their text, so recording a keystroke
+// only allocates when a ring doubles; only large edits get a heap block of
+// their own. History is kept in full, the oldest actions are only dropped if
+// a ring can't grow.
+typedef struct {
+  UndoAction *actions;
+  size_t action_capacity;
+  size_t first;
+  size_t count;
+  size_t current;
+
+  char *text;
+  size_t text_capacity;
+  size_t text_head; // text offsets count every byte ever recorded
+  size_t text_tail;
+} UndoHistory;
+
 typedef struct {
   bool dragging;
   bool mouse_down;
@@ -38,10 +64,16 @@ typedef struct {
   size_t sel_start;
   size_t sel_end;
 
-  UndoAction *undo_head;
-  UndoAction *undo_current;
+  UndoHistory undo;
 
+  // One per line, except that lines longer than EDITOR_CHUNK_MAX are laid
+  // out as several chunks. Each chunk after a line's first is cut where a
+  // row of the whole line starts in row_style, so the chunks wrap into the
+  // line's own rows.
   char **render_lines;
+  uint64_t *render_hashes; // layout_hash of each render line
+  size_t *render_starts;   // byte offset in the document
+  size_t *render_lengths;
   size_t render_line_count;
   size_t render_line_capacity;
 
@@ -49,8 +81,38 @@ typedef struct {
   size_t render_buffer_capacity;
   size_t render_buffer_used;
 
+  // bumped whenever the lines change; the render lines are only updated
+  // once it has moved
+  uint64_t revision;
+  uint64_t render_revision;
+  // Bytes [edit_start, edit_end) of the document were written by the edits
+  // since the render lines were last cut, which made it edit_delta bytes
+  // longer. Only the chunks around them are cut again, unless render_full
+  // says the lines were rebuilt from scratch.
+  size_t edit_start, edit_end;
+  ptrdiff_t edit_delta;
+  bool render_full;
+  // measures the rows chunks are cut along; NULL cuts them anywhere
+  const LayoutCache *row_cache;
+  LayoutStyle row_style;
+  // What the last text_editor_prepare_render_lines changed: of the render
+  // lines of render_changed_since, render_changed_removed from
+  // render_changed_first were replaced by render_changed_inserted new ones.
+  // render_changed_since is 0 after a full cut.
+  uint64_t render_changed_since;
+  size_t render_changed_first;
+  size_t render_changed_removed;
+  size_t render_changed_inserted;
+
+  // lines ui.c laid out as text last frame, the rest stand in as spacers
+  size_t layout_first;
+  size_t layout_end;
+
   float scroll_y;
   float target_scroll_y;
+  // set by text_editor_ensure_cursor_visible; ui.c scrolls to the caret once
+  // the line heights are known and clears it
+  bool follow_cursor;
 
   MouseState mouse;
 } TextEditor;
@@ -61,6 +123,14 @@ void text_editor_rebuild_lines(TextEditor *editor);
 void text_editor_update_cursor_pos(TextEditor *editor);
 void text_editor_ensure_cursor_visible(TextEditor *editor);
 void text_editor_prepare_render_lines(TextEditor *editor);
+// Cuts the chunks of long lines along the rows of style from now on, cutting
+// them all again if that changes anything.
+void text_editor_set_row_layout(TextEditor *editor, const LayoutCache *cache,
+                                const LayoutStyle *style);
+// Render line holding byte_pos and the offset into it; a position where one
+// chunk ends and the next begins is at the start of the next.
+size_t text_editor_render_line_at(const TextEditor *editor, size_t byte_pos,
+                                  size_t *col);
 void text_editor_clear(TextEditor *editor);
 
 void text_editor_move_to_pos(TextEditor *editor, size_t byte_pos);
@@ -1,4 +1,5 @@
 #include "files.h"
+#include "trace.h"
 #include <dirent.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,21 +20,29 @@
 #include "pick.h"
 
 bool files_ensure_directory(const char *path) {
+  TRACE_BEGIN("files_ensure_directory");
   struct stat st = {0};
+  bool ok;
   if (stat(path, &st) == -1) {
 #ifdef _WIN32
-    return mkdir(path) == 0;
+    ok = mkdir(path) == 0;
 #else
-    return mkdir(path, 0755) == 0;
+    ok = mkdir(path, 0755) == 0;
 #endif
+  } else {
+    ok = S_ISDIR(st.st_mode);
   }
-  return S_ISDIR(st.st_mode);
+  TRACE_END("files_ensure_directory");
+  return ok;
 }
 
 bool files_read_file(const char *path, char **out_data, size_t *out_size) {
+  TRACE_BEGIN("files_read_file");
   FILE *file = fopen(path, "rb");
-  if (!file)
+  if (!file) {
+    TRACE_END("files_read_file");
     return false;
+  }
 
   fseek(file, 0, SEEK_END);
   long size = ftell(file);
@@ -41,12 +50,14 @@ bool files_read_file(const char *path, char **out_data, size_t *out_size) {
 
   if (size < 0) {
     fclose(file);
+    TRACE_END("files_read_file");
     return false;
   }
 
   char *data = malloc(size + 1);
   if (!data) {
     fclose(file);
+    TRACE_END("files_read_file");
     return false;
   }
 
@@ -55,6 +66,7 @@ bool files_read_file(const char *path, char **out_data, size_t *out_size) {
 
   if (read != (size_t)size) {
     free(data);
+    TRACE_END("files_read_file");
     return false;
   }
 
@@ -62,13 +74,18 @@ bool files_read_file(const char *path, char **out_data, size_t *out_size) {
   *out_data = data;
   if (out_size)
     *out_size = size;
+  TRACE_COUNTER("files_read_bytes", size);
+  TRACE_END("files_read_file");
   return true;
 }
 
 bool files_read_bytes(const char *path, uint8_t **out_data, size_t *out_size) {
+  TRACE_BEGIN("files_read_bytes");
   FILE *file = fopen(path, "rb");
-  if (!file)
+  if (!file) {
+    TRACE_END("files_read_bytes");
     return false;
+  }
 
   fseek(file, 0, SEEK_END);
   long size = ftell(file);
@@ -76,12 +93,14 @@ bool files_read_bytes(const char *path, uint8_t **out_data, size_t *out_size) {
 
   if (size < 0) {
     fclose(file);
+    TRACE_END("files_read_bytes");
     return false;
   }
 
   uint8_t *data = malloc(size);
   if (!data) {
     fclose(file);
+    TRACE_END("files_read_bytes");
     return false;
   }
 
@@ -90,22 +109,30 @@ bool files_read_bytes(const char *path, uint8_t **out_data, size_t *out_size) {
 
   if (read != (size_t)size) {
     free(data);
+    TRACE_END("files_read_bytes");
     return false;
   }
 
   *out_data = data;
   if (out_size)
     *out_size = size;
+  TRACE_COUNTER("files_read_bytes", size);
+  TRACE_END("files_read_bytes");
   return true;
 }
 
 bool files_write_file(const char *path, const char *data, size_t size) {
+  TRACE_BEGIN("files_write_file");
   FILE *file = fopen(path, "wb");
-  if (!file)
+  if (!file) {
+    TRACE_END("files_write_file");
     return false;
+  }
 
   size_t written = fwrite(data, 1, size, file);
   fclose(file);
+  TRACE_COUNTER("files_written_bytes", written);
+  TRACE_END("files_write_file");
   return written == size;
 }
 
@@ -187,7 +214,10 @@ bool files_delete_file(const char *path) {
     fprintf(stderr, "Invalid path for deletion: %s\n", path);
     return false;
   }
-  return remove(path) == 0;
+  TRACE_BEGIN("files_delete_file");
+  bool removed = remove(path) == 0;
+  TRACE_END("files_delete_file");
+  return removed;
 }
 
 static void on_delete_confirm(PickButtonResult result, void *user_data) {
@@ -240,9 +270,12 @@ void files_delete_confirm(const char *path, void (*callback)(bool success, void
 
 
 bool files_list_directory(const char *path, FileList *out_list) {
+  TRACE_BEGIN("files_list_directory");
   DIR *dir = opendir(path);
-  if (!dir)
+  if (!dir) {
+    TRACE_END("files_list_directory");
     return false;
+  }
 
   out_list->count = 0;
   if (!out_list->items) {
@@ -281,6 +314,8 @@ bool files_list_directory(const char *path, FileList *out_list) {
   }
 
   closedir(dir);
+  TRACE_COUNTER("files_listed", out_list->count);
+  TRACE_END("files_list_directory");
   return true;
 }
 
@@ -0,0 +1,26 @@
+#ifndef FONT_INFO_H
+#define FONT_INFO_H
+
+#include "stb_truetype.h"
+
+// stb_truetype is compiled once, by fontstash in main.c, and the modules that
+// read fonts directly use fontstash's parsed fonts rather than their own.
+// fontstash points stb_truetype's allocator at its scratch buffer, so calls
+// that allocate, such as stbtt_GetGlyphSDF, follow font_info_scratch_reset
+// and their result is copied out before the next fontstash call.
+
+// fontstash's font for a handle, NULL when there is none
+const stbtt_fontinfo *font_info(int font_id);
+
+void font_info_scratch_reset(void);
+
+// Pen step of a glyph the way fontstash takes it: the advance in font units
+// is scaled, truncated to the tenths of a pixel fontstash stores and rounded
+// to whole pixels. Placing or measuring text with any other rounding drifts
+// from fontstash's layout by a pixel every few glyphs.
+static inline int font_info_advance_px(float scale, int advance) {
+  const short xadv = (short)(scale * (float)advance * 10.0f);
+  return (int)(xadv / 10.0f + 0.5f);
+}
+
+#endif
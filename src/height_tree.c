@@ -0,0 +1,193 @@
+#include "height_tree.h"
+#include "alloc.h"
+#include <string.h>
+
+#define HEIGHT_TREE_MIN_CAPACITY 256
+
+void height_tree_init(HeightTree *tree) { memset(tree, 0, sizeof(*tree)); }
+
+void height_tree_destroy(HeightTree *tree) {
+  core_free(tree->heights);
+  core_free(tree->tree);
+  memset(tree, 0, sizeof(*tree));
+}
+
+static bool height_tree_reserve(HeightTree *tree, size_t slots) {
+  if (slots <= tree->capacity)
+    return true;
+  size_t capacity = tree->capacity ? tree->capacity : HEIGHT_TREE_MIN_CAPACITY;
+  while (capacity < slots)
+    capacity *= 2;
+  float *heights = core_realloc(tree->heights, capacity * sizeof(float));
+  if (!heights)
+    return false;
+  tree->heights = heights;
+  double *sums = core_realloc(tree->tree, (capacity + 1) * sizeof(double));
+  if (!sums)
+    return false;
+  tree->tree = sums;
+  memset(tree->heights + tree->capacity, 0,
+         (capacity - tree->capacity) * sizeof(float));
+  tree->capacity = capacity;
+  return true;
+}
+
+static size_t height_tree_log2(size_t n) {
+  size_t log = 1;
+  while (n >>= 1)
+    log++;
+  return log;
+}
+
+static size_t height_tree_slot(const HeightTree *tree, size_t line) {
+  return line < tree->gap_start ? line : line + tree->gap_len;
+}
+
+static void height_tree_add(HeightTree *tree, size_t slot, double delta) {
+  for (size_t i = slot + 1; i <= tree->capacity; i += i & -i)
+    tree->tree[i] += delta;
+}
+
+// moves the height in slot from to the empty slot to
+static void height_tree_move(HeightTree *tree, size_t from, size_t to) {
+  const float height = tree->heights[from];
+  tree->heights[from] = 0.0f;
+  tree->heights[to] = height;
+  if (height != 0.0f) {
+    height_tree_add(tree, from, -(double)height);
+    height_tree_add(tree, to, height);
+  }
+}
+
+bool height_tree_resize(HeightTree *tree, size_t count) {
+  if (!height_tree_reserve(tree, count))
+    return false;
+  memset(tree->heights + count, 0,
+         (tree->capacity - count) * sizeof(float));
+  tree->count = count;
+  tree->gap_start = count;
+  tree->gap_len = tree->capacity - count;
+  return true;
+}
+
+void height_tree_rebuild(HeightTree *tree) {
+  if (!tree->tree)
+    return;
+  tree->tree[0] = 0.0;
+  for (size_t i = 1; i <= tree->capacity; i++)
+    tree->tree[i] = tree->heights[i - 1];
+  for (size_t i = 1; i <= tree->capacity; i++) {
+    const size_t parent = i + (i & -i);
+    if (parent <= tree->capacity)
+      tree->tree[parent] += tree->tree[i];
+  }
+}
+
+bool height_tree_splice(HeightTree *tree, size_t at, size_t removed,
+                        size_t inserted) {
+  if (at > tree->count || removed > tree->count - at)
+    return false;
+  if (inserted > tree->gap_len + removed) {
+    // a wider gap at the edit, resummed once; doubling keeps it amortized
+    const size_t old_capacity = tree->capacity;
+    const size_t tail = tree->count - tree->gap_start;
+    if (!height_tree_reserve(tree, tree->count - removed + inserted))
+      return false;
+    memmove(tree->heights + tree->capacity - tail,
+            tree->heights + old_capacity - tail, tail * sizeof(float));
+    memset(tree->heights + tree->gap_start, 0,
+           (tree->capacity - tail - tree->gap_start) * sizeof(float));
+    tree->gap_len = tree->capacity - tree->count;
+    height_tree_rebuild(tree);
+  }
+
+  // Gap to at. Each line it passes costs two point updates, so a long way
+  // off, as after a resize left it at the end, the heights are moved in one
+  // memmove and the tree resummed instead.
+  const size_t distance =
+      at > tree->gap_start ? at - tree->gap_start : tree->gap_start - at;
+  if (distance > tree->capacity / height_tree_log2(tree->capacity)) {
+    if (at < tree->gap_start)
+      memmove(tree->heights + at + tree->gap_len, tree->heights + at,
+              distance * sizeof(float));
+    else
+      memmove(tree->heights + tree->gap_start,
+              tree->heights + tree->gap_start + tree->gap_len,
+              distance * sizeof(float));
+    tree->gap_start = at;
+    memset(tree->heights + at, 0, tree->gap_len * sizeof(float));
+    height_tree_rebuild(tree);
+  }
+  while (tree->gap_start > at) {
+    tree->gap_start--;
+    height_tree_move(tree, tree->gap_start,
+                     tree->gap_start + tree->gap_len);
+  }
+  while (tree->gap_start < at) {
+    height_tree_move(tree, tree->gap_start + tree->gap_len,
+                     tree->gap_start);
+    tree->gap_start++;
+  }
+
+  // removed lines join the gap, inserted ones take slots from its front
+  for (size_t i = 0; i < removed; i++) {
+    const size_t slot = tree->gap_start + tree->gap_len;
+    height_tree_add(tree, slot, -(double)tree->heights[slot]);
+    tree->heights[slot] = 0.0f;
+    tree->gap_len++;
+  }
+  tree->count -= removed;
+  tree->gap_start += inserted;
+  tree->gap_len -= inserted;
+  tree->count += inserted;
+  return true;
+}
+
+void height_tree_set(HeightTree *tree, size_t line, float height) {
+  if (line >= tree->count)
+    return;
+  const size_t slot = height_tree_slot(tree, line);
+  const double delta = (double)height - tree->heights[slot];
+  tree->heights[slot] = height;
+  height_tree_add(tree, slot, delta);
+}
+
+float height_tree_get(const HeightTree *tree, size_t line) {
+  return line < tree->count ? tree->heights[height_tree_slot(tree, line)]
+                            : 0.0f;
+}
+
+float height_tree_top(const HeightTree *tree, size_t line) {
+  if (line > tree->count)
+    line = tree->count;
+  double sum = 0.0;
+  for (size_t i = height_tree_slot(tree, line); i > 0; i -= i & -i)
+    sum += tree->tree[i];
+  return (float)sum;
+}
+
+float height_tree_total(const HeightTree *tree) {
+  return height_tree_top(tree, tree->count);
+}
+
+size_t height_tree_line_at(const HeightTree *tree, float y) {
+  if (tree->count == 0)
+    return 0;
+  // the most slots whose heights sum to no more than y
+  size_t step = 1;
+  while (step * 2 <= tree->capacity)
+    step *= 2;
+  size_t pos = 0;
+  double left = y;
+  for (; step > 0; step /= 2) {
+    if (pos + step <= tree->capacity && tree->tree[pos + step] <= left) {
+      pos += step;
+      left -= tree->tree[pos];
+    }
+  }
+  size_t line = pos;
+  if (pos >= tree->gap_start)
+    line = pos < tree->gap_start + tree->gap_len ? tree->gap_start
+                                                 : pos - tree->gap_len;
+  return line < tree->count ? line : tree->count - 1;
+}
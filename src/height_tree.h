@@ -0,0 +1,51 @@
+#ifndef HEIGHT_TREE_H
+#define HEIGHT_TREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Wrapped heights of the editor's lines in a Fenwick tree, so changing one
+// line's height, the y of a line and the line at a y each take O(log n) on
+// documents of any length. Sums are kept in doubles; a long session of
+// single-line updates doesn't drift the way float sums would.
+//
+// The tree runs over slots rather than lines, with a gap of empty slots like
+// a gap buffer's. Lines coming or going at an edit take or leave gap slots,
+// and moving the gap to the next edit moves only the lines in between, each
+// as two point updates, so typing never resums the document.
+
+typedef struct {
+  float *heights; // per slot, 0 in the gap
+  double *tree;   // 1-based partial sums over the slots
+  size_t count;   // lines
+  size_t gap_start, gap_len;
+  size_t capacity; // slots
+} HeightTree;
+
+void height_tree_init(HeightTree *tree);
+void height_tree_destroy(HeightTree *tree);
+
+// Makes room for count lines, with the gap after the last one. Their heights
+// are then written straight into tree->heights and summed up with
+// height_tree_rebuild.
+bool height_tree_resize(HeightTree *tree, size_t count);
+// O(n), for after a resize or a pass that changed most lines
+void height_tree_rebuild(HeightTree *tree);
+
+// Replaces the removed lines from at with inserted lines of height 0, for
+// height_tree_set to fill in. O(log n) per line moved, removed or inserted,
+// except when the gap has to grow, which resums the tree.
+bool height_tree_splice(HeightTree *tree, size_t at, size_t removed,
+                        size_t inserted);
+
+void height_tree_set(HeightTree *tree, size_t line, float height);
+float height_tree_get(const HeightTree *tree, size_t line);
+
+// sum of the heights of the lines before line; line may be count
+float height_tree_top(const HeightTree *tree, size_t line);
+float height_tree_total(const HeightTree *tree);
+
+// the line whose extent holds y, clamped to the first and last line
+size_t height_tree_line_at(const HeightTree *tree, float y);
+
+#endif
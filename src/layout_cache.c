@@ -0,0 +1,409 @@
+#include "layout_cache.h"
+#include "alloc.h"
+#include <string.h>
+
+#define LAYOUT_CACHE_MIN_CAPACITY 256
+// generations an entry may go unused before it can be dropped for room
+#define LAYOUT_CACHE_MAX_IDLE 4
+
+static bool layout_is_continuation(char c) {
+  return ((unsigned char)c & 0xC0) == 0x80;
+}
+
+uint64_t layout_hash(const char *text, size_t len) {
+  // eight bytes a step; it only has to tell lines apart within one run
+  const uint64_t k = 0xC4CEB9FE1A85EC53ull;
+  uint64_t h = 0x9E3779B97F4A7C15ull ^ ((uint64_t)len * k);
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, text + i, 8);
+    h = (h ^ v) * k;
+    h ^= h >> 29;
+  }
+  uint64_t tail = 0;
+  memcpy(&tail, text + i, len - i);
+  h = (h ^ tail) * k;
+  return h ^ (h >> 32);
+}
+
+static uint64_t layout_slot_key(const LayoutStyle *style, uint64_t hash) {
+  const uint64_t k = 0xFF51AFD7ED558CCDull;
+  uint32_t wrap_width, line_height;
+  memcpy(&wrap_width, &style->wrap_width, sizeof(wrap_width));
+  memcpy(&line_height, &style->line_height, sizeof(line_height));
+  uint64_t key = hash;
+  key = (key ^ (uint32_t)style->font_id) * k;
+  key = (key ^ (uint32_t)style->font_size) * k;
+  key = (key ^ (uint32_t)style->letter_spacing) * k;
+  key = (key ^ wrap_width) * k;
+  key = (key ^ line_height) * k;
+  return key ^ (key >> 32);
+}
+
+static bool layout_same_style(const LayoutStyle *a, const LayoutStyle *b) {
+  return a->font_id == b->font_id && a->font_size == b->font_size &&
+         a->letter_spacing == b->letter_spacing &&
+         a->line_height == b->line_height && a->wrap_width == b->wrap_width;
+}
+
+// the entry for the key, or the free slot it would go in
+static LayoutLine *layout_find(LayoutCache *cache, const LayoutStyle *style,
+                               uint64_t hash, size_t len) {
+  const size_t mask = cache->capacity - 1;
+  for (size_t i = layout_slot_key(style, hash) & mask;; i = (i + 1) & mask) {
+    LayoutLine *line = &cache->slots[i];
+    if (!line->used || (line->hash == hash && line->len == len &&
+                        layout_same_style(&line->style, style)))
+      return line;
+  }
+}
+
+static bool layout_is_idle(const LayoutCache *cache, const LayoutLine *line) {
+  return cache->generation - line->last_used > LAYOUT_CACHE_MAX_IDLE;
+}
+
+static void layout_release(LayoutLine *line) {
+  core_free(line->row_starts);
+  core_free(line->caret_x);
+}
+
+// Moves the entries into a table of capacity slots, dropping idle ones if
+// drop_idle is set.
+static bool layout_rehash(LayoutCache *cache, size_t capacity, bool drop_idle) {
+  LayoutLine *slots = core_malloc(capacity * sizeof(LayoutLine));
+  if (!slots)
+    return false;
+  memset(slots, 0, capacity * sizeof(LayoutLine));
+
+  LayoutLine *old = cache->slots;
+  const size_t old_capacity = cache->capacity;
+  cache->slots = slots;
+  cache->capacity = capacity;
+  cache->count = 0;
+  for (size_t i = 0; i < old_capacity; i++) {
+    LayoutLine *line = &old[i];
+    if (!line->used)
+      continue;
+    if (drop_idle && layout_is_idle(cache, line)) {
+      layout_release(line);
+      cache->stats.evicted++;
+      continue;
+    }
+    *layout_find(cache, &line->style, line->hash, line->len) = *line;
+    cache->count++;
+  }
+  core_free(old);
+  cache->stats.lines = (uint32_t)cache->count;
+  return true;
+}
+
+// keeps the load at most 3/4 with one more entry
+static bool layout_make_room(LayoutCache *cache) {
+  if ((cache->count + 1) * 4 <= cache->capacity * 3)
+    return true;
+  size_t live = 0;
+  for (size_t i = 0; i < cache->capacity; i++) {
+    if (cache->slots[i].used && !layout_is_idle(cache, &cache->slots[i]))
+      live++;
+  }
+  size_t capacity = LAYOUT_CACHE_MIN_CAPACITY;
+  while (capacity < (live + 1) * 2)
+    capacity *= 2;
+  return layout_rehash(cache, capacity, true);
+}
+
+void layout_cache_init(LayoutCache *cache, LayoutMeasureFn measure,
+                       void *user_data) {
+  memset(cache, 0, sizeof(*cache));
+  cache->measure = measure;
+  cache->user_data = user_data;
+}
+
+void layout_cache_destroy(LayoutCache *cache) {
+  for (size_t i = 0; i < cache->capacity; i++) {
+    if (cache->slots[i].used)
+      layout_release(&cache->slots[i]);
+  }
+  core_free(cache->slots);
+  memset(cache, 0, sizeof(*cache));
+}
+
+void layout_cache_next_generation(LayoutCache *cache) { cache->generation++; }
+
+void layout_cache_forget(LayoutCache *cache, const LayoutStyle *style,
+                         uint64_t hash, size_t len) {
+  if (cache->count == 0)
+    return;
+  LayoutLine *line = layout_find(cache, style, hash, len);
+  if (!line->used)
+    return;
+  if (line->held_in == cache->generation && line->holds > 1) {
+    line->holds--;
+    return;
+  }
+  layout_release(line);
+
+  // backward shift: later entries of the probe run move up into the hole
+  // whenever the hole is no further from their home slot than they are
+  const size_t mask = cache->capacity - 1;
+  size_t hole = (size_t)(line - cache->slots);
+  for (size_t i = (hole + 1) & mask; cache->slots[i].used; i = (i + 1) & mask) {
+    LayoutLine *next = &cache->slots[i];
+    const size_t home = layout_slot_key(&next->style, next->hash) & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      cache->slots[hole] = *next;
+      hole = i;
+    }
+  }
+  memset(&cache->slots[hole], 0, sizeof(LayoutLine));
+  cache->count--;
+  cache->stats.evicted++;
+  cache->stats.lines = (uint32_t)cache->count;
+}
+
+static float layout_measure(const LayoutCache *cache, const char *str,
+                            size_t len) {
+  return len > 0 ? cache->measure(str, len, cache->user_data) : 0.0f;
+}
+
+static bool layout_push_row(LayoutLine *line, uint32_t *capacity,
+                            size_t start) {
+  if (line->rows == *capacity) {
+    uint32_t grown = *capacity ? *capacity * 2 : 4;
+    uint32_t *starts =
+        core_realloc(line->row_starts, grown * sizeof(uint32_t));
+    if (!starts)
+      return false;
+    line->row_starts = starts;
+    *capacity = grown;
+  }
+  line->row_starts[line->rows++] = (uint32_t)start;
+  return true;
+}
+
+// Longest prefix of word no wider than width, but at least one codepoint.
+// The whole word is known not to fit.
+static size_t layout_fit(const LayoutCache *cache, const char *word,
+                         size_t len, float width) {
+  size_t lo = 1;
+  while (lo < len && layout_is_continuation(word[lo]))
+    lo++;
+  size_t hi = len;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    while (mid < hi && layout_is_continuation(word[mid]))
+      mid++;
+    if (mid == hi)
+      break;
+    if (layout_measure(cache, word, mid) <= width)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+typedef struct {
+  float width;
+  float spacing;
+  float space_width;
+  size_t start; // next byte to place
+  size_t row_start;
+  size_t row_len;
+  float row_width;
+} LayoutWrap;
+
+static LayoutWrap layout_wrap_begin(const LayoutCache *cache,
+                                    const LayoutStyle *style) {
+  return (LayoutWrap){.width = style->wrap_width,
+                      .spacing = (float)style->letter_spacing,
+                      .space_width = layout_measure(cache, " ", 1)};
+}
+
+// Clay's word wrap, with the words that overflow a row on their own broken
+// instead of left to run past it. Places words until a row is complete and
+// returns its start in *row, or false once the text runs out first. A row
+// is only complete once the word after it is known not to fit, so the rows
+// found in a prefix of a line are rows of the whole line too.
+static bool layout_wrap_row(const LayoutCache *cache, LayoutWrap *wrap,
+                            const char *text, size_t len, size_t *row) {
+  while (wrap->start < len) {
+    const size_t start = wrap->start;
+    size_t end = start;
+    while (end < len && text[end] != ' ')
+      end++;
+    const bool space = end < len;
+    const size_t word_len = end - start + space;
+    const float bare_width = layout_measure(cache, text + start, end - start);
+    const float word_width = bare_width + (space ? wrap->space_width : 0.0f);
+
+    // a word that fits without its space keeps it at the end of the row
+    if (wrap->row_len == 0 && bare_width > wrap->width) {
+      const size_t fit =
+          end > start
+              ? layout_fit(cache, text + start, end - start, wrap->width)
+              : 0;
+      *row = start;
+      // what is left of the word starts the next row
+      wrap->start += fit > 0 && fit < end - start ? fit : word_len;
+      wrap->row_start = wrap->start;
+      return true;
+    }
+    if (wrap->row_len > 0 && wrap->row_width + word_width > wrap->width) {
+      *row = wrap->row_start;
+      wrap->row_width = 0.0f;
+      wrap->row_len = 0;
+      wrap->row_start = start;
+      return true;
+    }
+    wrap->row_width += word_width + wrap->spacing;
+    wrap->row_len += word_len;
+    wrap->start += word_len;
+  }
+  return false;
+}
+
+static bool layout_wrap(const LayoutCache *cache, LayoutLine *line,
+                        const char *text, size_t len) {
+  LayoutWrap wrap = layout_wrap_begin(cache, &line->style);
+  uint32_t capacity = 0;
+  size_t row;
+  while (layout_wrap_row(cache, &wrap, text, len, &row)) {
+    if (!layout_push_row(line, &capacity, row))
+      return false;
+  }
+  // an empty line is still a row, as Clay lays out the editor's " "
+  if ((wrap.row_len > 0 || line->rows == 0) &&
+      !layout_push_row(line, &capacity, wrap.row_start))
+    return false;
+  line->height = (float)line->rows * line->style.line_height;
+  return true;
+}
+
+size_t layout_next_row_start(const LayoutCache *cache,
+                             const LayoutStyle *style, const char *text,
+                             size_t len, size_t from) {
+  LayoutWrap wrap = layout_wrap_begin(cache, style);
+  size_t row;
+  while (layout_wrap_row(cache, &wrap, text, len, &row)) {
+    if (row >= from)
+      return row;
+  }
+  return 0;
+}
+
+const LayoutLine *layout_cache_get(LayoutCache *cache, const LayoutStyle *style,
+                                   uint64_t hash, const char *text,
+                                   size_t len) {
+  if (cache->capacity > 0) {
+    LayoutLine *line = layout_find(cache, style, hash, len);
+    if (line->used) {
+      line->last_used = cache->generation;
+      cache->stats.hits++;
+      return line;
+    }
+  }
+
+  if (!layout_make_room(cache))
+    return NULL;
+  LayoutLine *line = layout_find(cache, style, hash, len);
+  *line = (LayoutLine){.hash = hash,
+                       .len = (uint32_t)len,
+                       .style = *style,
+                       .last_used = cache->generation};
+  if (!layout_wrap(cache, line, text, len)) {
+    layout_release(line);
+    *line = (LayoutLine){0};
+    return NULL;
+  }
+  line->used = true;
+  cache->count++;
+  cache->stats.misses++;
+  cache->stats.lines = (uint32_t)cache->count;
+  return line;
+}
+
+const LayoutLine *layout_cache_hold(LayoutCache *cache,
+                                    const LayoutStyle *style, uint64_t hash,
+                                    const char *text, size_t len) {
+  if (!layout_cache_get(cache, style, hash, text, len))
+    return NULL;
+  LayoutLine *line = layout_find(cache, style, hash, len);
+  if (line->held_in != cache->generation) {
+    line->held_in = cache->generation;
+    line->holds = 0;
+  }
+  line->holds++;
+  return line;
+}
+
+static size_t layout_next_codepoint(const char *text, size_t b, size_t end) {
+  b++;
+  while (b < end && layout_is_continuation(text[b]))
+    b++;
+  return b;
+}
+
+// One pass per row. The measurement steps the pen per glyph by its advance
+// plus the kerning and spacing against the glyph before, so each codepoint
+// adds what it measures together with its left neighbour less what that
+// neighbour measures alone.
+static bool layout_carets(const LayoutCache *cache, LayoutLine *line,
+                          const char *text) {
+  float *x = core_malloc((line->len + 1) * sizeof(float));
+  if (!x)
+    return false;
+  for (uint32_t r = 0; r < line->rows; r++) {
+    const size_t row_start = line->row_starts[r];
+    const size_t row_end =
+        r + 1 < line->rows ? line->row_starts[r + 1] : line->len;
+    x[row_start] = 0.0f;
+    size_t prev = row_start; // start of the codepoint before b
+    float prev_width = 0.0f;
+    for (size_t b = row_start; b < row_end;) {
+      const size_t next = layout_next_codepoint(text, b, row_end);
+      const float width = layout_measure(cache, text + b, next - b);
+      x[next] = b == row_start
+                    ? width
+                    : x[b] + layout_measure(cache, text + prev, next - prev) -
+                          prev_width;
+      for (size_t c = b + 1; c < next; c++)
+        x[c] = x[b];
+      prev = b;
+      prev_width = width;
+      b = next;
+    }
+  }
+  line->caret_x = x;
+  return true;
+}
+
+void layout_cache_caret(LayoutCache *cache, const LayoutStyle *style,
+                        uint64_t hash, const char *text, size_t len,
+                        size_t byte, uint32_t *row, float *x) {
+  *row = 0;
+  *x = 0.0f;
+  LayoutLine *line = (LayoutLine *)layout_cache_get(cache, style, hash, text,
+                                                    len);
+  if (!line || (!line->caret_x && !layout_carets(cache, line, text)))
+    return;
+  if (byte > len)
+    byte = len;
+
+  // the last row starting at or before byte
+  uint32_t lo = 0, hi = line->rows;
+  while (hi - lo > 1) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (line->row_starts[mid] <= byte)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  *row = lo;
+  *x = line->caret_x[byte];
+}
+
+LayoutCacheStats layout_cache_stats(const LayoutCache *cache) {
+  return cache->stats;
+}
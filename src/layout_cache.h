@@ -0,0 +1,115 @@
+#ifndef LAYOUT_CACHE_H
+#define LAYOUT_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Wrapped layout of editor lines kept across frames, keyed by a hash of the
+// line's text together with everything that shapes it: font, size, spacing
+// and wrap width. An edited line hashes differently and is wrapped again;
+// unchanged lines, wherever they move to, are found again. After a font,
+// size or width change each line misses once under its new key, while the
+// entries for the old style stay until they age out, so switching back is
+// free.
+//
+// Lines wrap the way Clay wraps CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD text:
+// words run up to the next space, which stays with the word, and a word too
+// wide for a row of its own is broken after the last codepoint that fits.
+
+// width of [str, str + len) as the layout's text measurement has it
+typedef float (*LayoutMeasureFn)(const char *str, size_t len, void *user_data);
+
+typedef struct {
+  int font_id;
+  int font_size;
+  int letter_spacing;
+  float line_height; // of one wrapped row
+  float wrap_width;
+} LayoutStyle;
+
+typedef struct {
+  uint64_t hash;
+  uint32_t len;
+  LayoutStyle style;
+  bool used;
+  uint32_t last_used; // generation
+  uint32_t holds;     // from layout_cache_hold, in generation held_in
+  uint32_t held_in;
+
+  uint32_t rows;
+  uint32_t *row_starts; // byte offset each row starts at, rows entries
+  float height;
+  // caret x for every byte offset up to len, from the left of its row;
+  // NULL until layout_cache_caret first asks for it
+  float *caret_x;
+} LayoutLine;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses; // lines wrapped
+  uint64_t evicted;
+  uint32_t lines; // entries held
+} LayoutCacheStats;
+
+typedef struct {
+  LayoutMeasureFn measure;
+  void *user_data;
+
+  LayoutLine *slots; // open addressing, capacity a power of two
+  size_t capacity;
+  size_t count;
+  uint32_t generation;
+  LayoutCacheStats stats;
+} LayoutCache;
+
+void layout_cache_init(LayoutCache *cache, LayoutMeasureFn measure,
+                       void *user_data);
+void layout_cache_destroy(LayoutCache *cache);
+
+// the hash layout_cache_get keys text on
+uint64_t layout_hash(const char *text, size_t len);
+
+// Starts a new generation. Entries not looked up in the last few are
+// dropped when the table needs room, so call this once per full pass over
+// the document's lines rather than once per frame.
+void layout_cache_next_generation(LayoutCache *cache);
+
+// The layout of text, whose layout_hash is hash, wrapped in style. The
+// pointer stays valid until the next layout_cache_get or layout_cache_caret.
+const LayoutLine *layout_cache_get(LayoutCache *cache, const LayoutStyle *style,
+                                   uint64_t hash, const char *text,
+                                   size_t len);
+
+// Row of the caret before byte of text and its x from the left of that row.
+// byte is clamped to len; a caret at a row break sits at the start of the
+// next row.
+void layout_cache_caret(LayoutCache *cache, const LayoutStyle *style,
+                        uint64_t hash, const char *text, size_t len,
+                        size_t byte, uint32_t *row, float *x);
+
+// layout_cache_get for a line of the document, which holds on to the entry
+// until layout_cache_forget gives the line up. Identical lines, blank ones
+// above all, share one entry and each hold it. Holds count within the
+// current generation only.
+const LayoutLine *layout_cache_hold(LayoutCache *cache,
+                                    const LayoutStyle *style, uint64_t hash,
+                                    const char *text, size_t len);
+
+// Gives up a hold for a line an edit replaced, and drops the entry with its
+// last one. Lines that are typed over never come back, so forgetting them as
+// they go keeps the table the size of the document.
+void layout_cache_forget(LayoutCache *cache, const LayoutStyle *style,
+                         uint64_t hash, size_t len);
+
+// The first row at or after byte from of a line that wraps in style, where
+// text is the line from the start of a row on, cut off anywhere; 0 if no row
+// starts there before the text runs out. Rows near the end of a cut-off text
+// are not known yet, and none is given for them.
+size_t layout_next_row_start(const LayoutCache *cache,
+                             const LayoutStyle *style, const char *text,
+                             size_t len, size_t from);
+
+LayoutCacheStats layout_cache_stats(const LayoutCache *cache);
+
+#endif
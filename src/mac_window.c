@@ -1,5 +1,7 @@
 #ifdef __APPLE__
 #include <Foundation/Foundation.h>
+#include <dispatch/dispatch.h>
+#include <math.h>
 #include <objc/message.h>
 #include <objc/objc.h>
 #include <objc/runtime.h>
@@ -10,6 +12,8 @@ extern const void *sapp_macos_get_window(void);
 
 static IMP original_mouseDown = NULL;
 static IMP original_windowWillResize = NULL;
+// bumped on every pause and resume, so a stale timer leaves the view alone
+static uintptr_t frame_pause_generation = 0;
 
 static const CGFloat MIN_WINDOW_WIDTH = 800.0;
 static const CGFloat MIN_WINDOW_HEIGHT = 600.0;
@@ -205,4 +209,56 @@ void app_make_compact_window(bool show_controls) {
   app_install_resize_handler();
 }
 
-#endif
\ No newline at end of file
+// sokol draws from the window's MTKView; nil if the view can't be paused
+static id frame_view(void) {
+  id window = (id)sapp_macos_get_window();
+  if (!window)
+    return nil;
+  id view =
+      ((id (*)(id, SEL))objc_msgSend)(window, sel_registerName("contentView"));
+  if (!view || !((BOOL (*)(id, SEL, SEL))objc_msgSend)(
+                   view, sel_registerName("respondsToSelector:"),
+                   sel_registerName("setPaused:")))
+    return nil;
+  return view;
+}
+
+void app_resume_frames(void) {
+  id view = frame_view();
+  if (!view)
+    return;
+  frame_pause_generation++;
+  ((void (*)(id, SEL, BOOL))objc_msgSend)(view, sel_registerName("setPaused:"),
+                                          NO);
+}
+
+static void resume_after_pause(void *context) {
+  if ((uintptr_t)context == frame_pause_generation)
+    app_resume_frames();
+}
+
+static void resume_now(void *context) {
+  (void)context;
+  app_resume_frames();
+}
+
+void app_wake_frames(void) {
+  dispatch_async_f(dispatch_get_main_queue(), NULL, resume_now);
+}
+
+bool app_pause_frames(double seconds) {
+  id view = frame_view();
+  if (!view)
+    return false;
+  ((void (*)(id, SEL, BOOL))objc_msgSend)(view, sel_registerName("setPaused:"),
+                                          YES);
+  frame_pause_generation++;
+  if (isinf(seconds))
+    return true;
+  dispatch_after_f(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(seconds * 1e9)),
+                   dispatch_get_main_queue(),
+                   (void *)frame_pause_generation, resume_after_pause);
+  return true;
+}
+
+#endif
@@ -11,7 +11,17 @@
 #define SOKOL_GLCORE33
 #endif
 
+#if defined(ANDEX_HEADLESS)
+// andex_frame_bench drives the app itself: bench/headless_app.c provides the
+// sapp_* functions over an offscreen EGL context
+#define SOKOL_GFX_IMPL
+#define SOKOL_GLUE_IMPL
+#define SOKOL_GP_IMPL
+#define SOKOL_LOG_IMPL
+#define SOKOL_TIME_IMPL
+#else
 #define SOKOL_IMPL
+#endif
 #include "sokol_app.h"
 #include "sokol_gfx.h"
 #include "sokol_glue.h"
@@ -37,7 +47,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#define FONS_VERTEX_COUNT 128
+// fontstash's vertex array only stages glyphs for text_batch now, so a long
+// line fits in one copy
+#define FONS_VERTEX_COUNT 1536
+// declarations first; fontstash compiles the one stb_truetype implementation
+#include "font_info.h"
 #define FONTSTASH_IMPLEMENTATION
 #include "fontstash.h"
 #define SOKOL_FONTSTASH_IMPL
@@ -48,13 +62,24 @@
 #define SOKOL_CLAY_IMPL
 #include "sokol_clay.h"
 
+#include "anim.h"
+#include "app.h"
 #include "buffer.h"
 #include "editor.h"
 #include "files.h"
+#include "profiler.h"
+#include "replay.h"
+#include "res.h"
 #include "resources.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "text_batch.h"
+#include "text_measure.h"
+#include "text_sdf.h"
+#include "trace.h"
+#include "ui.h"
+
+#if defined(ANDEX_BAKED_GLYPHS)
+#include "glyph_atlas.h"
+#endif
 
 #define APP_MIN_WIDTH 1280
 #define APP_MIN_HEIGHT 720
@@ -62,213 +87,37 @@
 extern void app_make_compact_window(bool show_controls);
 extern void app_set_minimum_window_size(float width, float height);
 #endif
+#if defined(__APPLE__) && !defined(ANDEX_HEADLESS)
+// Stops the view sokol draws from until app_resume_frames or until seconds
+// pass (INFINITY for no timer), so the run loop sleeps in the OS and handles
+// input the moment it arrives. false if the view can't be paused.
+// app_wake_frames resumes it from any thread.
+extern bool app_pause_frames(double seconds);
+extern void app_resume_frames(void);
+extern void app_wake_frames(void);
+#define APP_PAUSES_FRAMES
+#endif
 
-#define BOTTOM_BAR_HEIGHT 68.0f
-#define SIDEBAR_WIDTH 220.0f
-
-typedef struct {
-  char id[64];
-  char date[32];
-  char filename[256];
-  char preview[64];
-  time_t timestamp;
-  bool is_selected;
-} FileEntry;
-
-typedef struct {
-  FileEntry *entries;
-  size_t count;
-  size_t capacity;
-  int selected_index;
-} FileHistory;
-
-typedef struct {
-  Clay_Color background;
-  Clay_Color sidebar_bg;
-  Clay_Color text_primary;
-  Clay_Color text_secondary;
-  Clay_Color border;
-  Clay_Color selection;
-  Clay_Color hover;
-} Theme;
-
-static const Theme LIGHT_THEME = {
-    .background = {248, 248, 248, 255},
-    .sidebar_bg = {245, 245, 245, 255},
-    .text_primary = {0, 0, 0, 255},
-    .text_secondary = {128, 128, 128, 255},
-    .border = {230, 230, 230, 255},
-    .selection = {100, 149, 237, 80},
-    .hover = {240, 240, 240, 255},
-};
-
-static const Theme DARK_THEME = {
-    .background = {40, 40, 40, 255},
-    .sidebar_bg = {30, 30, 30, 255},
-    .text_primary = {230, 230, 230, 255},
-    .text_secondary = {153, 153, 153, 255},
-    .border = {60, 60, 60, 255},
-    .selection = {100, 149, 237, 80},
-    .hover = {50, 50, 50, 255},
-};
-
-static const Clay_String EMPTY_STRING = CLAY_STRING(" ");
-
-static const int font_sizes[] = {22, 24, 26, 28, 30, 32, 34};
-static const int num_font_sizes = sizeof(font_sizes) / sizeof(font_sizes[0]);
-static Clay_String font_size_strings[] = {
-    CLAY_STRING("22px"), CLAY_STRING("24px"), CLAY_STRING("26px"),
-    CLAY_STRING("28px"), CLAY_STRING("30px"), CLAY_STRING("32px"),
-    CLAY_STRING("34px")};
-
-static const Clay_String WELCOME_MESSAGES[] = {
-    CLAY_STRING("Start typing to begin..."),
-    CLAY_STRING("Begin writing"),
-    CLAY_STRING("Pick a thought and go"),
-    CLAY_STRING("What's on your mind"),
-    CLAY_STRING("Just start"),
-    CLAY_STRING("Type your first thought"),
-    CLAY_STRING("Start with one sentence"),
-    CLAY_STRING("Just say it")};
-
-static const int WELCOME_MESSAGES_COUNT =
-    sizeof(WELCOME_MESSAGES) / sizeof(WELCOME_MESSAGES[0]);
-
-static const Clay_String *selected_welcome_message = NULL;
-
-static const Clay_String *get_welcome_message() {
-  if (selected_welcome_message == NULL) {
-    int index = rand() % WELCOME_MESSAGES_COUNT;
-    selected_welcome_message = &WELCOME_MESSAGES[index];
-  }
-  return selected_welcome_message;
-}
-
-typedef struct {
-  sg_pipeline pip;
-  sg_bindings bind;
-  globals_t uniforms;
-  float cursor_x;
-  float cursor_y;
-  float cursor_height;
-} CursorState;
-
-typedef struct {
-  float x, y;
-  float r, g, b, a;
-} SelectionVertex;
-
-typedef struct {
-  sg_pipeline pip;
-  sg_buffer vbuf;
-  sg_buffer ibuf;
-  SelectionVertex *vertices;
-  uint16_t *indices;
-  int capacity_quads;
-} SelectionState;
-
-typedef enum {
-  APP_WINDOW_NORMAL,
-  APP_WINDOW_FULLSCREEN,
-  APP_WINDOW_MINIMIZED
-} AppWindowState;
-
-typedef struct {
-  bool initialized;
-  Theme theme;
-  bool dark_mode;
-  bool lol;
-
-  int font_size_index;
-  int current_font_index;
-
-  float screen_width;
-  float screen_height;
-
-  TextEditor editor;
-  char current_filename[256];
-  char documents_path[512];
-
-  bool show_sidebar;
-  FileHistory history;
-  int hovered_entry_index;
-
-  int timer_seconds;
-  bool timer_running;
-  uint64_t last_timer_update;
-  char timer_string[6];
-  float bottom_nav_opacity;
-  bool bottom_nav_hovering;
-  uint64_t bottom_nav_fade_time;
-
-  uint64_t last_save_time;
-  bool needs_save;
-
-  CursorState cursor;
-  SelectionState selection;
-  void *current_line_tag;
+// rates are tuned to match the old per-frame steps at 60 Hz
+#define SCROLL_EASE_FACTOR 0.2f
+#define BOTTOM_NAV_FADE_OUT_SPEED 1.2f
+#define BOTTOM_NAV_FADE_IN_SPEED 3.0f
+#define BOTTOM_NAV_FADE_DELAY 1.0
+#define AUTOSAVE_INTERVAL 60.0
 
-  uint64_t start_time;
-  AppWindowState window_state;
+// must match the constants in cursor_fs (shaders.glsl)
+#define CURSOR_TRAIL_SECONDS 0.5f
+#define CURSOR_BLINK_SPEED 1.0f
 
-  struct {
-    sclay_image images[RES_IMG_COUNT];
-    sclay_font_t fonts[RES_FONT_COUNT];
-    svg_element_t icons[RES_ICON_COUNT];
-  } gfx;
-} AppState;
+#define PROFILER_REFRESH_FRAMES 15
 
-static AppState *g_app = NULL;
+AppState *g_app = NULL;
 
 typedef struct {
     int index;
 } DeleteEntryContext;
 
 
-static sclay_image make_image_from_embed(const EmbeddedBlob *blob) {
-  int w = 0, h = 0, comp = 0;
-  stbi_uc *pixels =
-      stbi_load_from_memory(blob->data, (int)blob->size, &w, &h, &comp, 4);
-  if (!pixels) {
-    fprintf(stderr, "stb_image failed to load %s\n", blob->name);
-    exit(1);
-  }
-
-  size_t img_size = w * h * 4;
-
-  sg_image img = sg_make_image(&(sg_image_desc){
-      .width = w,
-      .height = h,
-      .pixel_format = SG_PIXELFORMAT_RGBA8,
-      .data.subimage[0][0] = {.ptr = pixels, .size = img_size},
-      .label = blob->name,
-  });
-
-  stbi_image_free(pixels);
-
-  if (blob->as.image.uv) {
-    sg_sampler sampler =
-        sg_make_sampler(&(sg_sampler_desc){.min_filter = SG_FILTER_LINEAR,
-                                           .mag_filter = SG_FILTER_LINEAR,
-                                           .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
-                                           .wrap_v = SG_WRAP_CLAMP_TO_EDGE});
-
-    sclay_image sclayImg = sclay_make_image_region(
-        img, sampler, blob->as.image.uv->u0, blob->as.image.uv->v0,
-        blob->as.image.uv->u1, blob->as.image.uv->v1);
-    return sclayImg;
-  }
-
-  return sclay_make_image(img, sg_make_sampler(&(sg_sampler_desc){
-                                   .min_filter = SG_FILTER_LINEAR,
-                                   .mag_filter = SG_FILTER_LINEAR,
-                               }));
-}
-
-sclay_font_t get_current_font() {
-  return g_app->gfx.fonts[g_app->current_font_index];
-}
-
 static const void* get_current_window() {
 #if defined(__APPLE__)
   return sapp_macos_get_window();
@@ -339,6 +188,8 @@ static void save_current_entry() {
   if (!g_app->needs_save)
     return;
 
+  TRACE_BEGIN("save_current_entry");
+
   char filepath[768];
   snprintf(filepath, sizeof(filepath), "%s/%s", g_app->documents_path,
            g_app->current_filename);
@@ -362,9 +213,11 @@ static void save_current_entry() {
 
     free(text);
   }
+  TRACE_END("save_current_entry");
 }
 
 static void load_entry(FileEntry *entry) {
+  TRACE_BEGIN("load_entry");
   save_current_entry();
 
   char filepath[768];
@@ -383,6 +236,7 @@ static void load_entry(FileEntry *entry) {
 
   strcpy(g_app->current_filename, entry->filename);
   g_app->needs_save = false;
+  TRACE_END("load_entry");
 }
 
 static int compare_entries(const void *a, const void *b) {
@@ -392,9 +246,12 @@ static int compare_entries(const void *a, const void *b) {
 }
 
 static void load_existing_entries() {
+  TRACE_BEGIN("load_existing_entries");
   FileList list = {0};
-  if (!files_list_directory(g_app->documents_path, &list))
+  if (!files_list_directory(g_app->documents_path, &list)) {
+    TRACE_END("load_existing_entries");
     return;
+  }
 
   g_app->history.count = 0;
 
@@ -497,6 +354,8 @@ static void load_existing_entries() {
       load_entry(&g_app->history.entries[0]);
     }
   }
+  TRACE_COUNTER("history_entries", g_app->history.count);
+  TRACE_END("load_existing_entries");
 }
 
 static void export_entry(int index) {
@@ -578,36 +437,6 @@ static void delete_entry(int index) {
     files_delete_confirm(filepath, on_entry_deleted, get_current_window(), ctx);
 }
 
-static Theme *get_current_theme() {
-  return g_app->dark_mode ? (Theme *)&DARK_THEME : (Theme *)&LIGHT_THEME;
-}
-
-static Clay_Color get_background_color() {
-  return get_current_theme()->background;
-}
-
-static Clay_Color get_sidebar_bg_color() {
-  return get_current_theme()->sidebar_bg;
-}
-
-static Clay_Color get_text_color() { return get_current_theme()->text_primary; }
-
-static Clay_Color get_secondary_text_color() {
-  return get_current_theme()->text_secondary;
-}
-
-static Clay_Color get_ui_text_color() {
-  return Clay_Hovered() ? get_text_color() : get_secondary_text_color();
-}
-
-static Clay_Color get_border_color() { return get_current_theme()->border; }
-
-static Clay_Color get_selection_color() {
-  return get_current_theme()->selection;
-}
-
-static Clay_Color get_hover_color() { return get_current_theme()->hover; }
-
 static void timer_init(int seconds) {
   g_app->timer_seconds = seconds;
   g_app->timer_running = false;
@@ -640,6 +469,10 @@ static uint64_t timer_update(void) {
     snprintf(g_app->timer_string, sizeof(g_app->timer_string), "%d:%02d",
              minutes, seconds);
   }
+
+  if (g_app->timer_running) {
+    anim_wake_after(&g_app->anim, g_app->last_timer_update, 1.0);
+  }
   return now;
 }
 
@@ -668,14 +501,22 @@ static size_t caret_byte_from_xy(TextEditor *editor,
   if (line_count == 0)
     return 0;
 
+  // only the lines laid out as text have elements; the rest are off screen
+  size_t first = editor->layout_first;
+  size_t end = editor->layout_end;
+  if (first >= end || end > line_count) {
+    first = 0;
+    end = line_count;
+  }
+
   int target_line = -1;
   float first_top = 0.0f, last_bottom = 0.0f;
-  for (size_t i = 0; i < line_count; i++) {
+  for (size_t i = first; i < end; i++) {
     Clay_ElementId line_id = CLAY_IDI("EditorLine", i);
     Clay_ElementData line_data = Clay_GetElementData(line_id);
-    if (i == 0)
+    if (i == first)
       first_top = line_data.boundingBox.y;
-    if (i == line_count - 1)
+    if (i == end - 1)
       last_bottom = line_data.boundingBox.y + line_data.boundingBox.height;
 
     if (my >= line_data.boundingBox.y &&
@@ -685,16 +526,12 @@ static size_t caret_byte_from_xy(TextEditor *editor,
     }
   }
   if (target_line < 0) {
-    target_line = (my < first_top) ? 0 : (int)line_count - 1;
-  }
-
-  size_t byte_prefix = 0;
-  for (int i = 0; i < target_line; i++) {
-    byte_prefix += strlen(editor->render_lines[i]) + 1;
+    target_line = (my < first_top) ? (int)first : (int)end - 1;
   }
 
+  size_t byte_prefix = editor->render_starts[target_line];
   const char *line_chars = editor->render_lines[target_line];
-  size_t line_len = strlen(line_chars);
+  size_t line_len = editor->render_lengths[target_line];
   if (line_len == 0) {
     return byte_prefix;
   }
@@ -990,6 +827,8 @@ static void handle_mouse_input(const sapp_event *ev) {
     }
   } else if (ev->type == SAPP_EVENTTYPE_MOUSE_SCROLL) {
     editor->target_scroll_y -= ev->scroll_y * 40.0f;
+    if (editor->target_scroll_y > ui_editor_scroll_limit())
+      editor->target_scroll_y = ui_editor_scroll_limit();
     if (editor->target_scroll_y < 0)
       editor->target_scroll_y = 0;
   }
@@ -1101,499 +940,13 @@ void HandleEntryDelete(Clay_ElementId elementId, Clay_PointerData pointerData,
   }
 }
 
-Clay_ElementDeclaration IconButtonStyle(bool hovered, float size,
-                                        Clay_ElementId id) {
-  return (Clay_ElementDeclaration){
-      .id = id,
-      .layout = {.sizing = {CLAY_SIZING_FIXED(size), CLAY_SIZING_FIXED(size)}}};
-}
-
-Clay_ElementDeclaration IconStyle(svg_element_t *icon, bool hovered,
-                                  uint32_t normal_color, uint32_t hover_color,
-                                  float_t opacity) {
-  uint32_t color = hovered ? hover_color : normal_color;
-  icon->fill_color = color;
-  icon->stroke_color = color;
-  icon->opacity_override = opacity;
-
-  return (Clay_ElementDeclaration){
-      .custom = {.customData = icon},
-      .layout = {.sizing = {CLAY_SIZING_GROW(), CLAY_SIZING_GROW()}}};
-}
-
-void HandleIconButtonInteraction(Clay_ElementId elementId,
-                                 Clay_PointerData pointerData,
-                                 intptr_t userData) {
-  void (*onClick)(void) = (void (*)(void))userData;
-  if (pointerData.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME && onClick) {
-    onClick();
-  }
-}
-
-void RenderIconButton(Clay_String id, int icon_idx, uint32_t normal_color,
-                      uint32_t hover_color, void (*onClick)(void), float size,
-                      float_t opacity) {
-  CLAY(IconButtonStyle(Clay_Hovered(), size, Clay_GetElementId(id))) {
-    Clay_OnHover(HandleIconButtonInteraction, (intptr_t)onClick);
-    svg_element_t *icon = &g_app->gfx.icons[icon_idx];
-    CLAY(IconStyle(icon, Clay_Hovered(), normal_color, hover_color, opacity)) {}
-  }
-}
-
-static void toggleHistoryBar(void) {
-  g_app->show_sidebar = !g_app->show_sidebar;
-}
-
-static void toggleTheme(void) { g_app->dark_mode = !g_app->dark_mode; }
-
-static void HandleOpenDirectory(Clay_ElementId elementId,
-                                Clay_PointerData pointerData,
-                                intptr_t userData) {
+void HandleOpenDirectory(Clay_ElementId elementId, Clay_PointerData pointerData,
+                         intptr_t userData) {
   if (pointerData.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME) {
     files_open_directory(g_app->documents_path);
   }
 }
 
-static void render_sidebar() {
-  if (!g_app->show_sidebar)
-    return;
-
-  CLAY({.id = CLAY_ID("Sidebar"),
-        .backgroundColor = get_sidebar_bg_color(),
-        .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
-                   .sizing = {CLAY_SIZING_FIXED(SIDEBAR_WIDTH),
-                              CLAY_SIZING_GROW(0)}}}) {
-
-    CLAY({.id = CLAY_ID("SidebarHeader"),
-          .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
-                     .padding = {12, 16, 10, 16},
-                     .layoutDirection = CLAY_TOP_TO_BOTTOM,
-                     .childGap = 4},
-          .clip = {.horizontal = true}}) {
-
-      CLAY({.layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
-                       .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
-                       .childAlignment = {.y = CLAY_ALIGN_Y_CENTER},
-                       .childGap = 4}}) {
-
-        Clay_OnHover(HandleOpenDirectory, 0);
-        bool header_hover = Clay_Hovered();
-
-        CLAY_TEXT(CLAY_STRING("History"),
-                  CLAY_TEXT_CONFIG({.fontId = 0,
-                                    .fontSize = 16,
-                                    .textColor = get_ui_text_color()}));
-
-        Clay_Color icon_color = get_ui_text_color();
-        uint32_t icon_color_hex =
-            ((uint8_t)(icon_color.r) << 24) | ((uint8_t)(icon_color.g) << 16) |
-            ((uint8_t)(icon_color.b) << 8) | ((uint8_t)(icon_color.a));
-        svg_element_t *open_icon = &g_app->gfx.icons[RES_ICON_TURN_UP_RIGHT];
-        open_icon->fill_color = icon_color_hex;
-        open_icon->stroke_color = icon_color_hex;
-
-        CLAY({.custom = {.customData = open_icon},
-              .layout = {
-                  .sizing = {CLAY_SIZING_FIXED(12), CLAY_SIZING_FIXED(12)}}}) {}
-      }
-
-      Clay_String p = {.chars = g_app->documents_path,
-                       .isStaticallyAllocated = true,
-                       .length = (int)strlen(g_app->documents_path)};
-      CLAY_TEXT(p, CLAY_TEXT_CONFIG(
-                       {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                        .fontSize = 10,
-                        .textColor = get_secondary_text_color(),
-                        .wrapMode = CLAY_TEXT_WRAP_NONE}));
-    }
-
-    CLAY({.backgroundColor = get_border_color(),
-          .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(1)}}}) {}
-
-    CLAY({.id = CLAY_ID("EntriesList"),
-          .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
-                     .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
-          .clip = {.vertical = true}}) {
-
-      for (size_t i = 0; i < g_app->history.count; i++) {
-        FileEntry *entry = &g_app->history.entries[i];
-        Clay_ElementId row_id = CLAY_IDI("HistoryRow", i);
-        bool row_hover = Clay_PointerOver(row_id);
-
-        Clay_Color row_bg =
-            entry->is_selected
-                ? (Clay_Color){255, 255, 255, 14}
-                : (row_hover ? get_hover_color() : (Clay_Color){0, 0, 0, 0});
-
-        CLAY({.id = row_id,
-              .backgroundColor = row_bg,
-              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
-                         .padding = {8, 16, 8, 16},
-                         .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
-                         .childAlignment = {.y = CLAY_ALIGN_Y_CENTER}},
-              .clip = {.horizontal = true}}) {
-
-          CLAY({.layout = {
-                    .layoutDirection = CLAY_TOP_TO_BOTTOM,
-                    .childGap = 4,
-                    .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)}}}) {
-
-            Clay_String pv_s;
-            pv_s = entry->preview[0]
-                       ? (Clay_String){.chars = entry->preview,
-                                       .isStaticallyAllocated = true,
-                                       .length = (int)strlen(entry->preview)}
-                       : CLAY_STRING("(empty)");
-            CLAY_TEXT(pv_s,
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = get_text_color(),
-                           .wrapMode = CLAY_TEXT_WRAP_NONE}));
-
-            Clay_String date = {.chars = entry->date,
-                                .isStaticallyAllocated = true,
-                                .length = (int)strlen(entry->date)};
-            CLAY_TEXT(date,
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 15,
-                           .textColor = get_secondary_text_color(),
-                           .wrapMode = CLAY_TEXT_WRAP_NONE}));
-          }
-
-          if (row_hover) {
-            Clay_ElementId export_id = CLAY_IDI("Export", i);
-            bool hot = Clay_PointerOver(export_id);
-            uint32_t base = g_app->dark_mode ? 0xA0A0A0FF : 0x808080FF;
-            uint32_t on = g_app->dark_mode ? 0xFFFFFFFF : 0x000000FF;
-            uint32_t col = hot ? on : base;
-            svg_element_t *ic = &g_app->gfx.icons[RES_ICON_ARROW_DOWN_CIRCLE];
-            ic->fill_color = col;
-            ic->stroke_color = col;
-            CLAY({.id = export_id,
-                  .custom = {.customData = ic},
-                  .layout = {.sizing = {CLAY_SIZING_FIXED(12),
-                                        CLAY_SIZING_FIXED(12)}}}) {
-              Clay_OnHover(HandleEntryExport, (intptr_t)i);
-            }
-
-            CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(8),
-                                        CLAY_SIZING_FIXED(1)}}}) {}
-
-            Clay_ElementId del_id = CLAY_IDI("Delete", i);
-            bool hot2 = Clay_PointerOver(del_id);
-            uint32_t col2 = hot2 ? 0xFF5A5AFF
-                                 : (g_app->dark_mode ? 0xB8B8B8FF : 0x808080FF);
-            svg_element_t *ic2 = &g_app->gfx.icons[RES_ICON_TRASH];
-            ic2->fill_color = col2;
-            ic2->stroke_color = col2;
-            CLAY({.id = del_id,
-                  .custom = {.customData = ic2},
-                  .layout = {.sizing = {CLAY_SIZING_FIXED(12),
-                                        CLAY_SIZING_FIXED(12)}}}) {
-              Clay_OnHover(HandleEntryDelete, (intptr_t)i);
-            }
-          }
-        }
-
-        if (row_hover) {
-          g_app->hovered_entry_index = (int)i;
-          Clay_OnHover(HandleEntrySelect, (intptr_t)i);
-        } else if (g_app->hovered_entry_index == (int)i) {
-          g_app->hovered_entry_index = -1;
-        }
-
-        if (i < g_app->history.count - 1) {
-          CLAY({.backgroundColor = get_border_color(),
-                .layout = {
-                    .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(1)}}}) {}
-        }
-      }
-    }
-  }
-}
-
-static void render_editor_ui() {
-  TextEditor *editor = &g_app->editor;
-
-  CLAY({.id = CLAY_ID("MainContainer"),
-        .backgroundColor = get_background_color(),
-        .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
-                   .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}}}) {
-
-    CLAY({.id = CLAY_ID("ContentArea"),
-          .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
-                     .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}}}) {
-
-      CLAY(
-          {.id = CLAY_ID("EditorContainer"),
-           .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
-                      .childAlignment = {.x = CLAY_ALIGN_X_CENTER}},
-           .clip = {.vertical = true, .childOffset = {0, -editor->scroll_y}}}) {
-        if (g_app->lol) {
-          CLAY({.image = {.imageData = &g_app->gfx.images[RES_IMG_WIN]},
-                .layout = {.sizing = {CLAY_SIZING_FIXED(512.0f),
-                                      CLAY_SIZING_FIXED(512.0f)}},
-                .floating = {
-                    .attachTo = CLAY_ATTACH_TO_PARENT,
-                    .attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER,
-                                     .parent = CLAY_ATTACH_POINT_CENTER_CENTER},
-                    .zIndex = 100}}) {}
-        }
-
-        CLAY({.id = CLAY_ID("TextEditor"),
-              .layout = {
-                  .sizing = {CLAY_SIZING_FIXED(650.0f), CLAY_SIZING_FIT(0, 0)},
-                  .padding = {40, 40, 40, 40},
-                  .layoutDirection = CLAY_TOP_TO_BOTTOM}}) {
-
-          if (editor->render_line_count == 0 ||
-              (editor->render_line_count == 1 &&
-               strlen(editor->render_lines[0]) == 0)) {
-            CLAY_TEXT(*get_welcome_message(),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = get_current_font(),
-                           .fontSize = font_sizes[g_app->font_size_index],
-                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
-                           .textColor = get_secondary_text_color(),
-                           .textAlignment = CLAY_TEXT_ALIGN_CENTER}));
-          } else {
-            for (size_t i = 0; i < editor->render_line_count; i++) {
-              Clay_ElementId line_id = CLAY_IDI("EditorLine", i);
-              void *line_tag =
-                  (i == editor->cursor.line) ? &g_app->current_line_tag : NULL;
-
-              CLAY({.id = line_id,
-                    .layout = {.sizing = {CLAY_SIZING_FIT(0, 0),
-                                          CLAY_SIZING_GROW(0)}}}) {
-                if (strlen(editor->render_lines[i]) > 0) {
-                  Clay_String text = {.chars = editor->render_lines[i],
-                                      .isStaticallyAllocated = true,
-                                      .length =
-                                          (int)strlen(editor->render_lines[i])};
-
-                  CLAY_TEXT(
-                      text,
-                      CLAY_TEXT_CONFIG(
-                          {.userData = line_tag,
-                           .textColor = get_text_color(),
-                           .fontId = get_current_font(),
-                           .fontSize = font_sizes[g_app->font_size_index],
-                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
-                           .wrapMode = CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD,
-                           .textAlignment = CLAY_TEXT_ALIGN_LEFT}));
-                } else {
-                  CLAY_TEXT(
-                      EMPTY_STRING,
-                      CLAY_TEXT_CONFIG(
-                          {.userData = line_tag,
-                           .textColor = get_text_color(),
-                           .fontId = get_current_font(),
-                           .fontSize = font_sizes[g_app->font_size_index],
-                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
-                           .wrapMode = CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD,
-                           .textAlignment = CLAY_TEXT_ALIGN_LEFT}));
-                }
-              }
-            }
-          }
-        }
-      }
-
-      CLAY(
-          {.id = CLAY_ID("BottomNav"),
-           .backgroundColor = get_background_color(),
-           .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(68.0f)},
-                      .padding = {16, 16, 16, 16},
-                      .childAlignment = {.y = CLAY_ALIGN_Y_CENTER}}}) {
-
-        bool is_hovering = Clay_Hovered();
-        g_app->bottom_nav_hovering = is_hovering;
-
-        if (is_hovering && g_app->timer_running) {
-          g_app->bottom_nav_opacity = 1.0f;
-        }
-
-        float opacity = g_app->bottom_nav_opacity;
-        Clay_Color dot_color = get_secondary_text_color();
-        dot_color.a = (uint8_t)(dot_color.a * opacity);
-        CLAY({.id = CLAY_ID("FontControls"),
-              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
-                         .childGap = 8,
-                         .padding = {8, 8, 8, 8}}}) {
-
-          CLAY({.id = CLAY_ID("FontSize")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(font_size_strings[g_app->font_size_index],
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFontSizeChange, 0);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("FontLato")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("Lato"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_LATO_REGULAR);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("FontArial")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("Arial"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_ARIAL);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("FontSerif")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("Serif"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_SERIF);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("FontMono")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("Mono"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_FIRA_MONO);
-          }
-        }
-
-        CLAY({.layout = {
-                  .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(0.0f)}}}) {}
-
-        CLAY({.id = CLAY_ID("UtilityControls"),
-              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
-                         .childGap = 8,
-                         .padding = {8, 8, 8, 8}}}) {
-
-          CLAY({.id = CLAY_ID("Timer")}) {
-            Clay_String time = {.chars = g_app->timer_string,
-                                .isStaticallyAllocated = true,
-                                .length = (int)strlen(g_app->timer_string)};
-            Clay_Color timer_color =
-                g_app->timer_running ? get_text_color() : get_ui_text_color();
-            timer_color.a = (uint8_t)(timer_color.a * opacity);
-            CLAY_TEXT(time,
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = timer_color}));
-            Clay_OnHover(HandleTimerToggle, 0);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("ChatButton")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("Chat"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleLulCow, 0);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("FullscreenButton")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(g_app->window_state == APP_WINDOW_FULLSCREEN
-                          ? CLAY_STRING("Minimize")
-                          : CLAY_STRING("Fullscreen"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleFullscreenToggle, 0);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          CLAY({.id = CLAY_ID("NewEntryButton")}) {
-            Clay_Color text_color = get_ui_text_color();
-            text_color.a = (uint8_t)(text_color.a * opacity);
-            CLAY_TEXT(CLAY_STRING("New Entry"),
-                      CLAY_TEXT_CONFIG(
-                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
-                           .fontSize = 16,
-                           .textColor = text_color}));
-            Clay_OnHover(HandleNewEntry, 0);
-          }
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          uint32_t icon_normal = g_app->dark_mode ? 0x808080FF : 0x808080FF;
-          uint32_t icon_hover = g_app->dark_mode ? 0xFFFFFFFF : 0x000000FF;
-
-          uint8_t alpha_normal = (uint8_t)(0x80 * opacity);
-          uint8_t alpha_hover = (uint8_t)(0xFF * opacity);
-          icon_normal = (icon_normal & 0xFFFFFF00) | alpha_normal;
-          icon_hover = (icon_hover & 0xFFFFFF00) | alpha_hover;
-
-          RenderIconButton(CLAY_STRING("ThemeToggle"),
-                           g_app->dark_mode ? RES_ICON_SUN : RES_ICON_MOON,
-                           icon_normal, icon_hover, toggleTheme, 16.0f,
-                           opacity);
-
-          CLAY_TEXT(CLAY_STRING("•"),
-                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
-
-          RenderIconButton(CLAY_STRING("HistoryButton"), RES_ICON_HISTORY,
-                           icon_normal, icon_hover, toggleHistoryBar, 16.0f,
-                           opacity);
-        }
-      }
-    }
-
-    if (g_app->show_sidebar) {
-      CLAY(
-          {.backgroundColor = get_border_color(),
-           .layout = {.sizing = {CLAY_SIZING_FIXED(1), CLAY_SIZING_GROW(0)}}}) {
-      }
-      render_sidebar();
-    }
-  }
-}
-
 static void render_selection_quads(Clay_RenderCommandArray commands) {
   TextEditor *editor = &g_app->editor;
 
@@ -1622,18 +975,22 @@ static void render_selection_quads(Clay_RenderCommandArray commands) {
   float b = sel_color.b / 255.0f;
   float a = sel_color.a / 255.0f;
 
-  size_t byte_pos = 0;
+  // only the lines laid out as text have anything to highlight
+  size_t first = editor->layout_first;
+  size_t end = editor->layout_end;
+  if (first >= end || end > editor->render_line_count) {
+    first = 0;
+    end = editor->render_line_count;
+  }
 
-  for (size_t line_idx = 0; line_idx < editor->render_line_count; line_idx++) {
+  for (size_t line_idx = first; line_idx < end; line_idx++) {
     const char *line_chars = editor->render_lines[line_idx];
-    size_t line_len = strlen(line_chars);
-    size_t line_start = byte_pos;
-    size_t line_end = byte_pos + line_len;
+    size_t line_len = editor->render_lengths[line_idx];
+    size_t line_start = editor->render_starts[line_idx];
+    size_t line_end = line_start + line_len;
 
-    if (sel_end <= line_start || sel_start > line_end) {
-      byte_pos += line_len + 1;
+    if (sel_end <= line_start || sel_start > line_end)
       continue;
-    }
 
     int32_t sel_in_line_start =
         (int32_t)((sel_start > line_start) ? (sel_start - line_start) : 0);
@@ -1741,8 +1098,6 @@ static void render_selection_quads(Clay_RenderCommandArray commands) {
         sel_quad_count++;
       }
     }
-
-    byte_pos += line_len + 1;
   }
 
   if (sel_quad_count > 0) {
@@ -1765,7 +1120,9 @@ static void render_selection_quads(Clay_RenderCommandArray commands) {
 
 static void update_cursor_position(Clay_RenderCommandArray commands) {
   TextEditor *editor = &g_app->editor;
-  size_t col = editor->cursor.col;
+  size_t col;
+  const size_t line =
+      text_editor_render_line_at(editor, editor->cursor.byte_pos, &col);
   bool caret_set = false;
 
   Clay_RenderCommand *last_cmd = NULL;
@@ -1831,8 +1188,18 @@ static void update_cursor_position(Clay_RenderCommandArray commands) {
     caret_set = true;
   }
 
+  // a line out of view has no element, the layout cache still places it
+  float cache_x, cache_y;
+  if (!caret_set && ui_editor_caret(line, col, &cache_x, &cache_y)) {
+    g_app->cursor.cursor_x = cache_x;
+    g_app->cursor.cursor_y = cache_y;
+    g_app->cursor.cursor_height =
+        (float)(font_sizes[g_app->font_size_index] - 2);
+    caret_set = true;
+  }
+
   if (!caret_set) {
-    Clay_ElementId line_id = CLAY_IDI("EditorLine", editor->cursor.line);
+    Clay_ElementId line_id = CLAY_IDI("EditorLine", line);
     Clay_ElementData line_data = Clay_GetElementData(line_id);
     if (line_data.found) {
       g_app->cursor.cursor_x = line_data.boundingBox.x;
@@ -1842,9 +1209,34 @@ static void update_cursor_position(Clay_RenderCommandArray commands) {
   }
 }
 
+// The cursor shader draws a trail right after a move and then blinks through
+// smoothstep(0.3, 0.7, sin * 0.5 + 0.5). Outside of those ramps the caret is
+// fully on or off, so the next frame can wait until the next ramp begins.
+static void schedule_cursor_wake(float time) {
+  float since_move = time - g_app->cursor.uniforms.iTimeCursorChange;
+  if (since_move < CURSOR_TRAIL_SECONDS) {
+    anim_request_frame(&g_app->anim);
+    return;
+  }
+
+  const float ramp = asinf(0.4f) / (2.0f * HMM_PI32);
+  float phase = time * CURSOR_BLINK_SPEED;
+  phase -= floorf(phase);
+
+  if (phase < ramp || phase > 1.0f - ramp ||
+      (phase > 0.5f - ramp && phase < 0.5f + ramp)) {
+    anim_request_frame(&g_app->anim);
+    return;
+  }
+
+  float next_ramp = phase < 0.5f ? 0.5f - ramp : 1.0f - ramp;
+  anim_wake_after(&g_app->anim, g_app->anim.last_tick,
+                  (next_ramp - phase) / CURSOR_BLINK_SPEED);
+}
+
 static void render_cursor() {
   float dpi_scale = sapp_dpi_scale();
-  float time = stm_sec(stm_since(g_app->start_time));
+  float time = stm_sec(stm_diff(g_app->anim.last_tick, g_app->start_time));
 
   g_app->cursor.uniforms.iResolution.X = (float)sapp_width();
   g_app->cursor.uniforms.iResolution.Y = (float)sapp_height();
@@ -1877,6 +1269,68 @@ static void render_cursor() {
   sg_apply_bindings(&g_app->cursor.bind);
   sg_apply_uniforms(UB_globals, &SG_RANGE(g_app->cursor.uniforms));
   sg_draw(0, 6, 1);
+
+  schedule_cursor_wake(time);
+}
+
+static void refresh_profiler_lines(void) {
+  snprintf(g_app->profiler.lines[0], sizeof(g_app->profiler.lines[0]),
+           "%-24s %7s %7s %7s  (%zu frames)", "phase", "p50", "p99", "max",
+           prof_frame_count());
+
+  for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+    ProfStats stats = prof_stats((ProfPhase)p);
+    snprintf(g_app->profiler.lines[p + 1], sizeof(g_app->profiler.lines[0]),
+             "%-24s %7.3f %7.3f %7.3f", prof_phase_name((ProfPhase)p),
+             stats.p50_ms, stats.p99_ms, stats.max_ms);
+  }
+}
+
+static void render_profiler_overlay(void) {
+  if (!g_app->profiler.visible)
+    return;
+
+  if (--g_app->profiler.frames_until_refresh <= 0) {
+    refresh_profiler_lines();
+    g_app->profiler.frames_until_refresh = PROFILER_REFRESH_FRAMES;
+  }
+
+  CLAY({.id = CLAY_ID("ProfilerOverlay"),
+        .backgroundColor = {0, 0, 0, 200},
+        .cornerRadius = CLAY_CORNER_RADIUS(6),
+        .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
+                   .padding = {12, 12, 10, 10},
+                   .childGap = 2},
+        .floating = {.attachTo = CLAY_ATTACH_TO_ROOT,
+                     .offset = {16, 16},
+                     .zIndex = 200}}) {
+    for (int i = 0; i < PROF_PHASE_COUNT + 1; i++) {
+      Clay_String line = {.chars = g_app->profiler.lines[i],
+                          .isStaticallyAllocated = true,
+                          .length = (int)strlen(g_app->profiler.lines[i])};
+      CLAY_TEXT(line, CLAY_TEXT_CONFIG(
+                          {.fontId = res_font(RES_FONT_FIRA_MONO),
+                           .fontSize = 13,
+                           .textColor = {230, 230, 230, 255},
+                           .wrapMode = CLAY_TEXT_WRAP_NONE}));
+    }
+  }
+}
+
+static void dump_profiler_csv(void) {
+  char date_str[64];
+  time_t now = time(NULL);
+  strftime(date_str, sizeof(date_str), "%Y-%m-%d-%H-%M-%S", localtime(&now));
+
+  char filepath[768];
+  snprintf(filepath, sizeof(filepath), "%s/andex-profile-%s.csv",
+           g_app->documents_path, date_str);
+
+  if (prof_dump_csv(filepath)) {
+    printf("Wrote frame profile to: %s\n", filepath);
+  } else {
+    fprintf(stderr, "Failed to write frame profile to: %s\n", filepath);
+  }
 }
 
 static void HandleClayErrors(Clay_ErrorData errorData) {
@@ -1884,16 +1338,288 @@ static void HandleClayErrors(Clay_ErrorData errorData) {
   exit(1);
 }
 
-char *app_strdup(const char *s, size_t len) {
-  if (s == NULL) {
+static void dispatch_event(const sapp_event *ev);
+
+static bool g_glyph_upload_pending;
+
+const stbtt_fontinfo *font_info(int font_id) {
+  FONScontext *fs = _sclay.fonts;
+  if (!fs || font_id < 0 || font_id >= fs->nfonts)
     return NULL;
+  return &fs->fonts[font_id]->font.font;
+}
+
+void font_info_scratch_reset(void) { _sclay.fonts->nscratch = 0; }
+
+// fontstash renderDraw: glyphs go to the batch render_clay flushes once per
+// run of text commands, rather than one sokol_gl draw per fontstash flush
+static void batch_glyphs(void *user_ptr, const float *verts,
+                         const float *tcoords, const unsigned int *colors,
+                         int nverts) {
+  const _sfons_t *sfons = (const _sfons_t *)user_ptr;
+  text_batch_add(sfons->img, sfons->smp, sfons->pip, verts, tcoords, colors,
+                 nverts);
+}
+
+// fontstash renderUpdate: every sclay_render call ends in sfons_flush, and an
+// image may only be updated once per frame, so the upload waits for the end
+// of render_clay
+static int defer_glyph_upload(void *user_ptr, int *rect,
+                              const unsigned char *data) {
+  (void)user_ptr;
+  (void)rect;
+  (void)data;
+  g_glyph_upload_pending = true;
+  return 1;
+}
+
+// text_sdf draws the fonts it took; the rest stay fontstash bitmaps
+static bool font_uses_sdf(int font_id) {
+  return g_app->gfx.sdf_text && text_sdf_has_font(font_id);
+}
+
+#if defined(ANDEX_BAKED_GLYPHS)
+// Glyph pages rasterized at build time by andex_glyph_bake are copied into
+// the fontstash atlas before the first frame that draws their face, so the
+// chrome and the editor's font render without rasterizing anything, and a
+// font or size switch only copies the new face in.
+
+// largest atlas side seeding grows the atlas to; past it the remaining
+// glyphs rasterize on demand as before
+#define GLYPH_SEED_MAX_ATLAS 2048
+
+// faces the chrome and the profiler overlay draw with, next to the editor's
+static const struct {
+  ResourceFontId font;
+  int size;
+} g_ui_faces[] = {{RES_FONT_LATO_REGULAR, 10},
+                  {RES_FONT_LATO_REGULAR, 15},
+                  {RES_FONT_LATO_REGULAR, 16},
+                  {RES_FONT_FIRA_MONO, 13}};
+
+static struct {
+  bool page_seeded[BAKED_GLYPH_PAGE_COUNT];
+  int font, size;
+  float dpi;
+} g_glyph_seed = {.font = -1};
+
+// Read-only walk of fontstash's glyph table; fontstash itself creates the
+// records, see seed_glyph_page.
+static FONSglyph *find_glyph(FONSfont *font, unsigned int codepoint,
+                             short isize) {
+  int i = font->lut[fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE - 1)];
+  for (; i != -1; i = font->glyphs[i].next) {
+    FONSglyph *glyph = &font->glyphs[i];
+    if (glyph->codepoint == codepoint && glyph->size == isize &&
+        glyph->blur == 0)
+      return glyph;
   }
-  char *dup = malloc(len);
-  if (dup == NULL) {
-    return NULL;
+  return NULL;
+}
+
+// Rows are coded separately, so no run crosses the end of a row.
+static void unpack_glyph_page(const BakedGlyphPage *page, unsigned char *dst,
+                              int stride) {
+  const unsigned char *src = g_baked_glyph_data + page->data_offset;
+  for (int y = 0; y < page->height; y++, dst += stride) {
+    for (int x = 0; x < page->width;) {
+      unsigned char value = *src++;
+      int run = (value == 0x00 || value == 0xFF) ? *src++ : 1;
+      memset(dst + x, value, (size_t)run);
+      x += run;
+    }
   }
-  memcpy(dup, s, len);
-  return dup;
+}
+
+static int encode_utf8(unsigned int codepoint, char *out) {
+  if (codepoint < 0x80) {
+    out[0] = (char)codepoint;
+    return 1;
+  }
+  if (codepoint < 0x800) {
+    out[0] = (char)(0xC0 | (codepoint >> 6));
+    out[1] = (char)(0x80 | (codepoint & 0x3F));
+    return 2;
+  }
+  out[0] = (char)(0xE0 | (codepoint >> 12));
+  out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+  out[2] = (char)(0x80 | (codepoint & 0x3F));
+  return 3;
+}
+
+// Measuring the page's codepoints makes fontstash add a record, without a
+// bitmap, for every glyph it doesn't have yet, so seeding never allocates
+// glyphs or edits the lookup table itself.
+static void measure_glyph_page(FONScontext *fs, const BakedGlyphPage *page) {
+  char text[256];
+  int len = 0;
+  fonsPushState(fs);
+  fonsClearState(fs);
+  fonsSetFont(fs, g_app->gfx.fonts[page->font]);
+  // fontstash truncates size * 10 back to isize
+  fonsSetSize(fs, ((float)page->isize + 0.5f) / 10.0f);
+  for (uint32_t i = 0; i < page->nglyphs; i++) {
+    len += encode_utf8(g_baked_glyphs[page->first_glyph + i].codepoint,
+                       text + len);
+    if (len > (int)sizeof(text) - 4 || i + 1 == page->nglyphs) {
+      fonsTextBounds(fs, 0.0f, 0.0f, text, text + len, NULL);
+      len = 0;
+    }
+  }
+  fonsPopState(fs);
+}
+
+// true when every glyph of the page already has a bitmap in the atlas
+static bool glyph_page_present(FONScontext *fs, const BakedGlyphPage *page) {
+  FONSfont *font = fs->fonts[g_app->gfx.fonts[page->font]];
+  for (uint32_t i = 0; i < page->nglyphs; i++) {
+    const FONSglyph *glyph = find_glyph(
+        font, g_baked_glyphs[page->first_glyph + i].codepoint, page->isize);
+    if (!glyph || glyph->x0 < 0 || glyph->y0 < 0)
+      return false;
+  }
+  return true;
+}
+
+// The atlas has no public allocator, so the page's rect comes from
+// fontstash's skyline packer, the only internal call seeding makes.
+// Everything else goes through the public API or fills in records fontstash
+// created.
+static bool seed_glyph_page(FONScontext *fs, const BakedGlyphPage *page) {
+  int gx, gy, width, height;
+  while (!fons__atlasAddRect(fs->atlas, page->width, page->height, &gx, &gy)) {
+    fonsGetAtlasSize(fs, &width, &height);
+    if (width <= height && width < GLYPH_SEED_MAX_ATLAS)
+      width = width * 2 < GLYPH_SEED_MAX_ATLAS ? width * 2
+                                               : GLYPH_SEED_MAX_ATLAS;
+    else if (height < GLYPH_SEED_MAX_ATLAS)
+      height = height * 2 < GLYPH_SEED_MAX_ATLAS ? height * 2
+                                                 : GLYPH_SEED_MAX_ATLAS;
+    else
+      return false;
+    if (!fonsExpandAtlas(fs, width, height))
+      return false;
+  }
+  unsigned char *tex = (unsigned char *)fonsGetTextureData(fs, &width, &height);
+  unpack_glyph_page(page, tex + (size_t)gy * width + gx, width);
+
+  measure_glyph_page(fs, page);
+  FONSfont *font = fs->fonts[g_app->gfx.fonts[page->font]];
+  for (uint32_t i = 0; i < page->nglyphs; i++) {
+    const BakedGlyph *baked = &g_baked_glyphs[page->first_glyph + i];
+    FONSglyph *glyph = find_glyph(font, baked->codepoint, page->isize);
+    // rasterized since, or the font has no such glyph
+    if (!glyph || (glyph->x0 >= 0 && glyph->y0 >= 0))
+      continue;
+    glyph->index = baked->index;
+    glyph->x0 = (short)(gx + baked->x0);
+    glyph->y0 = (short)(gy + baked->y0);
+    glyph->x1 = (short)(gx + baked->x1);
+    glyph->y1 = (short)(gy + baked->y1);
+    glyph->xadv = baked->xadv;
+    glyph->xoff = baked->xoff;
+    glyph->yoff = baked->yoff;
+  }
+
+  // sfons uploads the whole texture at the end of render_clay
+  g_glyph_upload_pending = true;
+  return true;
+}
+
+// A reset drops every glyph, so the seeded pages are checked again on the
+// next frame; pages an expansion kept are found in place and not copied
+// twice.
+static void forget_seeded_pages(void) {
+  memset(g_glyph_seed.page_seeded, 0, sizeof(g_glyph_seed.page_seeded));
+  g_glyph_seed.font = -1;
+  g_glyph_seed.dpi = 0.0f;
+}
+
+// sclay hands fontstash the Clay font size times the dpi scale
+static void seed_face(FONScontext *fs, ResourceFontId font, int size,
+                      float dpi) {
+  if (font_uses_sdf(g_app->gfx.fonts[font]))
+    return;
+  const short isize = (short)((float)size * dpi * 10.0f);
+  for (int i = 0; i < BAKED_GLYPH_PAGE_COUNT; i++) {
+    const BakedGlyphPage *page = &g_baked_glyph_pages[i];
+    if (page->font != font || page->isize != isize ||
+        g_glyph_seed.page_seeded[i])
+      continue;
+    // one attempt; a page that doesn't fit is left to fontstash
+    g_glyph_seed.page_seeded[i] = true;
+    if (!glyph_page_present(fs, page))
+      seed_glyph_page(fs, page);
+  }
+}
+
+// Runs before layout, while nothing is batched yet against an atlas image
+// that growing the atlas would replace.
+static void seed_baked_glyphs(void) {
+  const float dpi = sapp_dpi_scale();
+  const int font = g_app->current_font_index;
+  const int size = font_sizes[g_app->font_size_index];
+  if (font == g_glyph_seed.font && size == g_glyph_seed.size &&
+      dpi == g_glyph_seed.dpi)
+    return;
+
+  FONScontext *fs = _sclay.fonts;
+  if (dpi != g_glyph_seed.dpi) {
+    for (size_t i = 0; i < sizeof(g_ui_faces) / sizeof(g_ui_faces[0]); i++)
+      seed_face(fs, g_ui_faces[i].font, g_ui_faces[i].size, dpi);
+  }
+  seed_face(fs, (ResourceFontId)font, size, dpi);
+  g_glyph_seed.font = font;
+  g_glyph_seed.size = size;
+  g_glyph_seed.dpi = dpi;
+}
+#endif
+
+static int (*g_sfons_resize)(void *user_ptr, int width, int height);
+
+// fontstash renderResize, called by fonsExpandAtlas and fonsResetAtlas: sfons
+// replaces the atlas image and every glyph's texture coordinates change
+static int resize_glyph_atlas(void *user_ptr, int width, int height) {
+  text_batch_forget_atlas(((const _sfons_t *)user_ptr)->img);
+#if defined(ANDEX_BAKED_GLYPHS)
+  forget_seeded_pages();
+#endif
+  return g_sfons_resize(user_ptr, width, height);
+}
+
+// Clay's measure callback: Latin-1 runs are summed from text_measure's
+// tables, everything else goes through fontstash as sclay measures it.
+static Clay_Dimensions measure_text(Clay_StringSlice text,
+                                    Clay_TextElementConfig *config,
+                                    void *user_data) {
+  // sclay's height comes from the font's vertical metrics alone, so an empty
+  // slice measures it; Clay measures a text element's words in a row
+  static struct {
+    uint16_t font_id, font_size;
+    float dpi;
+    float height;
+  } line = {UINT16_MAX, 0, 0, 0};
+
+  // like sclay: glyphs at the framebuffer size, the width back in Clay units
+  const float dpi = sapp_dpi_scale();
+  const sclay_font_t *fonts = user_data;
+  float width;
+  if (!text_measure_width(fonts[config->fontId], config->fontSize * dpi,
+                          config->letterSpacing * dpi, text.chars,
+                          (size_t)text.length, &width))
+    return sclay_measure_text(text, config, user_data);
+
+  if (config->fontId != line.font_id || config->fontSize != line.font_size ||
+      dpi != line.dpi) {
+    line.font_id = config->fontId;
+    line.font_size = config->fontSize;
+    line.dpi = dpi;
+    line.height =
+        sclay_measure_text((Clay_StringSlice){.chars = text.chars}, config,
+                           user_data)
+            .height;
+  }
+  return (Clay_Dimensions){.width = width / dpi, .height = line.height};
 }
 
 static void init(void) {
@@ -1903,11 +1629,17 @@ static void init(void) {
 #endif
 
   stm_setup();
+  TRACE_INIT();
   srand(time(NULL));
   sg_setup(
       &(sg_desc){.environment = sglue_environment(), .logger.func = slog_func});
-  sgl_setup(&(sgl_desc_t){.logger.func = slog_func});
+  // room for a screen of small text at 1440p in the one text draw per run
+  sgl_setup(&(sgl_desc_t){.max_vertices = 1 << 17, .logger.func = slog_func});
   sclay_setup();
+  _sclay.fonts->params.renderDraw = batch_glyphs;
+  _sclay.fonts->params.renderUpdate = defer_glyph_upload;
+  g_sfons_resize = _sclay.fonts->params.renderResize;
+  _sclay.fonts->params.renderResize = resize_glyph_atlas;
   Clay_SetMaxMeasureTextCacheWordCount(65536);
 
   g_app = calloc(1, sizeof(AppState));
@@ -1924,6 +1656,14 @@ static void init(void) {
   g_app->last_timer_update = stm_now();
 
   g_app->start_time = stm_now();
+  anim_clock_init(&g_app->anim);
+#if defined(APP_PAUSES_FRAMES)
+  anim_wake_init(app_wake_frames);
+#else
+  anim_wake_init(NULL);
+#endif
+  prof_init();
+  replay_init(dispatch_event);
   g_app->last_save_time = stm_now();
   g_app->needs_save = false;
 
@@ -1943,43 +1683,20 @@ static void init(void) {
       clayMemory, (Clay_Dimensions){(float)sapp_width(), (float)sapp_height()},
       (Clay_ErrorHandler){.errorHandlerFunction = HandleClayErrors});
 
-  RES_FOR_EACH_FONT(i) {
-    const unsigned char *font_data = RES_GET_FONT_DATA(i);
-    size_t font_size = RES_GET_FONT_SIZE(i);
-    g_app->gfx.fonts[i] =
-        sclay_add_font_mem((unsigned char *)font_data, font_size);
-  }
-  Clay_SetMeasureTextFunction(sclay_measure_text, g_app->gfx.fonts);
-
-  RES_FOR_EACH_IMAGE(i) {
-    const EmbeddedBlob *img_blob = RES_GET_IMAGE(i);
-    g_app->gfx.images[i] = make_image_from_embed(img_blob);
-  }
-
-  RES_FOR_EACH_ICON(i) {
-    const EmbeddedBlob *icon_blob = RES_GET_ICON(i);
-    char *svg_copy = app_strdup((const char *)icon_blob->data, icon_blob->size);
-    printf("Parsing SVG icon %d: %s\n", i, icon_blob->name);
-    NSVGimage *svg = svg_parse(svg_copy, 96.0f);
-    free(svg_copy);
-
-    if (!svg) {
-      fprintf(stderr, "Failed to parse SVG icon %d: %s\n", i, icon_blob->name);
-      g_app->gfx.icons[i] =
-          (svg_element_t){.image = NULL,
-                          .fill_color = RES_GET_ICON_FILL(i),
-                          .stroke_color = RES_GET_ICON_STROKE(i),
-                          .opacity_override = 1.0f};
-      continue;
-    }
-
-    g_app->gfx.icons[i] =
-        (svg_element_t){.image = svg,
-                        .fill_color = RES_GET_ICON_FILL(i),
-                        .stroke_color = RES_GET_ICON_STROKE(i),
-                        .opacity_override = 1.0f};
+  // ANDEX_TEXT=sdf draws text from one distance-field atlas per font, so
+  // font size and dpi changes rasterize nothing new
+  const char *text_mode = getenv("ANDEX_TEXT");
+  if (text_mode && strcmp(text_mode, "sdf") == 0) {
+    g_app->gfx.sdf_text = text_sdf_init(
+        sg_make_shader(text_sdf_shader_desc(sg_query_backend())));
   }
 
+  // ANDEX_RES_DECODE=background decodes images on a worker thread; they
+  // show up a frame or two after they are first asked for
+  const char *res_decode = getenv("ANDEX_RES_DECODE");
+  res_init(res_decode && strcmp(res_decode, "background") == 0);
+  ui_set_measure_text(measure_text, g_app->gfx.fonts);
+
   text_editor_init(&g_app->editor, 4096);
   load_existing_entries();
 
@@ -2050,14 +1767,27 @@ static void init(void) {
       .cull_mode = SG_CULLMODE_NONE,
       .face_winding = SG_FACEWINDING_CCW});
 
-  svg_init(sapp_sample_count());
+  // ANDEX_SVG_BACKEND=atlas draws the icons as rasterized, tinted quads,
+  // which is much cheaper than triangles on software GL
+  const char *svg_backend = getenv("ANDEX_SVG_BACKEND");
+  svg_init(sapp_sample_count(),
+           svg_backend && strcmp(svg_backend, "atlas") == 0
+               ? SVG_BACKEND_ATLAS
+               : SVG_BACKEND_TRIANGLES);
 
   g_app->initialized = true;
 }
 
-static void event_cb(const sapp_event *ev) {
+static void dispatch_event(const sapp_event *ev) {
   if (ev->type == SAPP_EVENTTYPE_KEY_DOWN && ev->key_code == SAPP_KEYCODE_F1) {
     Clay_SetDebugModeEnabled(true);
+  } else if (ev->type == SAPP_EVENTTYPE_KEY_DOWN &&
+             ev->key_code == SAPP_KEYCODE_F2) {
+    g_app->profiler.visible = !g_app->profiler.visible;
+    g_app->profiler.frames_until_refresh = 0;
+  } else if (ev->type == SAPP_EVENTTYPE_KEY_DOWN &&
+             ev->key_code == SAPP_KEYCODE_F3) {
+    dump_profiler_csv();
   } else {
     sclay_handle_event(ev);
     handle_mouse_input(ev);
@@ -2066,6 +1796,179 @@ static void event_cb(const sapp_event *ev) {
   }
 }
 
+static void event_cb(const sapp_event *ev) {
+  anim_request_frame(&g_app->anim);
+#if defined(APP_PAUSES_FRAMES)
+  app_resume_frames();
+#endif
+  // live input would make a replay diverge from the recording
+  if (replay_is_replaying())
+    return;
+  replay_record(ev);
+  dispatch_event(ev);
+}
+
+static uint32_t text_command_color(const Clay_RenderCommand *cmd) {
+  const Clay_Color c = cmd->renderData.text.textColor;
+  return sfons_rgba((uint8_t)c.r, (uint8_t)c.g, (uint8_t)c.b, (uint8_t)c.a);
+}
+
+// Places text where sclay would: Clay units times the dpi scale, with
+// fontstash's top alignment, which text_sdf follows.
+static bool render_text_sdf_at(const Clay_RenderCommand *cmd, float x,
+                               float y) {
+  const Clay_TextRenderData *td = &cmd->renderData.text;
+  const float dpi = sapp_dpi_scale();
+  return text_sdf_draw(td->fontId, td->fontSize * dpi, td->letterSpacing * dpi,
+                       x * dpi, y * dpi, text_command_color(cmd),
+                       td->stringContents.chars,
+                       td->stringContents.chars + td->stringContents.length);
+}
+
+static void render_text_at(const Clay_RenderCommand *cmd, float x, float y) {
+  if (font_uses_sdf(cmd->renderData.text.fontId) &&
+      render_text_sdf_at(cmd, x, y))
+    return;
+  Clay_RenderCommand moved = *cmd;
+  moved.boundingBox.x = x;
+  moved.boundingBox.y = y;
+  sclay_render((Clay_RenderCommandArray){.capacity = 1,
+                                         .length = 1,
+                                         .internalArray = &moved},
+               g_app->gfx.fonts);
+}
+
+// Scale from Clay coordinates to the vertex space sclay hands fontstash,
+// measured from where one string lands at two positions instead of assuming
+// how sclay applies the dpi scale
+static struct {
+  bool measured;
+  float dpi;
+  float scale_x, scale_y;
+} g_text_space;
+
+#define TEXT_SPACE_PROBE 100.0f
+
+static bool measure_text_space(const Clay_RenderCommand *cmd) {
+  float x0, y0, x1, y1;
+  text_batch_capture_begin();
+  render_text_at(cmd, 0.0f, 0.0f);
+  bool placed = text_batch_capture_origin(&x0, &y0);
+  text_batch_capture_end(0, false);
+  text_batch_capture_begin();
+  render_text_at(cmd, TEXT_SPACE_PROBE, TEXT_SPACE_PROBE);
+  placed = text_batch_capture_origin(&x1, &y1) && placed;
+  text_batch_capture_end(0, false);
+  if (!placed)
+    return false;
+
+  g_text_space.measured = true;
+  g_text_space.dpi = sapp_dpi_scale();
+  g_text_space.scale_x = (x1 - x0) / TEXT_SPACE_PROBE;
+  g_text_space.scale_y = (y1 - y0) / TEXT_SPACE_PROBE;
+  return true;
+}
+
+// everything that shapes a text command's glyphs apart from its position
+// and color, so a fading label keeps hitting the cache
+static uint64_t text_command_key(const Clay_RenderCommand *cmd) {
+  const Clay_TextRenderData *td = &cmd->renderData.text;
+  struct {
+    uint16_t font_id, font_size, letter_spacing, line_height;
+    float dpi;
+  } params;
+  memset(&params, 0, sizeof(params));
+  params.font_id = td->fontId;
+  params.font_size = td->fontSize;
+  params.letter_spacing = td->letterSpacing;
+  params.line_height = td->lineHeight;
+  params.dpi = sapp_dpi_scale();
+
+  uint64_t hash =
+      text_batch_hash(td->stringContents.chars,
+                      (size_t)td->stringContents.length, TEXT_BATCH_HASH_SEED);
+  return text_batch_hash(&params, sizeof(params), hash);
+}
+
+// Text commands reuse the glyphs they had in earlier frames, moved to where
+// the command is now and in its current color; only new or edited text goes
+// through fontstash. The offset is rounded to whole vertex units so glyphs
+// stay on the pixel grid fontstash snaps them to.
+static void render_text_run(const Clay_RenderCommand *cmds, int32_t count) {
+  for (int32_t i = 0; i < count; i++) {
+    const Clay_RenderCommand *cmd = &cmds[i];
+    const Clay_BoundingBox bb = cmd->boundingBox;
+    if ((!g_text_space.measured || g_text_space.dpi != sapp_dpi_scale()) &&
+        !measure_text_space(cmd)) {
+      render_text_at(cmd, bb.x, bb.y);
+      continue;
+    }
+
+    const uint64_t key = text_command_key(cmd);
+    const uint32_t color = text_command_color(cmd);
+    const float dx = roundf(bb.x * g_text_space.scale_x);
+    const float dy = roundf(bb.y * g_text_space.scale_y);
+    if (text_batch_add_cached(key, dx, dy, color))
+      continue;
+
+    text_batch_capture_begin();
+    render_text_at(cmd, 0.0f, 0.0f);
+    text_batch_capture_end(key, true);
+    // rasterizing new glyphs can replace the atlas mid-capture
+    if (!text_batch_add_cached(key, dx, dy, color))
+      render_text_at(cmd, bb.x, bb.y);
+  }
+}
+
+// Draws the Clay commands in runs. The glyphs of each run of text commands
+// reach sokol_gl as a single draw; the rectangles, borders and scissors
+// between runs keep their painter's order.
+static void render_clay(Clay_RenderCommandArray commands) {
+  text_batch_begin_frame();
+
+  int32_t start = 0;
+  while (start < commands.length) {
+    const bool text = commands.internalArray[start].commandType ==
+                      CLAY_RENDER_COMMAND_TYPE_TEXT;
+    int32_t end = start + 1;
+    while (end < commands.length &&
+           (commands.internalArray[end].commandType ==
+            CLAY_RENDER_COMMAND_TYPE_TEXT) == text)
+      end++;
+
+    if (text) {
+      render_text_run(commands.internalArray + start, end - start);
+      text_batch_flush();
+    } else {
+      Clay_RenderCommandArray run = {.capacity = end - start,
+                                     .length = end - start,
+                                     .internalArray =
+                                         commands.internalArray + start};
+      sclay_render(run, g_app->gfx.fonts);
+    }
+    start = end;
+  }
+
+  if (g_glyph_upload_pending) {
+    _sfons_t *sfons = (_sfons_t *)_sclay.fonts->params.userPtr;
+    sfons->img_dirty = true;
+    sfons_flush(_sclay.fonts);
+    g_glyph_upload_pending = false;
+  }
+  if (g_app->gfx.sdf_text) {
+    TRACE_COUNTER("sdf_glyphs_generated", text_sdf_stats().generated);
+    text_sdf_upload();
+  }
+
+  TextBatchStats stats = text_batch_stats();
+  TRACE_COUNTER("text_draws", stats.draws);
+  TRACE_COUNTER("text_glyphs", stats.glyphs);
+  TRACE_COUNTER("text_cache_misses", stats.cache_misses);
+  TextMeasureStats measure = text_measure_stats();
+  TRACE_COUNTER("text_measure_fast", measure.fast);
+  TRACE_COUNTER("text_measure_fallback", measure.fallback);
+}
+
 static void render_svgs(Clay_RenderCommandArray commands) {
   const float dpi = sapp_dpi_scale();
 
@@ -2083,53 +1986,108 @@ static void render_svgs(Clay_RenderCommandArray commands) {
   }
 }
 
+// Waits out an idle stretch before a frame, until the next animation,
+// blink, timer or autosave is due. Input and anim_wake_signal (a finished
+// background decode) cut the wait short, so it adds no latency.
+static void idle_wait(void) {
+#if defined(APP_PAUSES_FRAMES)
+  // the view was paused at the end of the last frame instead
+#elif defined(ANDEX_HEADLESS)
+  // the frame bench drives every frame itself and times the work
+#elif defined(__linux__)
+  Display *display = (Display *)sapp_x11_get_display();
+  if (XPending(display) == 0)
+    anim_wait(&g_app->anim, ConnectionNumber(display));
+#else
+  anim_wait(&g_app->anim, -1);
+#endif
+}
+
 static void frame(void) {
   if (!g_app->initialized) {
     return;
   }
+  idle_wait();
+  anim_clock_advance(&g_app->anim);
+  replay_frame_begin();
+  prof_frame_begin();
+
   g_app->screen_width = sapp_widthf();
   g_app->screen_height = sapp_heightf();
 
+  prof_begin(PROF_TIMER_UPDATE);
   uint64_t now = timer_update();
+  prof_end(PROF_TIMER_UPDATE);
 
-  if (stm_sec(stm_diff(now, g_app->last_save_time)) >= 60.0) {
+  prof_begin(PROF_AUTOSAVE);
+  if (stm_sec(stm_diff(now, g_app->last_save_time)) >= AUTOSAVE_INTERVAL) {
     save_current_entry();
     g_app->last_save_time = now;
   }
+  prof_end(PROF_AUTOSAVE);
+  if (g_app->needs_save) {
+    anim_wake_after(&g_app->anim, g_app->last_save_time, AUTOSAVE_INTERVAL);
+  }
 
   if (g_app->timer_running && !g_app->bottom_nav_hovering) {
 
     uint64_t fade_elapsed = stm_diff(now, g_app->bottom_nav_fade_time);
-    if (stm_sec(fade_elapsed) > 1.0) {
-      g_app->bottom_nav_opacity -= 0.02f;
-      if (g_app->bottom_nav_opacity < 0.0f) {
-        g_app->bottom_nav_opacity = 0.0f;
-      }
-    }
-  } else if (!g_app->timer_running || g_app->bottom_nav_hovering) {
-
-    g_app->bottom_nav_opacity += 0.05f;
-    if (g_app->bottom_nav_opacity > 1.0f) {
-      g_app->bottom_nav_opacity = 1.0f;
+    if (stm_sec(fade_elapsed) > BOTTOM_NAV_FADE_DELAY) {
+      anim_linear(&g_app->anim, &g_app->bottom_nav_opacity, 0.0f,
+                  BOTTOM_NAV_FADE_OUT_SPEED);
+    } else {
+      anim_wake_after(&g_app->anim, g_app->bottom_nav_fade_time,
+                      BOTTOM_NAV_FADE_DELAY);
     }
+  } else {
+    anim_linear(&g_app->anim, &g_app->bottom_nav_opacity, 1.0f,
+                BOTTOM_NAV_FADE_IN_SPEED);
   }
 
-  g_app->editor.scroll_y +=
-      (g_app->editor.target_scroll_y - g_app->editor.scroll_y) * 0.2f;
+  anim_ease(&g_app->anim, &g_app->editor.scroll_y,
+            g_app->editor.target_scroll_y,
+            anim_rate_from_frame_factor(SCROLL_EASE_FACTOR, 60.0f));
 
+  if (res_update())
+    anim_request_frame(&g_app->anim);
+
+  prof_begin(PROF_PREPARE_LINES);
   text_editor_prepare_render_lines(&g_app->editor);
+  prof_end(PROF_PREPARE_LINES);
 
   sclay_new_frame();
+#if defined(ANDEX_BAKED_GLYPHS)
+  seed_baked_glyphs();
+#endif
+
+  prof_begin(PROF_LAYOUT);
   Clay_BeginLayout();
 
   render_editor_ui();
+  prof_end(PROF_LAYOUT);
+
+  // timed apart, so the HUD doesn't inflate the layout numbers it shows
+  prof_begin(PROF_OVERLAY);
+  render_profiler_overlay();
+  prof_end(PROF_OVERLAY);
 
+  prof_begin(PROF_LAYOUT);
   Clay_RenderCommandArray commands = Clay_EndLayout();
+  prof_end(PROF_LAYOUT);
+
+  TRACE_COUNTER("document_bytes", char_buffer_len(&g_app->editor.chars));
+  TRACE_COUNTER("render_lines", g_app->editor.render_line_count);
+  TRACE_COUNTER("laid_out_lines",
+                g_app->editor.layout_end - g_app->editor.layout_first);
+  TRACE_COUNTER("line_layout_misses", ui_line_cache_stats().misses);
+  TRACE_COUNTER("render_commands", commands.length);
 
   if (g_app->editor.mouse.mouse_down) {
+    prof_begin(PROF_CARET_HIT_TEST);
     size_t mouse_byte_pos = caret_byte_from_xy(&g_app->editor, commands,
                                                g_app->editor.mouse.mouse_x,
                                                g_app->editor.mouse.mouse_y);
+    prof_end(PROF_CARET_HIT_TEST);
 
     if (!g_app->editor.mouse.dragging) {
       text_editor_move_to_pos(&g_app->editor, mouse_byte_pos);
@@ -2138,6 +2096,7 @@ static void frame(void) {
       g_app->editor.sel_end = mouse_byte_pos;
       g_app->editor.mouse.dragging = true;
     } else {
+      anim_request_frame(&g_app->anim);
       g_app->editor.sel_end = mouse_byte_pos;
       g_app->editor.has_selection =
           (g_app->editor.sel_start != g_app->editor.sel_end);
@@ -2154,19 +2113,42 @@ static void frame(void) {
                                .clear_value = {0.95f, 0.95f, 0.95f, 1.0f}}},
       .swapchain = sglue_swapchain()});
 
+  prof_begin(PROF_SCLAY_RENDER);
   sgl_load_identity();
-  sclay_render(commands, g_app->gfx.fonts);
+  render_clay(commands);
   sgl_draw();
+  prof_end(PROF_SCLAY_RENDER);
 
+  prof_begin(PROF_SELECTION);
   render_selection_quads(commands);
+  prof_end(PROF_SELECTION);
+
+  prof_begin(PROF_CURSOR);
   render_cursor();
+  prof_end(PROF_CURSOR);
 
+  prof_begin(PROF_SVGS);
   svg_begin_draw(sapp_width(), sapp_height());
   render_svgs(commands);
   svg_end_draw();
+  prof_end(PROF_SVGS);
 
   sg_end_pass();
   sg_commit();
+
+  prof_frame_end();
+  if (g_app->profiler.visible) {
+    anim_request_frame(&g_app->anim);
+  }
+
+  replay_frame_end();
+  anim_wake_at(&g_app->anim, replay_next_wake());
+
+#if defined(APP_PAUSES_FRAMES)
+  const double wait = anim_wait_seconds(&g_app->anim);
+  if (wait > 0.0 && !app_pause_frames(wait))
+    anim_wait(&g_app->anim, -1);
+#endif
 }
 
 static void cleanup(void) {
@@ -2186,20 +2168,18 @@ static void cleanup(void) {
 
     text_editor_destroy(&g_app->editor);
 
-    for (int i = 0; i < RES_ICON_COUNT; i++) {
-      if (g_app->gfx.fonts[i] != 0) {
-        svg_free(g_app->gfx.icons[i].image);
-        g_app->gfx.icons[i].image = NULL;
-      }
-    }
-
-    for (int i = 0; i < RES_IMG_COUNT; i++) {
-      sg_destroy_image(g_app->gfx.images[i].image);
-    }
+    res_shutdown();
+    anim_wake_shutdown();
 
     free(g_app);
     g_app = NULL;
   }
+  replay_shutdown();
+  TRACE_SHUTDOWN();
+  text_batch_shutdown();
+  text_sdf_shutdown();
+  text_measure_shutdown();
+  ui_shutdown();
   sgl_shutdown();
   sg_shutdown();
 }
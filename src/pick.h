@@ -286,6 +286,7 @@
 // | `PICK_EM_MAX_REQUESTS` | Max concurrent operations | 64 | Emscripten |
 // | `PICK_EM_BASE_PICKED` | Import directory | "/picked" | Emscripten |
 // | `PICK_EM_BASE_SAVED` | Save directory | "/saved" | Emscripten |
+// | `PICK_HEADLESS` | No dialogs; every request reports cancel | undefined | All |
 //
 // ---
 //
@@ -367,7 +368,9 @@
 extern "C" {
 #endif
 
-#if defined(__APPLE__) && defined(__MACH__)
+#if defined(PICK_HEADLESS)
+  #define PICK_PLATFORM_HEADLESS
+#elif defined(__APPLE__) && defined(__MACH__)
   #define PICK_PLATFORM_MACOS
 #elif defined(_WIN32) || defined(_WIN64)
   #define PICK_PLATFORM_WINDOWS
@@ -1359,6 +1362,40 @@ void pick__message_impl(const PickMessageOptions *options,
 
 #endif
 
+#ifdef PICK_PLATFORM_HEADLESS
+
+void pick__file_impl(const PickFileOptions *options, PickFileCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(NULL, user_data);
+}
+
+void pick__files_impl(const PickFileOptions *options, PickMultiFileCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(NULL, 0, user_data);
+}
+
+void pick__folder_impl(const PickFileOptions *options, PickFileCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(NULL, user_data);
+}
+
+void pick__folders_impl(const PickFileOptions *options, PickMultiFileCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(NULL, 0, user_data);
+}
+
+void pick__save_impl(const PickFileOptions *options, PickFileCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(NULL, user_data);
+}
+
+void pick__message_impl(const PickMessageOptions *options, PickMessageCallback callback, void *user_data) {
+  (void)options;
+  if (callback) callback(PICK_RESULT_CANCEL, user_data);
+}
+
+#endif
+
 #ifdef PICK_PLATFORM_WINDOWS
 #error "Windows implementation not yet available"
 #endif
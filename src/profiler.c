@@ -0,0 +1,131 @@
+#include "profiler.h"
+#include "sokol_time.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *PHASE_NAMES[PROF_PHASE_COUNT] = {
+    [PROF_TIMER_UPDATE] = "timer_update",
+    [PROF_AUTOSAVE] = "autosave",
+    [PROF_PREPARE_LINES] = "prepare_render_lines",
+    [PROF_LAYOUT] = "layout",
+    [PROF_OVERLAY] = "profiler_overlay",
+    [PROF_CARET_HIT_TEST] = "caret_byte_from_xy",
+    [PROF_SCLAY_RENDER] = "sclay_render",
+    [PROF_SELECTION] = "render_selection_quads",
+    [PROF_CURSOR] = "render_cursor",
+    [PROF_SVGS] = "render_svgs",
+    [PROF_FRAME] = "frame",
+};
+
+typedef struct {
+  uint64_t frame_index;
+  uint64_t ticks[PROF_PHASE_COUNT];
+} ProfFrame;
+
+static struct {
+  ProfFrame frames[PROF_HISTORY];
+  size_t head;
+  size_t count;
+  uint64_t next_frame_index;
+  uint64_t phase_start[PROF_PHASE_COUNT];
+  ProfFrame *current;
+} g_prof;
+
+void prof_init(void) {
+  memset(&g_prof, 0, sizeof(g_prof));
+  g_prof.current = &g_prof.frames[0];
+}
+
+void prof_frame_begin(void) {
+  ProfFrame *frame = &g_prof.frames[g_prof.head];
+  memset(frame, 0, sizeof(*frame));
+  frame->frame_index = g_prof.next_frame_index++;
+  g_prof.current = frame;
+  prof_begin(PROF_FRAME);
+}
+
+void prof_frame_end(void) {
+  prof_end(PROF_FRAME);
+  g_prof.head = (g_prof.head + 1) % PROF_HISTORY;
+  if (g_prof.count < PROF_HISTORY)
+    g_prof.count++;
+}
+
+void prof_begin(ProfPhase phase) {
+  TRACE_BEGIN(PHASE_NAMES[phase]);
+  g_prof.phase_start[phase] = stm_now();
+}
+
+void prof_end(ProfPhase phase) {
+  g_prof.current->ticks[phase] += stm_since(g_prof.phase_start[phase]);
+  TRACE_END(PHASE_NAMES[phase]);
+}
+
+const char *prof_phase_name(ProfPhase phase) { return PHASE_NAMES[phase]; }
+
+size_t prof_frame_count(void) { return g_prof.count; }
+
+static const ProfFrame *prof_frame_at(size_t i) {
+  size_t oldest = (g_prof.head + PROF_HISTORY - g_prof.count) % PROF_HISTORY;
+  return &g_prof.frames[(oldest + i) % PROF_HISTORY];
+}
+
+double prof_last_frame_ms(ProfPhase phase) {
+  if (g_prof.count == 0)
+    return 0.0;
+  return stm_ms(prof_frame_at(g_prof.count - 1)->ticks[phase]);
+}
+
+static int compare_ticks(const void *a, const void *b) {
+  uint64_t ta = *(const uint64_t *)a;
+  uint64_t tb = *(const uint64_t *)b;
+  return (ta > tb) - (ta < tb);
+}
+
+ProfStats prof_stats(ProfPhase phase) {
+  ProfStats stats = {0};
+  if (g_prof.count == 0)
+    return stats;
+
+  uint64_t sorted[PROF_HISTORY];
+  for (size_t i = 0; i < g_prof.count; i++) {
+    sorted[i] = prof_frame_at(i)->ticks[phase];
+  }
+  qsort(sorted, g_prof.count, sizeof(uint64_t), compare_ticks);
+
+  size_t p99 = (g_prof.count * 99) / 100;
+  if (p99 >= g_prof.count)
+    p99 = g_prof.count - 1;
+
+  stats.p50_ms = stm_ms(sorted[g_prof.count / 2]);
+  stats.p99_ms = stm_ms(sorted[p99]);
+  stats.max_ms = stm_ms(sorted[g_prof.count - 1]);
+  return stats;
+}
+
+bool prof_dump_csv(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return false;
+
+  fprintf(file, "frame");
+  for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+    fprintf(file, ",%s_ms", PHASE_NAMES[p]);
+  }
+  fprintf(file, "\n");
+
+  for (size_t i = 0; i < g_prof.count; i++) {
+    const ProfFrame *frame = prof_frame_at(i);
+    fprintf(file, "%llu", (unsigned long long)frame->frame_index);
+    for (int p = 0; p < PROF_PHASE_COUNT; p++) {
+      fprintf(file, ",%.4f", stm_ms(frame->ticks[p]));
+    }
+    fprintf(file, "\n");
+  }
+
+  bool ok = ferror(file) == 0;
+  fclose(file);
+  return ok;
+}
@@ -0,0 +1,43 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROF_HISTORY 600
+
+typedef enum {
+  PROF_TIMER_UPDATE,
+  PROF_AUTOSAVE,
+  PROF_PREPARE_LINES,
+  PROF_LAYOUT,
+  PROF_OVERLAY,
+  PROF_CARET_HIT_TEST,
+  PROF_SCLAY_RENDER,
+  PROF_SELECTION,
+  PROF_CURSOR,
+  PROF_SVGS,
+  PROF_FRAME,
+  PROF_PHASE_COUNT
+} ProfPhase;
+
+typedef struct {
+  double p50_ms;
+  double p99_ms;
+  double max_ms;
+} ProfStats;
+
+void prof_init(void);
+void prof_frame_begin(void);
+void prof_frame_end(void);
+void prof_begin(ProfPhase phase);
+void prof_end(ProfPhase phase);
+
+const char *prof_phase_name(ProfPhase phase);
+size_t prof_frame_count(void);
+double prof_last_frame_ms(ProfPhase phase);
+ProfStats prof_stats(ProfPhase phase);
+bool prof_dump_csv(const char *path);
+
+#endif
@@ -0,0 +1,421 @@
+#include "replay.h"
+#include "profiler.h"
+#include "sokol_app.h"
+#include "sokol_time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// File layout: an 8-byte magic, then one record per event:
+//   varint frame delta, varint microsecond delta, u8 type, varint modifiers,
+//   type-specific fields, varint payload length, payload bytes.
+// Floats are stored as raw little-endian IEEE-754.
+
+#define REPLAY_MAGIC "ANDXREC1"
+#define REPLAY_MAGIC_LEN 8
+#define REPLAY_FLUSH_EVENTS 256
+
+typedef enum { REPLAY_OFF, REPLAY_RECORDING, REPLAY_PLAYING } ReplayMode;
+
+typedef struct {
+  uint64_t frame;
+  uint64_t tick;
+  sapp_event ev;
+  const char *payload;
+} ReplayEvent;
+
+typedef struct {
+  uint32_t events;
+  double ms[PROF_PHASE_COUNT];
+} ReplayFrame;
+
+static struct {
+  ReplayMode mode;
+  void (*dispatch)(const sapp_event *ev);
+  uint64_t frame;
+
+  // recording
+  FILE *file;
+  uint64_t start_tick;
+  uint64_t last_frame;
+  uint64_t last_us;
+  size_t unflushed;
+
+  // replay
+  bool max_speed;
+  unsigned char *data;
+  size_t size;
+  size_t offset;
+  ReplayEvent next;
+  bool has_next;
+  uint64_t replay_start;
+  uint32_t frame_events;
+  char *payload;
+  ReplayFrame *frames;
+  size_t frame_count;
+  size_t frame_capacity;
+  char report_path[1024];
+} g_replay;
+
+static void write_varint(uint64_t value) {
+  unsigned char buf[10];
+  int n = 0;
+  do {
+    unsigned char byte = value & 0x7F;
+    value >>= 7;
+    buf[n++] = byte | (value ? 0x80 : 0);
+  } while (value);
+  fwrite(buf, 1, n, g_replay.file);
+}
+
+static void write_u8(uint8_t value) { fputc(value, g_replay.file); }
+
+static void write_f32(float value) { fwrite(&value, 4, 1, g_replay.file); }
+
+static bool read_varint(uint64_t *value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (g_replay.offset >= g_replay.size)
+      return false;
+    unsigned char byte = g_replay.data[g_replay.offset++];
+    result |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool read_u8(uint8_t *value) {
+  if (g_replay.offset >= g_replay.size)
+    return false;
+  *value = g_replay.data[g_replay.offset++];
+  return true;
+}
+
+static bool read_f32(float *value) {
+  if (g_replay.offset + 4 > g_replay.size)
+    return false;
+  memcpy(value, g_replay.data + g_replay.offset, 4);
+  g_replay.offset += 4;
+  return true;
+}
+
+static bool is_mouse_event(sapp_event_type type) {
+  return type == SAPP_EVENTTYPE_MOUSE_DOWN || type == SAPP_EVENTTYPE_MOUSE_UP ||
+         type == SAPP_EVENTTYPE_MOUSE_MOVE ||
+         type == SAPP_EVENTTYPE_MOUSE_SCROLL ||
+         type == SAPP_EVENTTYPE_MOUSE_ENTER ||
+         type == SAPP_EVENTTYPE_MOUSE_LEAVE;
+}
+
+static bool is_paste(const sapp_event *ev) {
+  if (ev->type == SAPP_EVENTTYPE_CLIPBOARD_PASTED)
+    return true;
+  return ev->type == SAPP_EVENTTYPE_KEY_DOWN &&
+         ev->key_code == SAPP_KEYCODE_V &&
+         (ev->modifiers & (SAPP_MODIFIER_CTRL | SAPP_MODIFIER_SUPER));
+}
+
+void replay_record(const sapp_event *ev) {
+  if (g_replay.mode != REPLAY_RECORDING)
+    return;
+
+  uint64_t us = (uint64_t)(stm_us(stm_since(g_replay.start_tick)));
+  write_varint(g_replay.frame - g_replay.last_frame);
+  write_varint(us - g_replay.last_us);
+  g_replay.last_frame = g_replay.frame;
+  g_replay.last_us = us;
+
+  write_u8((uint8_t)ev->type);
+  write_varint(ev->modifiers);
+
+  switch (ev->type) {
+  case SAPP_EVENTTYPE_KEY_DOWN:
+  case SAPP_EVENTTYPE_KEY_UP:
+    write_varint((uint64_t)ev->key_code);
+    write_u8(ev->key_repeat);
+    break;
+  case SAPP_EVENTTYPE_CHAR:
+    write_varint(ev->char_code);
+    write_u8(ev->key_repeat);
+    break;
+  case SAPP_EVENTTYPE_RESIZED:
+    write_varint((uint64_t)ev->window_width);
+    write_varint((uint64_t)ev->window_height);
+    write_varint((uint64_t)ev->framebuffer_width);
+    write_varint((uint64_t)ev->framebuffer_height);
+    break;
+  default:
+    if (is_mouse_event(ev->type)) {
+      write_varint((uint64_t)ev->mouse_button);
+      write_f32(ev->mouse_x);
+      write_f32(ev->mouse_y);
+      write_f32(ev->mouse_dx);
+      write_f32(ev->mouse_dy);
+      write_f32(ev->scroll_x);
+      write_f32(ev->scroll_y);
+    }
+    break;
+  }
+
+  const char *clipboard = is_paste(ev) ? sapp_get_clipboard_string() : NULL;
+  size_t len = clipboard ? strlen(clipboard) : 0;
+  write_varint(len);
+  if (len > 0)
+    fwrite(clipboard, 1, len, g_replay.file);
+
+  if (++g_replay.unflushed >= REPLAY_FLUSH_EVENTS) {
+    fflush(g_replay.file);
+    g_replay.unflushed = 0;
+  }
+}
+
+static bool read_event(ReplayEvent *out) {
+  uint64_t frame_delta, us_delta, modifiers, payload_len;
+  uint8_t type;
+  if (!read_varint(&frame_delta) || !read_varint(&us_delta) ||
+      !read_u8(&type) || !read_varint(&modifiers))
+    return false;
+
+  sapp_event *ev = &out->ev;
+  memset(ev, 0, sizeof(*ev));
+  ev->type = (sapp_event_type)type;
+  ev->modifiers = (uint32_t)modifiers;
+
+  uint64_t a, b, c, d;
+  uint8_t repeat;
+  switch (ev->type) {
+  case SAPP_EVENTTYPE_KEY_DOWN:
+  case SAPP_EVENTTYPE_KEY_UP:
+    if (!read_varint(&a) || !read_u8(&repeat))
+      return false;
+    ev->key_code = (sapp_keycode)a;
+    ev->key_repeat = repeat != 0;
+    break;
+  case SAPP_EVENTTYPE_CHAR:
+    if (!read_varint(&a) || !read_u8(&repeat))
+      return false;
+    ev->char_code = (uint32_t)a;
+    ev->key_repeat = repeat != 0;
+    break;
+  case SAPP_EVENTTYPE_RESIZED:
+    if (!read_varint(&a) || !read_varint(&b) || !read_varint(&c) ||
+        !read_varint(&d))
+      return false;
+    ev->window_width = (int)a;
+    ev->window_height = (int)b;
+    ev->framebuffer_width = (int)c;
+    ev->framebuffer_height = (int)d;
+    break;
+  default:
+    if (is_mouse_event(ev->type)) {
+      if (!read_varint(&a) || !read_f32(&ev->mouse_x) ||
+          !read_f32(&ev->mouse_y) || !read_f32(&ev->mouse_dx) ||
+          !read_f32(&ev->mouse_dy) || !read_f32(&ev->scroll_x) ||
+          !read_f32(&ev->scroll_y))
+        return false;
+      ev->mouse_button = (sapp_mousebutton)a;
+    }
+    break;
+  }
+
+  if (!read_varint(&payload_len) ||
+      g_replay.offset + payload_len > g_replay.size)
+    return false;
+
+  out->payload = NULL;
+  if (payload_len > 0) {
+    free(g_replay.payload);
+    g_replay.payload = malloc(payload_len + 1);
+    memcpy(g_replay.payload, g_replay.data + g_replay.offset, payload_len);
+    g_replay.payload[payload_len] = '\0';
+    g_replay.offset += payload_len;
+    out->payload = g_replay.payload;
+  }
+
+  out->frame += frame_delta;
+  out->tick += us_delta * 1000;
+  return true;
+}
+
+static bool open_recording(const char *path) {
+  g_replay.file = fopen(path, "wb");
+  if (!g_replay.file) {
+    fprintf(stderr, "Failed to open input recording: %s\n", path);
+    return false;
+  }
+  fwrite(REPLAY_MAGIC, 1, REPLAY_MAGIC_LEN, g_replay.file);
+  g_replay.start_tick = stm_now();
+  g_replay.mode = REPLAY_RECORDING;
+  printf("Recording input to: %s\n", path);
+  return true;
+}
+
+static bool open_replay(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "Failed to open input replay: %s\n", path);
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  g_replay.data = size > 0 ? malloc((size_t)size) : NULL;
+  g_replay.size = g_replay.data ? fread(g_replay.data, 1, size, file) : 0;
+  fclose(file);
+
+  if (g_replay.size < REPLAY_MAGIC_LEN ||
+      memcmp(g_replay.data, REPLAY_MAGIC, REPLAY_MAGIC_LEN) != 0) {
+    fprintf(stderr, "Not an andex input recording: %s\n", path);
+    free(g_replay.data);
+    g_replay.data = NULL;
+    return false;
+  }
+
+  const char *speed = getenv("ANDEX_REPLAY_SPEED");
+  g_replay.max_speed = speed && strcmp(speed, "max") == 0;
+
+  const char *report = getenv("ANDEX_REPLAY_REPORT");
+  if (report && report[0]) {
+    snprintf(g_replay.report_path, sizeof(g_replay.report_path), "%s", report);
+  } else {
+    snprintf(g_replay.report_path, sizeof(g_replay.report_path), "%s.csv",
+             path);
+  }
+
+  g_replay.offset = REPLAY_MAGIC_LEN;
+  g_replay.replay_start = stm_now();
+  g_replay.has_next = read_event(&g_replay.next);
+  g_replay.mode = REPLAY_PLAYING;
+  printf("Replaying input from: %s (%s speed)\n", path,
+         g_replay.max_speed ? "max" : "recorded");
+  return true;
+}
+
+void replay_init(void (*dispatch)(const sapp_event *ev)) {
+  g_replay.dispatch = dispatch;
+
+  const char *replay_path = getenv("ANDEX_REPLAY_FILE");
+  if (replay_path && replay_path[0] && open_replay(replay_path))
+    return;
+
+  const char *record_path = getenv("ANDEX_RECORD_FILE");
+  if (record_path && record_path[0])
+    open_recording(record_path);
+}
+
+bool replay_is_recording(void) { return g_replay.mode == REPLAY_RECORDING; }
+
+bool replay_is_replaying(void) { return g_replay.mode == REPLAY_PLAYING; }
+
+static void deliver_next(void) {
+  if (g_replay.next.payload)
+    sapp_set_clipboard_string(g_replay.next.payload);
+  g_replay.dispatch(&g_replay.next.ev);
+  g_replay.frame_events++;
+  g_replay.has_next = read_event(&g_replay.next);
+}
+
+void replay_frame_begin(void) {
+  g_replay.frame++;
+  if (g_replay.mode != REPLAY_PLAYING)
+    return;
+
+  g_replay.frame_events = 0;
+  if (g_replay.max_speed) {
+    // one recorded frame's worth of events per frame, skipping idle gaps
+    uint64_t group = g_replay.next.frame;
+    while (g_replay.has_next && g_replay.next.frame == group)
+      deliver_next();
+  } else {
+    uint64_t elapsed = stm_since(g_replay.replay_start);
+    while (g_replay.has_next && g_replay.next.tick <= elapsed)
+      deliver_next();
+  }
+}
+
+uint64_t replay_next_wake(void) {
+  if (g_replay.mode != REPLAY_PLAYING)
+    return UINT64_MAX;
+  if (g_replay.max_speed || !g_replay.has_next)
+    return 0;
+  return g_replay.replay_start + g_replay.next.tick;
+}
+
+static int compare_double(const void *a, const void *b) {
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+static void finish_replay(void) {
+  FILE *file = fopen(g_replay.report_path, "w");
+  if (file) {
+    fprintf(file, "frame,events");
+    for (int p = 0; p < PROF_PHASE_COUNT; p++)
+      fprintf(file, ",%s_ms", prof_phase_name((ProfPhase)p));
+    fprintf(file, "\n");
+    for (size_t i = 0; i < g_replay.frame_count; i++) {
+      const ReplayFrame *frame = &g_replay.frames[i];
+      fprintf(file, "%zu,%u", i, frame->events);
+      for (int p = 0; p < PROF_PHASE_COUNT; p++)
+        fprintf(file, ",%.4f", frame->ms[p]);
+      fprintf(file, "\n");
+    }
+    fclose(file);
+    printf("Wrote replay timings to: %s\n", g_replay.report_path);
+  } else {
+    fprintf(stderr, "Failed to write replay timings to: %s\n",
+            g_replay.report_path);
+  }
+
+  if (g_replay.frame_count > 0) {
+    double *sorted = malloc(g_replay.frame_count * sizeof(double));
+    for (size_t i = 0; i < g_replay.frame_count; i++)
+      sorted[i] = g_replay.frames[i].ms[PROF_FRAME];
+    qsort(sorted, g_replay.frame_count, sizeof(double), compare_double);
+
+    size_t n = g_replay.frame_count;
+    printf("Replay: %zu frames, frame ms p50 %.3f p90 %.3f p99 %.3f max %.3f\n",
+           n, sorted[n / 2], sorted[(n * 90) / 100], sorted[(n * 99) / 100],
+           sorted[n - 1]);
+    free(sorted);
+  }
+
+  g_replay.mode = REPLAY_OFF;
+  sapp_request_quit();
+}
+
+void replay_frame_end(void) {
+  if (g_replay.mode != REPLAY_PLAYING)
+    return;
+
+  if (g_replay.frame_count == g_replay.frame_capacity) {
+    g_replay.frame_capacity =
+        g_replay.frame_capacity ? g_replay.frame_capacity * 2 : 1024;
+    g_replay.frames = realloc(g_replay.frames,
+                              g_replay.frame_capacity * sizeof(ReplayFrame));
+  }
+
+  ReplayFrame *frame = &g_replay.frames[g_replay.frame_count++];
+  frame->events = g_replay.frame_events;
+  for (int p = 0; p < PROF_PHASE_COUNT; p++)
+    frame->ms[p] = prof_last_frame_ms((ProfPhase)p);
+
+  if (!g_replay.has_next)
+    finish_replay();
+}
+
+void replay_shutdown(void) {
+  if (g_replay.file) {
+    fclose(g_replay.file);
+    g_replay.file = NULL;
+  }
+  free(g_replay.data);
+  free(g_replay.payload);
+  free(g_replay.frames);
+  memset(&g_replay, 0, sizeof(g_replay));
+}
@@ -0,0 +1,36 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Input recording and deterministic replay for performance runs.
+//
+//   ANDEX_RECORD_FILE=path   record every event reaching event_cb
+//   ANDEX_REPLAY_FILE=path   feed a recording back instead of live input
+//   ANDEX_REPLAY_SPEED=max   replay one recorded frame of events per frame
+//                            (default "recorded" keeps the original timing)
+//   ANDEX_REPLAY_REPORT=path per-frame timings CSV (default <replay>.csv)
+//
+// Clipboard contents are captured with paste chords so replays insert the
+// same text. The app quits once a replay is finished. Replays should start
+// from the same document as the recording.
+
+typedef struct sapp_event sapp_event;
+
+void replay_init(void (*dispatch)(const sapp_event *ev));
+void replay_shutdown(void);
+
+bool replay_is_recording(void);
+bool replay_is_replaying(void);
+
+void replay_record(const sapp_event *ev);
+
+// delivers the events that are due this frame through the dispatch callback
+void replay_frame_begin(void);
+// collects the frame's profiler timings and finishes the replay when done
+void replay_frame_end(void);
+// tick of the next pending event, 0 at max speed, UINT64_MAX when idle
+uint64_t replay_next_wake(void);
+
+#endif
@@ -0,0 +1,378 @@
+#include "sokol_gfx.h"
+#include "util/sokol_gl.h"
+#include "clay.h"
+#include "fontstash.h"
+#include "util/sokol_fontstash.h"
+#include "shaders.h"
+#include "sokol_clay.h"
+
+#include "app.h"
+#include "res.h"
+#include "text_measure.h"
+#include "text_sdf.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define RES_THREADS
+#include <pthread.h>
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+typedef enum {
+  RES_STATE_UNLOADED,
+  RES_STATE_PENDING,
+  RES_STATE_READY,
+  RES_STATE_FAILED,
+} ResState;
+
+typedef struct {
+  ResourceTextureId id;
+  unsigned char *pixels; // NULL if the texture didn't decode
+} ResDecoded;
+
+static struct {
+  ResState fonts[RES_FONT_COUNT];
+  ResState icons[RES_ICON_COUNT];
+  ResState textures[RES_TEXTURE_COUNT];
+  sg_image gpu[RES_TEXTURE_COUNT];
+  sg_sampler sampler; // shared by every image
+  ResStats stats;
+  bool background;
+
+#if defined(RES_THREADS)
+  pthread_t worker;
+  bool worker_started;
+  bool quit;
+  // each texture is queued at most once, so neither list outgrows its array
+  ResourceTextureId queue[RES_TEXTURE_COUNT];
+  size_t queued;
+  ResDecoded done[RES_TEXTURE_COUNT];
+  size_t finished;
+#endif
+} g_res;
+
+#if defined(RES_THREADS)
+static pthread_mutex_t g_res_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_res_wake = PTHREAD_COND_INITIALIZER;
+#endif
+
+static uint32_t res_read_be32(const unsigned char *p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+         p[3];
+}
+
+// QOI as gen.ts writes it, always four channels; see qoiformat.org
+static unsigned char *res_decode_qoi(const ResourceTexture *tex) {
+  const unsigned char *p = tex->data;
+  if (tex->size < 14 + 8 || memcmp(p, "qoif", 4) != 0 ||
+      res_read_be32(p + 4) != (uint32_t)tex->width ||
+      res_read_be32(p + 8) != (uint32_t)tex->height)
+    return NULL;
+  const size_t count = (size_t)tex->width * tex->height;
+  unsigned char *pixels = malloc(count * 4);
+  if (!pixels)
+    return NULL;
+
+  // the stream ends in 8 bytes of padding, so no op reads past the data
+  const unsigned char *end = tex->data + tex->size - 8;
+  unsigned char index[64][4] = {0};
+  unsigned char px[4] = {0, 0, 0, 255};
+  size_t run = 0;
+  p += 14;
+  for (size_t i = 0; i < count; i++) {
+    if (run > 0) {
+      run--;
+    } else if (p < end) {
+      const unsigned char op = *p++;
+      if (op == 0xfe) {
+        memcpy(px, p, 3);
+        p += 3;
+      } else if (op == 0xff) {
+        memcpy(px, p, 4);
+        p += 4;
+      } else if ((op >> 6) == 0) {
+        memcpy(px, index[op], 4);
+      } else if ((op >> 6) == 1) {
+        px[0] += ((op >> 4) & 3) - 2;
+        px[1] += ((op >> 2) & 3) - 2;
+        px[2] += (op & 3) - 2;
+      } else if ((op >> 6) == 2) {
+        const int vg = (op & 63) - 32;
+        const unsigned char rb = *p++;
+        px[0] += vg - 8 + (rb >> 4);
+        px[1] += vg;
+        px[2] += vg - 8 + (rb & 15);
+      } else {
+        run = op & 63;
+      }
+      memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px,
+             4);
+    }
+    memcpy(pixels + i * 4, px, 4);
+  }
+  return pixels;
+}
+
+// RGBA8 textures have nothing to decode and upload straight from the binary
+static ResDecoded res_decode(ResourceTextureId id) {
+  const ResourceTexture *tex = RES_GET_TEXTURE(id);
+  ResDecoded decoded = {.id = id};
+  if (tex->format == RES_IMAGE_RGBA8) {
+    decoded.pixels = (unsigned char *)tex->data;
+  } else if (tex->format == RES_IMAGE_QOI) {
+    decoded.pixels = res_decode_qoi(tex);
+  } else {
+    int width = 0, height = 0, comp = 0;
+    decoded.pixels = stbi_load_from_memory(tex->data, (int)tex->size, &width,
+                                           &height, &comp, 4);
+    if (decoded.pixels && (width != tex->width || height != tex->height)) {
+      stbi_image_free(decoded.pixels);
+      decoded.pixels = NULL;
+    }
+  }
+  if (!decoded.pixels)
+    fprintf(stderr, "Failed to decode texture %s\n", tex->name);
+  return decoded;
+}
+
+static void res_free_decoded(ResDecoded *decoded) {
+  const ResourceTexture *tex = RES_GET_TEXTURE(decoded->id);
+  if (tex->format == RES_IMAGE_PNG)
+    stbi_image_free(decoded->pixels);
+  else if (tex->format == RES_IMAGE_QOI)
+    free(decoded->pixels);
+  decoded->pixels = NULL;
+}
+
+// One upload per texture; every image on it becomes usable at once
+static void res_upload(ResDecoded *decoded) {
+  const ResourceTextureId id = decoded->id;
+  const ResourceTexture *tex = RES_GET_TEXTURE(id);
+  if (!decoded->pixels) {
+    g_res.textures[id] = RES_STATE_FAILED;
+    return;
+  }
+
+  TRACE_BEGIN("res_upload");
+  // sokol takes at most SG_MAX_MIPMAPS levels; smaller ones are left out
+  const int mips = tex->mips < SG_MAX_MIPMAPS ? tex->mips : SG_MAX_MIPMAPS;
+  sg_image_desc desc = {
+      .width = tex->width,
+      .height = tex->height,
+      .num_mipmaps = mips,
+      .pixel_format = SG_PIXELFORMAT_RGBA8,
+      .label = tex->name,
+  };
+  size_t offset = 0;
+  for (int level = 0; level < tex->mips; level++) {
+    const int width = (tex->width >> level) > 0 ? tex->width >> level : 1;
+    const int height = (tex->height >> level) > 0 ? tex->height >> level : 1;
+    const size_t size = (size_t)width * height * 4;
+    if (level < mips)
+      desc.data.subimage[0][level] =
+          (sg_range){.ptr = decoded->pixels + offset, .size = size};
+    offset += size;
+  }
+  if (tex->format == RES_IMAGE_RGBA8 && offset != tex->size) {
+    fprintf(stderr, "Texture %s is %zu bytes, expected %zu\n", tex->name,
+            tex->size, offset);
+    g_res.textures[id] = RES_STATE_FAILED;
+    TRACE_END("res_upload");
+    return;
+  }
+  g_res.gpu[id] = sg_make_image(&desc);
+  res_free_decoded(decoded);
+
+  if (g_res.sampler.id == SG_INVALID_ID) {
+    g_res.sampler = sg_make_sampler(&(sg_sampler_desc){
+        .min_filter = SG_FILTER_LINEAR,
+        .mag_filter = SG_FILTER_LINEAR,
+        .mipmap_filter = SG_FILTER_LINEAR,
+        .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+        .wrap_v = SG_WRAP_CLAMP_TO_EDGE,
+        .label = "res-images",
+    });
+  }
+  RES_FOR_EACH_IMAGE(i) {
+    if (RES_GET_IMAGE_TEXTURE(i) != (int)id)
+      continue;
+    const ResourceUV *uv = RES_GET_IMAGE_UV(i);
+    g_app->gfx.images[i] =
+        uv ? sclay_make_image_region(g_res.gpu[id], g_res.sampler, uv->u0,
+                                     uv->v0, uv->u1, uv->v1)
+           : sclay_make_image(g_res.gpu[id], g_res.sampler);
+    g_res.stats.images++;
+  }
+  g_res.textures[id] = RES_STATE_READY;
+  g_res.stats.textures++;
+  TRACE_END("res_upload");
+}
+
+#if defined(RES_THREADS)
+static void *res_worker(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&g_res_lock);
+  while (!g_res.quit) {
+    if (g_res.queued == 0) {
+      pthread_cond_wait(&g_res_wake, &g_res_lock);
+      continue;
+    }
+    const ResourceTextureId id = g_res.queue[--g_res.queued];
+    pthread_mutex_unlock(&g_res_lock);
+    ResDecoded decoded = res_decode(id);
+    pthread_mutex_lock(&g_res_lock);
+    g_res.done[g_res.finished++] = decoded;
+    // the main loop may be asleep with nothing else due
+    anim_wake_signal();
+  }
+  pthread_mutex_unlock(&g_res_lock);
+  return NULL;
+}
+
+// false if there is no worker to take it, and the caller decodes it itself
+static bool res_decode_in_background(ResourceTextureId id) {
+  if (!g_res.worker_started) {
+    if (pthread_create(&g_res.worker, NULL, res_worker, NULL) != 0) {
+      g_res.background = false;
+      return false;
+    }
+    g_res.worker_started = true;
+  }
+  pthread_mutex_lock(&g_res_lock);
+  g_res.queue[g_res.queued++] = id;
+  pthread_cond_signal(&g_res_wake);
+  pthread_mutex_unlock(&g_res_lock);
+  return true;
+}
+#endif
+
+static void res_texture(ResourceTextureId id) {
+  if (g_res.textures[id] != RES_STATE_UNLOADED)
+    return;
+#if defined(RES_THREADS)
+  if (g_res.background && RES_GET_TEXTURE(id)->format != RES_IMAGE_RGBA8 &&
+      res_decode_in_background(id)) {
+    g_res.textures[id] = RES_STATE_PENDING;
+    g_res.stats.pending++;
+    return;
+  }
+#endif
+  TRACE_BEGIN("res_decode");
+  ResDecoded decoded = res_decode(id);
+  TRACE_END("res_decode");
+  res_upload(&decoded);
+}
+
+void res_init(bool background) {
+  memset(&g_res, 0, sizeof(g_res));
+#if defined(RES_THREADS)
+  g_res.background = background;
+#else
+  (void)background;
+#endif
+
+  // Clay's font ids are fontstash's, which number faces in the order they
+  // are added, so every face is registered now; that only reads the font's
+  // table directory
+  RES_FOR_EACH_FONT(i) {
+    g_app->gfx.fonts[i] = sclay_add_font_mem(
+        (unsigned char *)RES_GET_FONT_DATA(i), RES_GET_FONT_SIZE(i));
+  }
+  res_font(RES_FONT_LATO_REGULAR);
+}
+
+bool res_update(void) {
+#if defined(RES_THREADS)
+  if (!g_res.worker_started)
+    return false;
+  ResDecoded done[RES_TEXTURE_COUNT];
+  pthread_mutex_lock(&g_res_lock);
+  const size_t finished = g_res.finished;
+  memcpy(done, g_res.done, finished * sizeof(ResDecoded));
+  g_res.finished = 0;
+  pthread_mutex_unlock(&g_res_lock);
+
+  for (size_t i = 0; i < finished; i++) {
+    res_upload(&done[i]);
+    g_res.stats.pending--;
+  }
+  return finished > 0;
+#else
+  return false;
+#endif
+}
+
+void res_shutdown(void) {
+#if defined(RES_THREADS)
+  if (g_res.worker_started) {
+    pthread_mutex_lock(&g_res_lock);
+    g_res.quit = true;
+    pthread_cond_signal(&g_res_wake);
+    pthread_mutex_unlock(&g_res_lock);
+    pthread_join(g_res.worker, NULL);
+    for (size_t i = 0; i < g_res.finished; i++)
+      res_free_decoded(&g_res.done[i]);
+  }
+#endif
+
+  RES_FOR_EACH_ICON(i) {
+    if (g_res.icons[i] == RES_STATE_READY) {
+      svg_free(g_app->gfx.icons[i].image);
+      g_app->gfx.icons[i].image = NULL;
+    }
+  }
+  RES_FOR_EACH_TEXTURE(i) {
+    if (g_res.textures[i] == RES_STATE_READY)
+      sg_destroy_image(g_res.gpu[i]);
+  }
+  if (g_res.sampler.id != SG_INVALID_ID)
+    sg_destroy_sampler(g_res.sampler);
+  memset(&g_res, 0, sizeof(g_res));
+}
+
+sclay_font_t res_font(ResourceFontId id) {
+  if (g_res.fonts[id] == RES_STATE_UNLOADED) {
+    TRACE_BEGIN("res_font");
+    text_measure_add_font(g_app->gfx.fonts[id]);
+    // a font text_sdf can't take is still drawn, by fontstash
+    if (g_app->gfx.sdf_text)
+      text_sdf_add_font(g_app->gfx.fonts[id]);
+    g_res.fonts[id] = RES_STATE_READY;
+    g_res.stats.fonts++;
+    TRACE_END("res_font");
+  }
+  return g_app->gfx.fonts[id];
+}
+
+svg_element_t *res_icon(ResourceIconId id) {
+  if (g_res.icons[id] == RES_STATE_UNLOADED) {
+    NSVGimage *svg = svg_load_compiled(RES_GET_ICON_SVG(id));
+    if (!svg) {
+      fprintf(stderr, "Failed to load SVG icon %d: %s\n", id,
+              RES_GET_ICON(id)->name);
+    }
+    g_app->gfx.icons[id] =
+        (svg_element_t){.image = svg,
+                        .fill_color = RES_GET_ICON_FILL(id),
+                        .stroke_color = RES_GET_ICON_STROKE(id),
+                        .opacity_override = 1.0f};
+    g_res.icons[id] = svg ? RES_STATE_READY : RES_STATE_FAILED;
+    if (svg)
+      g_res.stats.icons++;
+  }
+  return &g_app->gfx.icons[id];
+}
+
+sclay_image *res_image(ResourceImageId id) {
+  const ResourceTextureId texture = RES_GET_IMAGE_TEXTURE(id);
+  res_texture(texture);
+  return g_res.textures[texture] == RES_STATE_READY ? &g_app->gfx.images[id]
+                                                     : NULL;
+}
+
+ResStats res_stats(void) { return g_res.stats; }
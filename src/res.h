@@ -0,0 +1,47 @@
+#ifndef RES_H
+#define RES_H
+
+// The embedded RES_* resources, resolved the first time something asks for
+// them instead of all at startup. res_init readies the default UI font;
+// the other fonts get their measurement and SDF tables on first use, icons
+// are rebuilt from their compiled paths when first drawn and images are
+// uploaded when first shown.
+//
+// Images live on the textures gen.ts packs them into, and showing one
+// uploads its whole texture in one go; every image shares one sampler.
+// RGBA8 textures upload straight from the binary, QOI and PNG ones are
+// decoded first. Premultiplied textures are for pipelines blending with
+// ONE / ONE_MINUS_SRC_ALPHA; sokol_clay blends straight alpha.
+//
+// With background decoding, res_image hands the decode to a worker thread
+// and returns NULL until res_update has uploaded the pixels on the main
+// thread. Include after sokol_gfx.h and sokol_clay.h, like app.h.
+
+#include "resources.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  uint32_t fonts;    // faces with their tables built
+  uint32_t icons;    // icons rebuilt
+  uint32_t images;   // images ready to draw
+  uint32_t textures; // textures uploaded
+  uint32_t pending;  // textures decoding in the background
+} ResStats;
+
+// Registers every font with fontstash and builds the default UI font's
+// tables. background decodes images on a worker where there are threads.
+void res_init(bool background);
+// Uploads the textures decoded in the background since the last call and
+// returns true if there were any; main thread only.
+bool res_update(void);
+void res_shutdown(void);
+
+sclay_font_t res_font(ResourceFontId id);
+svg_element_t *res_icon(ResourceIconId id);
+// NULL while the image decodes in the background or if it failed to
+sclay_image *res_image(ResourceImageId id);
+
+ResStats res_stats(void);
+
+#endif
@@ -5,6 +5,8 @@
 #include <stddef.h> /* size_t */
 #include <stdint.h> /* uint32_t */
 
+#include "svg.h" /* svg_compiled_t */
+
 /* ===== Resource kinds (tag) ===== */
 typedef enum {
   RES_KIND_IMAGE = 1,
@@ -17,6 +19,24 @@ typedef struct ResourceUV {
   float u0, v0, u1, v1;
 } ResourceUV;
 
+/* How a texture's pixels are embedded */
+typedef enum {
+  RES_IMAGE_PNG = 0,   /* the file itself, decoded by stb_image */
+  RES_IMAGE_RGBA8 = 1, /* raw pixels, mip levels back to back */
+  RES_IMAGE_QOI = 2,   /* QOI stream of RGBA8 pixels */
+} ResourceImageFormat;
+
+/* One GPU texture; images on it are told apart by their ResourceUV */
+typedef struct ResourceTexture {
+  const unsigned char *data;
+  size_t size;
+  const char *name;
+  ResourceImageFormat format;
+  int width, height;
+  int mips;          /* levels in data, 1 without mipmaps */
+  int premultiplied; /* color already multiplied by alpha */
+} ResourceTexture;
+
 /* Tagged union for all embedded resources */
 typedef struct EmbeddedBlob {
   const unsigned char *data;
@@ -26,6 +46,7 @@ typedef struct EmbeddedBlob {
   union {
     struct {
       const ResourceUV *uv; /* NULL if not provided */
+      int texture;          /* ResourceTextureId */
     } image;
     struct {
       int _unused; /* room for future font-specific metadata */
@@ -33,6 +54,7 @@ typedef struct EmbeddedBlob {
     struct {
       uint32_t fill;   /* RGBA color in 0xRRGGBBAA format */
       uint32_t stroke; /* RGBA color in 0xRRGGBBAA format */
+      const svg_compiled_t *svg; /* compiled by gen.ts */
     } icon;
   } as;
 } EmbeddedBlob;
@@ -40,6 +62,8 @@ typedef struct EmbeddedBlob {
 /* ===== Per-kind IDs ===== */
 typedef enum { RES_IMG_WIN, RES_IMG_COUNT } ResourceImageId;
 
+typedef enum { RES_TEXTURE_WIN, RES_TEXTURE_COUNT } ResourceTextureId;
+
 typedef enum {
   RES_FONT_LATO_REGULAR,
   RES_FONT_FIRA_MONO,
@@ -71,6 +95,8 @@ typedef enum {
 #define RES_INDEX_ICON(id) (RES_FIRST_ICON + (id))
 #define RES_FOR_EACH_IMAGE(idvar)                                              \
   for (int idvar = 0; idvar < RES_IMG_COUNT; ++idvar)
+#define RES_FOR_EACH_TEXTURE(idvar)                                            \
+  for (int idvar = 0; idvar < RES_TEXTURE_COUNT; ++idvar)
 #define RES_FOR_EACH_FONT(idvar)                                               \
   for (int idvar = 0; idvar < RES_FONT_COUNT; ++idvar)
 #define RES_FOR_EACH_ICON(idvar)                                               \
@@ -91,29 +117,301 @@ static const unsigned char res_arial_ttf[] = {
 static const unsigned char res_ibmplexserif_regular_ttf[] = {
 #embed "../resources/fonts/IBMPlexSerif-Regular.ttf"
 };
-static const unsigned char res_sun_max_fill_svg[] = {
-#embed "../resources/icons/sun.max.fill.svg"
-    , 0 /* null terminator for SVG strings */
+static const float res_sun_max_fill_svg_pts[] = {
+    27.19922f, 7.755859f, 27.19922f, 7.455078f, 26.91992f, 7.154297f, 26.59766f,
+    7.154297f, 26.27539f, 7.154297f, 25.99609f, 7.455078f, 25.99609f, 7.755859f,
+    25.99609f, 9.453125f, 25.99609f, 11.15039f, 25.99609f, 12.84766f, 25.99609f,
+    13.16992f, 26.27539f, 13.44922f, 26.59766f, 13.44922f, 26.91992f, 13.44922f,
+    27.19922f, 13.16992f, 27.19922f, 12.84766f, 27.19922f, 11.15039f, 27.19922f,
+    9.453125f, 27.19922f, 7.755859f, 14.11523f, 18.2832f, 14.30859f, 18.51953f,
+    14.7168f, 18.51953f, 14.95313f, 18.2832f, 15.18945f, 18.06836f, 15.18945f,
+    17.68164f, 14.95313f, 17.44531f, 13.76432f, 16.24219f, 12.57552f, 15.03906f,
+    11.38672f, 13.83594f, 11.17188f, 13.59961f, 10.76367f, 13.59961f, 10.52734f,
+    13.83594f, 10.29102f, 14.05078f, 10.29102f, 14.45898f, 10.52734f, 14.69531f,
+    11.72331f, 15.89128f, 12.91927f, 17.08724f, 14.11523f, 18.2832f, 38.2207f,
+    17.44531f, 37.98438f, 17.68164f, 37.98438f, 18.04688f, 38.2207f, 18.2832f,
+    38.45703f, 18.51953f, 38.82227f, 18.51953f, 39.05859f, 18.2832f, 40.26172f,
+    17.08724f, 41.46484f, 15.89128f, 42.66797f, 14.69531f, 42.9043f, 14.45898f,
+    42.9043f, 14.07227f, 42.66797f, 13.83594f, 42.43164f, 13.59961f, 42.04492f,
+    13.59961f, 41.80859f, 13.83594f, 40.61263f, 15.03906f, 39.41667f, 16.24219f,
+    38.2207f, 17.44531f, 26.5332f, 20.04492f, 21.14063f, 20.04492f, 16.69336f,
+    24.51367f, 16.69336f, 29.90625f, 16.69336f, 35.29883f, 21.14063f, 39.76758f,
+    26.5332f, 39.76758f, 31.92578f, 39.76758f, 36.39453f, 35.29883f, 36.39453f,
+    29.90625f, 36.39453f, 24.51367f, 31.92578f, 20.04492f, 26.5332f, 20.04492f,
+    26.5332f, 20.04492f, 26.5332f, 20.04492f, 26.5332f, 20.04492f, 48.74805f,
+    30.50781f, 49.04883f, 30.50781f, 49.34961f, 30.22852f, 49.34961f, 29.90625f,
+    49.34961f, 29.58398f, 49.04883f, 29.30469f, 48.74805f, 29.30469f, 47.05078f,
+    29.30469f, 45.35352f, 29.30469f, 43.65625f, 29.30469f, 43.33398f, 29.30469f,
+    43.05469f, 29.58398f, 43.05469f, 29.90625f, 43.05469f, 30.22852f, 43.33398f,
+    30.50781f, 43.65625f, 30.50781f, 45.35352f, 30.50781f, 47.05078f, 30.50781f,
+    48.74805f, 30.50781f, 4.447266f, 29.30469f, 4.146484f, 29.30469f, 3.845703f,
+    29.58398f, 3.845703f, 29.90625f, 3.845703f, 30.22852f, 4.146484f, 30.50781f,
+    4.447266f, 30.50781f, 6.144531f, 30.50781f, 7.841797f, 30.50781f, 9.539063f,
+    30.50781f, 9.861328f, 30.50781f, 10.14063f, 30.22852f, 10.14063f, 29.90625f,
+    10.14063f, 29.58398f, 9.861328f, 29.30469f, 9.539063f, 29.30469f, 7.841797f,
+    29.30469f, 6.144531f, 29.30469f, 4.447266f, 29.30469f, 39.05859f, 41.5293f,
+    38.82227f, 41.29297f, 38.45703f, 41.29297f, 38.2207f, 41.5293f, 37.98438f,
+    41.76563f, 37.98438f, 42.13086f, 38.2207f, 42.36719f, 39.41667f, 43.57031f,
+    40.61263f, 44.77344f, 41.80859f, 45.97656f, 42.04492f, 46.21289f, 42.43164f,
+    46.21289f, 42.66797f, 45.97656f, 42.9043f, 45.74023f, 42.9043f, 45.35352f,
+    42.66797f, 45.11719f, 41.46484f, 43.92122f, 40.26172f, 42.72526f, 39.05859f,
+    41.5293f, 10.50586f, 45.11719f, 10.26953f, 45.33203f, 10.26953f, 45.74023f,
+    10.50586f, 45.97656f, 10.7207f, 46.21289f, 11.10742f, 46.21289f, 11.34375f,
+    45.97656f, 12.54688f, 44.7806f, 13.75f, 43.58464f, 14.95313f, 42.38867f,
+    15.18945f, 42.19531f, 15.18945f, 41.78711f, 14.95313f, 41.55078f, 14.73828f,
+    41.31445f, 14.35156f, 41.31445f, 14.11523f, 41.55078f, 12.91211f, 42.73958f,
+    11.70898f, 43.92839f, 10.50586f, 45.11719f, 27.19922f, 46.96484f, 27.19922f,
+    46.64258f, 26.91992f, 46.36328f, 26.59766f, 46.36328f, 26.27539f, 46.36328f,
+    25.99609f, 46.64258f, 25.99609f, 46.96484f, 25.99609f, 48.66211f, 25.99609f,
+    50.35938f, 25.99609f, 52.05664f, 25.99609f, 52.35742f, 26.27539f, 52.6582f,
+    26.59766f, 52.6582f, 26.91992f, 52.6582f, 27.19922f, 52.35742f, 27.19922f,
+    52.05664f, 27.19922f, 50.35938f, 27.19922f, 48.66211f, 27.19922f, 46.96484f
+};
+static const svg_compiled_path_t res_sun_max_fill_svg_paths[] = {
+    {0, 19, true},
+    {19, 19, true},
+    {38, 19, true},
+    {57, 16, true},
+    {73, 19, true},
+    {92, 19, true},
+    {111, 19, true},
+    {130, 19, true},
+    {149, 19, true},
+};
+static const svg_compiled_shape_t res_sun_max_fill_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0xFF000000, .has_fill = true,
+     .has_stroke = true, .opacity = 1.0f, .stroke_width = 1.0f,
+     .miter_limit = 4.0f, .fill_rule = 0, .line_join = 0, .line_cap = 0,
+     .visible = true, .first_path = 0, .npaths = 9},
+};
+static const svg_compiled_t res_sun_max_fill_svg = {
+    53.19531f, 59.8125f, res_sun_max_fill_svg_shapes, 1,
+    res_sun_max_fill_svg_paths, res_sun_max_fill_svg_pts};
+static const float res_moon_fill_svg_pts[] = {
+    34.6543f, 31.92578f, 23.74023f, 31.92578f, 15.91992f, 24.10547f, 15.91992f,
+    13.14844f, 15.91992f, 9.818359f, 16.24219f, 7.691406f, 17.16602f, 5.542969f,
+    17.23047f, 5.392578f, 17.27344f, 5.220703f, 17.27344f, 5.091797f, 17.27344f,
+    4.597656f, 16.88672f, 4.232422f, 16.41406f, 4.232422f, 16.28516f, 4.232422f,
+    16.15625f, 4.253906f, 16.02734f, 4.296875f, 8.808594f, 7.433594f, 3.845703f,
+    15.33984f, 3.845703f, 23.71875f, 3.845703f, 34.99805f, 12.7832f, 43.93555f,
+    24.10547f, 43.93555f, 32.44141f, 43.93555f, 40.73438f, 38.7793f, 43.3125f,
+    32.01172f, 43.35547f, 31.88281f, 43.35547f, 31.75391f, 43.35547f, 31.625f,
+    43.35547f, 31.10938f, 43.01172f, 30.70117f, 42.49609f, 30.70117f, 42.41016f,
+    30.70117f, 42.3457f, 30.72266f, 42.23828f, 30.74414f, 40.60547f, 31.25977f,
+    37.64063f, 31.92578f, 34.6543f, 31.92578f, 34.6543f, 31.92578f, 34.6543f,
+    31.92578f, 34.6543f, 31.92578f
+};
+static const svg_compiled_path_t res_moon_fill_svg_paths[] = {
+    {0, 40, true},
 };
-static const unsigned char res_moon_fill_svg[] = {
-#embed "../resources/icons/moon.fill.svg"
-    , 0 /* null terminator for SVG strings */
+static const svg_compiled_shape_t res_moon_fill_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0xFF000000, .has_fill = true,
+     .has_stroke = true, .opacity = 1.0f, .stroke_width = 1.0f,
+     .miter_limit = 4.0f, .fill_rule = 0, .line_join = 0, .line_cap = 0,
+     .visible = true, .first_path = 0, .npaths = 1},
 };
-static const unsigned char res_clock_arrow_circlepath_svg[] = {
-#embed "../resources/icons/clock.arrow.circlepath.svg"
-    , 0 /* null terminator for SVG strings */
+static const svg_compiled_t res_moon_fill_svg = {
+    47.20117f, 48.16797f, res_moon_fill_svg_shapes, 1, res_moon_fill_svg_paths,
+    res_moon_fill_svg_pts};
+static const float res_clock_arrow_circlepath_svg_pts[] = {
+    14.2281f, 23.9062f, 20.7555f, 23.9062f, 26.1813f, 18.4805f, 26.1813f,
+    11.9531f, 26.1813f, 5.41406f, 20.7555f, 0.0f, 14.2281f, 0.0f, 7.68908f,
+    0.0f, 2.27502f, 5.40234f, 2.27502f, 11.9414f, 2.939083f, 11.9414f,
+    3.603147f, 11.9414f, 4.26721f, 11.9414f, 4.26721f, 6.41016f, 8.69689f,
+    2.00391f, 14.2281f, 2.00391f, 19.7594f, 2.00391f, 24.1891f, 6.42188f,
+    24.1891f, 11.9531f, 24.1891f, 17.4844f, 19.7594f, 21.9375f, 14.2281f,
+    21.9141f, 10.8883f, 21.9023f, 7.95861f, 20.2852f, 6.16564f, 17.7891f,
+    5.80236f, 17.3086f, 5.25158f, 17.1562f, 4.75939f, 17.4492f, 4.29064f,
+    17.7422f, 4.16174f, 18.3867f, 4.56017f, 18.9023f, 6.78674f, 21.8906f,
+    10.2789f, 23.9062f, 14.2281f, 23.9062f, 14.2281f, 23.9062f, 14.2281f,
+    23.9062f, 14.2281f, 23.9062f, 0.833612f, 9.69141f, -0.0101376f, 9.69141f,
+    -0.221075f, 10.2656f, 0.235956f, 10.9219f, 1.110957f, 12.16407f, 1.985959f,
+    13.40623f, 2.86096f, 14.6484f, 3.24767f, 15.1875f, 3.81017f, 15.1758f,
+    4.18517f, 14.6484f, 5.06017f, 13.40233f, 5.93517f, 12.15627f, 6.81017f,
+    10.9102f, 7.25549f, 10.2656f, 7.04455f, 9.69141f, 6.21252f, 9.69141f,
+    4.419551f, 9.69141f, 2.626581f, 9.69141f, 0.833612f, 9.69141f, 13.7828f,
+    5.08594f, 13.2672f, 5.08594f, 12.8453f, 5.49609f, 12.8453f, 6.01172f,
+    12.8453f, 8.191413f, 12.8453f, 10.37111f, 12.8453f, 12.5508f, 12.8453f,
+    12.8203f, 12.9274f, 13.0547f, 13.1266f, 13.3125f, 14.09143f, 14.58593f,
+    15.05627f, 15.85937f, 16.0211f, 17.1328f, 16.4078f, 17.6367f, 16.9469f,
+    17.7188f, 17.4274f, 17.3906f, 17.861f, 17.0859f, 17.8961f, 16.5352f,
+    17.5445f, 16.0547f, 16.24373f, 14.3008f, 14.94297f, 12.5469f, 13.6422f,
+    10.793f, 13.99767f, 11.88673f, 14.35313f, 12.98047f, 14.7086f, 14.0742f,
+    14.7086f, 11.38671f, 14.7086f, 8.699213f, 14.7086f, 6.01172f, 14.7086f,
+    5.49609f, 14.2985f, 5.08594f, 13.7828f, 5.08594f, 13.7828f, 5.08594f,
+    13.7828f, 5.08594f, 13.7828f, 5.08594f
 };
-static const unsigned char res_trash_svg[] = {
-#embed "../resources/icons/trash.svg"
-    , 0 /* null terminator for SVG strings */
+static const svg_compiled_path_t res_clock_arrow_circlepath_svg_paths[] = {
+    {0, 37, true},
+    {37, 19, true},
+    {56, 34, true},
 };
-static const unsigned char res_arrow_down_circle_svg[] = {
-#embed "../resources/icons/arrow.down.circle.svg"
-    , 0 /* null terminator for SVG strings */
+static const svg_compiled_shape_t res_clock_arrow_circlepath_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 0,
+     .npaths = 2},
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 2,
+     .npaths = 1},
 };
-static const unsigned char res_arrow_turn_up_right_svg[] = {
-#embed "../resources/icons/arrow.turn.up.right.svg"
-    , 0 /* null terminator for SVG strings */
+static const svg_compiled_t res_clock_arrow_circlepath_svg = {
+    26.1813f, 23.918f, res_clock_arrow_circlepath_svg_shapes, 2,
+    res_clock_arrow_circlepath_svg_paths, res_clock_arrow_circlepath_svg_pts};
+static const float res_trash_svg_pts[] = {
+    6.19922f, 5.35547f, 6.820313f, 5.35547f, 7.441407f, 5.35547f, 8.0625f,
+    5.35547f, 8.0625f, 4.519533f, 8.0625f, 3.683597f, 8.0625f, 2.84766f,
+    8.0625f, 2.17969f, 8.53125f, 1.74609f, 9.23438f, 1.74609f, 10.63282f,
+    1.74609f, 12.03126f, 1.74609f, 13.4297f, 1.74609f, 14.1328f, 1.74609f,
+    14.6016f, 2.17969f, 14.6016f, 2.84766f, 14.6016f, 3.683597f, 14.6016f,
+    4.519533f, 14.6016f, 5.35547f, 15.22267f, 5.35547f, 15.84373f, 5.35547f,
+    16.4648f, 5.35547f, 16.4648f, 4.48047f, 16.4648f, 3.60547f, 16.4648f,
+    2.73047f, 16.4648f, 1.03125f, 15.3633f, 0.0f, 13.5586f, 0.0f, 12.07422f,
+    0.0f, 10.58985f, 0.0f, 9.10547f, 0.0f, 7.30078f, 0.0f, 6.19922f, 1.03125f,
+    6.19922f, 2.73047f, 6.19922f, 3.60547f, 6.19922f, 4.48047f, 6.19922f,
+    5.35547f, 0.878906f, 6.29297f, 7.859371f, 6.29297f, 14.83984f, 6.29297f,
+    21.8203f, 6.29297f, 22.3008f, 6.29297f, 22.6875f, 5.88281f, 22.6875f,
+    5.40234f, 22.6875f, 4.92188f, 22.3008f, 4.52344f, 21.8203f, 4.52344f,
+    14.83984f, 4.52344f, 7.859371f, 4.52344f, 0.878906f, 4.52344f, 0.410156f,
+    4.52344f, 0.0f, 4.92188f, 0.0f, 5.40234f, 0.0f, 5.89453f, 0.410156f,
+    6.29297f, 0.878906f, 6.29297f, 0.878906f, 6.29297f, 0.878906f, 6.29297f,
+    0.878906f, 6.29297f, 5.97656f, 26.0977f, 9.558607f, 26.0977f, 13.14065f,
+    26.0977f, 16.7227f, 26.0977f, 18.3984f, 26.0977f, 19.5234f, 25.0078f,
+    19.6055f, 23.332f, 19.87893f, 17.5781f, 20.15237f, 11.82421f, 20.4258f,
+    6.07031f, 19.7969f, 6.07031f, 19.168f, 6.07031f, 18.5391f, 6.07031f,
+    18.27737f, 11.75781f, 18.01563f, 17.4453f, 17.7539f, 23.1328f, 17.7305f,
+    23.8359f, 17.2266f, 24.3281f, 16.5352f, 24.3281f, 13.07034f, 24.3281f,
+    9.60548f, 24.3281f, 6.14062f, 24.3281f, 5.47266f, 24.3281f, 4.96875f,
+    23.8242f, 4.93359f, 23.1328f, 4.656247f, 17.4453f, 4.378903f, 11.75781f,
+    4.10156f, 6.07031f, 3.48828f, 6.07031f, 2.875f, 6.07031f, 2.26172f,
+    6.07031f, 2.539063f, 11.82814f, 2.816407f, 17.58597f, 3.09375f, 23.3438f,
+    3.17578f, 25.0195f, 4.27734f, 26.0977f, 5.97656f, 26.0977f, 5.97656f,
+    26.0977f, 5.97656f, 26.0977f, 5.97656f, 26.0977f, 7.875f, 22.3242f,
+    8.32031f, 22.3242f, 8.61328f, 22.043f, 8.60156f, 21.6328f, 8.480467f,
+    17.45312f, 8.359373f, 13.27343f, 8.23828f, 9.09375f, 8.22656f, 8.68359f,
+    7.93359f, 8.41406f, 7.51172f, 8.41406f, 7.06641f, 8.41406f, 6.77344f,
+    8.69531f, 6.78516f, 9.10547f, 6.902347f, 13.28125f, 7.019533f, 17.45702f,
+    7.13672f, 21.6328f, 7.14844f, 22.0547f, 7.44141f, 22.3242f, 7.875f,
+    22.3242f, 7.875f, 22.3242f, 7.875f, 22.3242f, 7.875f, 22.3242f, 11.3438f,
+    22.3242f, 11.7891f, 22.3242f, 12.1055f, 22.043f, 12.1055f, 21.6328f,
+    12.1055f, 17.45702f, 12.1055f, 13.28125f, 12.1055f, 9.10547f, 12.1055f,
+    8.69531f, 11.7891f, 8.41406f, 11.3438f, 8.41406f, 10.8984f, 8.41406f,
+    10.5938f, 8.69531f, 10.5938f, 9.10547f, 10.5938f, 13.28125f, 10.5938f,
+    17.45702f, 10.5938f, 21.6328f, 10.5938f, 22.043f, 10.8984f, 22.3242f,
+    11.3438f, 22.3242f, 11.3438f, 22.3242f, 11.3438f, 22.3242f, 11.3438f,
+    22.3242f, 14.8242f, 22.3242f, 15.2461f, 22.3242f, 15.5391f, 22.0547f,
+    15.5508f, 21.6328f, 15.66797f, 17.45702f, 15.78513f, 13.28125f, 15.9023f,
+    9.10547f, 15.9141f, 8.69531f, 15.6211f, 8.41406f, 15.1758f, 8.41406f,
+    14.7539f, 8.41406f, 14.4609f, 8.68359f, 14.4492f, 9.10547f, 14.33203f,
+    13.28125f, 14.21487f, 17.45702f, 14.0977f, 21.6328f, 14.0859f, 22.043f,
+    14.3789f, 22.3242f, 14.8242f, 22.3242f, 14.8242f, 22.3242f, 14.8242f,
+    22.3242f, 14.8242f, 22.3242f
+};
+static const svg_compiled_path_t res_trash_svg_paths[] = {
+    {0, 37, true},
+    {37, 22, true},
+    {59, 40, true},
+    {99, 22, true},
+    {121, 22, true},
+    {143, 22, true},
+};
+static const svg_compiled_shape_t res_trash_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 0,
+     .npaths = 6},
+};
+static const svg_compiled_t res_trash_svg = {
+    22.6875f, 28.1836f, res_trash_svg_shapes, 1, res_trash_svg_paths,
+    res_trash_svg_pts};
+static const float res_arrow_down_circle_svg_pts[] = {
+    11.9531f, 23.9062f, 18.4922f, 23.9062f, 23.9062f, 18.4805f, 23.9062f,
+    11.9531f, 23.9062f, 5.41406f, 18.4805f, 0.0f, 11.9414f, 0.0f, 5.41406f,
+    0.0f, 0.0f, 5.41406f, 0.0f, 11.9531f, 0.0f, 18.4805f, 5.42578f, 23.9062f,
+    11.9531f, 23.9062f, 11.9531f, 23.9062f, 11.9531f, 23.9062f, 11.9531f,
+    23.9062f, 11.9531f, 21.9141f, 6.42188f, 21.9141f, 2.00391f, 17.4844f,
+    2.00391f, 11.9531f, 2.00391f, 6.42188f, 6.41016f, 1.99219f, 11.9414f,
+    1.99219f, 17.4727f, 1.99219f, 21.9141f, 6.42188f, 21.9141f, 11.9531f,
+    21.9141f, 17.4844f, 17.4844f, 21.9141f, 11.9531f, 21.9141f, 11.9531f,
+    21.9141f, 11.9531f, 21.9141f, 11.9531f, 21.9141f, 11.9531f, 5.98828f,
+    11.4492f, 5.98828f, 11.0742f, 6.35156f, 11.0742f, 6.86719f, 11.0742f,
+    8.820327f, 11.0742f, 10.77346f, 11.0742f, 12.7266f, 11.10547f, 13.5508f,
+    11.13673f, 14.375f, 11.168f, 15.1992f, 10.77736f, 14.73047f, 10.38673f,
+    14.26173f, 9.99609f, 13.793f, 9.531247f, 13.32423f, 9.066403f, 12.85547f,
+    8.60156f, 12.3867f, 8.4375f, 12.2227f, 8.22656f, 12.1289f, 7.98047f,
+    12.1289f, 7.5f, 12.1289f, 7.13672f, 12.4922f, 7.13672f, 12.9727f, 7.13672f,
+    13.2188f, 7.20703f, 13.4297f, 7.35938f, 13.582f, 8.664053f, 14.8789f,
+    9.968727f, 16.1758f, 11.2734f, 17.4727f, 11.5078f, 17.707f, 11.707f,
+    17.8125f, 11.9531f, 17.8125f, 12.2109f, 17.8125f, 12.4219f, 17.6953f,
+    12.6445f, 17.4727f, 13.9453f, 16.1758f, 15.2461f, 14.8789f, 16.5469f,
+    13.582f, 16.6992f, 13.4297f, 16.793f, 13.2188f, 16.793f, 12.9727f, 16.793f,
+    12.4922f, 16.418f, 12.1289f, 15.9375f, 12.1289f, 15.6797f, 12.1289f,
+    15.4688f, 12.2109f, 15.3164f, 12.3867f, 14.85547f, 12.85547f, 14.39453f,
+    13.32423f, 13.9336f, 13.793f, 13.53517f, 14.26563f, 13.13673f, 14.73827f,
+    12.7383f, 15.2109f, 12.76953f, 14.3828f, 12.80077f, 13.5547f, 12.832f,
+    12.7266f, 12.832f, 10.77346f, 12.832f, 8.820327f, 12.832f, 6.86719f,
+    12.832f, 6.35156f, 12.4688f, 5.98828f, 11.9531f, 5.98828f, 11.9531f,
+    5.98828f, 11.9531f, 5.98828f, 11.9531f, 5.98828f
+};
+static const svg_compiled_path_t res_arrow_down_circle_svg_paths[] = {
+    {0, 16, true},
+    {16, 16, true},
+    {32, 64, true},
+};
+static const svg_compiled_shape_t res_arrow_down_circle_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 0,
+     .npaths = 2},
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 2,
+     .npaths = 1},
+};
+static const svg_compiled_t res_arrow_down_circle_svg = {
+    23.9062f, 23.918f, res_arrow_down_circle_svg_shapes, 2,
+    res_arrow_down_circle_svg_paths, res_arrow_down_circle_svg_pts};
+static const float res_arrow_turn_up_right_svg_pts[] = {
+    1.10156f, 18.5273f, 1.71094f, 18.5273f, 2.15625f, 18.1055f, 2.15625f,
+    17.4844f, 2.15625f, 17.0742f, 2.12109f, 16.6875f, 2.12109f, 16.1367f,
+    2.12109f, 11.7891f, 3.63281f, 10.0195f, 7.93359f, 10.0195f, 10.62889f,
+    10.0195f, 13.3242f, 10.0195f, 16.0195f, 10.0195f, 16.98043f, 9.960917f,
+    17.94137f, 9.902333f, 18.9023f, 9.84375f, 17.582f, 11.04687f, 16.2617f,
+    12.24998f, 14.9414f, 13.4531f, 14.0742f, 14.33593f, 13.207f, 15.21877f,
+    12.3398f, 16.1016f, 12.1641f, 16.2891f, 12.0586f, 16.5703f, 12.0586f,
+    16.8516f, 12.0586f, 17.4375f, 12.5039f, 17.8594f, 13.0898f, 17.8594f,
+    13.3594f, 17.8594f, 13.6172f, 17.7539f, 13.8516f, 17.5312f, 16.44533f,
+    14.94137f, 19.03907f, 12.35155f, 21.6328f, 9.76172f, 21.8789f, 9.52734f,
+    21.9961f, 9.25781f, 21.9961f, 8.96484f, 21.9961f, 8.68359f, 21.8789f,
+    8.40234f, 21.6328f, 8.17969f, 19.04687f, 5.597658f, 16.46093f, 3.015626f,
+    13.875f, 0.433594f, 13.6172f, 0.175781f, 13.3594f, 0.0820312f, 13.0898f,
+    0.0820312f, 12.5039f, 0.0820312f, 12.0586f, 0.503906f, 12.0586f, 1.08984f,
+    12.0586f, 1.37109f, 12.1523f, 1.64062f, 12.3398f, 1.82812f, 13.207f,
+    2.710933f, 14.0742f, 3.593747f, 14.9414f, 4.47656f, 16.2578f, 5.679687f,
+    17.5742f, 6.882813f, 18.8906f, 8.08594f, 17.93357f, 8.031253f, 16.97653f,
+    7.976567f, 16.0195f, 7.92188f, 13.28904f, 7.92188f, 10.55858f, 7.92188f,
+    7.82812f, 7.92188f, 2.27344f, 7.92188f, 0.0f, 10.3594f, 0.0f, 16.0312f,
+    0.0f, 16.7109f, 0.0234375f, 17.2969f, 0.105469f, 17.6484f, 0.199219f,
+    18.1289f, 0.480469f, 18.5273f, 1.10156f, 18.5273f, 1.10156f, 18.5273f,
+    1.10156f, 18.5273f, 1.10156f, 18.5273f
+};
+static const svg_compiled_path_t res_arrow_turn_up_right_svg_paths[] = {
+    {0, 76, true},
+};
+static const svg_compiled_shape_t res_arrow_turn_up_right_svg_shapes[] = {
+    {.fill = 0xFF000000, .stroke = 0, .has_fill = true, .has_stroke = false,
+     .opacity = 1.0f, .stroke_width = 1.0f, .miter_limit = 4.0f, .fill_rule = 0,
+     .line_join = 0, .line_cap = 0, .visible = true, .first_path = 0,
+     .npaths = 1},
+};
+static const svg_compiled_t res_arrow_turn_up_right_svg = {
+    21.9961f, 18.5273f, res_arrow_turn_up_right_svg_shapes, 1,
+    res_arrow_turn_up_right_svg_paths, res_arrow_turn_up_right_svg_pts};
+
+static const ResourceTexture g_resource_textures[RES_TEXTURE_COUNT] = {
+    [RES_TEXTURE_WIN] = {res_win_png, sizeof(res_win_png), "win", RES_IMAGE_PNG,
+                         1055, 1576, 1, 0},
 };
 
 static const EmbeddedBlob g_embedded_resources[RES_COUNT] = {
@@ -121,7 +419,7 @@ static const EmbeddedBlob g_embedded_resources[RES_COUNT] = {
                                       sizeof(res_win_png),
                                       "win.png",
                                       RES_KIND_IMAGE,
-                                      {.image = {NULL}}},
+                                      {.image = {NULL, RES_TEXTURE_WIN}}},
     [RES_INDEX_FONT(RES_FONT_LATO_REGULAR)] = {res_lato_regular_ttf,
                                                sizeof(res_lato_regular_ttf),
                                                "Lato-Regular.ttf",
@@ -142,39 +440,24 @@ static const EmbeddedBlob g_embedded_resources[RES_COUNT] = {
                                         "IBMPlexSerif-Regular.ttf",
                                         RES_KIND_FONT,
                                         {.font = {0}}},
-    [RES_INDEX_ICON(RES_ICON_SUN)] = {res_sun_max_fill_svg,
-                                      sizeof(res_sun_max_fill_svg),
-                                      "sun.max.fill.svg",
-                                      RES_KIND_ICON,
-                                      {.icon = {0x808080FF, 0x808080FF}}},
-    [RES_INDEX_ICON(RES_ICON_MOON)] = {res_moon_fill_svg,
-                                       sizeof(res_moon_fill_svg),
-                                       "moon.fill.svg",
-                                       RES_KIND_ICON,
-                                       {.icon = {0x808080FF, 0x808080FF}}},
-    [RES_INDEX_ICON(RES_ICON_HISTORY)] = {res_clock_arrow_circlepath_svg,
-                                          sizeof(
-                                              res_clock_arrow_circlepath_svg),
-                                          "clock.arrow.circlepath.svg",
-                                          RES_KIND_ICON,
-                                          {.icon = {0x808080FF, 0x808080FF}}},
-    [RES_INDEX_ICON(RES_ICON_TRASH)] = {res_trash_svg,
-                                        sizeof(res_trash_svg),
-                                        "trash.svg",
-                                        RES_KIND_ICON,
-                                        {.icon = {0x808080FF, 0x808080FF}}},
-    [RES_INDEX_ICON(
-        RES_ICON_ARROW_DOWN_CIRCLE)] = {res_arrow_down_circle_svg,
-                                        sizeof(res_arrow_down_circle_svg),
-                                        "arrow.down.circle.svg",
-                                        RES_KIND_ICON,
-                                        {.icon = {0x808080FF, 0x808080FF}}},
-    [RES_INDEX_ICON(
-        RES_ICON_TURN_UP_RIGHT)] = {res_arrow_turn_up_right_svg,
-                                    sizeof(res_arrow_turn_up_right_svg),
-                                    "arrow.turn.up.right.svg",
-                                    RES_KIND_ICON,
-                                    {.icon = {0x808080FF, 0x808080FF}}},
+    [RES_INDEX_ICON(RES_ICON_SUN)] = {
+        NULL, 0, "sun.max.fill.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_sun_max_fill_svg}}},
+    [RES_INDEX_ICON(RES_ICON_MOON)] = {
+        NULL, 0, "moon.fill.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_moon_fill_svg}}},
+    [RES_INDEX_ICON(RES_ICON_HISTORY)] = {
+        NULL, 0, "clock.arrow.circlepath.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_clock_arrow_circlepath_svg}}},
+    [RES_INDEX_ICON(RES_ICON_TRASH)] = {
+        NULL, 0, "trash.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_trash_svg}}},
+    [RES_INDEX_ICON(RES_ICON_ARROW_DOWN_CIRCLE)] = {
+        NULL, 0, "arrow.down.circle.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_arrow_down_circle_svg}}},
+    [RES_INDEX_ICON(RES_ICON_TURN_UP_RIGHT)] = {
+        NULL, 0, "arrow.turn.up.right.svg", RES_KIND_ICON,
+        {.icon = {0x808080FF, 0x808080FF, &res_arrow_turn_up_right_svg}}},
 };
 
 /* ===== Quick access macros ===== */
@@ -186,13 +469,57 @@ static const EmbeddedBlob g_embedded_resources[RES_COUNT] = {
 #define RES_GET_IMAGE_SIZE(id) (g_embedded_resources[RES_INDEX_IMAGE(id)].size)
 #define RES_GET_IMAGE_UV(id)                                                   \
   (g_embedded_resources[RES_INDEX_IMAGE(id)].as.image.uv)
+#define RES_GET_IMAGE_TEXTURE(id)                                              \
+  (g_embedded_resources[RES_INDEX_IMAGE(id)].as.image.texture)
+#define RES_GET_TEXTURE(id) (&g_resource_textures[id])
 #define RES_GET_FONT_DATA(id) (g_embedded_resources[RES_INDEX_FONT(id)].data)
 #define RES_GET_FONT_SIZE(id) (g_embedded_resources[RES_INDEX_FONT(id)].size)
-#define RES_GET_ICON_DATA(id) (g_embedded_resources[RES_INDEX_ICON(id)].data)
-#define RES_GET_ICON_SIZE(id) (g_embedded_resources[RES_INDEX_ICON(id)].size)
+#define RES_GET_ICON_SVG(id)                                                   \
+  (g_embedded_resources[RES_INDEX_ICON(id)].as.icon.svg)
 #define RES_GET_ICON_FILL(id)                                                  \
   (g_embedded_resources[RES_INDEX_ICON(id)].as.icon.fill)
 #define RES_GET_ICON_STROKE(id)                                                \
   (g_embedded_resources[RES_INDEX_ICON(id)].as.icon.stroke)
 
+/* ===== Glyph bake spec (expanded by tools/glyph_bake.c) ===== */
+#define RES_GLYPH_BAKE_SCALES(X)                                               \
+  X(1)                                                                         \
+  X(2)
+#define RES_GLYPH_BAKE_RANGES(X)                                               \
+  X(32, 126)                                                                   \
+  X(160, 255)
+#define RES_GLYPH_BAKE_FACES(X)                                                \
+  X(RES_FONT_LATO_REGULAR, 22)                                                 \
+  X(RES_FONT_LATO_REGULAR, 24)                                                 \
+  X(RES_FONT_LATO_REGULAR, 26)                                                 \
+  X(RES_FONT_LATO_REGULAR, 28)                                                 \
+  X(RES_FONT_LATO_REGULAR, 30)                                                 \
+  X(RES_FONT_LATO_REGULAR, 32)                                                 \
+  X(RES_FONT_LATO_REGULAR, 34)                                                 \
+  X(RES_FONT_FIRA_MONO, 22)                                                    \
+  X(RES_FONT_FIRA_MONO, 24)                                                    \
+  X(RES_FONT_FIRA_MONO, 26)                                                    \
+  X(RES_FONT_FIRA_MONO, 28)                                                    \
+  X(RES_FONT_FIRA_MONO, 30)                                                    \
+  X(RES_FONT_FIRA_MONO, 32)                                                    \
+  X(RES_FONT_FIRA_MONO, 34)                                                    \
+  X(RES_FONT_ARIAL, 22)                                                        \
+  X(RES_FONT_ARIAL, 24)                                                        \
+  X(RES_FONT_ARIAL, 26)                                                        \
+  X(RES_FONT_ARIAL, 28)                                                        \
+  X(RES_FONT_ARIAL, 30)                                                        \
+  X(RES_FONT_ARIAL, 32)                                                        \
+  X(RES_FONT_ARIAL, 34)                                                        \
+  X(RES_FONT_SERIF, 22)                                                        \
+  X(RES_FONT_SERIF, 24)                                                        \
+  X(RES_FONT_SERIF, 26)                                                        \
+  X(RES_FONT_SERIF, 28)                                                        \
+  X(RES_FONT_SERIF, 30)                                                        \
+  X(RES_FONT_SERIF, 32)                                                        \
+  X(RES_FONT_SERIF, 34)                                                        \
+  X(RES_FONT_LATO_REGULAR, 10)                                                 \
+  X(RES_FONT_LATO_REGULAR, 15)                                                 \
+  X(RES_FONT_LATO_REGULAR, 16)                                                 \
+  X(RES_FONT_FIRA_MONO, 13)
+
 #endif /* RESOURCES_H */
@@ -1,106 +1,72 @@
 #include "svg.h"
+// icons come from gen.ts as compiled geometry, so release builds only need
+// nanosvg's types and rasterizer
+#if defined(ANDEX_SVG_PARSER)
 #define NANOSVG_IMPLEMENTATION
-#include "HandmadeMath.h"
+#endif
+#define NANOSVGRAST_IMPLEMENTATION
 #include "nanosvg.h"
-#include "sokol_gfx.h"
-#include "sokol_gp.h"
+#include "nanosvgrast.h"
+#include "svg_tess.h"
 #include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-
-#define SVG_FLATNESS_PX 0.25f
-#define SVG_MAX_FLAT_POINTS 8192
-#define SVG_MAX_EDGES 16384
-#define SVG_MAX_FILL_TRIS 32768
-#define SVG_MAX_STROKE_TRIS 32768
-
-#ifndef NSVG_PI
-#define NSVG_PI 3.14159265358979323846f
-#endif
-
+#include <string.h>
+
+#define SVG_GEOM_CACHE_SIZE 32
+#define SVG_ATLAS_SIZE 1024
+// sg_update_image replaces a whole image, so the atlas is a stack of bands
+// that are textures of their own and only bands that changed upload
+#define SVG_ATLAS_BAND_HEIGHT 128
+#define SVG_ATLAS_BANDS (SVG_ATLAS_SIZE / SVG_ATLAS_BAND_HEIGHT)
+#define SVG_ATLAS_PADDING 1
+#define SVG_ATLAS_MAX_ENTRIES 256
+#define SVG_ATLAS_MAX_ICON_PX (SVG_ATLAS_BAND_HEIGHT - SVG_ATLAS_PADDING)
+
+static svg_geom_t g_svg_geom_cache[SVG_GEOM_CACHE_SIZE];
+static uint64_t g_svg_geom_clock;
+
+// One rasterized icon in the atlas. Elements drawn in a single override
+// color share a white mask that is tinted at draw time, so hover and theme
+// colors don't rasterize again; anything else is keyed by its colors.
 typedef struct {
-  uint8_t *memory;
-  size_t size;
-  size_t used;
-} svg_arena_t;
-
-static svg_arena_t g_svg_arena = {0};
-
-static void *svg_arena_alloc(size_t size) {
-  size = (size + 15) & ~15;
-
-  if (g_svg_arena.used + size > g_svg_arena.size) {
-    fprintf(stderr, "SVG arena out of memory! Requested %zu, available %zu\n",
-            size, g_svg_arena.size - g_svg_arena.used);
-    return NULL;
+  const NSVGimage *image;
+  int width_px, height_px;
+  bool mask;
+  uint32_t fill_color, stroke_color;
+  int x, y;
+} svg_atlas_entry_t;
+
+// Shelf-packed RGBA atlas for SVG_BACKEND_ATLAS. Pixels are rasterized on
+// the CPU when an icon is first drawn at a size, premultiplied so linear
+// filtering doesn't pull dark or off-color fringes in from transparent
+// texels, and the bands they landed in upload once per frame in
+// svg_end_draw. A full atlas or a dpi change starts over, but only before
+// the frame has queued any quad that samples the old contents.
+static struct {
+  NSVGrasterizer *rast;
+  uint8_t *pixels;
+  sg_image bands[SVG_ATLAS_BANDS];
+  bool dirty[SVG_ATLAS_BANDS];
+  sg_sampler sampler;
+  svg_atlas_entry_t entries[SVG_ATLAS_MAX_ENTRIES];
+  int nentries;
+  int shelf_x, shelf_y, shelf_height;
+  float dpi_scale;
+  bool reset_pending;
+  int queued;
+} g_svg_atlas;
+
+static svg_backend_t g_svg_backend;
+
+static void svg_geom_forget(const NSVGimage *image) {
+  for (int i = 0; i < SVG_GEOM_CACHE_SIZE; i++) {
+    if (g_svg_geom_cache[i].image == image)
+      svg_geom_release(&g_svg_geom_cache[i]);
   }
-
-  void *ptr = g_svg_arena.memory + g_svg_arena.used;
-  g_svg_arena.used += size;
-  return ptr;
-}
-
-static void svg_arena_reset(void) { g_svg_arena.used = 0; }
-
-typedef struct {
-  float minx, miny, maxx, maxy;
-} svg_bbox_t;
-
-typedef struct {
-  HMM_Vec2 pts[SVG_MAX_FLAT_POINTS];
-  int count;
-  svg_bbox_t bb;
-} svg_flat_poly_t;
-
-typedef struct {
-  float x0, y0, x1, y1;
-  int dir;
-} svg_edge_t;
-
-typedef struct {
-  svg_edge_t edges[SVG_MAX_EDGES];
-  int nedges;
-  sgp_triangle tris[SVG_MAX_FILL_TRIS];
-  int ntris;
-} svg_edge_fill_t;
-
-typedef struct {
-  sgp_triangle tris[SVG_MAX_STROKE_TRIS];
-  int count;
-} svg_tri_stroke_t;
-
-static inline svg_bbox_t svg_bbox_init(void) {
-  svg_bbox_t b = {+FLT_MAX, +FLT_MAX, -FLT_MAX, -FLT_MAX};
-  return b;
-}
-
-static inline void svg_bbox_add(svg_bbox_t *b, HMM_Vec2 p) {
-  if (p.X < b->minx)
-    b->minx = p.X;
-  if (p.Y < b->miny)
-    b->miny = p.Y;
-  if (p.X > b->maxx)
-    b->maxx = p.X;
-  if (p.Y > b->maxy)
-    b->maxy = p.Y;
-}
-
-static inline HMM_Vec2 svg_v2(float x, float y) { return HMM_V2(x, y); }
-
-static inline sgp_point svg_to_sgp_point(HMM_Vec2 p) {
-  sgp_point q;
-  q.x = p.X;
-  q.y = p.Y;
-  return q;
 }
 
-static inline float svg_clampf(float x, float a, float b) {
-  return x < a ? a : (x > b ? b : x);
-}
-
-static inline float svg_absf(float x) { return x < 0 ? -x : x; }
-
 static inline void svg_set_color_u32(uint32_t rgba) {
   float r = ((rgba >> 24) & 0xFF) / 255.0f;
   float g = ((rgba >> 16) & 0xFF) / 255.0f;
@@ -160,393 +126,279 @@ static inline uint32_t svg_choose_stroke_rgba(const svg_element_t *el,
   return rgba;
 }
 
-static void svg_flatten_cubic_bez(HMM_Vec2 p1, HMM_Vec2 p2, HMM_Vec2 p3,
-                                  HMM_Vec2 p4, svg_flat_poly_t *out, float tol,
-                                  int level) {
-  if (level > 10) {
-    if (out->count < SVG_MAX_FLAT_POINTS) {
-      out->pts[out->count++] = p4;
-      svg_bbox_add(&out->bb, p4);
-    }
-    return;
-  }
-
-  float x12 = (p1.X + p2.X) * 0.5f;
-  float y12 = (p1.Y + p2.Y) * 0.5f;
-  float x23 = (p2.X + p3.X) * 0.5f;
-  float y23 = (p2.Y + p3.Y) * 0.5f;
-  float x34 = (p3.X + p4.X) * 0.5f;
-  float y34 = (p3.Y + p4.Y) * 0.5f;
-  float x123 = (x12 + x23) * 0.5f;
-  float y123 = (y12 + y23) * 0.5f;
-
-  float dx = p4.X - p1.X;
-  float dy = p4.Y - p1.Y;
-  float d2 = svg_absf((p2.X - p4.X) * dy - (p2.Y - p4.Y) * dx);
-  float d3 = svg_absf((p3.X - p4.X) * dy - (p3.Y - p4.Y) * dx);
-
-  if ((d2 + d3) * (d2 + d3) < tol * (dx * dx + dy * dy)) {
-    if (out->count < SVG_MAX_FLAT_POINTS) {
-      out->pts[out->count++] = p4;
-      svg_bbox_add(&out->bb, p4);
-    }
-    return;
-  }
-
-  float x234 = (x23 + x34) * 0.5f;
-  float y234 = (y23 + y34) * 0.5f;
-  float x1234 = (x123 + x234) * 0.5f;
-  float y1234 = (y123 + y234) * 0.5f;
-
-  svg_flatten_cubic_bez(p1, svg_v2(x12, y12), svg_v2(x123, y123),
-                        svg_v2(x1234, y1234), out, tol, level + 1);
-  svg_flatten_cubic_bez(svg_v2(x1234, y1234), svg_v2(x234, y234),
-                        svg_v2(x34, y34), p4, out, tol, level + 1);
+static inline uint32_t svg_rgba_to_nsvg_color(uint32_t rgba) {
+  uint32_t rr = (rgba >> 24) & 0xFF;
+  uint32_t gg = (rgba >> 16) & 0xFF;
+  uint32_t bb = (rgba >> 8) & 0xFF;
+  uint32_t aa = rgba & 0xFF;
+  return (aa << 24) | (bb << 16) | (gg << 8) | rr;
 }
 
-static void svg_path_flatten(const NSVGpath *path, float tol,
-                             svg_flat_poly_t *out) {
-  out->count = 0;
-  out->bb = svg_bbox_init();
-  if (path->npts < 1)
-    return;
-
-  HMM_Vec2 p0 = svg_v2(path->pts[0], path->pts[1]);
-  out->pts[out->count++] = p0;
-  svg_bbox_add(&out->bb, p0);
-
-  for (int i = 0; i < path->npts - 1; i += 3) {
-    float *p = &path->pts[i * 2];
-    HMM_Vec2 p1 = svg_v2(p[0], p[1]);
-    HMM_Vec2 p2 = svg_v2(p[2], p[3]);
-    HMM_Vec2 p3 = svg_v2(p[4], p[5]);
-    HMM_Vec2 p4 = svg_v2(p[6], p[7]);
-    svg_flatten_cubic_bez(p1, p2, p3, p4, out, tol, 0);
-  }
-
-  if (path->closed && out->count > 1) {
-    HMM_Vec2 first = out->pts[0];
-    HMM_Vec2 last = out->pts[out->count - 1];
-    if (svg_absf(first.X - last.X) > 1e-6f ||
-        svg_absf(first.Y - last.Y) > 1e-6f) {
-      if (out->count < SVG_MAX_FLAT_POINTS) {
-        out->pts[out->count++] = first;
-        svg_bbox_add(&out->bb, first);
-      }
-    }
+static inline void svg_set_paint(NSVGpaint *paint, uint32_t rgba) {
+  if (rgba) {
+    paint->type = NSVG_PAINT_COLOR;
+    paint->color = svg_rgba_to_nsvg_color(rgba);
+  } else {
+    paint->type = NSVG_PAINT_NONE;
   }
 }
 
-static void svg_add_edge(svg_edge_fill_t *ef, float x0, float y0, float x1,
-                         float y1) {
-  if (ef->nedges >= SVG_MAX_EDGES)
-    return;
-  if (svg_absf(y0 - y1) < 1e-6f)
-    return;
+static void svg_atlas_reset(void) {
+  g_svg_atlas.nentries = 0;
+  g_svg_atlas.shelf_x = 0;
+  g_svg_atlas.shelf_y = 0;
+  g_svg_atlas.shelf_height = 0;
+  g_svg_atlas.reset_pending = false;
+  // padding texels must stay transparent for linear filtering; a band
+  // uploads whole the next time an icon lands in it
+  memset(g_svg_atlas.pixels, 0, SVG_ATLAS_SIZE * SVG_ATLAS_SIZE * 4);
+}
 
-  svg_edge_t *e = &ef->edges[ef->nedges++];
-  if (y0 < y1) {
-    e->x0 = x0;
-    e->y0 = y0;
-    e->x1 = x1;
-    e->y1 = y1;
-    e->dir = 1;
-  } else {
-    e->x0 = x1;
-    e->y0 = y1;
-    e->x1 = x0;
-    e->y1 = y0;
-    e->dir = -1;
+static void svg_atlas_forget(const NSVGimage *image) {
+  for (int i = 0; i < g_svg_atlas.nentries; i++) {
+    if (g_svg_atlas.entries[i].image == image)
+      g_svg_atlas.entries[i].image = NULL;
   }
 }
 
-static int svg_cmp_edge(const void *a, const void *b) {
-  const svg_edge_t *ea = (const svg_edge_t *)a;
-  const svg_edge_t *eb = (const svg_edge_t *)b;
-  if (ea->y0 < eb->y0)
-    return -1;
-  if (ea->y0 > eb->y0)
-    return 1;
-  return 0;
+static bool svg_atlas_pack(int w, int h, int *x, int *y) {
+  const int pw = w + SVG_ATLAS_PADDING;
+  const int ph = h + SVG_ATLAS_PADDING;
+  if (g_svg_atlas.shelf_x + pw > SVG_ATLAS_SIZE) {
+    g_svg_atlas.shelf_y += g_svg_atlas.shelf_height;
+    g_svg_atlas.shelf_x = 0;
+    g_svg_atlas.shelf_height = 0;
+  }
+  // a shelf never straddles two bands
+  const int band_end =
+      (g_svg_atlas.shelf_y / SVG_ATLAS_BAND_HEIGHT + 1) * SVG_ATLAS_BAND_HEIGHT;
+  if (g_svg_atlas.shelf_y + ph > band_end) {
+    g_svg_atlas.shelf_y = band_end;
+    g_svg_atlas.shelf_x = 0;
+    g_svg_atlas.shelf_height = 0;
+  }
+  if (g_svg_atlas.shelf_y + ph > SVG_ATLAS_SIZE)
+    return false;
+
+  *x = g_svg_atlas.shelf_x;
+  *y = g_svg_atlas.shelf_y;
+  g_svg_atlas.shelf_x += pw;
+  if (ph > g_svg_atlas.shelf_height)
+    g_svg_atlas.shelf_height = ph;
+  return true;
 }
 
-static void svg_edges_to_triangles(svg_edge_fill_t *ef, int fillRule) {
-  if (ef->nedges == 0)
-    return;
-
-  qsort(ef->edges, ef->nedges, sizeof(svg_edge_t), svg_cmp_edge);
-
-  float ymin = ef->edges[0].y0;
-  float ymax = ymin;
-  for (int i = 0; i < ef->nedges; i++) {
-    if (ef->edges[i].y1 > ymax)
-      ymax = ef->edges[i].y1;
+// Rasterizes with the colors the triangle backend would pick for each
+// shape, by swapping them into the image for the duration of the call.
+static bool svg_atlas_rasterize(const svg_element_t *el, NSVGimage *image,
+                                const svg_atlas_entry_t *entry) {
+  svg_arena_reset();
+  int nshapes = 0;
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    nshapes++;
+  NSVGshape *saved =
+      (NSVGshape *)svg_arena_alloc((size_t)nshapes * sizeof(NSVGshape));
+  if (!saved)
+    return false;
+
+  svg_element_t colors = *el;
+  colors.opacity_override = 1.0f;
+  if (entry->mask) {
+    colors.fill_color = 0xFFFFFFFF;
+    colors.stroke_color = 0xFFFFFFFF;
   }
 
-  float step = 1.0f;
-  ef->ntris = 0;
-
-  for (float y = ymin; y < ymax && ef->ntris < SVG_MAX_FILL_TRIS - 2;
-       y += step) {
-    float y_next = HMM_MIN(y + step, ymax);
-
-    typedef struct {
-      float x;
-      int dir;
-    } isect_t;
-    isect_t isects[256];
-    int n_isects = 0;
-
-    float y_mid = (y + y_next) * 0.5f;
+  int index = 0;
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next) {
+    saved[index++] = *shape;
+    uint32_t fill_rgba = svg_choose_fill_rgba(&colors, shape);
+    uint32_t stroke_rgba = svg_choose_stroke_rgba(&colors, shape);
+    svg_set_paint(&shape->fill, fill_rgba);
+    svg_set_paint(&shape->stroke, stroke_rgba);
+    shape->opacity = 1.0f;
+  }
 
-    for (int i = 0; i < ef->nedges && n_isects < 256; i++) {
-      svg_edge_t *e = &ef->edges[i];
+  uint8_t *dst =
+      g_svg_atlas.pixels + ((size_t)entry->y * SVG_ATLAS_SIZE + entry->x) * 4;
+  nsvgRasterizeXY(g_svg_atlas.rast, image, 0.0f, 0.0f,
+                  (float)entry->width_px / image->width,
+                  (float)entry->height_px / image->height, dst,
+                  entry->width_px, entry->height_px, SVG_ATLAS_SIZE * 4);
+
+  index = 0;
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next) {
+    shape->fill = saved[index].fill;
+    shape->stroke = saved[index].stroke;
+    shape->opacity = saved[index].opacity;
+    index++;
+  }
 
-      if (e->y0 <= y_mid && y_mid < e->y1) {
-        float t = (y_mid - e->y0) / (e->y1 - e->y0);
-        isects[n_isects].x = e->x0 + t * (e->x1 - e->x0);
-        isects[n_isects].dir = e->dir;
-        n_isects++;
-      }
+  for (int y = 0; y < entry->height_px; y++) {
+    uint8_t *px = dst + (size_t)y * SVG_ATLAS_SIZE * 4;
+    for (int x = 0; x < entry->width_px; x++, px += 4) {
+      const unsigned a = px[3];
+      px[0] = (uint8_t)((px[0] * a + 127) / 255);
+      px[1] = (uint8_t)((px[1] * a + 127) / 255);
+      px[2] = (uint8_t)((px[2] * a + 127) / 255);
     }
+  }
+  g_svg_atlas.dirty[entry->y / SVG_ATLAS_BAND_HEIGHT] = true;
+  return true;
+}
 
-    for (int i = 0; i < n_isects - 1; i++) {
-      for (int j = i + 1; j < n_isects; j++) {
-        if (isects[i].x > isects[j].x) {
-          isect_t tmp = isects[i];
-          isects[i] = isects[j];
-          isects[j] = tmp;
-        }
-      }
-    }
+static const svg_atlas_entry_t *svg_atlas_get(const svg_element_t *el,
+                                              float width_px, float height_px,
+                                              float dpi_scale) {
+  const int w = (int)(width_px + 0.5f);
+  const int h = (int)(height_px + 0.5f);
+  if (w <= 0 || h <= 0 || w > SVG_ATLAS_MAX_ICON_PX ||
+      h > SVG_ATLAS_MAX_ICON_PX)
+    return NULL;
 
-    if (fillRule == NSVG_FILLRULE_EVENODD) {
-      for (int i = 0; i < n_isects - 1; i += 2) {
-        if (ef->ntris < SVG_MAX_FILL_TRIS - 2) {
-          float x0 = isects[i].x;
-          float x1 = isects[i + 1].x;
-
-          HMM_Vec2 a = svg_v2(x0, y);
-          HMM_Vec2 b = svg_v2(x1, y);
-          HMM_Vec2 c = svg_v2(x1, y_next);
-          HMM_Vec2 d = svg_v2(x0, y_next);
-
-          ef->tris[ef->ntris].a = svg_to_sgp_point(a);
-          ef->tris[ef->ntris].b = svg_to_sgp_point(b);
-          ef->tris[ef->ntris].c = svg_to_sgp_point(c);
-          ef->ntris++;
-
-          ef->tris[ef->ntris].a = svg_to_sgp_point(a);
-          ef->tris[ef->ntris].b = svg_to_sgp_point(c);
-          ef->tris[ef->ntris].c = svg_to_sgp_point(d);
-          ef->ntris++;
-        }
-      }
-    } else {
-      int winding = 0;
-      for (int i = 0; i < n_isects - 1; i++) {
-        winding += isects[i].dir;
-
-        if (winding != 0 && ef->ntris < SVG_MAX_FILL_TRIS - 2) {
-          float x0 = isects[i].x;
-          float x1 = isects[i + 1].x;
-
-          HMM_Vec2 a = svg_v2(x0, y);
-          HMM_Vec2 b = svg_v2(x1, y);
-          HMM_Vec2 c = svg_v2(x1, y_next);
-          HMM_Vec2 d = svg_v2(x0, y_next);
-
-          ef->tris[ef->ntris].a = svg_to_sgp_point(a);
-          ef->tris[ef->ntris].b = svg_to_sgp_point(b);
-          ef->tris[ef->ntris].c = svg_to_sgp_point(c);
-          ef->ntris++;
-
-          ef->tris[ef->ntris].a = svg_to_sgp_point(a);
-          ef->tris[ef->ntris].b = svg_to_sgp_point(c);
-          ef->tris[ef->ntris].c = svg_to_sgp_point(d);
-          ef->ntris++;
-        }
-      }
-    }
+  if (dpi_scale != g_svg_atlas.dpi_scale) {
+    // every cached size belongs to the old scale
+    g_svg_atlas.dpi_scale = dpi_scale;
+    g_svg_atlas.reset_pending = true;
+  }
+  if (g_svg_atlas.reset_pending) {
+    if (g_svg_atlas.queued > 0)
+      return NULL;
+    svg_atlas_reset();
   }
-}
 
-static inline void svg_push_tri(svg_tri_stroke_t *tb, HMM_Vec2 a, HMM_Vec2 b,
-                                HMM_Vec2 c) {
-  if (tb->count < SVG_MAX_STROKE_TRIS) {
-    tb->tris[tb->count].a = svg_to_sgp_point(a);
-    tb->tris[tb->count].b = svg_to_sgp_point(b);
-    tb->tris[tb->count].c = svg_to_sgp_point(c);
-    tb->count++;
+  const bool mask = el->fill_color != 0 && el->fill_color == el->stroke_color;
+  const uint32_t fill_color = mask ? 0 : el->fill_color;
+  const uint32_t stroke_color = mask ? 0 : el->stroke_color;
+  for (int i = 0; i < g_svg_atlas.nentries; i++) {
+    const svg_atlas_entry_t *e = &g_svg_atlas.entries[i];
+    if (e->image == el->image && e->width_px == w && e->height_px == h &&
+        e->mask == mask && e->fill_color == fill_color &&
+        e->stroke_color == stroke_color)
+      return e;
   }
-}
 
-static inline void svg_push_quad(svg_tri_stroke_t *tb, HMM_Vec2 a, HMM_Vec2 b,
-                                 HMM_Vec2 c, HMM_Vec2 d) {
-  svg_push_tri(tb, a, b, c);
-  svg_push_tri(tb, a, c, d);
-}
+  int x, y;
+  if (g_svg_atlas.nentries == SVG_ATLAS_MAX_ENTRIES ||
+      !svg_atlas_pack(w, h, &x, &y)) {
+    if (g_svg_atlas.queued > 0) {
+      g_svg_atlas.reset_pending = true;
+      return NULL;
+    }
+    svg_atlas_reset();
+    if (!svg_atlas_pack(w, h, &x, &y))
+      return NULL;
+  }
 
-static HMM_Vec2 svg_normal_of(HMM_Vec2 a, HMM_Vec2 b) {
-  HMM_Vec2 d = HMM_SubV2(b, a);
-  float L2 = HMM_DotV2(d, d);
-  if (L2 <= 1e-20f)
-    return HMM_V2(0, 0);
-  HMM_Vec2 n = HMM_V2(-d.Y, d.X);
-  return HMM_MulV2F(n, HMM_InvSqrtF(L2));
+  svg_atlas_entry_t *entry = &g_svg_atlas.entries[g_svg_atlas.nentries];
+  *entry = (svg_atlas_entry_t){.image = el->image,
+                               .width_px = w,
+                               .height_px = h,
+                               .mask = mask,
+                               .fill_color = fill_color,
+                               .stroke_color = stroke_color,
+                               .x = x,
+                               .y = y};
+  if (!svg_atlas_rasterize(el, el->image, entry))
+    return NULL;
+  g_svg_atlas.nentries++;
+  return entry;
 }
 
-static void svg_fan_arc(svg_tri_stroke_t *tb, HMM_Vec2 p, HMM_Vec2 n0,
-                        HMM_Vec2 n1, float r, int side, float tol) {
-  float dot = svg_clampf(HMM_DotV2(n0, n1), -1.0f, 1.0f);
-  float theta = acosf(dot);
-  if (theta < 1e-4f)
-    return;
-
-  float da = acosf(r / (r + tol)) * 2.0f;
-  int segs = (int)ceilf(theta / da);
-  if (segs < 2)
-    segs = 2;
-  if (segs > 64)
-    segs = 64;
-
-  float ang = theta / (float)segs;
-  if (side < 0)
-    ang = -ang;
-
-  HMM_Vec2 prev = HMM_AddV2(p, HMM_MulV2F(n0, r));
-
-  for (int i = 1; i <= segs; i++) {
-    float t = ang * i;
-    float s = sinf(t), c = cosf(t);
-    HMM_Vec2 nextN = HMM_V2(c * n0.X - s * n0.Y, s * n0.X + c * n0.Y);
-    if (side < 0)
-      nextN = HMM_V2(nextN.X, -nextN.Y);
-
-    HMM_Vec2 cur = HMM_AddV2(p, HMM_MulV2F(nextN, r));
-    svg_push_tri(tb, p, prev, cur);
-    prev = cur;
+static bool svg_atlas_init(void) {
+  g_svg_atlas.rast = nsvgCreateRasterizer();
+  g_svg_atlas.pixels = calloc(1, SVG_ATLAS_SIZE * SVG_ATLAS_SIZE * 4);
+  if (!g_svg_atlas.rast || !g_svg_atlas.pixels)
+    return false;
+
+  for (int band = 0; band < SVG_ATLAS_BANDS; band++) {
+    g_svg_atlas.bands[band] = sg_make_image(&(sg_image_desc){
+        .usage = {.dynamic_update = true},
+        .width = SVG_ATLAS_SIZE,
+        .height = SVG_ATLAS_BAND_HEIGHT,
+        .pixel_format = SG_PIXELFORMAT_RGBA8,
+        .label = "svg-atlas",
+    });
   }
+  g_svg_atlas.sampler = sg_make_sampler(&(sg_sampler_desc){
+      .min_filter = SG_FILTER_LINEAR,
+      .mag_filter = SG_FILTER_LINEAR,
+      .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+      .wrap_v = SG_WRAP_CLAMP_TO_EDGE,
+  });
+  g_svg_atlas.dpi_scale = 0.0f;
+  svg_atlas_reset();
+  return true;
 }
 
-static void svg_stroke_tessellate(const HMM_Vec2 *p, int n, HMM_Bool closed,
-                                  float width, int join, int cap,
-                                  float miterLimit, float tol,
-                                  svg_tri_stroke_t *out) {
-  if (n < 2 || width <= 0.0f) {
-    out->count = 0;
-    return;
-  }
-  out->count = 0;
-  const float hw = 0.5f * width;
-
-  for (int i = 0; i < n - 1; i++) {
-    HMM_Vec2 a = p[i], b = p[i + 1];
-    HMM_Vec2 nrm = svg_normal_of(a, b);
-    if (HMM_DotV2(nrm, nrm) < 1e-8f)
-      continue;
-
-    HMM_Vec2 aL = HMM_AddV2(a, HMM_MulV2F(nrm, hw));
-    HMM_Vec2 aR = HMM_SubV2(a, HMM_MulV2F(nrm, hw));
-    HMM_Vec2 bL = HMM_AddV2(b, HMM_MulV2F(nrm, hw));
-    HMM_Vec2 bR = HMM_SubV2(b, HMM_MulV2F(nrm, hw));
-    svg_push_quad(out, aL, bL, bR, aR);
-    if (out->count >= SVG_MAX_STROKE_TRIS)
-      return;
+static void svg_atlas_cleanup(void) {
+  if (g_svg_atlas.rast) {
+    sg_destroy_sampler(g_svg_atlas.sampler);
+    for (int band = 0; band < SVG_ATLAS_BANDS; band++)
+      sg_destroy_image(g_svg_atlas.bands[band]);
+    nsvgDeleteRasterizer(g_svg_atlas.rast);
   }
+  free(g_svg_atlas.pixels);
+  memset(&g_svg_atlas, 0, sizeof(g_svg_atlas));
+}
 
-  for (int i = 1; i < n - 1; i++) {
-    HMM_Vec2 a = p[i - 1], b = p[i], c = p[i + 1];
-    HMM_Vec2 dn0 = HMM_NormV2(HMM_SubV2(b, a));
-    HMM_Vec2 dn1 = HMM_NormV2(HMM_SubV2(c, b));
-    if (HMM_DotV2(dn0, dn0) < 1e-8f || HMM_DotV2(dn1, dn1) < 1e-8f)
-      continue;
+static void svg_atlas_draw(const svg_element_t *el,
+                           const svg_atlas_entry_t *entry, float x_px,
+                           float y_px, float width_px, float height_px) {
+  uint32_t tint = entry->mask ? el->fill_color : 0xFFFFFFFF;
+  float alpha = (tint & 0xFF) / 255.0f;
+  if (el->opacity_override < 1.0f)
+    alpha *= el->opacity_override;
+
+  // the texels are premultiplied, so the tint has to be as well
+  sgp_set_color(((tint >> 24) & 0xFF) / 255.0f * alpha,
+                ((tint >> 16) & 0xFF) / 255.0f * alpha,
+                ((tint >> 8) & 0xFF) / 255.0f * alpha, alpha);
+  sgp_set_blend_mode(SGP_BLENDMODE_BLEND_PREMULTIPLIED);
+  const int band = entry->y / SVG_ATLAS_BAND_HEIGHT;
+  sgp_set_image(0, g_svg_atlas.bands[band]);
+  sgp_set_sampler(0, g_svg_atlas.sampler);
+  sgp_draw_textured_rect(
+      0, (sgp_rect){x_px, y_px, width_px, height_px},
+      (sgp_rect){(float)entry->x,
+                 (float)(entry->y - band * SVG_ATLAS_BAND_HEIGHT),
+                 (float)entry->width_px, (float)entry->height_px});
+  sgp_reset_sampler(0);
+  sgp_reset_image(0);
+  sgp_set_blend_mode(SGP_BLENDMODE_BLEND);
+  g_svg_atlas.queued++;
+}
 
-    HMM_Vec2 n0 = HMM_V2(-dn0.Y, dn0.X);
-    HMM_Vec2 n1 = HMM_V2(-dn1.Y, dn1.X);
-
-    float cross = dn0.X * dn1.Y - dn0.Y * dn1.X;
-    float dot = HMM_DotV2(dn0, dn1);
-    int left_turn = (cross > 0.0f) ? 1 : -1;
-
-    HMM_Bool did_join = 0;
-    if (join == NSVG_JOIN_MITER && svg_absf(1.0f + dot) > 1e-6f) {
-      HMM_Vec2 m = HMM_AddV2(n0, n1);
-      float mlen2 = HMM_DotV2(m, m);
-      if (mlen2 > 1e-8f) {
-        HMM_Vec2 mN = HMM_MulV2F(m, HMM_InvSqrtF(mlen2));
-        HMM_Vec2 outerN = (left_turn > 0) ? n1 : HMM_MulV2F(n1, -1.0f);
-        float denom = HMM_DotV2(mN, outerN);
-        if (svg_absf(denom) > 1e-6f) {
-          float ml = hw / denom;
-          if (svg_absf(ml) <= miterLimit * hw) {
-            HMM_Vec2 outer = HMM_AddV2(b, HMM_MulV2F(mN, ml));
-            HMM_Vec2 tip0 =
-                HMM_AddV2(b, HMM_MulV2F(n0, left_turn > 0 ? hw : -hw));
-            HMM_Vec2 tip1 =
-                HMM_AddV2(b, HMM_MulV2F(n1, left_turn > 0 ? hw : -hw));
-            if (left_turn > 0)
-              svg_push_tri(out, tip0, outer, tip1);
-            else
-              svg_push_tri(out, tip1, outer, tip0);
-            did_join = 1;
-          }
-        }
-      }
-    }
-    if (!did_join && join == NSVG_JOIN_BEVEL) {
-      HMM_Vec2 tip0 = HMM_AddV2(b, HMM_MulV2F(n0, left_turn > 0 ? hw : -hw));
-      HMM_Vec2 tip1 = HMM_AddV2(b, HMM_MulV2F(n1, left_turn > 0 ? hw : -hw));
-      svg_push_tri(out, b, tip0, tip1);
-    } else if (!did_join && join == NSVG_JOIN_ROUND) {
-      HMM_Vec2 start = (left_turn > 0) ? n0 : HMM_MulV2F(n0, -1.0f);
-      HMM_Vec2 end = (left_turn > 0) ? n1 : HMM_MulV2F(n1, -1.0f);
-      svg_fan_arc(out, b, start, end, hw, left_turn, tol);
+static const svg_geom_t *svg_geom_get(const NSVGimage *image, float width_px,
+                                      float height_px) {
+  int w = (int)(width_px + 0.5f);
+  int h = (int)(height_px + 0.5f);
+  g_svg_geom_clock++;
+
+  svg_geom_t *victim = &g_svg_geom_cache[0];
+  for (int i = 0; i < SVG_GEOM_CACHE_SIZE; i++) {
+    svg_geom_t *g = &g_svg_geom_cache[i];
+    if (g->image == image && g->width_px == w && g->height_px == h) {
+      g->last_used = g_svg_geom_clock;
+      return g;
     }
-
-    if (out->count >= SVG_MAX_STROKE_TRIS)
-      return;
+    if (g->last_used < victim->last_used)
+      victim = g;
   }
 
-  if (!closed && cap != NSVG_CAP_BUTT) {
-
-    {
-      HMM_Vec2 a = p[0], b = p[1];
-      HMM_Vec2 dir = HMM_NormV2(HMM_SubV2(b, a));
-      HMM_Vec2 nrm = HMM_V2(-dir.Y, dir.X);
-
-      if (cap == NSVG_CAP_SQUARE) {
-        HMM_Vec2 back = HMM_SubV2(a, HMM_MulV2F(dir, hw));
-        HMM_Vec2 bL = HMM_AddV2(back, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 bR = HMM_SubV2(back, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 aL = HMM_AddV2(a, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 aR = HMM_SubV2(a, HMM_MulV2F(nrm, hw));
-        svg_push_quad(out, bL, aL, aR, bR);
-      } else if (cap == NSVG_CAP_ROUND) {
-        svg_fan_arc(out, a, nrm, HMM_MulV2F(nrm, -1.0f), hw, -1, tol);
-      }
-    }
-
-    {
-      HMM_Vec2 a = p[n - 2], b = p[n - 1];
-      HMM_Vec2 dir = HMM_NormV2(HMM_SubV2(b, a));
-      HMM_Vec2 nrm = HMM_V2(-dir.Y, dir.X);
-
-      if (cap == NSVG_CAP_SQUARE) {
-        HMM_Vec2 fwd = HMM_AddV2(b, HMM_MulV2F(dir, hw));
-        HMM_Vec2 bL = HMM_AddV2(b, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 bR = HMM_SubV2(b, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 cL = HMM_AddV2(fwd, HMM_MulV2F(nrm, hw));
-        HMM_Vec2 cR = HMM_SubV2(fwd, HMM_MulV2F(nrm, hw));
-        svg_push_quad(out, bL, cL, cR, bR);
-      } else if (cap == NSVG_CAP_ROUND) {
-        svg_fan_arc(out, b, HMM_MulV2F(nrm, -1.0f), nrm, hw, -1, tol);
-      }
-    }
+  svg_geom_release(victim);
+  victim->image = image;
+  victim->width_px = w;
+  victim->height_px = h;
+  victim->last_used = g_svg_geom_clock;
+  if (!svg_geom_build(victim, image, width_px / image->width,
+                      height_px / image->height, NULL)) {
+    svg_geom_release(victim);
+    return NULL;
   }
+  return victim;
 }
 
-void svg_init(int sample_count) {
+void svg_init(int sample_count, svg_backend_t backend) {
   sgp_desc sgpdesc = {0};
   sgpdesc.sample_count = sample_count;
   sgp_setup(&sgpdesc);
@@ -557,38 +409,48 @@ void svg_init(int sample_count) {
   }
   sgp_set_blend_mode(SGP_BLENDMODE_BLEND);
 
-  g_svg_arena.size = 2 * 1024 * 1024;
-  g_svg_arena.memory = calloc(1, g_svg_arena.size);
-  g_svg_arena.used = 0;
-
-  if (!g_svg_arena.memory) {
-    fprintf(stderr, "Failed to allocate SVG arena memory\n");
-    exit(-1);
+  g_svg_backend = backend;
+  if (backend == SVG_BACKEND_ATLAS && !svg_atlas_init()) {
+    fprintf(stderr, "Failed to create SVG atlas, drawing triangles\n");
+    svg_atlas_cleanup();
+    g_svg_backend = SVG_BACKEND_TRIANGLES;
   }
 }
 
 void svg_cleanup(void) {
   sgp_shutdown();
 
-  if (g_svg_arena.memory) {
-    free(g_svg_arena.memory);
-    g_svg_arena.memory = NULL;
-    g_svg_arena.size = 0;
-    g_svg_arena.used = 0;
-  }
+  for (int i = 0; i < SVG_GEOM_CACHE_SIZE; i++)
+    svg_geom_release(&g_svg_geom_cache[i]);
+  svg_atlas_cleanup();
+  svg_tess_cleanup();
 }
 
 void svg_begin_draw(int width, int height) {
   sgp_begin(width, height);
   sgp_viewport(0, 0, width, height);
   sgp_set_blend_mode(SGP_BLENDMODE_BLEND);
+  g_svg_atlas.queued = 0;
 }
 
 void svg_end_draw(void) {
+  // sgp_flush issues the queued quads, so they see this upload
+  for (int band = 0; band < SVG_ATLAS_BANDS && g_svg_atlas.rast; band++) {
+    if (!g_svg_atlas.dirty[band])
+      continue;
+    const size_t band_bytes = SVG_ATLAS_SIZE * SVG_ATLAS_BAND_HEIGHT * 4;
+    sg_update_image(g_svg_atlas.bands[band],
+                    &(sg_image_data){.subimage[0][0] = {
+                                         .ptr = g_svg_atlas.pixels +
+                                                band * band_bytes,
+                                         .size = band_bytes}});
+    g_svg_atlas.dirty[band] = false;
+  }
   sgp_flush();
   sgp_end();
 }
 
+#if defined(ANDEX_SVG_PARSER)
 NSVGimage *svg_load_file(const char *filename, float dpi) {
   return nsvgParseFromFile(filename, "px", dpi);
 }
@@ -596,10 +458,17 @@ NSVGimage *svg_load_file(const char *filename, float dpi) {
 NSVGimage *svg_parse(char *data, float dpi) {
   return nsvgParse(data, "px", dpi);
 }
+#endif
 
 void svg_free(NSVGimage *image) {
   if (image) {
+    svg_geom_forget(image);
+    svg_atlas_forget(image);
+#if defined(ANDEX_SVG_PARSER)
     nsvgDelete(image);
+#else
+    svg_image_delete(image);
+#endif
   }
 }
 
@@ -618,89 +487,50 @@ void svg_render_element(const svg_element_t *element, float x, float y,
   if (!element || !element->image)
     return;
 
-  svg_arena_reset();
-
-  svg_edge_fill_t *ef =
-      (svg_edge_fill_t *)svg_arena_alloc(sizeof(svg_edge_fill_t));
-  svg_flat_poly_t *fp =
-      (svg_flat_poly_t *)svg_arena_alloc(sizeof(svg_flat_poly_t));
-  svg_tri_stroke_t *sb =
-      (svg_tri_stroke_t *)svg_arena_alloc(sizeof(svg_tri_stroke_t));
+  if (g_svg_backend == SVG_BACKEND_ATLAS) {
+    // oversized icons and frames waiting on an atlas reset use triangles
+    const svg_atlas_entry_t *entry = svg_atlas_get(
+        element, width * dpi_scale, height * dpi_scale, dpi_scale);
+    if (entry) {
+      svg_atlas_draw(element, entry, x * dpi_scale, y * dpi_scale,
+                     width * dpi_scale, height * dpi_scale);
+      return;
+    }
+  }
 
-  if (!ef || !fp || !sb) {
-    fprintf(stderr, "Failed to allocate from SVG arena\n");
+  const svg_geom_t *geom = svg_geom_get(element->image, width * dpi_scale,
+                                        height * dpi_scale);
+  if (!geom)
     return;
-  }
 
   const float x_px = x * dpi_scale;
   const float y_px = y * dpi_scale;
   const float sx = (width * dpi_scale) / element->image->width;
   const float sy = (height * dpi_scale) / element->image->height;
 
-  const float smax = (sx > sy) ? sx : sy;
-  const float tol_svg =
-      (smax > 0.0f) ? (SVG_FLATNESS_PX / smax) : SVG_FLATNESS_PX;
-  const float tol = tol_svg * tol_svg * 0.25f;
-
   sgp_push_transform();
   sgp_translate(x_px, y_px);
   sgp_scale(sx, sy);
   sgp_set_blend_mode(SGP_BLENDMODE_BLEND);
 
-  for (NSVGshape *shape = element->image->shapes; shape; shape = shape->next) {
-    if (!(shape->flags & NSVG_FLAGS_VISIBLE))
-      continue;
+  int index = 0;
+  for (NSVGshape *shape = element->image->shapes; shape;
+       shape = shape->next, index++) {
+    const svg_shape_geom_t *sg = &geom->shapes[index];
 
     uint32_t fill_rgba = svg_choose_fill_rgba(element, shape);
-    if (fill_rgba && shape->paths) {
-      ef->nedges = 0;
-      ef->ntris = 0;
-      for (NSVGpath *path = shape->paths; path; path = path->next) {
-        if (path->npts < 4)
-          continue;
-
-        fp->count = 0;
-        svg_path_flatten(path, tol, fp);
-
-        for (int j = 0, k = fp->count - 1; j < fp->count; k = j++) {
-          svg_add_edge(ef, fp->pts[k].X, fp->pts[k].Y, fp->pts[j].X,
-                       fp->pts[j].Y);
-        }
-      }
-
-      svg_edges_to_triangles(ef, shape->fillRule);
-
-      if (ef->ntris > 0) {
-        svg_set_color_u32(fill_rgba);
-        sgp_draw_filled_triangles(ef->tris, (uint32_t)ef->ntris);
-      }
+    if (fill_rgba && sg->fill_count > 0) {
+      svg_set_color_u32(fill_rgba);
+      sgp_draw_filled_triangles(geom->tris + sg->fill_start, sg->fill_count);
     }
 
     uint32_t stroke_rgba = svg_choose_stroke_rgba(element, shape);
-    float sw = shape->strokeWidth;
-    if (stroke_rgba && sw > 0.0f && shape->paths) {
+    if (stroke_rgba && sg->stroke_count > 0) {
       svg_set_color_u32(stroke_rgba);
-
-      for (NSVGpath *path = shape->paths; path; path = path->next) {
-        if (path->npts < 4)
-          continue;
-
-        fp->count = 0;
-        svg_path_flatten(path, tol, fp);
-
-        if (fp->count >= 2) {
-          sb->count = 0;
-          svg_stroke_tessellate(
-              fp->pts, fp->count, path->closed, sw, (int)shape->strokeLineJoin,
-              (int)shape->strokeLineCap,
-              shape->miterLimit > 0.0f ? shape->miterLimit : 4.0f, tol_svg, sb);
-          if (sb->count > 0) {
-            sgp_draw_filled_triangles(sb->tris, (uint32_t)sb->count);
-          }
-        }
-      }
+      sgp_draw_filled_triangles(geom->tris + sg->stroke_start,
+                                sg->stroke_count);
     }
   }
 
   sgp_pop_transform();
-}
\ No newline at end of file
+}
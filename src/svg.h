@@ -2,10 +2,39 @@
 #define SVG_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct NSVGimage NSVGimage;
 
+// Icons compiled by gen.ts into the layout nanosvg's parser produces at
+// 96 dpi: transforms applied, each path a start point followed by cubic
+// segments (x1 y1 x2 y2 x y).
+typedef struct {
+  uint32_t first_pt; // index of the path's start point in pts
+  uint32_t npts;
+  bool closed;
+} svg_compiled_path_t;
+
+typedef struct {
+  uint32_t fill, stroke; // 0xAABBGGRR like NSVGpaint.color
+  bool has_fill, has_stroke;
+  float opacity;
+  float stroke_width;
+  float miter_limit;
+  uint8_t fill_rule, line_join, line_cap;
+  bool visible;
+  uint32_t first_path, npaths;
+} svg_compiled_shape_t;
+
+typedef struct {
+  float width, height;
+  const svg_compiled_shape_t *shapes;
+  uint32_t nshapes;
+  const svg_compiled_path_t *paths;
+  const float *pts; // x, y pairs
+} svg_compiled_t;
+
 typedef struct {
   NSVGimage *image;
   uint32_t fill_color;
@@ -13,17 +42,41 @@ typedef struct {
   float opacity_override;
 } svg_element_t;
 
-void svg_init(int sample_count);
+typedef enum {
+  // tessellated triangles, cached per pixel size
+  SVG_BACKEND_TRIANGLES,
+  // icons rasterized once per pixel size into a texture atlas and drawn as
+  // tinted quads
+  SVG_BACKEND_ATLAS,
+} svg_backend_t;
+
+typedef struct {
+  size_t arena_peak_bytes; // most scratch memory one build needed
+  size_t arena_reserved_bytes;
+  int max_flat_points; // longest flattened path
+  int max_edges;       // most fill edges in one shape
+  int max_stroke_tris; // most stroke triangles for one path
+} svg_scratch_stats_t;
+
+void svg_init(int sample_count, svg_backend_t backend);
 
 void svg_cleanup(void);
 
+// high-water marks of the tessellation scratch space since svg_init
+svg_scratch_stats_t svg_scratch_stats(void);
+
 void svg_begin_draw(int width, int height);
 
 void svg_end_draw(void);
 
+// builds an image svg_free can release, without any XML parsing
+NSVGimage *svg_load_compiled(const svg_compiled_t *compiled);
+
+#if defined(ANDEX_SVG_PARSER)
 NSVGimage *svg_load_file(const char *filename, float dpi);
 
 NSVGimage *svg_parse(char *data, float dpi);
+#endif
 
 void svg_free(NSVGimage *image);
 
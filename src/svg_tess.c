@@ -0,0 +1,897 @@
+#include "svg_tess.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SVG_FLATNESS_PX 0.25f
+#define SVG_ARENA_BLOCK_SIZE (64 * 1024)
+#define SVG_SWEEP_EPS 1e-5f
+#define SVG_SWEEP_MAX_SPLITS 8
+
+#ifndef NSVG_PI
+#define NSVG_PI 3.14159265358979323846f
+#endif
+
+typedef struct svg_arena_block {
+  struct svg_arena_block *next;
+  size_t size;
+  size_t used;
+} svg_arena_block_t;
+
+// block memory starts after the header, keeping malloc's 16 byte alignment
+#define SVG_ARENA_HEADER_SIZE ((sizeof(svg_arena_block_t) + 15) & ~(size_t)15)
+
+// Scratch memory for one tessellation or rasterization, reset before each.
+// Blocks are chained instead of reallocated so earlier allocations stay put,
+// and kept across resets, so steady-state builds don't call malloc.
+typedef struct {
+  svg_arena_block_t *first;
+  svg_arena_block_t *current;
+  size_t used;
+  size_t peak;
+  size_t reserved;
+  bool failed;
+} svg_arena_t;
+
+typedef struct {
+  svg_arena_block_t *block;
+  size_t block_used;
+  size_t used;
+} svg_arena_mark_t;
+
+static svg_arena_t g_svg_arena = {0};
+
+static svg_arena_block_t *svg_arena_new_block(size_t size) {
+  svg_arena_block_t *block = malloc(SVG_ARENA_HEADER_SIZE + size);
+  if (!block)
+    return NULL;
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+  g_svg_arena.reserved += size;
+  return block;
+}
+
+void *svg_arena_alloc(size_t size) {
+  size = (size + 15) & ~(size_t)15;
+
+  svg_arena_block_t *block = g_svg_arena.current;
+  if (!block) {
+    if (!g_svg_arena.first) {
+      g_svg_arena.first = svg_arena_new_block(
+          size > SVG_ARENA_BLOCK_SIZE ? size : SVG_ARENA_BLOCK_SIZE);
+    }
+    block = g_svg_arena.first;
+    if (block)
+      block->used = 0;
+  }
+  // blocks past the current one are empty since the last reset
+  while (block && block->used + size > block->size) {
+    if (!block->next) {
+      size_t grown = block->size * 2;
+      block->next = svg_arena_new_block(grown > size ? grown : size);
+    }
+    block = block->next;
+    if (block)
+      block->used = 0;
+  }
+  if (!block) {
+    fprintf(stderr, "SVG arena out of memory! Requested %zu\n", size);
+    g_svg_arena.failed = true;
+    return NULL;
+  }
+
+  g_svg_arena.current = block;
+  void *ptr = (uint8_t *)block + SVG_ARENA_HEADER_SIZE + block->used;
+  block->used += size;
+  g_svg_arena.used += size;
+  if (g_svg_arena.used > g_svg_arena.peak)
+    g_svg_arena.peak = g_svg_arena.used;
+  return ptr;
+}
+
+// Arena-backed arrays grow by moving to a region twice the size; the old
+// copy stays behind until the next reset.
+static bool svg_arena_grow(void **items, int count, int *capacity, int needed,
+                           size_t item_size) {
+  if (needed <= *capacity)
+    return true;
+  int grown = *capacity ? *capacity * 2 : 256;
+  while (grown < needed)
+    grown *= 2;
+  void *moved = svg_arena_alloc((size_t)grown * item_size);
+  if (!moved)
+    return false;
+  if (count > 0)
+    memcpy(moved, *items, (size_t)count * item_size);
+  *items = moved;
+  *capacity = grown;
+  return true;
+}
+
+static svg_arena_mark_t svg_arena_mark(void) {
+  svg_arena_block_t *block = g_svg_arena.current;
+  return (svg_arena_mark_t){block, block ? block->used : 0, g_svg_arena.used};
+}
+
+static void svg_arena_release(svg_arena_mark_t mark) {
+  g_svg_arena.current = mark.block;
+  if (mark.block)
+    mark.block->used = mark.block_used;
+  g_svg_arena.used = mark.used;
+}
+
+void svg_arena_reset(void) {
+  g_svg_arena.current = NULL;
+  g_svg_arena.used = 0;
+  g_svg_arena.failed = false;
+}
+
+static void svg_arena_free(void) {
+  svg_arena_block_t *block = g_svg_arena.first;
+  while (block) {
+    svg_arena_block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+  memset(&g_svg_arena, 0, sizeof(g_svg_arena));
+}
+
+typedef struct {
+  float minx, miny, maxx, maxy;
+} svg_bbox_t;
+
+typedef struct {
+  HMM_Vec2 *pts;
+  int count, capacity;
+  svg_bbox_t bb;
+} svg_flat_poly_t;
+
+typedef struct {
+  float x0, y0, x1, y1;
+  int dir;
+} svg_edge_t;
+
+typedef struct {
+  svg_edge_t *edges;
+  int nedges, capacity;
+} svg_edge_fill_t;
+
+// an open trapezoid between two active edges, from ytop down to the sweep
+typedef struct {
+  int left, right;
+  float ytop;
+  bool matched;
+} svg_trap_t;
+
+typedef struct {
+  sgp_triangle *tris;
+  int count, capacity;
+} svg_tri_stroke_t;
+
+// largest scratch use seen by any build, see svg_scratch_stats
+static svg_scratch_stats_t g_svg_stats;
+
+void svg_geom_release(svg_geom_t *g) {
+  free(g->shapes);
+  free(g->tris);
+  memset(g, 0, sizeof(*g));
+}
+
+static bool svg_geom_append(svg_geom_t *g, const sgp_triangle *tris,
+                            uint32_t count) {
+  if (g->ntris + count > g->tris_capacity) {
+    uint32_t capacity = g->tris_capacity ? g->tris_capacity * 2 : 256;
+    while (capacity < g->ntris + count)
+      capacity *= 2;
+    sgp_triangle *grown = realloc(g->tris, capacity * sizeof(sgp_triangle));
+    if (!grown)
+      return false;
+    g->tris = grown;
+    g->tris_capacity = capacity;
+  }
+  memcpy(g->tris + g->ntris, tris, count * sizeof(sgp_triangle));
+  g->ntris += count;
+  return true;
+}
+
+static inline svg_bbox_t svg_bbox_init(void) {
+  svg_bbox_t b = {+FLT_MAX, +FLT_MAX, -FLT_MAX, -FLT_MAX};
+  return b;
+}
+
+static inline void svg_bbox_add(svg_bbox_t *b, HMM_Vec2 p) {
+  if (p.X < b->minx)
+    b->minx = p.X;
+  if (p.Y < b->miny)
+    b->miny = p.Y;
+  if (p.X > b->maxx)
+    b->maxx = p.X;
+  if (p.Y > b->maxy)
+    b->maxy = p.Y;
+}
+
+static inline HMM_Vec2 svg_v2(float x, float y) { return HMM_V2(x, y); }
+
+static inline sgp_point svg_to_sgp_point(HMM_Vec2 p) {
+  sgp_point q;
+  q.x = p.X;
+  q.y = p.Y;
+  return q;
+}
+
+static inline float svg_clampf(float x, float a, float b) {
+  return x < a ? a : (x > b ? b : x);
+}
+
+static inline float svg_absf(float x) { return x < 0 ? -x : x; }
+
+static uint64_t svg_now_ns(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void svg_flat_push(svg_flat_poly_t *out, HMM_Vec2 p) {
+  if (!svg_arena_grow((void **)&out->pts, out->count, &out->capacity,
+                      out->count + 1, sizeof(HMM_Vec2)))
+    return;
+  out->pts[out->count++] = p;
+  svg_bbox_add(&out->bb, p);
+}
+
+static void svg_flatten_cubic_bez(HMM_Vec2 p1, HMM_Vec2 p2, HMM_Vec2 p3,
+                                  HMM_Vec2 p4, svg_flat_poly_t *out, float tol,
+                                  int level) {
+  if (level > 10) {
+    svg_flat_push(out, p4);
+    return;
+  }
+
+  float x12 = (p1.X + p2.X) * 0.5f;
+  float y12 = (p1.Y + p2.Y) * 0.5f;
+  float x23 = (p2.X + p3.X) * 0.5f;
+  float y23 = (p2.Y + p3.Y) * 0.5f;
+  float x34 = (p3.X + p4.X) * 0.5f;
+  float y34 = (p3.Y + p4.Y) * 0.5f;
+  float x123 = (x12 + x23) * 0.5f;
+  float y123 = (y12 + y23) * 0.5f;
+
+  float dx = p4.X - p1.X;
+  float dy = p4.Y - p1.Y;
+  float d2 = svg_absf((p2.X - p4.X) * dy - (p2.Y - p4.Y) * dx);
+  float d3 = svg_absf((p3.X - p4.X) * dy - (p3.Y - p4.Y) * dx);
+
+  if ((d2 + d3) * (d2 + d3) < tol * (dx * dx + dy * dy)) {
+    svg_flat_push(out, p4);
+    return;
+  }
+
+  float x234 = (x23 + x34) * 0.5f;
+  float y234 = (y23 + y34) * 0.5f;
+  float x1234 = (x123 + x234) * 0.5f;
+  float y1234 = (y123 + y234) * 0.5f;
+
+  svg_flatten_cubic_bez(p1, svg_v2(x12, y12), svg_v2(x123, y123),
+                        svg_v2(x1234, y1234), out, tol, level + 1);
+  svg_flatten_cubic_bez(svg_v2(x1234, y1234), svg_v2(x234, y234),
+                        svg_v2(x34, y34), p4, out, tol, level + 1);
+}
+
+static void svg_path_flatten(const NSVGpath *path, float tol,
+                             svg_flat_poly_t *out) {
+  out->count = 0;
+  out->bb = svg_bbox_init();
+  if (path->npts < 1)
+    return;
+
+  svg_flat_push(out, svg_v2(path->pts[0], path->pts[1]));
+
+  for (int i = 0; i < path->npts - 1; i += 3) {
+    float *p = &path->pts[i * 2];
+    HMM_Vec2 p1 = svg_v2(p[0], p[1]);
+    HMM_Vec2 p2 = svg_v2(p[2], p[3]);
+    HMM_Vec2 p3 = svg_v2(p[4], p[5]);
+    HMM_Vec2 p4 = svg_v2(p[6], p[7]);
+    svg_flatten_cubic_bez(p1, p2, p3, p4, out, tol, 0);
+  }
+
+  if (path->closed && out->count > 1) {
+    HMM_Vec2 first = out->pts[0];
+    HMM_Vec2 last = out->pts[out->count - 1];
+    if (svg_absf(first.X - last.X) > 1e-6f ||
+        svg_absf(first.Y - last.Y) > 1e-6f)
+      svg_flat_push(out, first);
+  }
+  if (out->count > g_svg_stats.max_flat_points)
+    g_svg_stats.max_flat_points = out->count;
+}
+
+static void svg_add_edge(svg_edge_fill_t *ef, float x0, float y0, float x1,
+                         float y1) {
+  if (svg_absf(y0 - y1) < 1e-6f)
+    return;
+  if (!svg_arena_grow((void **)&ef->edges, ef->nedges, &ef->capacity,
+                      ef->nedges + 1, sizeof(svg_edge_t)))
+    return;
+
+  svg_edge_t *e = &ef->edges[ef->nedges++];
+  if (y0 < y1) {
+    e->x0 = x0;
+    e->y0 = y0;
+    e->x1 = x1;
+    e->y1 = y1;
+    e->dir = 1;
+  } else {
+    e->x0 = x1;
+    e->y0 = y1;
+    e->x1 = x0;
+    e->y1 = y0;
+    e->dir = -1;
+  }
+}
+
+static int svg_cmp_edge(const void *a, const void *b) {
+  const svg_edge_t *ea = (const svg_edge_t *)a;
+  const svg_edge_t *eb = (const svg_edge_t *)b;
+  if (ea->y0 < eb->y0)
+    return -1;
+  if (ea->y0 > eb->y0)
+    return 1;
+  return 0;
+}
+
+static int svg_cmp_float(const void *a, const void *b) {
+  float fa = *(const float *)a;
+  float fb = *(const float *)b;
+  return (fa > fb) - (fa < fb);
+}
+
+static inline float svg_edge_x_at(const svg_edge_t *e, float y) {
+  float t = (y - e->y0) / (e->y1 - e->y0);
+  return e->x0 + t * (e->x1 - e->x0);
+}
+
+static bool svg_emit_trap(svg_geom_t *g, const svg_edge_t *edges,
+                          const svg_trap_t *trap, float ybot) {
+  const svg_edge_t *l = &edges[trap->left];
+  const svg_edge_t *r = &edges[trap->right];
+  sgp_point a = {svg_edge_x_at(l, trap->ytop), trap->ytop};
+  sgp_point b = {svg_edge_x_at(r, trap->ytop), trap->ytop};
+  sgp_point c = {svg_edge_x_at(r, ybot), ybot};
+  sgp_point d = {svg_edge_x_at(l, ybot), ybot};
+
+  // a trapezoid that narrows to a point only needs one triangle
+  sgp_triangle tris[2];
+  uint32_t n = 0;
+  if (svg_absf(b.x - a.x) > SVG_SWEEP_EPS)
+    tris[n++] = (sgp_triangle){a, b, c};
+  if (svg_absf(c.x - d.x) > SVG_SWEEP_EPS)
+    tris[n++] = (sgp_triangle){a, c, d};
+  return n == 0 || svg_geom_append(g, tris, n);
+}
+
+// Sweep-line trapezoidation. Bands run between consecutive edge endpoints
+// (and crossings, for self-intersecting paths); inside a band the active
+// edges keep their order, so every filled span is one trapezoid. A span
+// bounded by the same two edges as in the band above just grows downwards,
+// which keeps the output to a couple of triangles per edge pair rather than
+// per scanline.
+static bool svg_sweep(svg_edge_fill_t *ef, int fillRule, svg_geom_t *g) {
+  const int n = ef->nedges;
+  if (n == 0)
+    return true;
+
+  svg_edge_t *edges = ef->edges;
+  qsort(edges, n, sizeof(svg_edge_t), svg_cmp_edge);
+
+  float *ys = (float *)svg_arena_alloc(sizeof(float) * 2 * n);
+  int *active = (int *)svg_arena_alloc(sizeof(int) * n);
+  float *keys = (float *)svg_arena_alloc(sizeof(float) * n);
+  svg_trap_t *open = (svg_trap_t *)svg_arena_alloc(sizeof(svg_trap_t) * n);
+  svg_trap_t *next = (svg_trap_t *)svg_arena_alloc(sizeof(svg_trap_t) * n);
+  int *open_at = (int *)svg_arena_alloc(sizeof(int) * n);
+  if (!ys || !active || !keys || !open || !next || !open_at) {
+    fprintf(stderr, "Failed to allocate SVG sweep from arena\n");
+    return false;
+  }
+  // an edge is the left side of at most one open trapezoid
+  for (int i = 0; i < n; i++)
+    open_at[i] = -1;
+
+  int nys = 0;
+  for (int i = 0; i < n; i++) {
+    ys[nys++] = edges[i].y0;
+    ys[nys++] = edges[i].y1;
+  }
+  qsort(ys, nys, sizeof(float), svg_cmp_float);
+  int unique = 1;
+  for (int i = 1; i < nys; i++) {
+    if (ys[i] > ys[unique - 1])
+      ys[unique++] = ys[i];
+  }
+  nys = unique;
+
+  int nactive = 0;
+  int next_edge = 0;
+  int nopen = 0;
+
+  for (int k = 0; k + 1 < nys; k++) {
+    float ya = ys[k];
+    const float yb = ys[k + 1];
+
+    int kept = 0;
+    for (int i = 0; i < nactive; i++) {
+      if (edges[active[i]].y1 > ya)
+        active[kept++] = active[i];
+    }
+    nactive = kept;
+    while (next_edge < n && edges[next_edge].y0 <= ya) {
+      if (edges[next_edge].y1 > ya)
+        active[nactive++] = next_edge;
+      next_edge++;
+    }
+
+    while (ya < yb) {
+      float ysplit = yb;
+
+      // order by x in the middle of the band, then cut the band at the first
+      // crossing of neighbouring edges until no neighbours swap inside it
+      for (int pass = 0; pass < SVG_SWEEP_MAX_SPLITS; pass++) {
+        float ymid = (ya + ysplit) * 0.5f;
+        for (int i = 0; i < nactive; i++) {
+          int e = active[i];
+          float key = svg_edge_x_at(&edges[e], ymid);
+          int j = i;
+          for (; j > 0 && keys[j - 1] > key; j--) {
+            keys[j] = keys[j - 1];
+            active[j] = active[j - 1];
+          }
+          keys[j] = key;
+          active[j] = e;
+        }
+
+        float ycross = ysplit;
+        for (int i = 0; i + 1 < nactive; i++) {
+          const svg_edge_t *e0 = &edges[active[i]];
+          const svg_edge_t *e1 = &edges[active[i + 1]];
+          float dtop = svg_edge_x_at(e1, ya) - svg_edge_x_at(e0, ya);
+          float dbot = svg_edge_x_at(e1, ysplit) - svg_edge_x_at(e0, ysplit);
+          if (dtop >= -SVG_SWEEP_EPS && dbot >= -SVG_SWEEP_EPS)
+            continue;
+          float t = dtop / (dtop - dbot);
+          float yc = ya + t * (ysplit - ya);
+          if (yc > ya + SVG_SWEEP_EPS && yc < ycross - SVG_SWEEP_EPS)
+            ycross = yc;
+        }
+        if (ycross >= ysplit)
+          break;
+        ysplit = ycross;
+      }
+
+      int nnext = 0;
+      int winding = 0;
+      for (int i = 0; i + 1 < nactive; i++) {
+        winding += fillRule == NSVG_FILLRULE_EVENODD ? 1 : edges[active[i]].dir;
+        bool inside = fillRule == NSVG_FILLRULE_EVENODD ? (winding & 1) != 0
+                                                        : winding != 0;
+        if (!inside)
+          continue;
+
+        svg_trap_t span = {active[i], active[i + 1], ya, false};
+        int j = open_at[span.left];
+        if (j >= 0 && open[j].right == span.right) {
+          open[j].matched = true;
+          span.ytop = open[j].ytop;
+        }
+        next[nnext++] = span;
+      }
+
+      for (int j = 0; j < nopen; j++) {
+        if (!open[j].matched && !svg_emit_trap(g, edges, &open[j], ya))
+          return false;
+        open_at[open[j].left] = -1;
+      }
+
+      svg_trap_t *swap = open;
+      open = next;
+      next = swap;
+      nopen = nnext;
+      for (int j = 0; j < nopen; j++)
+        open_at[open[j].left] = j;
+      ya = ysplit;
+    }
+  }
+
+  for (int j = 0; j < nopen; j++) {
+    if (!svg_emit_trap(g, edges, &open[j], ys[nys - 1]))
+      return false;
+  }
+  return true;
+}
+
+static bool svg_edges_to_triangles(svg_edge_fill_t *ef, int fillRule,
+                                   svg_geom_t *g) {
+  // the sweep's scratch arrays only live for one shape
+  svg_arena_mark_t mark = svg_arena_mark();
+  bool ok = svg_sweep(ef, fillRule, g);
+  svg_arena_release(mark);
+  return ok;
+}
+
+static inline void svg_push_tri(svg_tri_stroke_t *tb, HMM_Vec2 a, HMM_Vec2 b,
+                                HMM_Vec2 c) {
+  if (!svg_arena_grow((void **)&tb->tris, tb->count, &tb->capacity,
+                      tb->count + 1, sizeof(sgp_triangle)))
+    return;
+  tb->tris[tb->count].a = svg_to_sgp_point(a);
+  tb->tris[tb->count].b = svg_to_sgp_point(b);
+  tb->tris[tb->count].c = svg_to_sgp_point(c);
+  tb->count++;
+}
+
+static inline void svg_push_quad(svg_tri_stroke_t *tb, HMM_Vec2 a, HMM_Vec2 b,
+                                 HMM_Vec2 c, HMM_Vec2 d) {
+  svg_push_tri(tb, a, b, c);
+  svg_push_tri(tb, a, c, d);
+}
+
+static HMM_Vec2 svg_normal_of(HMM_Vec2 a, HMM_Vec2 b) {
+  HMM_Vec2 d = HMM_SubV2(b, a);
+  float L2 = HMM_DotV2(d, d);
+  if (L2 <= 1e-20f)
+    return HMM_V2(0, 0);
+  HMM_Vec2 n = HMM_V2(-d.Y, d.X);
+  return HMM_MulV2F(n, HMM_InvSqrtF(L2));
+}
+
+static void svg_fan_arc(svg_tri_stroke_t *tb, HMM_Vec2 p, HMM_Vec2 n0,
+                        HMM_Vec2 n1, float r, int side, float tol) {
+  float dot = svg_clampf(HMM_DotV2(n0, n1), -1.0f, 1.0f);
+  float theta = acosf(dot);
+  if (theta < 1e-4f)
+    return;
+
+  float da = acosf(r / (r + tol)) * 2.0f;
+  int segs = (int)ceilf(theta / da);
+  if (segs < 2)
+    segs = 2;
+  if (segs > 64)
+    segs = 64;
+
+  float ang = theta / (float)segs;
+  if (side < 0)
+    ang = -ang;
+
+  HMM_Vec2 prev = HMM_AddV2(p, HMM_MulV2F(n0, r));
+
+  for (int i = 1; i <= segs; i++) {
+    float t = ang * i;
+    float s = sinf(t), c = cosf(t);
+    HMM_Vec2 nextN = HMM_V2(c * n0.X - s * n0.Y, s * n0.X + c * n0.Y);
+    if (side < 0)
+      nextN = HMM_V2(nextN.X, -nextN.Y);
+
+    HMM_Vec2 cur = HMM_AddV2(p, HMM_MulV2F(nextN, r));
+    svg_push_tri(tb, p, prev, cur);
+    prev = cur;
+  }
+}
+
+static void svg_stroke_tessellate(const HMM_Vec2 *p, int n, HMM_Bool closed,
+                                  float width, int join, int cap,
+                                  float miterLimit, float tol,
+                                  svg_tri_stroke_t *out) {
+  if (n < 2 || width <= 0.0f) {
+    out->count = 0;
+    return;
+  }
+  out->count = 0;
+  const float hw = 0.5f * width;
+
+  for (int i = 0; i < n - 1; i++) {
+    HMM_Vec2 a = p[i], b = p[i + 1];
+    HMM_Vec2 nrm = svg_normal_of(a, b);
+    if (HMM_DotV2(nrm, nrm) < 1e-8f)
+      continue;
+
+    HMM_Vec2 aL = HMM_AddV2(a, HMM_MulV2F(nrm, hw));
+    HMM_Vec2 aR = HMM_SubV2(a, HMM_MulV2F(nrm, hw));
+    HMM_Vec2 bL = HMM_AddV2(b, HMM_MulV2F(nrm, hw));
+    HMM_Vec2 bR = HMM_SubV2(b, HMM_MulV2F(nrm, hw));
+    svg_push_quad(out, aL, bL, bR, aR);
+  }
+
+  for (int i = 1; i < n - 1; i++) {
+    HMM_Vec2 a = p[i - 1], b = p[i], c = p[i + 1];
+    HMM_Vec2 dn0 = HMM_NormV2(HMM_SubV2(b, a));
+    HMM_Vec2 dn1 = HMM_NormV2(HMM_SubV2(c, b));
+    if (HMM_DotV2(dn0, dn0) < 1e-8f || HMM_DotV2(dn1, dn1) < 1e-8f)
+      continue;
+
+    HMM_Vec2 n0 = HMM_V2(-dn0.Y, dn0.X);
+    HMM_Vec2 n1 = HMM_V2(-dn1.Y, dn1.X);
+
+    float cross = dn0.X * dn1.Y - dn0.Y * dn1.X;
+    float dot = HMM_DotV2(dn0, dn1);
+    int left_turn = (cross > 0.0f) ? 1 : -1;
+
+    HMM_Bool did_join = 0;
+    if (join == NSVG_JOIN_MITER && svg_absf(1.0f + dot) > 1e-6f) {
+      HMM_Vec2 m = HMM_AddV2(n0, n1);
+      float mlen2 = HMM_DotV2(m, m);
+      if (mlen2 > 1e-8f) {
+        HMM_Vec2 mN = HMM_MulV2F(m, HMM_InvSqrtF(mlen2));
+        HMM_Vec2 outerN = (left_turn > 0) ? n1 : HMM_MulV2F(n1, -1.0f);
+        float denom = HMM_DotV2(mN, outerN);
+        if (svg_absf(denom) > 1e-6f) {
+          float ml = hw / denom;
+          if (svg_absf(ml) <= miterLimit * hw) {
+            HMM_Vec2 outer = HMM_AddV2(b, HMM_MulV2F(mN, ml));
+            HMM_Vec2 tip0 =
+                HMM_AddV2(b, HMM_MulV2F(n0, left_turn > 0 ? hw : -hw));
+            HMM_Vec2 tip1 =
+                HMM_AddV2(b, HMM_MulV2F(n1, left_turn > 0 ? hw : -hw));
+            if (left_turn > 0)
+              svg_push_tri(out, tip0, outer, tip1);
+            else
+              svg_push_tri(out, tip1, outer, tip0);
+            did_join = 1;
+          }
+        }
+      }
+    }
+    if (!did_join && join == NSVG_JOIN_BEVEL) {
+      HMM_Vec2 tip0 = HMM_AddV2(b, HMM_MulV2F(n0, left_turn > 0 ? hw : -hw));
+      HMM_Vec2 tip1 = HMM_AddV2(b, HMM_MulV2F(n1, left_turn > 0 ? hw : -hw));
+      svg_push_tri(out, b, tip0, tip1);
+    } else if (!did_join && join == NSVG_JOIN_ROUND) {
+      HMM_Vec2 start = (left_turn > 0) ? n0 : HMM_MulV2F(n0, -1.0f);
+      HMM_Vec2 end = (left_turn > 0) ? n1 : HMM_MulV2F(n1, -1.0f);
+      svg_fan_arc(out, b, start, end, hw, left_turn, tol);
+    }
+  }
+
+  if (!closed && cap != NSVG_CAP_BUTT) {
+
+    {
+      HMM_Vec2 a = p[0], b = p[1];
+      HMM_Vec2 dir = HMM_NormV2(HMM_SubV2(b, a));
+      HMM_Vec2 nrm = HMM_V2(-dir.Y, dir.X);
+
+      if (cap == NSVG_CAP_SQUARE) {
+        HMM_Vec2 back = HMM_SubV2(a, HMM_MulV2F(dir, hw));
+        HMM_Vec2 bL = HMM_AddV2(back, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 bR = HMM_SubV2(back, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 aL = HMM_AddV2(a, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 aR = HMM_SubV2(a, HMM_MulV2F(nrm, hw));
+        svg_push_quad(out, bL, aL, aR, bR);
+      } else if (cap == NSVG_CAP_ROUND) {
+        svg_fan_arc(out, a, nrm, HMM_MulV2F(nrm, -1.0f), hw, -1, tol);
+      }
+    }
+
+    {
+      HMM_Vec2 a = p[n - 2], b = p[n - 1];
+      HMM_Vec2 dir = HMM_NormV2(HMM_SubV2(b, a));
+      HMM_Vec2 nrm = HMM_V2(-dir.Y, dir.X);
+
+      if (cap == NSVG_CAP_SQUARE) {
+        HMM_Vec2 fwd = HMM_AddV2(b, HMM_MulV2F(dir, hw));
+        HMM_Vec2 bL = HMM_AddV2(b, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 bR = HMM_SubV2(b, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 cL = HMM_AddV2(fwd, HMM_MulV2F(nrm, hw));
+        HMM_Vec2 cR = HMM_SubV2(fwd, HMM_MulV2F(nrm, hw));
+        svg_push_quad(out, bL, cL, cR, bR);
+      } else if (cap == NSVG_CAP_ROUND) {
+        svg_fan_arc(out, b, HMM_MulV2F(nrm, -1.0f), nrm, hw, -1, tol);
+      }
+    }
+  }
+}
+
+bool svg_geom_build(svg_geom_t *g, const NSVGimage *image, float sx, float sy,
+                    svg_tess_timing_t *timing) {
+  svg_arena_reset();
+
+  svg_edge_fill_t edge_fill = {0};
+  svg_flat_poly_t flat = {0};
+  svg_tri_stroke_t stroke = {0};
+  svg_edge_fill_t *ef = &edge_fill;
+  svg_flat_poly_t *fp = &flat;
+  svg_tri_stroke_t *sb = &stroke;
+
+  const float smax = (sx > sy) ? sx : sy;
+  const float tol_svg =
+      (smax > 0.0f) ? (SVG_FLATNESS_PX / smax) : SVG_FLATNESS_PX;
+  const float tol = tol_svg * tol_svg * 0.25f;
+
+  g->nshapes = 0;
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next)
+    g->nshapes++;
+  g->shapes = calloc(g->nshapes ? g->nshapes : 1, sizeof(svg_shape_geom_t));
+  if (!g->shapes)
+    return false;
+
+  int index = 0;
+  for (NSVGshape *shape = image->shapes; shape; shape = shape->next, index++) {
+    svg_shape_geom_t *sg = &g->shapes[index];
+    if (!(shape->flags & NSVG_FLAGS_VISIBLE) || !shape->paths)
+      continue;
+
+    ef->nedges = 0;
+    for (NSVGpath *path = shape->paths; path; path = path->next) {
+      if (path->npts < 4)
+        continue;
+
+      uint64_t t0 = timing ? svg_now_ns() : 0;
+      fp->count = 0;
+      svg_path_flatten(path, tol, fp);
+      uint64_t t1 = timing ? svg_now_ns() : 0;
+
+      for (int j = 0, k = fp->count - 1; j < fp->count; k = j++) {
+        svg_add_edge(ef, fp->pts[k].X, fp->pts[k].Y, fp->pts[j].X,
+                     fp->pts[j].Y);
+      }
+      if (timing) {
+        timing->flatten_ns += t1 - t0;
+        timing->fill_ns += svg_now_ns() - t1;
+      }
+    }
+
+    if (ef->nedges > g_svg_stats.max_edges)
+      g_svg_stats.max_edges = ef->nedges;
+
+    sg->fill_start = g->ntris;
+    uint64_t t0 = timing ? svg_now_ns() : 0;
+    if (!svg_edges_to_triangles(ef, shape->fillRule, g))
+      return false;
+    if (timing)
+      timing->fill_ns += svg_now_ns() - t0;
+    sg->fill_count = g->ntris - sg->fill_start;
+
+    float sw = shape->strokeWidth;
+    sg->stroke_start = g->ntris;
+    if (sw > 0.0f) {
+      for (NSVGpath *path = shape->paths; path; path = path->next) {
+        if (path->npts < 4)
+          continue;
+
+        uint64_t t1 = timing ? svg_now_ns() : 0;
+        fp->count = 0;
+        svg_path_flatten(path, tol, fp);
+        uint64_t t2 = timing ? svg_now_ns() : 0;
+        if (timing)
+          timing->flatten_ns += t2 - t1;
+
+        if (fp->count >= 2) {
+          sb->count = 0;
+          svg_stroke_tessellate(
+              fp->pts, fp->count, path->closed, sw, (int)shape->strokeLineJoin,
+              (int)shape->strokeLineCap,
+              shape->miterLimit > 0.0f ? shape->miterLimit : 4.0f, tol_svg, sb);
+          if (sb->count > g_svg_stats.max_stroke_tris)
+            g_svg_stats.max_stroke_tris = sb->count;
+          if (sb->count > 0 &&
+              !svg_geom_append(g, sb->tris, (uint32_t)sb->count))
+            return false;
+          if (timing)
+            timing->stroke_ns += svg_now_ns() - t2;
+        }
+      }
+    }
+    sg->stroke_count = g->ntris - sg->stroke_start;
+  }
+  // a tessellation with pieces missing is worse than none
+  return !g_svg_arena.failed;
+}
+
+void svg_tess_cleanup(void) {
+  svg_arena_free();
+  memset(&g_svg_stats, 0, sizeof(g_svg_stats));
+}
+
+svg_scratch_stats_t svg_scratch_stats(void) {
+  svg_scratch_stats_t stats = g_svg_stats;
+  stats.arena_peak_bytes = g_svg_arena.peak;
+  stats.arena_reserved_bytes = g_svg_arena.reserved;
+  return stats;
+}
+
+void svg_image_delete(NSVGimage *image) {
+  NSVGshape *shape = image->shapes;
+  while (shape) {
+    NSVGshape *next_shape = shape->next;
+    NSVGpath *path = shape->paths;
+    while (path) {
+      NSVGpath *next_path = path->next;
+      free(path->pts);
+      free(path);
+      path = next_path;
+    }
+    free(shape);
+    shape = next_shape;
+  }
+  free(image);
+}
+
+static inline void svg_bounds_add(float *bounds, float x, float y) {
+  if (x < bounds[0])
+    bounds[0] = x;
+  if (y < bounds[1])
+    bounds[1] = y;
+  if (x > bounds[2])
+    bounds[2] = x;
+  if (y > bounds[3])
+    bounds[3] = y;
+}
+
+NSVGimage *svg_load_compiled(const svg_compiled_t *compiled) {
+  if (!compiled)
+    return NULL;
+
+  NSVGimage *image = calloc(1, sizeof(NSVGimage));
+  if (!image)
+    return NULL;
+  image->width = compiled->width;
+  image->height = compiled->height;
+
+  // same allocations as nanosvg's parser, so either delete function works
+  NSVGshape **shape_tail = &image->shapes;
+  for (uint32_t i = 0; i < compiled->nshapes; i++) {
+    const svg_compiled_shape_t *cs = &compiled->shapes[i];
+    NSVGshape *shape = calloc(1, sizeof(NSVGshape));
+    if (!shape)
+      goto fail;
+    *shape_tail = shape;
+    shape_tail = &shape->next;
+
+    shape->fill.type = cs->has_fill ? NSVG_PAINT_COLOR : NSVG_PAINT_NONE;
+    shape->fill.color = cs->fill;
+    shape->stroke.type = cs->has_stroke ? NSVG_PAINT_COLOR : NSVG_PAINT_NONE;
+    shape->stroke.color = cs->stroke;
+    shape->opacity = cs->opacity;
+    shape->strokeWidth = cs->stroke_width;
+    shape->miterLimit = cs->miter_limit;
+    shape->fillRule = (char)cs->fill_rule;
+    shape->strokeLineJoin = (char)cs->line_join;
+    shape->strokeLineCap = (char)cs->line_cap;
+    shape->flags = cs->visible ? NSVG_FLAGS_VISIBLE : 0;
+    shape->bounds[0] = shape->bounds[1] = FLT_MAX;
+    shape->bounds[2] = shape->bounds[3] = -FLT_MAX;
+
+    NSVGpath **path_tail = &shape->paths;
+    for (uint32_t j = 0; j < cs->npaths; j++) {
+      const svg_compiled_path_t *cp = &compiled->paths[cs->first_path + j];
+      NSVGpath *path = calloc(1, sizeof(NSVGpath));
+      if (!path)
+        goto fail;
+      *path_tail = path;
+      path_tail = &path->next;
+
+      path->pts = malloc(cp->npts * 2 * sizeof(float));
+      if (!path->pts)
+        goto fail;
+      memcpy(path->pts, compiled->pts + cp->first_pt * 2,
+             cp->npts * 2 * sizeof(float));
+      path->npts = (int)cp->npts;
+      path->closed = cp->closed;
+
+      // control point hull, which contains the curve
+      path->bounds[0] = path->bounds[1] = FLT_MAX;
+      path->bounds[2] = path->bounds[3] = -FLT_MAX;
+      for (int k = 0; k < path->npts; k++)
+        svg_bounds_add(path->bounds, path->pts[k * 2], path->pts[k * 2 + 1]);
+      svg_bounds_add(shape->bounds, path->bounds[0], path->bounds[1]);
+      svg_bounds_add(shape->bounds, path->bounds[2], path->bounds[3]);
+    }
+  }
+  return image;
+
+fail:
+  svg_image_delete(image);
+  return NULL;
+}
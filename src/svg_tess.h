@@ -0,0 +1,61 @@
+#ifndef SVG_TESS_H
+#define SVG_TESS_H
+
+// CPU side of the triangle backend: flattening, fill trapezoidation and
+// stroke outlines, plus svg_load_compiled. Needs no GPU context, so
+// andex_svg_bench links it alone.
+
+#include "svg.h"
+#include "HandmadeMath.h"
+#include "nanosvg.h"
+#include "sokol_gfx.h"
+#include "sokol_gp.h"
+
+typedef struct {
+  uint32_t fill_start, fill_count;
+  uint32_t stroke_start, stroke_count;
+} svg_shape_geom_t;
+
+// Tessellated triangles of one image at one framebuffer pixel size, in SVG
+// units. Colors are not part of the geometry, so hover and theme changes
+// reuse it; only a new size or dpi scale builds another entry.
+typedef struct {
+  const NSVGimage *image;
+  int width_px, height_px;
+  svg_shape_geom_t *shapes;
+  int nshapes;
+  sgp_triangle *tris;
+  uint32_t ntris;
+  uint32_t tris_capacity;
+  uint64_t last_used;
+} svg_geom_t;
+
+// time spent in each stage of one svg_geom_build
+typedef struct {
+  uint64_t flatten_ns;
+  uint64_t fill_ns; // edge list and sweep
+  uint64_t stroke_ns;
+} svg_tess_timing_t;
+
+// Fill geometry is built for every visible shape and stroke geometry for
+// every stroked one, because an element's color overrides can paint parts
+// the SVG itself leaves unpainted. sx, sy scale SVG units to pixels and
+// only pick the flattening tolerance. timing may be NULL; measuring adds a
+// clock read around every path.
+bool svg_geom_build(svg_geom_t *g, const NSVGimage *image, float sx, float sy,
+                    svg_tess_timing_t *timing);
+
+void svg_geom_release(svg_geom_t *g);
+
+// Scratch memory shared with the atlas rasterizer. A reset invalidates
+// everything allocated since the previous one.
+void svg_arena_reset(void);
+void *svg_arena_alloc(size_t size);
+
+// frees an image built by svg_load_compiled without touching svg.c's caches
+void svg_image_delete(NSVGimage *image);
+
+// frees the scratch blocks and clears svg_scratch_stats
+void svg_tess_cleanup(void);
+
+#endif
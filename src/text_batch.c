@@ -0,0 +1,304 @@
+#include "text_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_BATCH_MIN_VERTS (6 * 256)
+#define TEXT_CACHE_SIZE 1024 // direct mapped, a power of two
+#define TEXT_CACHE_MAX_IDLE_FRAMES 120
+#define TEXT_CACHE_SWEEP_PER_FRAME 16
+// atlas images one cached command may draw from, such as text_sdf's bands
+#define TEXT_CACHE_MAX_RUNS 4
+
+typedef struct {
+  float x, y, u, v;
+  uint32_t color;
+} TextBatchVertex;
+
+typedef struct {
+  TextBatchVertex *verts;
+  int count;
+  int capacity;
+} TextBatchVerts;
+
+// glyphs from start up to the next run's start sample img
+typedef struct {
+  sg_image img;
+  int start;
+} TextCacheRun;
+
+typedef struct {
+  uint64_t key;
+  bool valid;
+  bool fresh; // captured for this use, not a hit yet
+  uint64_t last_used;
+  TextCacheRun runs[TEXT_CACHE_MAX_RUNS];
+  int nruns;
+  sg_sampler smp;
+  sgl_pipeline pip;
+  TextBatchVerts glyphs;
+} TextCacheEntry;
+
+static struct {
+  TextBatchVerts batch;
+  sg_image img;
+  sg_sampler smp;
+  sgl_pipeline pip;
+
+  bool capturing;
+  // too many images, another pipeline, or an image forgotten halfway
+  // through the capture
+  bool capture_mixed;
+  TextBatchVerts capture;
+  TextCacheRun capture_runs[TEXT_CACHE_MAX_RUNS];
+  int capture_nruns;
+  sg_sampler capture_smp;
+  sgl_pipeline capture_pip;
+
+  TextCacheEntry cache[TEXT_CACHE_SIZE];
+  uint64_t frame;
+  int sweep;
+  TextBatchStats stats;
+} g_text_batch;
+
+static bool text_batch_reserve(TextBatchVerts *v, int needed) {
+  if (needed <= v->capacity)
+    return true;
+  int capacity = v->capacity ? v->capacity : TEXT_BATCH_MIN_VERTS;
+  while (capacity < needed)
+    capacity *= 2;
+  TextBatchVertex *grown =
+      realloc(v->verts, (size_t)capacity * sizeof(TextBatchVertex));
+  if (!grown) {
+    fprintf(stderr, "Failed to grow a text batch to %d vertices\n", capacity);
+    return false;
+  }
+  v->verts = grown;
+  v->capacity = capacity;
+  return true;
+}
+
+static void text_batch_release(TextBatchVerts *v) {
+  free(v->verts);
+  memset(v, 0, sizeof(*v));
+}
+
+// Entries idle for a while give their vertices back, a few slots per frame,
+// so scrolling through a long document doesn't keep every line it passed.
+static void text_cache_sweep(void) {
+  for (int i = 0; i < TEXT_CACHE_SWEEP_PER_FRAME; i++) {
+    TextCacheEntry *entry = &g_text_batch.cache[g_text_batch.sweep];
+    g_text_batch.sweep = (g_text_batch.sweep + 1) & (TEXT_CACHE_SIZE - 1);
+    if (entry->glyphs.verts &&
+        g_text_batch.frame - entry->last_used > TEXT_CACHE_MAX_IDLE_FRAMES) {
+      text_batch_release(&entry->glyphs);
+      entry->valid = false;
+    }
+  }
+}
+
+void text_batch_begin_frame(void) {
+  g_text_batch.batch.count = 0;
+  g_text_batch.frame++;
+  text_cache_sweep();
+  g_text_batch.stats = (TextBatchStats){
+      .capacity_glyphs = (uint32_t)(g_text_batch.batch.capacity / 6)};
+}
+
+// flushes first when the glyphs need a different atlas image or pipeline
+static void text_batch_use(sg_image img, sg_sampler smp, sgl_pipeline pip) {
+  if (g_text_batch.batch.count > 0 &&
+      (img.id != g_text_batch.img.id || smp.id != g_text_batch.smp.id ||
+       pip.id != g_text_batch.pip.id))
+    text_batch_flush();
+  g_text_batch.img = img;
+  g_text_batch.smp = smp;
+  g_text_batch.pip = pip;
+}
+
+static TextBatchVertex *text_batch_extend(TextBatchVerts *v, int nverts) {
+  if (!text_batch_reserve(v, v->count + nverts))
+    return NULL;
+  TextBatchVertex *out = v->verts + v->count;
+  v->count += nverts;
+  if (v == &g_text_batch.batch) {
+    g_text_batch.stats.glyphs += (uint32_t)(nverts / 6);
+    g_text_batch.stats.capacity_glyphs = (uint32_t)(v->capacity / 6);
+  }
+  return out;
+}
+
+void text_batch_add(sg_image img, sg_sampler smp, sgl_pipeline pip,
+                    const float *verts, const float *tcoords,
+                    const unsigned int *colors, int nverts) {
+  if (nverts <= 0)
+    return;
+  g_text_batch.stats.flushes++;
+
+  TextBatchVerts *dst = &g_text_batch.batch;
+  if (g_text_batch.capturing) {
+    dst = &g_text_batch.capture;
+    int *nruns = &g_text_batch.capture_nruns;
+    if (dst->count > 0 && (smp.id != g_text_batch.capture_smp.id ||
+                           pip.id != g_text_batch.capture_pip.id))
+      g_text_batch.capture_mixed = true;
+    if (*nruns == 0 ||
+        img.id != g_text_batch.capture_runs[*nruns - 1].img.id) {
+      if (*nruns == TEXT_CACHE_MAX_RUNS)
+        g_text_batch.capture_mixed = true;
+      else
+        g_text_batch.capture_runs[(*nruns)++] =
+            (TextCacheRun){.img = img, .start = dst->count};
+    }
+    g_text_batch.capture_smp = smp;
+    g_text_batch.capture_pip = pip;
+  } else {
+    text_batch_use(img, smp, pip);
+  }
+
+  TextBatchVertex *out = text_batch_extend(dst, nverts);
+  if (!out)
+    return;
+  for (int i = 0; i < nverts; i++) {
+    out[i] = (TextBatchVertex){verts[2 * i], verts[2 * i + 1], tcoords[2 * i],
+                               tcoords[2 * i + 1], colors[i]};
+  }
+}
+
+void text_batch_flush(void) {
+  TextBatchVerts *batch = &g_text_batch.batch;
+  if (batch->count == 0)
+    return;
+
+  // same state sokol_fontstash sets around its own draws
+  sgl_enable_texture();
+  sgl_texture(g_text_batch.img, g_text_batch.smp);
+  sgl_push_pipeline();
+  sgl_load_pipeline(g_text_batch.pip);
+  sgl_begin_triangles();
+  for (int i = 0; i < batch->count; i++) {
+    const TextBatchVertex *v = &batch->verts[i];
+    sgl_v2f_t2f_c1i(v->x, v->y, v->u, v->v, v->color);
+  }
+  sgl_end();
+  sgl_pop_pipeline();
+  sgl_disable_texture();
+
+  batch->count = 0;
+  g_text_batch.stats.draws++;
+}
+
+uint64_t text_batch_hash(const void *data, size_t size, uint64_t hash) {
+  // FNV-1a
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+bool text_batch_add_cached(uint64_t key, float dx, float dy, uint32_t color) {
+  TextCacheEntry *entry = &g_text_batch.cache[key & (TEXT_CACHE_SIZE - 1)];
+  if (!entry->valid || entry->key != key) {
+    g_text_batch.stats.cache_misses++;
+    return false;
+  }
+  entry->last_used = g_text_batch.frame;
+  if (entry->fresh)
+    entry->fresh = false;
+  else
+    g_text_batch.stats.cache_hits++;
+
+  for (int r = 0; r < entry->nruns; r++) {
+    const int start = entry->runs[r].start;
+    const int end =
+        r + 1 < entry->nruns ? entry->runs[r + 1].start : entry->glyphs.count;
+    text_batch_use(entry->runs[r].img, entry->smp, entry->pip);
+    TextBatchVertex *out = text_batch_extend(&g_text_batch.batch, end - start);
+    if (!out)
+      return true;
+    const TextBatchVertex *src = entry->glyphs.verts + start;
+    for (int i = 0; i < end - start; i++) {
+      out[i] = src[i];
+      out[i].x += dx;
+      out[i].y += dy;
+      out[i].color = color;
+    }
+  }
+  return true;
+}
+
+void text_batch_forget_atlas(sg_image img) {
+  for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+    TextCacheEntry *entry = &g_text_batch.cache[i];
+    for (int r = 0; entry->valid && r < entry->nruns; r++) {
+      if (entry->runs[r].img.id == img.id)
+        entry->valid = false;
+    }
+  }
+  for (int r = 0; g_text_batch.capturing && r < g_text_batch.capture_nruns;
+       r++) {
+    if (g_text_batch.capture_runs[r].img.id == img.id)
+      g_text_batch.capture_mixed = true;
+  }
+}
+
+void text_batch_capture_begin(void) {
+  g_text_batch.capturing = true;
+  g_text_batch.capture_mixed = false;
+  g_text_batch.capture_nruns = 0;
+  g_text_batch.capture.count = 0;
+}
+
+bool text_batch_capture_origin(float *x, float *y) {
+  if (g_text_batch.capture.count == 0)
+    return false;
+  *x = g_text_batch.capture.verts[0].x;
+  *y = g_text_batch.capture.verts[0].y;
+  return true;
+}
+
+void text_batch_capture_end(uint64_t key, bool store) {
+  g_text_batch.capturing = false;
+  if (!store || g_text_batch.capture_mixed)
+    return;
+
+  TextCacheEntry *entry = &g_text_batch.cache[key & (TEXT_CACHE_SIZE - 1)];
+  const TextBatchVerts *capture = &g_text_batch.capture;
+  entry->valid = false;
+  // sized exactly, a screen of lines stays resident
+  if (capture->count > entry->glyphs.capacity) {
+    TextBatchVertex *grown =
+        realloc(entry->glyphs.verts,
+                (size_t)capture->count * sizeof(TextBatchVertex));
+    if (!grown)
+      return;
+    entry->glyphs.verts = grown;
+    entry->glyphs.capacity = capture->count;
+  }
+  if (capture->count > 0)
+    memcpy(entry->glyphs.verts, capture->verts,
+           (size_t)capture->count * sizeof(TextBatchVertex));
+  entry->glyphs.count = capture->count;
+  entry->key = key;
+  memcpy(entry->runs, g_text_batch.capture_runs,
+         sizeof(TextCacheRun) * (size_t)g_text_batch.capture_nruns);
+  entry->nruns = g_text_batch.capture_nruns;
+  entry->smp = g_text_batch.capture_smp;
+  entry->pip = g_text_batch.capture_pip;
+  entry->last_used = g_text_batch.frame;
+  entry->fresh = true;
+  entry->valid = true;
+}
+
+TextBatchStats text_batch_stats(void) { return g_text_batch.stats; }
+
+void text_batch_shutdown(void) {
+  text_batch_release(&g_text_batch.batch);
+  text_batch_release(&g_text_batch.capture);
+  for (int i = 0; i < TEXT_CACHE_SIZE; i++)
+    text_batch_release(&g_text_batch.cache[i].glyphs);
+  memset(&g_text_batch, 0, sizeof(g_text_batch));
+}
@@ -0,0 +1,65 @@
+#ifndef TEXT_BATCH_H
+#define TEXT_BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sokol_gfx.h"
+#include "util/sokol_gl.h"
+
+// Glyph quads from fontstash collected over a run of text commands and
+// handed to sokol_gl as a single triangle list. fontstash flushes at the end
+// of every string and whenever its fixed vertex array fills up; each of
+// those only appends here. The storage keeps its high-water mark, so it
+// settles at the visible glyph count and steady frames don't allocate.
+//
+// Glyphs of a whole text command can also be kept across frames under a
+// key the caller derives from everything that shapes them. Cached glyphs are
+// stored at the origin and translated and recolored on reuse, so scrolling
+// and color fades only rewrite vertices.
+
+typedef struct {
+  uint32_t draws;   // sgl draws issued this frame
+  uint32_t flushes; // fontstash flushes folded into them
+  uint32_t glyphs;
+  uint32_t capacity_glyphs;
+  uint32_t cache_hits; // text commands drawn from cached glyphs
+  uint32_t cache_misses;
+} TextBatchStats;
+
+void text_batch_begin_frame(void);
+
+// a renderDraw call; a different atlas image or pipeline flushes first
+void text_batch_add(sg_image img, sg_sampler smp, sgl_pipeline pip,
+                    const float *verts, const float *tcoords,
+                    const unsigned int *colors, int nverts);
+
+// draws everything added since the last flush
+void text_batch_flush(void);
+
+// FNV-1a, chained through hash; start from TEXT_BATCH_HASH_SEED
+#define TEXT_BATCH_HASH_SEED 0xCBF29CE484222325ull
+uint64_t text_batch_hash(const void *data, size_t size, uint64_t hash);
+
+// Appends the glyphs cached under key, moved by dx, dy and painted color
+// (fontstash's packed RGBA). False when there are none.
+bool text_batch_add_cached(uint64_t key, float dx, float dy, uint32_t color);
+
+// Drops the cached glyphs that sample img, for an atlas about to be replaced
+// or resized. A capture in progress that used it won't be stored.
+void text_batch_forget_atlas(sg_image img);
+
+// text_batch_add calls between these are captured instead of drawn and, if
+// store is set, cached under key
+void text_batch_capture_begin(void);
+void text_batch_capture_end(uint64_t key, bool store);
+
+// position of the first captured vertex, for measuring where text lands
+bool text_batch_capture_origin(float *x, float *y);
+
+TextBatchStats text_batch_stats(void);
+
+void text_batch_shutdown(void);
+
+#endif
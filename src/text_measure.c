@@ -0,0 +1,194 @@
+#include "text_measure.h"
+
+#include "font_info.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_MEASURE_MAX_FONTS 8
+// sizes in use at once: UI sizes plus editor sizes at each dpi
+#define TEXT_MEASURE_MAX_FACES 32
+#define TEXT_MEASURE_CODES 256 // U+0000..U+00FF
+#define TEXT_MEASURE_CHUNK 256 // codepoints summed per pass
+
+typedef struct {
+  bool loaded;
+  const stbtt_fontinfo *info; // fontstash's
+  int glyph[TEXT_MEASURE_CODES];   // glyph index per codepoint
+  int advance[TEXT_MEASURE_CODES]; // in font units
+  // TEXT_MEASURE_CODES rows of font-unit kerning, left codepoint major; a
+  // row is looked up the first time its codepoint starts a pair. 32-bit so
+  // the pair loop can gather from it.
+  int32_t *kern;
+  bool kern_ready[TEXT_MEASURE_CODES];
+} TextMeasureFont;
+
+typedef struct {
+  int font_id;
+  short isize; // pixel size * 10, fontstash's glyph key
+  float scale;
+  int32_t advance[TEXT_MEASURE_CODES]; // whole pixels, as fontstash steps
+} TextMeasureFace;
+
+static struct {
+  TextMeasureFont fonts[TEXT_MEASURE_MAX_FONTS];
+  TextMeasureFace faces[TEXT_MEASURE_MAX_FACES];
+  int nfaces;
+  int last_face;
+  int next_evict;
+  TextMeasureStats stats;
+} g_text_measure;
+
+static TextMeasureFont *text_measure_font(int font_id) {
+  if (font_id < 0 || font_id >= TEXT_MEASURE_MAX_FONTS ||
+      !g_text_measure.fonts[font_id].loaded)
+    return NULL;
+  return &g_text_measure.fonts[font_id];
+}
+
+bool text_measure_add_font(int font_id) {
+  if (font_id < 0 || font_id >= TEXT_MEASURE_MAX_FONTS)
+    return false;
+  TextMeasureFont *f = &g_text_measure.fonts[font_id];
+  f->info = font_info(font_id);
+  if (!f->info) {
+    fprintf(stderr, "text_measure: font %d is not loaded in fontstash\n",
+            font_id);
+    return false;
+  }
+  // codepoints the font lacks measure as its .notdef glyph, as in fontstash
+  // without fallback fonts
+  for (int c = 0; c < TEXT_MEASURE_CODES; c++) {
+    f->glyph[c] = stbtt_FindGlyphIndex(f->info, c);
+    stbtt_GetGlyphHMetrics(f->info, f->glyph[c], &f->advance[c], NULL);
+  }
+  f->loaded = true;
+  return true;
+}
+
+static const TextMeasureFace *text_measure_face(int font_id, short isize) {
+  TextMeasureFace *faces = g_text_measure.faces;
+  // Clay measures words of one text element after another, so the last face
+  // usually hits
+  const TextMeasureFace *last = &faces[g_text_measure.last_face];
+  if (g_text_measure.nfaces > 0 && last->font_id == font_id &&
+      last->isize == isize)
+    return last;
+  for (int i = 0; i < g_text_measure.nfaces; i++) {
+    if (faces[i].font_id == font_id && faces[i].isize == isize) {
+      g_text_measure.last_face = i;
+      return &faces[i];
+    }
+  }
+
+  int slot = g_text_measure.nfaces;
+  if (slot == TEXT_MEASURE_MAX_FACES) {
+    slot = g_text_measure.next_evict;
+    g_text_measure.next_evict = (slot + 1) % TEXT_MEASURE_MAX_FACES;
+  } else {
+    g_text_measure.nfaces++;
+  }
+  const TextMeasureFont *f = &g_text_measure.fonts[font_id];
+  TextMeasureFace *face = &faces[slot];
+  face->font_id = font_id;
+  face->isize = isize;
+  face->scale = stbtt_ScaleForPixelHeight(f->info, (float)isize / 10.0f);
+  for (int c = 0; c < TEXT_MEASURE_CODES; c++)
+    face->advance[c] = font_info_advance_px(face->scale, f->advance[c]);
+  g_text_measure.last_face = slot;
+  return face;
+}
+
+static bool text_measure_kern_row(TextMeasureFont *f, int left) {
+  if (!f->kern) {
+    f->kern = calloc((size_t)TEXT_MEASURE_CODES * TEXT_MEASURE_CODES,
+                     sizeof(int32_t));
+    if (!f->kern)
+      return false;
+  }
+  int32_t *row = &f->kern[left * TEXT_MEASURE_CODES];
+  for (int c = 0; c < TEXT_MEASURE_CODES; c++)
+    row[c] = stbtt_GetGlyphKernAdvance(f->info, f->glyph[left], f->glyph[c]);
+  f->kern_ready[left] = true;
+  return true;
+}
+
+// Sum of advances and pair steps for codes, with prev the codepoint before
+// them or -1. Each step is the whole pixels fontstash adds, so the sum is
+// exact whatever order it is taken in; both loops vectorize.
+static int text_measure_sum(const TextMeasureFace *face, const int32_t *kern,
+                            float spacing, int prev, const uint8_t *codes,
+                            int n) {
+  int width = 0;
+  for (int i = 0; i < n; i++)
+    width += face->advance[codes[i]];
+
+  const float scale = face->scale;
+  if (prev >= 0)
+    width += (int)(kern[prev * TEXT_MEASURE_CODES + codes[0]] * scale +
+                   spacing + 0.5f);
+  for (int i = 1; i < n; i++) {
+    const int pair = codes[i - 1] * TEXT_MEASURE_CODES + codes[i];
+    width += (int)(kern[pair] * scale + spacing + 0.5f);
+  }
+  return width;
+}
+
+bool text_measure_width(int font_id, float size, float spacing,
+                        const char *str, size_t len, float *width) {
+  TextMeasureFont *f = text_measure_font(font_id);
+  const short isize = (short)(size * 10.0f);
+  if (!f || isize < 2) {
+    g_text_measure.stats.fallback++;
+    return false;
+  }
+  const TextMeasureFace *face = text_measure_face(font_id, isize);
+
+  const unsigned char *s = (const unsigned char *)str;
+  const unsigned char *end = s + len;
+  uint8_t codes[TEXT_MEASURE_CHUNK];
+  int total = 0;
+  int prev = -1;
+  while (s < end) {
+    int n = 0;
+    while (s < end && n < TEXT_MEASURE_CHUNK) {
+      unsigned int c = s[0];
+      if (c < 0x80) {
+        s++;
+      } else if ((c == 0xC2 || c == 0xC3) && end - s >= 2 &&
+                 (s[1] & 0xC0) == 0x80) {
+        c = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+        s += 2;
+      } else {
+        g_text_measure.stats.fallback++;
+        return false;
+      }
+      codes[n++] = (uint8_t)c;
+    }
+
+    // every pair's row, so the sums below only read the table
+    bool ready =
+        prev < 0 || f->kern_ready[prev] || text_measure_kern_row(f, prev);
+    for (int i = 0; ready && i < n - 1; i++)
+      ready = f->kern_ready[codes[i]] || text_measure_kern_row(f, codes[i]);
+    if (!ready) {
+      g_text_measure.stats.fallback++;
+      return false;
+    }
+    total += text_measure_sum(face, f->kern, spacing, prev, codes, n);
+    prev = codes[n - 1];
+  }
+
+  *width = (float)total;
+  g_text_measure.stats.fast++;
+  return true;
+}
+
+TextMeasureStats text_measure_stats(void) { return g_text_measure.stats; }
+
+void text_measure_shutdown(void) {
+  for (int i = 0; i < TEXT_MEASURE_MAX_FONTS; i++)
+    free(g_text_measure.fonts[i].kern);
+  memset(&g_text_measure, 0, sizeof(g_text_measure));
+}
@@ -0,0 +1,31 @@
+#ifndef TEXT_MEASURE_H
+#define TEXT_MEASURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Widths of Latin-1 text as fontstash's fonsTextBounds returns them, summed
+// from flat tables instead of a glyph lookup per character: whole-pixel
+// advances for U+0000..U+00FF per font and size, and kerning for every pair
+// of them per font. Runs with other codepoints or malformed UTF-8 are left
+// to fontstash.
+
+typedef struct {
+  uint32_t fast;     // runs measured from the tables, since startup
+  uint32_t fallback; // runs left to fontstash, since startup
+} TextMeasureStats;
+
+// builds the font's tables from fontstash's font behind the handle
+bool text_measure_add_font(int font_id);
+
+// Sets *width to the advance of [str, str + len) at size pixels with spacing
+// between glyphs. False, with *width untouched, when the run needs fontstash.
+bool text_measure_width(int font_id, float size, float spacing,
+                        const char *str, size_t len, float *width);
+
+TextMeasureStats text_measure_stats(void);
+
+void text_measure_shutdown(void);
+
+#endif
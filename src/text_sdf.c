@@ -0,0 +1,343 @@
+#include "text_sdf.h"
+
+#include "font_info.h"
+#include "text_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_SDF_MAX_FONTS 8
+#define TEXT_SDF_ATLAS_SIZE 1024
+// Each atlas is this many horizontal band textures, so a frame that adds
+// glyphs uploads only the bands they landed in; sg_update_image can't
+// update part of an image.
+#define TEXT_SDF_BANDS 4
+#define TEXT_SDF_BAND_HEIGHT (TEXT_SDF_ATLAS_SIZE / TEXT_SDF_BANDS)
+#define TEXT_SDF_HASH_SIZE 256 // a power of two
+// reference pixel height of the fields; 10 px UI text to 68 px editor text
+// at 2x scale all sample these
+#define TEXT_SDF_PX 40.0f
+#define TEXT_SDF_PAD 5 // field pixels around each glyph
+#define TEXT_SDF_ONEDGE 128
+#define TEXT_SDF_DIST_SCALE ((float)TEXT_SDF_ONEDGE / TEXT_SDF_PAD)
+#define TEXT_SDF_CHUNK 64 // glyphs handed to text_batch per call
+
+typedef struct {
+  uint32_t codepoint;
+  int index; // glyph index in the font
+  int advance;
+  bool has_field; // whitespace has none
+  int xoff, yoff; // field origin from the pen, at the reference size
+  int width, height;
+  int band;
+  float s0, t0, s1, t1; // within the band
+  int next;
+} TextSdfGlyph;
+
+typedef struct {
+  bool loaded;
+  const stbtt_fontinfo *info; // fontstash's
+  float ascender; // fraction of the line height, as fontstash normalizes it
+  float ref_scale;
+
+  TextSdfGlyph *glyphs;
+  int nglyphs, cglyphs;
+  int lut[TEXT_SDF_HASH_SIZE];
+
+  uint8_t *pixels; // the bands top to bottom
+  sg_image bands[TEXT_SDF_BANDS];
+  bool dirty[TEXT_SDF_BANDS];
+  int shelf_x, shelf_y, shelf_height;
+  bool full;
+} TextSdfFont;
+
+static struct {
+  sg_shader shd;
+  sgl_pipeline pip;
+  sg_sampler smp;
+  TextSdfFont fonts[TEXT_SDF_MAX_FONTS];
+  TextSdfStats stats;
+} g_text_sdf;
+
+bool text_sdf_init(sg_shader shd) {
+  g_text_sdf.shd = shd;
+  if (sg_query_shader_state(shd) != SG_RESOURCESTATE_VALID)
+    return false;
+  g_text_sdf.pip = sgl_make_pipeline(&(sg_pipeline_desc){
+      .shader = shd,
+      .colors[0].blend = {.enabled = true,
+                          .src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA,
+                          .dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA},
+      .label = "text-sdf",
+  });
+  g_text_sdf.smp = sg_make_sampler(&(sg_sampler_desc){
+      .min_filter = SG_FILTER_LINEAR,
+      .mag_filter = SG_FILTER_LINEAR,
+      .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
+      .wrap_v = SG_WRAP_CLAMP_TO_EDGE,
+      .label = "text-sdf",
+  });
+  return true;
+}
+
+static TextSdfFont *text_sdf_font(int font_id) {
+  if (font_id < 0 || font_id >= TEXT_SDF_MAX_FONTS ||
+      !g_text_sdf.fonts[font_id].loaded)
+    return NULL;
+  return &g_text_sdf.fonts[font_id];
+}
+
+bool text_sdf_has_font(int font_id) { return text_sdf_font(font_id) != NULL; }
+
+bool text_sdf_add_font(int font_id) {
+  if (font_id < 0 || font_id >= TEXT_SDF_MAX_FONTS)
+    return false;
+  TextSdfFont *f = &g_text_sdf.fonts[font_id];
+  f->info = font_info(font_id);
+  if (!f->info) {
+    fprintf(stderr, "text_sdf: font %d is not loaded in fontstash\n", font_id);
+    return false;
+  }
+  int ascent, descent, line_gap;
+  stbtt_GetFontVMetrics(f->info, &ascent, &descent, &line_gap);
+  ascent += line_gap;
+  f->ascender = (float)ascent / (float)(ascent - descent);
+  f->ref_scale = stbtt_ScaleForPixelHeight(f->info, TEXT_SDF_PX);
+  memset(f->lut, -1, sizeof(f->lut));
+  f->loaded = true;
+  return true;
+}
+
+// shelves never cross into the next band
+static bool text_sdf_pack(TextSdfFont *f, int w, int h, int *x, int *y) {
+  // a texel of space keeps bilinear taps inside each glyph's field
+  w += 1;
+  h += 1;
+  if (f->shelf_x + w > TEXT_SDF_ATLAS_SIZE) {
+    f->shelf_x = 0;
+    f->shelf_y += f->shelf_height;
+    f->shelf_height = 0;
+  }
+  const int band_end =
+      (f->shelf_y / TEXT_SDF_BAND_HEIGHT + 1) * TEXT_SDF_BAND_HEIGHT;
+  if (f->shelf_y + h > band_end) {
+    f->shelf_x = 0;
+    f->shelf_y = band_end;
+    f->shelf_height = 0;
+  }
+  if (w > TEXT_SDF_ATLAS_SIZE || h > TEXT_SDF_BAND_HEIGHT ||
+      f->shelf_y + h > TEXT_SDF_ATLAS_SIZE)
+    return false;
+  *x = f->shelf_x;
+  *y = f->shelf_y;
+  f->shelf_x += w;
+  if (h > f->shelf_height)
+    f->shelf_height = h;
+  return true;
+}
+
+static bool text_sdf_make_atlas(TextSdfFont *f) {
+  f->pixels = calloc(1, TEXT_SDF_ATLAS_SIZE * TEXT_SDF_ATLAS_SIZE);
+  if (!f->pixels)
+    return false;
+  for (int band = 0; band < TEXT_SDF_BANDS; band++) {
+    f->bands[band] = sg_make_image(&(sg_image_desc){
+        .usage = {.dynamic_update = true},
+        .width = TEXT_SDF_ATLAS_SIZE,
+        .height = TEXT_SDF_BAND_HEIGHT,
+        .pixel_format = SG_PIXELFORMAT_R8,
+        .label = "text-sdf-atlas",
+    });
+  }
+  return true;
+}
+
+static const TextSdfGlyph *text_sdf_glyph(TextSdfFont *f, uint32_t codepoint) {
+  const int h = (int)(codepoint & (TEXT_SDF_HASH_SIZE - 1));
+  for (int i = f->lut[h]; i != -1; i = f->glyphs[i].next) {
+    if (f->glyphs[i].codepoint == codepoint)
+      return &f->glyphs[i];
+  }
+  if (f->full)
+    return NULL;
+
+  TextSdfGlyph glyph = {.codepoint = codepoint};
+  glyph.index = stbtt_FindGlyphIndex(f->info, (int)codepoint);
+  int lsb;
+  stbtt_GetGlyphHMetrics(f->info, glyph.index, &glyph.advance, &lsb);
+  font_info_scratch_reset();
+  unsigned char *field = stbtt_GetGlyphSDF(
+      f->info, f->ref_scale, glyph.index, TEXT_SDF_PAD, TEXT_SDF_ONEDGE,
+      TEXT_SDF_DIST_SCALE, &glyph.width, &glyph.height, &glyph.xoff,
+      &glyph.yoff);
+  if (field) {
+    int x, y;
+    if ((!f->pixels && !text_sdf_make_atlas(f)) ||
+        !text_sdf_pack(f, glyph.width, glyph.height, &x, &y)) {
+      // keep the glyphs already there; new ones go to fontstash
+      f->full = true;
+      stbtt_FreeSDF(field, f->info->userdata);
+      return NULL;
+    }
+    for (int row = 0; row < glyph.height; row++)
+      memcpy(f->pixels + (size_t)(y + row) * TEXT_SDF_ATLAS_SIZE + x,
+             field + (size_t)row * glyph.width, (size_t)glyph.width);
+    stbtt_FreeSDF(field, f->info->userdata);
+    glyph.has_field = true;
+    glyph.band = y / TEXT_SDF_BAND_HEIGHT;
+    y -= glyph.band * TEXT_SDF_BAND_HEIGHT;
+    glyph.s0 = (float)x / TEXT_SDF_ATLAS_SIZE;
+    glyph.t0 = (float)y / TEXT_SDF_BAND_HEIGHT;
+    glyph.s1 = (float)(x + glyph.width) / TEXT_SDF_ATLAS_SIZE;
+    glyph.t1 = (float)(y + glyph.height) / TEXT_SDF_BAND_HEIGHT;
+    f->dirty[glyph.band] = true;
+  }
+
+  if (f->nglyphs == f->cglyphs) {
+    int capacity = f->cglyphs ? f->cglyphs * 2 : 128;
+    TextSdfGlyph *grown =
+        realloc(f->glyphs, (size_t)capacity * sizeof(TextSdfGlyph));
+    if (!grown)
+      return NULL;
+    f->glyphs = grown;
+    f->cglyphs = capacity;
+  }
+  glyph.next = f->lut[h];
+  f->lut[h] = f->nglyphs;
+  f->glyphs[f->nglyphs] = glyph;
+  g_text_sdf.stats.glyphs++;
+  g_text_sdf.stats.generated++;
+  return &f->glyphs[f->nglyphs++];
+}
+
+// Malformed bytes decode to U+FFFD one at a time.
+static uint32_t text_sdf_decode(const char **str, const char *end) {
+  const unsigned char *s = (const unsigned char *)*str;
+  const size_t left = (size_t)(end - *str);
+  uint32_t cp = 0xFFFD;
+  size_t len = 1;
+  if (s[0] < 0x80) {
+    cp = s[0];
+  } else if ((s[0] & 0xE0) == 0xC0 && left >= 2 && (s[1] & 0xC0) == 0x80) {
+    cp = ((uint32_t)(s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+    len = 2;
+  } else if ((s[0] & 0xF0) == 0xE0 && left >= 3 && (s[1] & 0xC0) == 0x80 &&
+             (s[2] & 0xC0) == 0x80) {
+    cp = ((uint32_t)(s[0] & 0x0F) << 12) | ((uint32_t)(s[1] & 0x3F) << 6) |
+         (s[2] & 0x3F);
+    len = 3;
+  } else if ((s[0] & 0xF8) == 0xF0 && left >= 4 && (s[1] & 0xC0) == 0x80 &&
+             (s[2] & 0xC0) == 0x80 && (s[3] & 0xC0) == 0x80) {
+    cp = ((uint32_t)(s[0] & 0x07) << 18) | ((uint32_t)(s[1] & 0x3F) << 12) |
+         ((uint32_t)(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+    len = 4;
+  }
+  *str += len;
+  return cp;
+}
+
+bool text_sdf_draw(int font_id, float size, float spacing, float x, float y,
+                   uint32_t color, const char *str, const char *end) {
+  TextSdfFont *f = text_sdf_font(font_id);
+  // fontstash keys glyphs on tenths of a pixel and so does its layout
+  const short isize = (short)(size * 10.0f);
+  if (!f || isize < 2)
+    return false;
+
+  // every glyph first, so a full atlas leaves the whole string to fontstash
+  for (const char *s = str; s < end;) {
+    if (!text_sdf_glyph(f, text_sdf_decode(&s, end)))
+      return false;
+  }
+
+  const float px = (float)isize / 10.0f;
+  const float scale = stbtt_ScaleForPixelHeight(f->info, px);
+  const float ratio = scale / f->ref_scale;
+  const float baseline = y + f->ascender * px;
+
+  float verts[TEXT_SDF_CHUNK * 12];
+  float tcoords[TEXT_SDF_CHUNK * 12];
+  unsigned int colors[TEXT_SDF_CHUNK * 6];
+  int nverts = 0;
+  int band = 0; // of the glyphs in verts
+  int prev = -1;
+  for (const char *s = str; s < end;) {
+    const TextSdfGlyph *g = text_sdf_glyph(f, text_sdf_decode(&s, end));
+    if (prev != -1)
+      x += (int)(stbtt_GetGlyphKernAdvance(f->info, prev, g->index) * scale +
+                 spacing + 0.5f);
+
+    if (g->has_field) {
+      if (nverts > 0 && g->band != band) {
+        text_batch_add(f->bands[band], g_text_sdf.smp, g_text_sdf.pip, verts,
+                       tcoords, colors, nverts);
+        nverts = 0;
+      }
+      band = g->band;
+      const float x0 = x + (float)g->xoff * ratio;
+      const float y0 = baseline + (float)g->yoff * ratio;
+      const float x1 = x0 + (float)g->width * ratio;
+      const float y1 = y0 + (float)g->height * ratio;
+      const float quad[6][4] = {
+          {x0, y0, g->s0, g->t0}, {x1, y1, g->s1, g->t1},
+          {x1, y0, g->s1, g->t0}, {x0, y0, g->s0, g->t0},
+          {x0, y1, g->s0, g->t1}, {x1, y1, g->s1, g->t1},
+      };
+      for (int v = 0; v < 6; v++, nverts++) {
+        verts[2 * nverts] = quad[v][0];
+        verts[2 * nverts + 1] = quad[v][1];
+        tcoords[2 * nverts] = quad[v][2];
+        tcoords[2 * nverts + 1] = quad[v][3];
+        colors[nverts] = color;
+      }
+      if (nverts == TEXT_SDF_CHUNK * 6) {
+        text_batch_add(f->bands[band], g_text_sdf.smp, g_text_sdf.pip, verts,
+                       tcoords, colors, nverts);
+        nverts = 0;
+      }
+    }
+
+    x += font_info_advance_px(scale, g->advance);
+    prev = g->index;
+  }
+  text_batch_add(f->bands[band], g_text_sdf.smp, g_text_sdf.pip, verts,
+                 tcoords, colors, nverts);
+  return true;
+}
+
+void text_sdf_upload(void) {
+  for (int i = 0; i < TEXT_SDF_MAX_FONTS; i++) {
+    TextSdfFont *f = &g_text_sdf.fonts[i];
+    for (int band = 0; band < TEXT_SDF_BANDS; band++) {
+      if (!f->dirty[band])
+        continue;
+      const size_t band_bytes = TEXT_SDF_ATLAS_SIZE * TEXT_SDF_BAND_HEIGHT;
+      sg_update_image(f->bands[band],
+                      &(sg_image_data){.subimage[0][0] = {
+                                           .ptr = f->pixels + band * band_bytes,
+                                           .size = band_bytes}});
+      f->dirty[band] = false;
+    }
+  }
+  g_text_sdf.stats.generated = 0;
+}
+
+TextSdfStats text_sdf_stats(void) { return g_text_sdf.stats; }
+
+void text_sdf_shutdown(void) {
+  for (int i = 0; i < TEXT_SDF_MAX_FONTS; i++) {
+    TextSdfFont *f = &g_text_sdf.fonts[i];
+    for (int band = 0; f->pixels && band < TEXT_SDF_BANDS; band++)
+      sg_destroy_image(f->bands[band]);
+    free(f->pixels);
+    free(f->glyphs);
+  }
+  if (g_text_sdf.smp.id)
+    sg_destroy_sampler(g_text_sdf.smp);
+  if (g_text_sdf.pip.id)
+    sgl_destroy_pipeline(g_text_sdf.pip);
+  if (g_text_sdf.shd.id)
+    sg_destroy_shader(g_text_sdf.shd);
+  memset(&g_text_sdf, 0, sizeof(g_text_sdf));
+}
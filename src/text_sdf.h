@@ -0,0 +1,47 @@
+#ifndef TEXT_SDF_H
+#define TEXT_SDF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sokol_gfx.h"
+#include "util/sokol_gl.h"
+
+// Glyphs as signed distance fields, generated once per font at a fixed
+// reference size into that font's atlas and drawn at any size by the
+// text_sdf shader. Size, dpi and zoom changes only change the quads, so
+// atlas memory stays at one atlas per font.
+//
+// Strings are placed the way fontstash places them at the same size:
+// whole-pixel advances, its kerning and spacing, and the baseline it uses for
+// top-aligned text. Clay's fontstash measurements and caret positions stay
+// valid.
+
+typedef struct {
+  uint32_t glyphs;    // distance fields resident in all atlases
+  uint32_t generated; // fields generated this frame
+} TextSdfStats;
+
+// takes ownership of shd, which must take sokol_gl's vertex layout
+bool text_sdf_init(sg_shader shd);
+
+// font_id is a fontstash handle; the fields come from fontstash's own font
+bool text_sdf_add_font(int font_id);
+// whether text_sdf_add_font took font_id; other fonts stay with fontstash
+bool text_sdf_has_font(int font_id);
+
+// Appends the glyphs of [str, end) at size pixels to text_batch, with the
+// pen at x and the top of the line at y. False when the font is unknown or
+// its atlas is full, with nothing appended.
+bool text_sdf_draw(int font_id, float size, float spacing, float x, float y,
+                   uint32_t color, const char *str, const char *end);
+
+// uploads fields generated this frame; once per frame, after drawing
+void text_sdf_upload(void);
+
+TextSdfStats text_sdf_stats(void);
+
+void text_sdf_shutdown(void);
+
+#endif
@@ -0,0 +1,122 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "trace.h"
+
+#if defined(ANDEX_TRACE)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define TRACE_FLUSH_EVENTS 8192
+
+typedef struct {
+  const char *name;
+  uint64_t ts_ns;
+  double value;
+  char phase;
+} TraceEvent;
+
+bool g_trace_enabled = false;
+
+static struct {
+  FILE *file;
+  TraceEvent events[TRACE_FLUSH_EVENTS];
+  size_t count;
+  size_t written;
+  uint64_t origin_ns;
+} g_trace;
+
+static uint64_t trace_now_ns(void) {
+#if defined(_WIN32)
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER counter;
+  if (freq.QuadPart == 0)
+    QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void trace_flush(void) {
+  for (size_t i = 0; i < g_trace.count; i++) {
+    const TraceEvent *ev = &g_trace.events[i];
+    double ts_us = (double)(ev->ts_ns - g_trace.origin_ns) / 1000.0;
+
+    fputs(g_trace.written++ > 0 ? ",\n" : "\n", g_trace.file);
+    if (ev->phase == 'C') {
+      fprintf(g_trace.file,
+              "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+              "\"args\":{\"value\":%.17g}}",
+              ev->name, ts_us, ev->value);
+    } else {
+      fprintf(g_trace.file,
+              "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}",
+              ev->name, ev->phase, ts_us);
+    }
+  }
+  g_trace.count = 0;
+}
+
+static void trace_push(const char *name, char phase, double value) {
+  if (g_trace.count == TRACE_FLUSH_EVENTS)
+    trace_flush();
+
+  TraceEvent *ev = &g_trace.events[g_trace.count++];
+  ev->name = name;
+  ev->ts_ns = trace_now_ns();
+  ev->value = value;
+  ev->phase = phase;
+}
+
+void trace_init(void) {
+  const char *path = getenv("ANDEX_TRACE_FILE");
+  if (!path || !path[0] || g_trace.file)
+    return;
+
+  g_trace.file = fopen(path, "w");
+  if (!g_trace.file) {
+    fprintf(stderr, "Failed to open trace file: %s\n", path);
+    return;
+  }
+
+  fputs("[", g_trace.file);
+  g_trace.count = 0;
+  g_trace.written = 0;
+  g_trace.origin_ns = trace_now_ns();
+  g_trace_enabled = true;
+  printf("Recording trace to: %s\n", path);
+}
+
+void trace_shutdown(void) {
+  if (!g_trace.file)
+    return;
+
+  trace_flush();
+  fputs("\n]\n", g_trace.file);
+  fclose(g_trace.file);
+  g_trace.file = NULL;
+  g_trace_enabled = false;
+}
+
+void trace_begin(const char *name) { trace_push(name, 'B', 0.0); }
+
+void trace_end(const char *name) { trace_push(name, 'E', 0.0); }
+
+void trace_counter(const char *name, double value) {
+  trace_push(name, 'C', value);
+}
+
+#endif
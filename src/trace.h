@@ -0,0 +1,49 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+// Chrome trace-event recording (chrome://tracing, ui.perfetto.dev).
+// Compiled in with -DANDEX_TRACE and switched on at runtime by pointing
+// the ANDEX_TRACE_FILE environment variable at the output .json file.
+// Scope and counter names must be string literals.
+
+#if defined(ANDEX_TRACE)
+
+extern bool g_trace_enabled;
+
+void trace_init(void);
+void trace_shutdown(void);
+void trace_begin(const char *name);
+void trace_end(const char *name);
+void trace_counter(const char *name, double value);
+
+#define TRACE_INIT() trace_init()
+#define TRACE_SHUTDOWN() trace_shutdown()
+#define TRACE_BEGIN(name)                                                      \
+  do {                                                                         \
+    if (g_trace_enabled)                                                       \
+      trace_begin(name);                                                       \
+  } while (0)
+#define TRACE_END(name)                                                        \
+  do {                                                                         \
+    if (g_trace_enabled)                                                       \
+      trace_end(name);                                                         \
+  } while (0)
+#define TRACE_COUNTER(name, value)                                             \
+  do {                                                                         \
+    if (g_trace_enabled)                                                       \
+      trace_counter(name, (double)(value));                                    \
+  } while (0)
+
+#else
+
+#define TRACE_INIT() ((void)0)
+#define TRACE_SHUTDOWN() ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+
+#endif
+
+#endif
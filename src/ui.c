@@ -0,0 +1,919 @@
+#include "sokol_gfx.h"
+#include "util/sokol_gl.h"
+#include "clay.h"
+#include "fontstash.h"
+#include "util/sokol_fontstash.h"
+#include "shaders.h"
+#include "sokol_clay.h"
+
+#include "app.h"
+#include "height_tree.h"
+#include "res.h"
+#include "ui.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BOTTOM_BAR_HEIGHT 68.0f
+#define SIDEBAR_WIDTH 220.0f
+
+static const Theme LIGHT_THEME = {
+    .background = {248, 248, 248, 255},
+    .sidebar_bg = {245, 245, 245, 255},
+    .text_primary = {0, 0, 0, 255},
+    .text_secondary = {128, 128, 128, 255},
+    .border = {230, 230, 230, 255},
+    .selection = {100, 149, 237, 80},
+    .hover = {240, 240, 240, 255},
+};
+
+static const Theme DARK_THEME = {
+    .background = {40, 40, 40, 255},
+    .sidebar_bg = {30, 30, 30, 255},
+    .text_primary = {230, 230, 230, 255},
+    .text_secondary = {153, 153, 153, 255},
+    .border = {60, 60, 60, 255},
+    .selection = {100, 149, 237, 80},
+    .hover = {50, 50, 50, 255},
+};
+
+static const Clay_String EMPTY_STRING = CLAY_STRING(" ");
+
+const int font_sizes[] = {22, 24, 26, 28, 30, 32, 34};
+const int num_font_sizes = sizeof(font_sizes) / sizeof(font_sizes[0]);
+static Clay_String font_size_strings[] = {
+    CLAY_STRING("22px"), CLAY_STRING("24px"), CLAY_STRING("26px"),
+    CLAY_STRING("28px"), CLAY_STRING("30px"), CLAY_STRING("32px"),
+    CLAY_STRING("34px")};
+
+static const Clay_String WELCOME_MESSAGES[] = {
+    CLAY_STRING("Start typing to begin..."),
+    CLAY_STRING("Begin writing"),
+    CLAY_STRING("Pick a thought and go"),
+    CLAY_STRING("What's on your mind"),
+    CLAY_STRING("Just start"),
+    CLAY_STRING("Type your first thought"),
+    CLAY_STRING("Start with one sentence"),
+    CLAY_STRING("Just say it")};
+
+static const int WELCOME_MESSAGES_COUNT =
+    sizeof(WELCOME_MESSAGES) / sizeof(WELCOME_MESSAGES[0]);
+
+static const Clay_String *selected_welcome_message = NULL;
+
+// lines this far outside the editor's viewport are still laid out as text
+#define EDITOR_OVERSCAN 256.0f
+
+#define SCROLLBAR_WIDTH 4.0f
+#define SCROLLBAR_INSET 4.0f
+#define SCROLLBAR_MIN_THUMB 24.0f
+
+// Heights of the editor's lines from the layout cache, summed in a tree so
+// lines out of view can stand in as two spacers and the scroll range is
+// known without laying the whole document out.
+static struct {
+  Clay_Dimensions (*measure)(Clay_StringSlice text,
+                             Clay_TextElementConfig *config, void *user_data);
+  void *measure_user_data;
+  LayoutCache cache;
+  LayoutStyle style;
+  uint64_t revision; // editor revision the heights are for
+  HeightTree heights;
+  uint64_t *hashes; // render hash and length each height was taken from
+  size_t *lengths;
+  size_t key_capacity;
+} g_lines;
+
+static const Clay_String *get_welcome_message() {
+  if (selected_welcome_message == NULL) {
+    int index = rand() % WELCOME_MESSAGES_COUNT;
+    selected_welcome_message = &WELCOME_MESSAGES[index];
+  }
+  return selected_welcome_message;
+}
+
+sclay_font_t get_current_font() {
+  return res_font((ResourceFontId)g_app->current_font_index);
+}
+
+static Theme *get_current_theme() {
+  return g_app->dark_mode ? (Theme *)&DARK_THEME : (Theme *)&LIGHT_THEME;
+}
+
+static Clay_Color get_background_color() {
+  return get_current_theme()->background;
+}
+
+static Clay_Color get_sidebar_bg_color() {
+  return get_current_theme()->sidebar_bg;
+}
+
+static Clay_Color get_text_color() { return get_current_theme()->text_primary; }
+
+static Clay_Color get_secondary_text_color() {
+  return get_current_theme()->text_secondary;
+}
+
+static Clay_Color get_ui_text_color() {
+  return Clay_Hovered() ? get_text_color() : get_secondary_text_color();
+}
+
+static Clay_Color get_border_color() { return get_current_theme()->border; }
+
+Clay_Color get_selection_color() {
+  return get_current_theme()->selection;
+}
+
+static Clay_Color get_hover_color() { return get_current_theme()->hover; }
+
+Clay_ElementDeclaration IconButtonStyle(bool hovered, float size,
+                                        Clay_ElementId id) {
+  return (Clay_ElementDeclaration){
+      .id = id,
+      .layout = {.sizing = {CLAY_SIZING_FIXED(size), CLAY_SIZING_FIXED(size)}}};
+}
+
+Clay_ElementDeclaration IconStyle(svg_element_t *icon, bool hovered,
+                                  uint32_t normal_color, uint32_t hover_color,
+                                  float_t opacity) {
+  uint32_t color = hovered ? hover_color : normal_color;
+  icon->fill_color = color;
+  icon->stroke_color = color;
+  icon->opacity_override = opacity;
+
+  return (Clay_ElementDeclaration){
+      .custom = {.customData = icon},
+      .layout = {.sizing = {CLAY_SIZING_GROW(), CLAY_SIZING_GROW()}}};
+}
+
+void HandleIconButtonInteraction(Clay_ElementId elementId,
+                                 Clay_PointerData pointerData,
+                                 intptr_t userData) {
+  void (*onClick)(void) = (void (*)(void))userData;
+  if (pointerData.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME && onClick) {
+    onClick();
+  }
+}
+
+void RenderIconButton(Clay_String id, int icon_idx, uint32_t normal_color,
+                      uint32_t hover_color, void (*onClick)(void), float size,
+                      float_t opacity) {
+  CLAY(IconButtonStyle(Clay_Hovered(), size, Clay_GetElementId(id))) {
+    Clay_OnHover(HandleIconButtonInteraction, (intptr_t)onClick);
+    svg_element_t *icon = res_icon((ResourceIconId)icon_idx);
+    CLAY(IconStyle(icon, Clay_Hovered(), normal_color, hover_color, opacity)) {}
+  }
+}
+
+static float measure_line_text(const char *str, size_t len, void *user_data) {
+  (void)user_data;
+  Clay_TextElementConfig config = {
+      .fontId = (uint16_t)g_lines.style.font_id,
+      .fontSize = (uint16_t)g_lines.style.font_size,
+      .letterSpacing = (uint16_t)g_lines.style.letter_spacing,
+      .lineHeight = (uint16_t)g_lines.style.line_height};
+  Clay_StringSlice slice = {
+      .length = (int32_t)len, .chars = str, .baseChars = str};
+  return g_lines.measure(slice, &config, g_lines.measure_user_data).width;
+}
+
+void ui_set_measure_text(Clay_Dimensions (*measure)(
+                             Clay_StringSlice text,
+                             Clay_TextElementConfig *config, void *user_data),
+                         void *user_data) {
+  Clay_SetMeasureTextFunction(measure, user_data);
+  layout_cache_destroy(&g_lines.cache);
+  layout_cache_init(&g_lines.cache, measure_line_text, NULL);
+  g_lines.measure = measure;
+  g_lines.measure_user_data = user_data;
+  g_lines.revision = 0;
+}
+
+static LayoutStyle editor_line_style(void) {
+  const int size = font_sizes[g_app->font_size_index];
+  return (LayoutStyle){
+      .font_id = get_current_font(),
+      .font_size = size,
+      .line_height = (float)(size - 2),
+      .wrap_width = EDITOR_COLUMN_WIDTH - 2.0f * EDITOR_COLUMN_PADDING};
+}
+
+static float line_height_of(TextEditor *editor, size_t i) {
+  const LayoutLine *line = layout_cache_hold(
+      &g_lines.cache, &g_lines.style, editor->render_hashes[i],
+      editor->render_lines[i], editor->render_lengths[i]);
+  g_lines.hashes[i] = editor->render_hashes[i];
+  g_lines.lengths[i] = editor->render_lengths[i];
+  return line ? line->height : g_lines.style.line_height;
+}
+
+static bool reserve_line_keys(size_t count) {
+  if (count <= g_lines.key_capacity)
+    return true;
+  const size_t capacity = count * 2;
+  uint64_t *hashes = realloc(g_lines.hashes, capacity * sizeof(uint64_t));
+  if (!hashes)
+    return false;
+  g_lines.hashes = hashes;
+  size_t *lengths = realloc(g_lines.lengths, capacity * sizeof(size_t));
+  if (!lengths)
+    return false;
+  g_lines.lengths = lengths;
+  g_lines.key_capacity = capacity;
+  return true;
+}
+
+// Clay wraps the lines it draws itself. Where one it laid out last frame
+// came out another height than its cached wrap, the tree takes Clay's, so
+// the spacers, the scroll range and the line at a y follow the screen. The
+// tree hasn't changed since that layout, so the lines are still at the same
+// index.
+static void correct_line_heights(const TextEditor *editor) {
+  const size_t end = editor->layout_end < g_lines.heights.count
+                         ? editor->layout_end
+                         : g_lines.heights.count;
+  for (size_t i = editor->layout_first; i < end; i++) {
+    Clay_ElementData line = Clay_GetElementData(CLAY_IDI("EditorLine", i));
+    if (line.found &&
+        line.boundingBox.height != height_tree_get(&g_lines.heights, i))
+      height_tree_set(&g_lines.heights, i, line.boundingBox.height);
+  }
+}
+
+// Looks every line up again after a style change. An edit only touches the
+// render lines the editor cut again, between an unchanged head and tail of
+// the document: the layouts of the lines it replaced are dropped from the
+// cache and the tree splices the new lines in where the old ones were.
+static void update_line_heights(TextEditor *editor) {
+  const LayoutStyle style = editor_line_style();
+  // a new style moves the rows the chunks of long lines are cut along
+  text_editor_set_row_layout(editor, &g_lines.cache, &style);
+  text_editor_prepare_render_lines(editor);
+  const size_t count = editor->render_line_count;
+  const size_t old_count = g_lines.heights.count;
+  const bool same_style = memcmp(&style, &g_lines.style, sizeof(style)) == 0;
+  if (same_style && g_lines.revision != 0)
+    correct_line_heights(editor);
+  if (editor->render_revision == g_lines.revision && count == old_count &&
+      same_style)
+    return;
+  if (!reserve_line_keys(count))
+    return;
+
+  if (!same_style || g_lines.revision == 0) {
+    layout_cache_next_generation(&g_lines.cache);
+    g_lines.style = style;
+    g_lines.revision = editor->render_revision;
+    if (!height_tree_resize(&g_lines.heights, count)) {
+      g_lines.revision = 0;
+      return;
+    }
+    for (size_t i = 0; i < count; i++)
+      g_lines.heights.heights[i] = line_height_of(editor, i);
+    height_tree_rebuild(&g_lines.heights);
+    return;
+  }
+
+  // the lines the editor says it replaced since these heights, if they are
+  // the last ones it cut, else every line; only those are compared
+  size_t head = 0, tail = 0;
+  if (editor->render_changed_since != 0 &&
+      editor->render_changed_since == g_lines.revision &&
+      editor->render_changed_first + editor->render_changed_removed <=
+          old_count &&
+      editor->render_changed_inserted <= count &&
+      count - editor->render_changed_inserted ==
+          old_count - editor->render_changed_removed) {
+    head = editor->render_changed_first;
+    tail = old_count - head - editor->render_changed_removed;
+  }
+  while (head < old_count - tail && head < count - tail &&
+         g_lines.hashes[head] == editor->render_hashes[head])
+    head++;
+  while (tail < old_count - head && tail < count - head &&
+         g_lines.hashes[old_count - 1 - tail] ==
+             editor->render_hashes[count - 1 - tail])
+    tail++;
+
+  const size_t removed = old_count - tail - head;
+  const size_t inserted = count - tail - head;
+  if (!height_tree_splice(&g_lines.heights, head, removed, inserted)) {
+    g_lines.revision = 0;
+    return;
+  }
+  for (size_t i = head; i < old_count - tail; i++)
+    layout_cache_forget(&g_lines.cache, &g_lines.style, g_lines.hashes[i],
+                        g_lines.lengths[i]);
+  memmove(g_lines.hashes + count - tail, g_lines.hashes + old_count - tail,
+          tail * sizeof(uint64_t));
+  memmove(g_lines.lengths + count - tail, g_lines.lengths + old_count - tail,
+          tail * sizeof(size_t));
+  g_lines.revision = editor->render_revision;
+  for (size_t i = head; i < count - tail; i++)
+    height_tree_set(&g_lines.heights, i, line_height_of(editor, i));
+}
+
+static bool lines_ready(const TextEditor *editor) {
+  return g_lines.measure && g_lines.heights.count > 0 &&
+         g_lines.heights.count == editor->render_line_count;
+}
+
+// Lines [first, end) that overlap the viewport Clay laid out last frame, or
+// every line before there is one.
+static void visible_lines(TextEditor *editor, size_t *first, size_t *end) {
+  *first = 0;
+  *end = editor->render_line_count;
+  Clay_ElementData view = Clay_GetElementData(CLAY_ID("EditorContainer"));
+  if (!lines_ready(editor) || !view.found)
+    return;
+
+  const float top = editor->scroll_y - EDITOR_COLUMN_PADDING - EDITOR_OVERSCAN;
+  const float bottom = top + view.boundingBox.height + 2.0f * EDITOR_OVERSCAN;
+  *first = height_tree_line_at(&g_lines.heights, top);
+  *end = height_tree_line_at(&g_lines.heights, bottom) + 1;
+}
+
+static float editor_content_height(void) {
+  return height_tree_total(&g_lines.heights) + 2.0f * EDITOR_COLUMN_PADDING;
+}
+
+float ui_editor_scroll_limit(void) {
+  TextEditor *editor = &g_app->editor;
+  Clay_ElementData view = Clay_GetElementData(CLAY_ID("EditorContainer"));
+  if (!lines_ready(editor) || !view.found)
+    return INFINITY;
+  return fmaxf(editor_content_height() - view.boundingBox.height, 0.0f);
+}
+
+// Scrolls just far enough to keep the caret's row, with a margin, in view
+// once text_editor_ensure_cursor_visible has asked for it.
+static void follow_cursor(TextEditor *editor) {
+  Clay_ElementData view = Clay_GetElementData(CLAY_ID("EditorContainer"));
+  if (!editor->follow_cursor || !lines_ready(editor) || !view.found)
+    return;
+  editor->follow_cursor = false;
+
+  size_t col;
+  const size_t line =
+      text_editor_render_line_at(editor, editor->cursor.byte_pos, &col);
+  uint32_t row;
+  float caret_x;
+  layout_cache_caret(&g_lines.cache, &g_lines.style,
+                     editor->render_hashes[line], editor->render_lines[line],
+                     editor->render_lengths[line], col, &row, &caret_x);
+
+  const float line_height = g_lines.style.line_height;
+  const float view_height = view.boundingBox.height;
+  const float caret_y = EDITOR_COLUMN_PADDING +
+                        height_tree_top(&g_lines.heights, line) +
+                        (float)row * line_height;
+  float target = editor->target_scroll_y;
+  if (caret_y > target + view_height - line_height * 2)
+    target = caret_y - view_height + line_height * 4;
+  else if (caret_y < target)
+    target = caret_y - line_height;
+  target = fminf(target, editor_content_height() - view_height);
+  target = fmaxf(target, 0.0f);
+
+  if (target != editor->target_scroll_y) {
+    editor->target_scroll_y = target;
+    anim_request_frame(&g_app->anim);
+  }
+}
+
+bool ui_editor_caret(size_t line, size_t byte, float *x, float *y) {
+  TextEditor *editor = &g_app->editor;
+  Clay_ElementData column = Clay_GetElementData(CLAY_ID("TextEditor"));
+  if (!lines_ready(editor) || line >= g_lines.heights.count || !column.found)
+    return false;
+
+  uint32_t row;
+  float caret_x;
+  layout_cache_caret(&g_lines.cache, &g_lines.style,
+                     editor->render_hashes[line], editor->render_lines[line],
+                     editor->render_lengths[line], byte, &row, &caret_x);
+  *x = column.boundingBox.x + EDITOR_COLUMN_PADDING + caret_x;
+  *y = column.boundingBox.y + EDITOR_COLUMN_PADDING +
+       height_tree_top(&g_lines.heights, line) +
+       (float)row * g_lines.style.line_height;
+  return true;
+}
+
+LayoutCacheStats ui_line_cache_stats(void) {
+  return layout_cache_stats(&g_lines.cache);
+}
+
+void ui_shutdown(void) {
+  layout_cache_destroy(&g_lines.cache);
+  height_tree_destroy(&g_lines.heights);
+  free(g_lines.hashes);
+  free(g_lines.lengths);
+  memset(&g_lines, 0, sizeof(g_lines));
+}
+
+static void toggleHistoryBar(void) {
+  g_app->show_sidebar = !g_app->show_sidebar;
+}
+
+static void toggleTheme(void) { g_app->dark_mode = !g_app->dark_mode; }
+
+static void render_sidebar() {
+  if (!g_app->show_sidebar)
+    return;
+
+  CLAY({.id = CLAY_ID("Sidebar"),
+        .backgroundColor = get_sidebar_bg_color(),
+        .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
+                   .sizing = {CLAY_SIZING_FIXED(SIDEBAR_WIDTH),
+                              CLAY_SIZING_GROW(0)}}}) {
+
+    CLAY({.id = CLAY_ID("SidebarHeader"),
+          .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
+                     .padding = {12, 16, 10, 16},
+                     .layoutDirection = CLAY_TOP_TO_BOTTOM,
+                     .childGap = 4},
+          .clip = {.horizontal = true}}) {
+
+      CLAY({.layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
+                       .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
+                       .childAlignment = {.y = CLAY_ALIGN_Y_CENTER},
+                       .childGap = 4}}) {
+
+        Clay_OnHover(HandleOpenDirectory, 0);
+        bool header_hover = Clay_Hovered();
+
+        CLAY_TEXT(CLAY_STRING("History"),
+                  CLAY_TEXT_CONFIG({.fontId = 0,
+                                    .fontSize = 16,
+                                    .textColor = get_ui_text_color()}));
+
+        Clay_Color icon_color = get_ui_text_color();
+        uint32_t icon_color_hex =
+            ((uint8_t)(icon_color.r) << 24) | ((uint8_t)(icon_color.g) << 16) |
+            ((uint8_t)(icon_color.b) << 8) | ((uint8_t)(icon_color.a));
+        svg_element_t *open_icon = res_icon(RES_ICON_TURN_UP_RIGHT);
+        open_icon->fill_color = icon_color_hex;
+        open_icon->stroke_color = icon_color_hex;
+
+        CLAY({.custom = {.customData = open_icon},
+              .layout = {
+                  .sizing = {CLAY_SIZING_FIXED(12), CLAY_SIZING_FIXED(12)}}}) {}
+      }
+
+      Clay_String p = {.chars = g_app->documents_path,
+                       .isStaticallyAllocated = true,
+                       .length = (int)strlen(g_app->documents_path)};
+      CLAY_TEXT(p, CLAY_TEXT_CONFIG(
+                       {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                        .fontSize = 10,
+                        .textColor = get_secondary_text_color(),
+                        .wrapMode = CLAY_TEXT_WRAP_NONE}));
+    }
+
+    CLAY({.backgroundColor = get_border_color(),
+          .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(1)}}}) {}
+
+    CLAY({.id = CLAY_ID("EntriesList"),
+          .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
+                     .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
+          .clip = {.vertical = true}}) {
+
+      for (size_t i = 0; i < g_app->history.count; i++) {
+        FileEntry *entry = &g_app->history.entries[i];
+        Clay_ElementId row_id = CLAY_IDI("HistoryRow", i);
+        bool row_hover = Clay_PointerOver(row_id);
+
+        Clay_Color row_bg =
+            entry->is_selected
+                ? (Clay_Color){255, 255, 255, 14}
+                : (row_hover ? get_hover_color() : (Clay_Color){0, 0, 0, 0});
+
+        CLAY({.id = row_id,
+              .backgroundColor = row_bg,
+              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
+                         .padding = {8, 16, 8, 16},
+                         .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)},
+                         .childAlignment = {.y = CLAY_ALIGN_Y_CENTER}},
+              .clip = {.horizontal = true}}) {
+
+          CLAY({.layout = {
+                    .layoutDirection = CLAY_TOP_TO_BOTTOM,
+                    .childGap = 4,
+                    .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0, 0)}}}) {
+
+            Clay_String pv_s;
+            pv_s = entry->preview[0]
+                       ? (Clay_String){.chars = entry->preview,
+                                       .isStaticallyAllocated = true,
+                                       .length = (int)strlen(entry->preview)}
+                       : CLAY_STRING("(empty)");
+            CLAY_TEXT(pv_s,
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = get_text_color(),
+                           .wrapMode = CLAY_TEXT_WRAP_NONE}));
+
+            Clay_String date = {.chars = entry->date,
+                                .isStaticallyAllocated = true,
+                                .length = (int)strlen(entry->date)};
+            CLAY_TEXT(date,
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 15,
+                           .textColor = get_secondary_text_color(),
+                           .wrapMode = CLAY_TEXT_WRAP_NONE}));
+          }
+
+          if (row_hover) {
+            Clay_ElementId export_id = CLAY_IDI("Export", i);
+            bool hot = Clay_PointerOver(export_id);
+            uint32_t base = g_app->dark_mode ? 0xA0A0A0FF : 0x808080FF;
+            uint32_t on = g_app->dark_mode ? 0xFFFFFFFF : 0x000000FF;
+            uint32_t col = hot ? on : base;
+            svg_element_t *ic = res_icon(RES_ICON_ARROW_DOWN_CIRCLE);
+            ic->fill_color = col;
+            ic->stroke_color = col;
+            CLAY({.id = export_id,
+                  .custom = {.customData = ic},
+                  .layout = {.sizing = {CLAY_SIZING_FIXED(12),
+                                        CLAY_SIZING_FIXED(12)}}}) {
+              Clay_OnHover(HandleEntryExport, (intptr_t)i);
+            }
+
+            CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(8),
+                                        CLAY_SIZING_FIXED(1)}}}) {}
+
+            Clay_ElementId del_id = CLAY_IDI("Delete", i);
+            bool hot2 = Clay_PointerOver(del_id);
+            uint32_t col2 = hot2 ? 0xFF5A5AFF
+                                 : (g_app->dark_mode ? 0xB8B8B8FF : 0x808080FF);
+            svg_element_t *ic2 = res_icon(RES_ICON_TRASH);
+            ic2->fill_color = col2;
+            ic2->stroke_color = col2;
+            CLAY({.id = del_id,
+                  .custom = {.customData = ic2},
+                  .layout = {.sizing = {CLAY_SIZING_FIXED(12),
+                                        CLAY_SIZING_FIXED(12)}}}) {
+              Clay_OnHover(HandleEntryDelete, (intptr_t)i);
+            }
+          }
+        }
+
+        if (row_hover) {
+          g_app->hovered_entry_index = (int)i;
+          Clay_OnHover(HandleEntrySelect, (intptr_t)i);
+        } else if (g_app->hovered_entry_index == (int)i) {
+          g_app->hovered_entry_index = -1;
+        }
+
+        if (i < g_app->history.count - 1) {
+          CLAY({.backgroundColor = get_border_color(),
+                .layout = {
+                    .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(1)}}}) {}
+        }
+      }
+    }
+  }
+}
+
+// A thumb sized to the share of the document in view, floated over the
+// editor's right edge; declared outside the clip so it doesn't scroll.
+static void render_scrollbar(TextEditor *editor) {
+  Clay_ElementData view = Clay_GetElementData(CLAY_ID("EditorContainer"));
+  if (!lines_ready(editor) || !view.found)
+    return;
+  const float view_height = view.boundingBox.height;
+  const float content_height = editor_content_height();
+  if (content_height <= view_height + 1.0f)
+    return;
+
+  const float track = view_height - 2.0f * SCROLLBAR_INSET;
+  const float thumb =
+      fmaxf(track * view_height / content_height, SCROLLBAR_MIN_THUMB);
+  const float range = content_height - view_height;
+  const float progress = fminf(fmaxf(editor->scroll_y / range, 0.0f), 1.0f);
+  CLAY({.id = CLAY_ID("EditorScrollbar"),
+        .backgroundColor = get_border_color(),
+        .cornerRadius = CLAY_CORNER_RADIUS(SCROLLBAR_WIDTH / 2.0f),
+        .layout = {.sizing = {CLAY_SIZING_FIXED(SCROLLBAR_WIDTH),
+                              CLAY_SIZING_FIXED(thumb)}},
+        .floating = {
+            .attachTo = CLAY_ATTACH_TO_ELEMENT_WITH_ID,
+            .parentId = CLAY_ID("EditorContainer").id,
+            .attachPoints = {.element = CLAY_ATTACH_POINT_RIGHT_TOP,
+                             .parent = CLAY_ATTACH_POINT_RIGHT_TOP},
+            .offset = {-SCROLLBAR_INSET,
+                       SCROLLBAR_INSET + (track - thumb) * progress},
+            .pointerCaptureMode = CLAY_POINTER_CAPTURE_MODE_PASSTHROUGH,
+            .zIndex = 50}}) {}
+}
+
+void render_editor_ui() {
+  TextEditor *editor = &g_app->editor;
+
+  CLAY({.id = CLAY_ID("MainContainer"),
+        .backgroundColor = get_background_color(),
+        .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
+                   .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}}}) {
+
+    CLAY({.id = CLAY_ID("ContentArea"),
+          .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM,
+                     .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}}}) {
+
+      CLAY(
+          {.id = CLAY_ID("EditorContainer"),
+           .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
+                      .childAlignment = {.x = CLAY_ALIGN_X_CENTER}},
+           .clip = {.vertical = true, .childOffset = {0, -editor->scroll_y}}}) {
+        // decoded the first time it is shown, NULL until then
+        sclay_image *win = g_app->lol ? res_image(RES_IMG_WIN) : NULL;
+        if (win) {
+          CLAY({.image = {.imageData = win},
+                .layout = {.sizing = {CLAY_SIZING_FIXED(512.0f),
+                                      CLAY_SIZING_FIXED(512.0f)}},
+                .floating = {
+                    .attachTo = CLAY_ATTACH_TO_PARENT,
+                    .attachPoints = {.element = CLAY_ATTACH_POINT_CENTER_CENTER,
+                                     .parent = CLAY_ATTACH_POINT_CENTER_CENTER},
+                    .zIndex = 100}}) {}
+        }
+
+        CLAY({.id = CLAY_ID("TextEditor"),
+              .layout = {
+                  .sizing = {CLAY_SIZING_FIXED(EDITOR_COLUMN_WIDTH),
+                             CLAY_SIZING_FIT(0, 0)},
+                  .padding = {EDITOR_COLUMN_PADDING, EDITOR_COLUMN_PADDING,
+                              EDITOR_COLUMN_PADDING, EDITOR_COLUMN_PADDING},
+                  .layoutDirection = CLAY_TOP_TO_BOTTOM}}) {
+
+          if (editor->render_line_count == 0 ||
+              (editor->render_line_count == 1 &&
+               editor->render_lengths[0] == 0)) {
+            CLAY_TEXT(*get_welcome_message(),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = get_current_font(),
+                           .fontSize = font_sizes[g_app->font_size_index],
+                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
+                           .textColor = get_secondary_text_color(),
+                           .textAlignment = CLAY_TEXT_ALIGN_CENTER}));
+          } else {
+            update_line_heights(editor);
+            follow_cursor(editor);
+            size_t first, end;
+            visible_lines(editor, &first, &end);
+            editor->layout_first = first;
+            editor->layout_end = end;
+            size_t cursor_col;
+            const size_t cursor_line = text_editor_render_line_at(
+                editor, editor->cursor.byte_pos, &cursor_col);
+
+            if (first > 0) {
+              CLAY({.id = CLAY_ID("EditorLinesAbove"),
+                    .layout = {.sizing = {CLAY_SIZING_FIT(0, 0),
+                                          CLAY_SIZING_FIXED(height_tree_top(
+                                              &g_lines.heights, first))}}}) {}
+            }
+            for (size_t i = first; i < end; i++) {
+              Clay_ElementId line_id = CLAY_IDI("EditorLine", i);
+              void *line_tag =
+                  (i == cursor_line) ? &g_app->current_line_tag : NULL;
+
+              CLAY({.id = line_id,
+                    .layout = {.sizing = {CLAY_SIZING_FIT(0, 0),
+                                          CLAY_SIZING_GROW(0)}}}) {
+                if (editor->render_lengths[i] > 0) {
+                  Clay_String text = {.chars = editor->render_lines[i],
+                                      .isStaticallyAllocated = true,
+                                      .length = (int)editor->render_lengths[i]};
+
+                  CLAY_TEXT(
+                      text,
+                      CLAY_TEXT_CONFIG(
+                          {.userData = line_tag,
+                           .textColor = get_text_color(),
+                           .fontId = get_current_font(),
+                           .fontSize = font_sizes[g_app->font_size_index],
+                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
+                           .wrapMode = CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD,
+                           .textAlignment = CLAY_TEXT_ALIGN_LEFT}));
+                } else {
+                  CLAY_TEXT(
+                      EMPTY_STRING,
+                      CLAY_TEXT_CONFIG(
+                          {.userData = line_tag,
+                           .textColor = get_text_color(),
+                           .fontId = get_current_font(),
+                           .fontSize = font_sizes[g_app->font_size_index],
+                           .lineHeight = font_sizes[g_app->font_size_index] - 2,
+                           .wrapMode = CLAY_TEXT_WRAP_OVERFLOW_BREAK_WORD,
+                           .textAlignment = CLAY_TEXT_ALIGN_LEFT}));
+                }
+              }
+            }
+            if (end < editor->render_line_count) {
+              CLAY({.id = CLAY_ID("EditorLinesBelow"),
+                    .layout = {.sizing = {CLAY_SIZING_FIT(0, 0),
+                                          CLAY_SIZING_FIXED(
+                                              height_tree_total(
+                                                  &g_lines.heights) -
+                                              height_tree_top(&g_lines.heights,
+                                                              end))}}}) {}
+            }
+          }
+        }
+      }
+      render_scrollbar(editor);
+
+      CLAY(
+          {.id = CLAY_ID("BottomNav"),
+           .backgroundColor = get_background_color(),
+           .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(68.0f)},
+                      .padding = {16, 16, 16, 16},
+                      .childAlignment = {.y = CLAY_ALIGN_Y_CENTER}}}) {
+
+        bool is_hovering = Clay_Hovered();
+        g_app->bottom_nav_hovering = is_hovering;
+
+        if (is_hovering && g_app->timer_running) {
+          g_app->bottom_nav_opacity = 1.0f;
+        }
+
+        float opacity = g_app->bottom_nav_opacity;
+        Clay_Color dot_color = get_secondary_text_color();
+        dot_color.a = (uint8_t)(dot_color.a * opacity);
+        CLAY({.id = CLAY_ID("FontControls"),
+              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
+                         .childGap = 8,
+                         .padding = {8, 8, 8, 8}}}) {
+
+          CLAY({.id = CLAY_ID("FontSize")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(font_size_strings[g_app->font_size_index],
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFontSizeChange, 0);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("FontLato")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("Lato"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_LATO_REGULAR);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("FontArial")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("Arial"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_ARIAL);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("FontSerif")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("Serif"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_SERIF);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("FontMono")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("Mono"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFontSelect, (intptr_t)RES_FONT_FIRA_MONO);
+          }
+        }
+
+        CLAY({.layout = {
+                  .sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIXED(0.0f)}}}) {}
+
+        CLAY({.id = CLAY_ID("UtilityControls"),
+              .layout = {.layoutDirection = CLAY_LEFT_TO_RIGHT,
+                         .childGap = 8,
+                         .padding = {8, 8, 8, 8}}}) {
+
+          CLAY({.id = CLAY_ID("Timer")}) {
+            Clay_String time = {.chars = g_app->timer_string,
+                                .isStaticallyAllocated = true,
+                                .length = (int)strlen(g_app->timer_string)};
+            Clay_Color timer_color =
+                g_app->timer_running ? get_text_color() : get_ui_text_color();
+            timer_color.a = (uint8_t)(timer_color.a * opacity);
+            CLAY_TEXT(time,
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = timer_color}));
+            Clay_OnHover(HandleTimerToggle, 0);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("ChatButton")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("Chat"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleLulCow, 0);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("FullscreenButton")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(g_app->window_state == APP_WINDOW_FULLSCREEN
+                          ? CLAY_STRING("Minimize")
+                          : CLAY_STRING("Fullscreen"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleFullscreenToggle, 0);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          CLAY({.id = CLAY_ID("NewEntryButton")}) {
+            Clay_Color text_color = get_ui_text_color();
+            text_color.a = (uint8_t)(text_color.a * opacity);
+            CLAY_TEXT(CLAY_STRING("New Entry"),
+                      CLAY_TEXT_CONFIG(
+                          {.fontId = g_app->gfx.fonts[RES_FONT_LATO_REGULAR],
+                           .fontSize = 16,
+                           .textColor = text_color}));
+            Clay_OnHover(HandleNewEntry, 0);
+          }
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          uint32_t icon_normal = g_app->dark_mode ? 0x808080FF : 0x808080FF;
+          uint32_t icon_hover = g_app->dark_mode ? 0xFFFFFFFF : 0x000000FF;
+
+          uint8_t alpha_normal = (uint8_t)(0x80 * opacity);
+          uint8_t alpha_hover = (uint8_t)(0xFF * opacity);
+          icon_normal = (icon_normal & 0xFFFFFF00) | alpha_normal;
+          icon_hover = (icon_hover & 0xFFFFFF00) | alpha_hover;
+
+          RenderIconButton(CLAY_STRING("ThemeToggle"),
+                           g_app->dark_mode ? RES_ICON_SUN : RES_ICON_MOON,
+                           icon_normal, icon_hover, toggleTheme, 16.0f,
+                           opacity);
+
+          CLAY_TEXT(CLAY_STRING("•"),
+                    CLAY_TEXT_CONFIG({.fontSize = 16, .textColor = dot_color}));
+
+          RenderIconButton(CLAY_STRING("HistoryButton"), RES_ICON_HISTORY,
+                           icon_normal, icon_hover, toggleHistoryBar, 16.0f,
+                           opacity);
+        }
+      }
+    }
+
+    if (g_app->show_sidebar) {
+      CLAY(
+          {.backgroundColor = get_border_color(),
+           .layout = {.sizing = {CLAY_SIZING_FIXED(1), CLAY_SIZING_GROW(0)}}}) {
+      }
+      render_sidebar();
+    }
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef UI_H
+#define UI_H
+
+// Clay layout for the editor window. Everything here only builds layout
+// commands from g_app, so it runs without a GPU given a measure function.
+
+#include "layout_cache.h"
+
+#define EDITOR_COLUMN_WIDTH 650.0f
+#define EDITOR_COLUMN_PADDING 40
+
+extern const int font_sizes[];
+extern const int num_font_sizes;
+
+sclay_font_t get_current_font();
+Clay_Color get_selection_color();
+
+void render_editor_ui();
+
+// Sets Clay's text measurement and the one the editor's line layout cache
+// wraps with, which have to agree for lines out of view to keep their height.
+void ui_set_measure_text(Clay_Dimensions (*measure)(
+                             Clay_StringSlice text,
+                             Clay_TextElementConfig *config, void *user_data),
+                         void *user_data);
+
+// Position of the caret before byte of a render line from the line layout
+// cache, for lines not laid out as text this frame. False before the first
+// layout.
+bool ui_editor_caret(size_t line, size_t byte, float *x, float *y);
+
+// Furthest the editor can scroll, from its laid out height and last frame's
+// viewport; INFINITY until both are known.
+float ui_editor_scroll_limit(void);
+
+LayoutCacheStats ui_line_cache_stats(void);
+
+void ui_shutdown(void);
+
+#endif
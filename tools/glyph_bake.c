@@ -0,0 +1,283 @@
+// Rasterizes the glyphs resources.h lists under RES_GLYPH_BAKE_* into atlas
+// pages, one per font, pixel size and codepoint range, for main.c to copy
+// into the fontstash atlas instead of rasterizing at startup. The glyphs go
+// through fontstash itself, so they are the same bitmaps and metrics it
+// would produce on demand.
+//
+//   andex_glyph_bake <glyph_atlas.h> <glyph_atlas.bin>
+//
+// The header holds the page and glyph tables and embeds the binary file,
+// which holds every page's alpha with runs of 0x00 and 0xFF coded as the
+// byte followed by a run length.
+
+#define FONTSTASH_IMPLEMENTATION
+#include "fontstash.h"
+
+#include "resources.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pages are packed by fontstash's own skyline packer in a scratch atlas this
+// wide; main.c grows its atlas to at least this width to seed them.
+#define BAKE_PAGE_WIDTH 512
+#define BAKE_PAGE_MAX_HEIGHT 4096
+
+typedef struct {
+  const char *font_name;
+  int font;
+  short isize; // pixel size * 10, fontstash's glyph key
+  int width, height;
+  uint32_t data_offset, data_size;
+  uint32_t first_glyph, nglyphs;
+} BakePage;
+
+typedef struct {
+  unsigned int codepoint;
+  int index;
+  short x0, y0, x1, y1;
+  short xadv, xoff, yoff;
+} BakeGlyph;
+
+static struct {
+  BakePage *pages;
+  int npages, cpages;
+  BakeGlyph *glyphs;
+  int nglyphs, cglyphs;
+  unsigned char *data;
+  size_t ndata, cdata;
+} g_bake;
+
+static void *grow(void *ptr, int *capacity, int needed, size_t item) {
+  if (needed <= *capacity)
+    return ptr;
+  int capacity2 = *capacity ? *capacity * 2 : 64;
+  while (capacity2 < needed)
+    capacity2 *= 2;
+  void *grown = realloc(ptr, (size_t)capacity2 * item);
+  if (!grown) {
+    fprintf(stderr, "glyph_bake: out of memory\n");
+    exit(1);
+  }
+  *capacity = capacity2;
+  return grown;
+}
+
+static void put_byte(unsigned char b) {
+  if (g_bake.ndata == g_bake.cdata) {
+    g_bake.cdata = g_bake.cdata ? g_bake.cdata * 2 : 1 << 16;
+    g_bake.data = realloc(g_bake.data, g_bake.cdata);
+    if (!g_bake.data) {
+      fprintf(stderr, "glyph_bake: out of memory\n");
+      exit(1);
+    }
+  }
+  g_bake.data[g_bake.ndata++] = b;
+}
+
+// Glyph coverage is mostly empty or solid, so only those two values are
+// run-length coded; anti-aliased edges stay literal bytes.
+static void put_alpha(const unsigned char *alpha, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    unsigned char b = alpha[i];
+    if (b != 0x00 && b != 0xFF) {
+      put_byte(b);
+      i++;
+      continue;
+    }
+    size_t run = 1;
+    while (i + run < n && alpha[i + run] == b && run < 255)
+      run++;
+    put_byte(b);
+    put_byte((unsigned char)run);
+    i += run;
+  }
+}
+
+static void bake_page(const char *font_name, int font_id, float px,
+                      unsigned int first, unsigned int last) {
+  FONSparams params = {.width = BAKE_PAGE_WIDTH,
+                       .height = BAKE_PAGE_MAX_HEIGHT,
+                       .flags = FONS_ZERO_TOPLEFT};
+  FONScontext *fs = fonsCreateInternal(&params);
+  if (!fs) {
+    fprintf(stderr, "glyph_bake: out of memory\n");
+    exit(1);
+  }
+  int font = fonsAddFontMem(fs, font_name,
+                            (unsigned char *)RES_GET_FONT_DATA(font_id),
+                            (int)RES_GET_FONT_SIZE(font_id), 0);
+  if (font == FONS_INVALID) {
+    fprintf(stderr, "glyph_bake: %s does not load\n", font_name);
+    exit(1);
+  }
+
+  short isize = (short)(px * 10.0f);
+  int minx = BAKE_PAGE_WIDTH, miny = BAKE_PAGE_MAX_HEIGHT, maxx = 0, maxy = 0;
+  int first_glyph = g_bake.nglyphs;
+  for (unsigned int cp = first; cp <= last; cp++) {
+    FONSglyph *glyph = fons__getGlyph(fs, fs->fonts[font], cp, isize, 0,
+                                      FONS_GLYPH_BITMAP_REQUIRED);
+    if (!glyph) {
+      fprintf(stderr, "glyph_bake: %s %.1fpx U+%04X does not fit a page\n",
+              font_name, px, cp);
+      exit(1);
+    }
+    g_bake.glyphs = grow(g_bake.glyphs, &g_bake.cglyphs, g_bake.nglyphs + 1,
+                         sizeof(BakeGlyph));
+    g_bake.glyphs[g_bake.nglyphs++] = (BakeGlyph){
+        glyph->codepoint, glyph->index, glyph->x0,   glyph->y0,  glyph->x1,
+        glyph->y1,        glyph->xadv,  glyph->xoff, glyph->yoff};
+    if (glyph->x0 < minx)
+      minx = glyph->x0;
+    if (glyph->y0 < miny)
+      miny = glyph->y0;
+    if (glyph->x1 > maxx)
+      maxx = glyph->x1;
+    if (glyph->y1 > maxy)
+      maxy = glyph->y1;
+  }
+
+  // crop to the glyphs; the page skips fontstash's white rect at 0, 0
+  int width = maxx - minx, height = maxy - miny;
+  for (int i = first_glyph; i < g_bake.nglyphs; i++) {
+    BakeGlyph *g = &g_bake.glyphs[i];
+    g->x0 = (short)(g->x0 - minx);
+    g->x1 = (short)(g->x1 - minx);
+    g->y0 = (short)(g->y0 - miny);
+    g->y1 = (short)(g->y1 - miny);
+  }
+  uint32_t data_offset = (uint32_t)g_bake.ndata;
+  for (int y = 0; y < height; y++)
+    put_alpha(fs->texData + (size_t)(miny + y) * BAKE_PAGE_WIDTH + minx,
+              (size_t)width);
+
+  g_bake.pages = grow(g_bake.pages, &g_bake.cpages, g_bake.npages + 1,
+                      sizeof(BakePage));
+  g_bake.pages[g_bake.npages++] = (BakePage){
+      .font_name = font_name,
+      .font = font_id,
+      .isize = isize,
+      .width = width,
+      .height = height,
+      .data_offset = data_offset,
+      .data_size = (uint32_t)(g_bake.ndata - data_offset),
+      .first_glyph = (uint32_t)first_glyph,
+      .nglyphs = (uint32_t)(g_bake.nglyphs - first_glyph),
+  };
+  fonsDeleteInternal(fs);
+}
+
+static void bake_face(const char *font_name, int font_id, int size) {
+  static const float scales[] = {
+#define BAKE_SCALE(s) (float)(s),
+      RES_GLYPH_BAKE_SCALES(BAKE_SCALE)
+#undef BAKE_SCALE
+  };
+  static const unsigned int ranges[][2] = {
+#define BAKE_RANGE(first, last) {first, last},
+      RES_GLYPH_BAKE_RANGES(BAKE_RANGE)
+#undef BAKE_RANGE
+  };
+  for (size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++)
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+      bake_page(font_name, font_id, (float)size * scales[s], ranges[r][0],
+                ranges[r][1]);
+}
+
+static bool write_header(const char *path, const char *bin_name) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fprintf(f,
+          "/* Generated by andex_glyph_bake from resources.h — do not edit. "
+          "*/\n"
+          "#ifndef GLYPH_ATLAS_H\n"
+          "#define GLYPH_ATLAS_H\n\n"
+          "#include <stdint.h>\n\n"
+          "#include \"resources.h\"\n\n"
+          "/* Glyph positions are page pixels, padding included; the rest is "
+          "as\n   FONSglyph stores it. */\n"
+          "typedef struct BakedGlyph {\n"
+          "  uint32_t codepoint;\n"
+          "  int32_t index;\n"
+          "  int16_t x0, y0, x1, y1;\n"
+          "  int16_t xadv, xoff, yoff;\n"
+          "} BakedGlyph;\n\n"
+          "typedef struct BakedGlyphPage {\n"
+          "  ResourceFontId font;\n"
+          "  int16_t isize; /* pixel size * 10 */\n"
+          "  int width, height;\n"
+          "  uint32_t data_offset, data_size; /* in g_baked_glyph_data */\n"
+          "  uint32_t first_glyph, nglyphs;\n"
+          "} BakedGlyphPage;\n\n"
+          "/* page alpha, runs of 0x00 and 0xFF as the byte and a count */\n"
+          "static const unsigned char g_baked_glyph_data[] = {\n"
+          "#embed \"%s\"\n"
+          "};\n\n",
+          bin_name);
+
+  fprintf(f, "static const BakedGlyph g_baked_glyphs[%d] = {\n",
+          g_bake.nglyphs);
+  for (int i = 0; i < g_bake.nglyphs; i++) {
+    const BakeGlyph *g = &g_bake.glyphs[i];
+    fprintf(f, "    {%u, %d, %d, %d, %d, %d, %d, %d, %d},\n", g->codepoint,
+            g->index, g->x0, g->y0, g->x1, g->y1, g->xadv, g->xoff, g->yoff);
+  }
+  fprintf(f, "};\n\n");
+
+  fprintf(f, "#define BAKED_GLYPH_PAGE_COUNT %d\n", g_bake.npages);
+  fprintf(f, "static const BakedGlyphPage "
+             "g_baked_glyph_pages[BAKED_GLYPH_PAGE_COUNT] = {\n");
+  for (int i = 0; i < g_bake.npages; i++) {
+    const BakePage *p = &g_bake.pages[i];
+    fprintf(f, "    {%s, %d, %d, %d, %u, %u, %u, %u},\n", p->font_name,
+            p->isize, p->width, p->height, p->data_offset, p->data_size,
+            p->first_glyph, p->nglyphs);
+  }
+  fprintf(f, "};\n\n#endif /* GLYPH_ATLAS_H */\n");
+  return fclose(f) == 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <glyph_atlas.h> <glyph_atlas.bin>\n", argv[0]);
+    return 2;
+  }
+
+#define BAKE_FACE(font, size) bake_face(#font, font, size);
+  RES_GLYPH_BAKE_FACES(BAKE_FACE)
+#undef BAKE_FACE
+  if (g_bake.npages == 0) {
+    fprintf(stderr, "glyph_bake: resources.json bakes no glyphs, configure "
+                    "with ANDEX_BAKED_GLYPHS=OFF instead\n");
+    return 1;
+  }
+
+  FILE *bin = fopen(argv[2], "wb");
+  if (!bin || (g_bake.ndata > 0 &&
+               fwrite(g_bake.data, 1, g_bake.ndata, bin) != g_bake.ndata)) {
+    fprintf(stderr, "glyph_bake: cannot write %s\n", argv[2]);
+    return 1;
+  }
+  fclose(bin);
+
+  const char *bin_name = argv[2];
+  for (const char *c = argv[2]; *c; c++)
+    if (*c == '/' || *c == '\\')
+      bin_name = c + 1;
+  if (!write_header(argv[1], bin_name)) {
+    fprintf(stderr, "glyph_bake: cannot write %s\n", argv[1]);
+    return 1;
+  }
+
+  printf("glyph_bake: %d pages, %d glyphs, %zu bytes\n", g_bake.npages,
+         g_bake.nglyphs, g_bake.ndata);
+  free(g_bake.pages);
+  free(g_bake.glyphs);
+  free(g_bake.data);
+  return 0;
+}